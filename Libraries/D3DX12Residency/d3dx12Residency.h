@@ -10,9 +10,36 @@
 //*********************************************************
 
 #pragma once
+
+#include <atomic>
+
+// The library only needs a few locks, events and a worker thread from the OS. By default these come from Win32, but
+// defining RESIDENCY_PORTABLE_THREADING as 1 builds them on the C++ standard library instead so that the scheduling, LRU
+// and batching logic can run on other hosts (see d3dx12ResidencyMock.h).
+#ifndef RESIDENCY_PORTABLE_THREADING
+#ifdef _WIN32
+#define RESIDENCY_PORTABLE_THREADING 0
+#else
+#define RESIDENCY_PORTABLE_THREADING 1
+#endif
+#endif
+
+#if RESIDENCY_PORTABLE_THREADING
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#ifdef _MSC_VER
+#define RESIDENCY_SELECTANY __declspec(selectany)
+#else
+#define RESIDENCY_SELECTANY __attribute__((weak))
+#endif
+
 namespace D3DX12Residency
 {
-	__declspec(selectany) INT64 g_ResidencyManagerUniqueID = 0;
+	RESIDENCY_SELECTANY INT64 g_ResidencyManagerUniqueID = 0;
 
 #if 0
 #define RESIDENCY_CHECK(x) \
@@ -22,22 +49,143 @@ namespace D3DX12Residency
 	if((x) != S_OK) { DebugBreak(); }
 #else
 #define RESIDENCY_CHECK(x)
-#define RESIDENCY_CHECK_RESULT(x) x
+#define RESIDENCY_CHECK_RESULT(x) (void)(x)
 #endif
 
 #define RESIDENCY_SINGLE_THREADED 0
 
+	// How many sync points of paging statistics are kept. Set to 0 to stop recording them.
+#define RESIDENCY_STATISTICS_HISTORY_SIZE 256
+
 #define RESIDENCY_MIN(x,y) ((x) < (y) ? (x) : (y))
 #define RESIDENCY_MAX(x,y) ((x) > (y) ? (x) : (y))
 
-	// This size can be tuned to your app in order to save space
-#define MAX_NUM_CONCURRENT_CMD_LISTS 32
+	// This size can be tuned to your app in order to save space. Each managed object uses one bit per command list,
+	// rounded up to a multiple of 32.
+#define MAX_NUM_CONCURRENT_CMD_LISTS 64
+#define RESIDENCY_CMD_LIST_MASK_WORDS ((MAX_NUM_CONCURRENT_CMD_LISTS + 31) / 32)
 
 	namespace Internal
 	{
+		/* Platform Layer */
+#if RESIDENCY_PORTABLE_THREADING
+		class CriticalSection
+		{
+		public:
+			void Enter() { CS.lock(); }
+			void Leave() { CS.unlock(); }
+
+		private:
+			std::mutex CS;
+		};
+
+		class Event
+		{
+		public:
+			Event() : Created(false), ManualReset(false), Signaled(false) {}
+
+			HRESULT Create(bool ManualResetIn)
+			{
+				ManualReset = ManualResetIn;
+				Signaled = false;
+				Created = true;
+				return S_OK;
+			}
+
+			void Destroy() { Created = false; }
+			bool IsCreated() const { return Created; }
+
+			HRESULT Set()
+			{
+				{
+					std::lock_guard<std::mutex> Lock(EventMutex);
+					Signaled = true;
+				}
+				Condition.notify_all();
+				return S_OK;
+			}
+
+			HRESULT Reset()
+			{
+				std::lock_guard<std::mutex> Lock(EventMutex);
+				Signaled = false;
+				return S_OK;
+			}
+
+			void Wait()
+			{
+				std::unique_lock<std::mutex> Lock(EventMutex);
+				Condition.wait(Lock, [this] { return Signaled; });
+				if (ManualReset == false)
+				{
+					Signaled = false;
+				}
+			}
+
+		private:
+			std::mutex EventMutex;
+			std::condition_variable Condition;
+			bool Created;
+			bool ManualReset;
+			bool Signaled;
+		};
+
+		class Thread
+		{
+		public:
+			HRESULT Start(unsigned long (*pThreadFunction)(void*), void* pData)
+			{
+				WorkerThread = std::thread(pThreadFunction, pData);
+				return S_OK;
+			}
+
+			void Join()
+			{
+				if (WorkerThread.joinable())
+				{
+					WorkerThread.join();
+				}
+			}
+
+		private:
+			std::thread WorkerThread;
+		};
+
+		inline UINT64 GetTimestamp()
+		{
+			return UINT64(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		inline UINT64 GetTimestampFrequency()
+		{
+			return 1000000000ull;
+		}
+
+		inline INT64 AtomicIncrement(volatile INT64* pValue) { return __atomic_add_fetch(pValue, 1, __ATOMIC_SEQ_CST); }
+		inline UINT32 AtomicIncrement(volatile UINT32* pValue) { return __atomic_add_fetch(pValue, 1, __ATOMIC_SEQ_CST); }
+
+		// Return the previous value of the bit
+		inline bool AtomicBitTestAndSet(volatile LONG* pValue, LONG Bit) { return ((__atomic_fetch_or(pValue, LONG(1u << Bit), __ATOMIC_SEQ_CST) >> Bit) & 1) != 0; }
+		inline bool AtomicBitTestAndReset(volatile LONG* pValue, LONG Bit) { return ((__atomic_fetch_and(pValue, LONG(~(1u << Bit)), __ATOMIC_SEQ_CST) >> Bit) & 1) != 0; }
+
+		inline bool BitScanForward(UINT32* pIndex, UINT32 Mask)
+		{
+			if (Mask == 0)
+			{
+				return false;
+			}
+			*pIndex = UINT32(__builtin_ctz(Mask));
+			return true;
+		}
+
+		// A null event makes SetEventOnCompletion block until the fence reaches the value
+		inline void WaitForFence(ID3D12Fence* pFence, UINT64 Value, Event&)
+		{
+			RESIDENCY_CHECK_RESULT(pFence->SetEventOnCompletion(Value, nullptr));
+		}
+#else
 		class CriticalSection
 		{
-			friend class ScopedLock;
 		public:
 			CriticalSection()
 			{
@@ -49,10 +197,107 @@ namespace D3DX12Residency
 				DeleteCriticalSection(&CS);
 			}
 
+			void Enter() { EnterCriticalSection(&CS); }
+			void Leave() { LeaveCriticalSection(&CS); }
+
 		private:
 			CRITICAL_SECTION CS;
 		};
 
+		class Event
+		{
+		public:
+			Event() : Handle(nullptr) {}
+			~Event() { Destroy(); }
+
+			HRESULT Create(bool ManualReset)
+			{
+				Handle = CreateEvent(nullptr, ManualReset, false, nullptr);
+				return Handle ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+			}
+
+			void Destroy()
+			{
+				if (Handle)
+				{
+					CloseHandle(Handle);
+					Handle = nullptr;
+				}
+			}
+
+			bool IsCreated() const { return Handle != nullptr; }
+
+			HRESULT Set() { return SetEvent(Handle) ? S_OK : HRESULT_FROM_WIN32(GetLastError()); }
+			HRESULT Reset() { return ResetEvent(Handle) ? S_OK : HRESULT_FROM_WIN32(GetLastError()); }
+			void Wait() { WaitForSingleObject(Handle, INFINITE); }
+
+			HANDLE GetHandle() const { return Handle; }
+
+		private:
+			HANDLE Handle;
+		};
+
+		class Thread
+		{
+		public:
+			Thread() : Handle(nullptr) {}
+
+			HRESULT Start(unsigned long (WINAPI* pThreadFunction)(void*), void* pData)
+			{
+				Handle = CreateThread(nullptr, 0, pThreadFunction, pData, 0, nullptr);
+				return Handle ? S_OK : HRESULT_FROM_WIN32(GetLastError());
+			}
+
+			void Join()
+			{
+				if (Handle)
+				{
+					WaitForSingleObject(Handle, INFINITE);
+					CloseHandle(Handle);
+					Handle = nullptr;
+				}
+			}
+
+		private:
+			HANDLE Handle;
+		};
+
+		inline UINT64 GetTimestamp()
+		{
+			LARGE_INTEGER Time;
+			QueryPerformanceCounter(&Time);
+			return UINT64(Time.QuadPart);
+		}
+
+		inline UINT64 GetTimestampFrequency()
+		{
+			LARGE_INTEGER Frequency;
+			QueryPerformanceFrequency(&Frequency);
+			return UINT64(Frequency.QuadPart);
+		}
+
+		inline INT64 AtomicIncrement(volatile INT64* pValue) { return InterlockedIncrement64(pValue); }
+		inline UINT32 AtomicIncrement(volatile UINT32* pValue) { return InterlockedIncrement(pValue); }
+
+		// Return the previous value of the bit
+		inline bool AtomicBitTestAndSet(volatile LONG* pValue, LONG Bit) { return InterlockedBitTestAndSet(pValue, Bit) != 0; }
+		inline bool AtomicBitTestAndReset(volatile LONG* pValue, LONG Bit) { return InterlockedBitTestAndReset(pValue, Bit) != 0; }
+
+		inline bool BitScanForward(UINT32* pIndex, UINT32 Mask)
+		{
+			DWORD Index;
+			const bool Found = _BitScanForward(&Index, Mask) != 0;
+			*pIndex = UINT32(Index);
+			return Found;
+		}
+
+		inline void WaitForFence(ID3D12Fence* pFence, UINT64 Value, Event& CompletionEvent)
+		{
+			RESIDENCY_CHECK_RESULT(pFence->SetEventOnCompletion(Value, CompletionEvent.GetHandle()));
+			CompletionEvent.Wait();
+		}
+#endif
+
 		class ScopedLock
 		{
 		public:
@@ -62,7 +307,7 @@ namespace D3DX12Residency
 			{
 				if (pCS)
 				{
-					EnterCriticalSection(&pCS->CS);
+					pCS->Enter();
 				}
 			};
 
@@ -70,7 +315,7 @@ namespace D3DX12Residency
 			{
 				if (pCS)
 				{
-					LeaveCriticalSection(&pCS->CS);
+					pCS->Leave();
 				}
 			}
 
@@ -87,21 +332,128 @@ namespace D3DX12Residency
 			{
 				for (UINT32 i = 0; i < ARRAYSIZE(AvailableCommandLists); i++)
 				{
-					AvailableCommandLists[i] = false;
+					AvailableCommandLists[i] = 0;
 				}
 			}
 
-			Internal::CriticalSection MaskCriticalSection;
+			// Claims the first command list that isn't open without taking a lock, so that many recording
+			// threads can open residency sets at once. Returns false if they are all in use.
+			bool ClaimCommandList(UINT32& Index)
+			{
+				for (UINT32 Word = 0; Word < ARRAYSIZE(AvailableCommandLists); Word++)
+				{
+					UINT32 FreeMask = ~UINT32(AvailableCommandLists[Word]);
+					UINT32 Bit;
+					while (Internal::BitScanForward(&Bit, FreeMask))
+					{
+						if (Word * 32 + Bit >= MAX_NUM_CONCURRENT_CMD_LISTS)
+						{
+							return false;
+						}
+
+						// Another thread may have claimed the bit since the mask was read
+						if (Internal::AtomicBitTestAndSet(&AvailableCommandLists[Word], LONG(Bit)) == false)
+						{
+							Index = Word * 32 + Bit;
+							return true;
+						}
+						FreeMask = ~UINT32(AvailableCommandLists[Word]);
+					}
+				}
+				return false;
+			}
+
+			void ReturnCommandList(UINT32 Index)
+			{
+				Internal::AtomicBitTestAndReset(&AvailableCommandLists[Index / 32], LONG(Index % 32));
+			}
 
 			static const UINT32 sUnsetValue = UINT32(-1);
-			// Represents which command lists are currently open for recording
-			bool AvailableCommandLists[MAX_NUM_CONCURRENT_CMD_LISTS];
+			// Represents which command lists are currently open for recording, one bit per command list
+			volatile LONG AvailableCommandLists[RESIDENCY_CMD_LIST_MASK_WORDS];
 		};
 
 		//Forward Declaration
 		class ResidencyManagerInternal;
 	}
 
+	// How the residency manager chooses which objects to evict
+	enum class EVICTION_POLICY
+	{
+		// Objects are evicted in least recently used order
+		LRU,
+
+		// Least recently used order, but unused objects that are larger than average are kept for longer before they are
+		// trimmed as they are the most expensive to page back in
+		SIZE_WEIGHTED_LRU,
+
+		// Segmented LRU with ARC style ghosts. Objects used by more than one submission are promoted to a protected list
+		// and are only evicted under memory pressure once the objects which were used once are gone. An object that was
+		// pushed out by memory pressure and is paged back in before the cache has turned over is protected straight away.
+		FREQUENCY,
+	};
+
+	// Priorities are assigned by the app. Under memory pressure lower priority objects are evicted first, and the
+	// priority scales how long an unused object is kept before it is trimmed.
+	enum class RESIDENCY_PRIORITY
+	{
+		MINIMUM,
+		LOW,
+		NORMAL,
+		HIGH,
+		MAXIMUM,
+		COUNT
+	};
+
+	// The paging work done before one call to ExecuteCommandLists could run on the GPU. Times are in QPC ticks.
+	struct SyncPointStatistics
+	{
+		UINT64 SyncPointGeneration;
+		// When the paging work finished
+		UINT64 Timestamp;
+
+		UINT64 BytesMadeResident;
+		UINT64 BytesEvicted;
+		UINT32 ObjectsMadeResident;
+		UINT32 ObjectsEvicted;
+
+		// From the call to ExecuteCommandLists until the GPU was allowed to run the command lists. If the GPU caught up
+		// with the submission this is how long it stalled waiting for paging.
+		UINT64 GPUWaitTicks;
+		// Time the paging thread spent waiting for the GPU to finish with objects so they could be evicted
+		UINT64 SyncPointWaitTicks;
+
+		// Budget and usage once the paging work was done
+		DXGI_QUERY_VIDEO_MEMORY_INFO LocalMemory;
+		DXGI_QUERY_VIDEO_MEMORY_INFO NonLocalMemory;
+
+		UINT32 NumResidentObjects;
+		UINT32 NumEvictedObjects;
+	};
+
+	// Totals since the residency manager was initialized, plus the current state
+	struct ResidencyStatistics
+	{
+		UINT64 NumSyncPoints;
+		UINT64 TotalBytesMadeResident;
+		UINT64 TotalBytesEvicted;
+		UINT64 TotalObjectsMadeResident;
+		UINT64 TotalObjectsEvicted;
+		UINT64 TotalGPUWaitTicks;
+		UINT64 MaxGPUWaitTicks;
+		UINT64 TotalSyncPointWaitTicks;
+
+		UINT32 NumTrackedObjects;
+		UINT32 NumResidentObjects;
+		UINT32 NumEvictedObjects;
+		UINT64 ResidentSize;
+
+		DXGI_QUERY_VIDEO_MEMORY_INFO LocalMemory;
+		DXGI_QUERY_VIDEO_MEMORY_INFO NonLocalMemory;
+
+		UINT64 QPCFrequency;
+	};
+
 	// Used to track meta data for each object the app potentially wants
 	// to make resident or evict.
 	class ManagedObject
@@ -114,13 +466,20 @@ namespace D3DX12Residency
 		};
 
 		ManagedObject() :
+			ResidencyStatus(RESIDENCY_STATUS::RESIDENT),
 			pUnderlying(nullptr),
 			Size(0),
-			ResidencyStatus(RESIDENCY_STATUS::RESIDENT),
 			LastGPUSyncPoint(0),
-			LastUsedTimestamp(0)
+			LastUsedTimestamp(0),
+			Priority(RESIDENCY_PRIORITY::NORMAL),
+			UseCount(0),
+			IsProtected(false),
+			EvictionStamp(MAXUINT64)
 		{
-			memset(CommandListsUsedOn, 0, sizeof(CommandListsUsedOn));
+			for (UINT32 i = 0; i < ARRAYSIZE(CommandListsUsedOn); i++)
+			{
+				CommandListsUsedOn[i] = 0;
+			}
 		}
 
 		void Initialize(ID3D12Pageable* pUnderlyingIn, UINT64 ObjectSize, UINT64 InitialGPUSyncPoint = 0)
@@ -144,8 +503,19 @@ namespace D3DX12Residency
 		UINT64 LastGPUSyncPoint;
 		UINT64 LastUsedTimestamp;
 
-		// This is used to track which open command lists this resource is currently used on.
-		bool CommandListsUsedOn[MAX_NUM_CONCURRENT_CMD_LISTS];
+		// Set this before calling BeginTrackingObject, or use ResidencyManager::SetPriority afterwards
+		RESIDENCY_PRIORITY Priority;
+
+		// Used by EVICTION_POLICY::FREQUENCY. How many submissions have used this object since it was made resident,
+		// whether it is on the LRU cache's protected list, and how many bytes the cache had evicted before this object
+		// was pushed out by memory pressure.
+		UINT32 UseCount;
+		bool IsProtected;
+		UINT64 EvictionStamp;
+
+		// This is used to track which open command lists this resource is currently used on, one bit per command list.
+		// Sets on different threads may update the same word so changes are made with interlocked operations.
+		volatile LONG CommandListsUsedOn[RESIDENCY_CMD_LIST_MASK_WORDS];
 
 		// Linked list entry
 		LIST_ENTRY ListEntry;
@@ -164,9 +534,9 @@ namespace D3DX12Residency
 
 		ResidencySet() :
 			CommandListIndex(InvalidIndex),
+			ppSet(nullptr),
 			MaxResidencySetSize(0),
 			CurrentSetSize(0),
-			ppSet(nullptr),
 			IsOpen(false),
 			OutOfMemory(false),
 			pSyncManager(nullptr)
@@ -184,10 +554,14 @@ namespace D3DX12Residency
 			RESIDENCY_CHECK(IsOpen);
 			RESIDENCY_CHECK(CommandListIndex != InvalidIndex);
 
-			// If we haven't seen this object on this command list mark it
-			if (pObject->CommandListsUsedOn[CommandListIndex] == false)
+			volatile LONG& UsedOnMask = pObject->CommandListsUsedOn[CommandListIndex / 32];
+			const LONG UsedOnBit = LONG(CommandListIndex % 32);
+
+			// If we haven't seen this object on this command list mark it. Only this set changes its own bit, so it
+			// can be tested without an interlocked operation first.
+			if ((UINT32(UsedOnMask) & (1u << UsedOnBit)) == 0)
 			{
-				pObject->CommandListsUsedOn[CommandListIndex] = true;
+				Internal::AtomicBitTestAndSet(&UsedOnMask, UsedOnBit);
 				if (ppSet == nullptr || CurrentSetSize >= MaxResidencySetSize)
 				{
 					Realloc();
@@ -210,8 +584,6 @@ namespace D3DX12Residency
 
 		HRESULT Open()
 		{
-			Internal::ScopedLock Lock(&pSyncManager->MaskCriticalSection);
-
 			// It's invalid to open a set that is already open
 			if (IsOpen)
 			{
@@ -220,20 +592,8 @@ namespace D3DX12Residency
 
 			RESIDENCY_CHECK(CommandListIndex == InvalidIndex);
 
-			bool CommandlistAvailable = false;
 			// Find the first available command list by bitscanning
-			for (UINT32 i = 0; i < ARRAYSIZE(pSyncManager->AvailableCommandLists); i++)
-			{
-				if (pSyncManager->AvailableCommandLists[i] == false)
-				{
-					CommandListIndex = i;
-					pSyncManager->AvailableCommandLists[i] = true;
-					CommandlistAvailable = true;
-					break;
-				}
-			}
-
-			if (CommandlistAvailable == false)
+			if (pSyncManager->ClaimCommandList(CommandListIndex) == false)
 			{
 				// There are too many open residency sets, consider using less or increasing the value of MAX_NUM_CONCURRENT_CMD_LISTS
 				RESIDENCY_CHECK(false);
@@ -275,14 +635,12 @@ namespace D3DX12Residency
 
 		inline void Remove(ManagedObject* pObject)
 		{
-			pObject->CommandListsUsedOn[CommandListIndex] = false;
+			Internal::AtomicBitTestAndReset(&pObject->CommandListsUsedOn[CommandListIndex / 32], LONG(CommandListIndex % 32));
 		}
 
 		inline void ReturnCommandListReservation()
 		{
-			Internal::ScopedLock Lock(&pSyncManager->MaskCriticalSection);
-
-			pSyncManager->AvailableCommandLists[CommandListIndex] = false;
+			pSyncManager->ReturnCommandList(CommandListIndex);
 
 			CommandListIndex = ResidencySet::InvalidIndex;
 
@@ -294,28 +652,43 @@ namespace D3DX12Residency
 			pSyncManager = pSyncManagerIn;
 		}
 
-		bool Initialize(Internal::SyncManager* pSyncManagerIn, UINT32 MaxSize)
+		// Makes room for at least MinSize objects. The storage only ever grows, so a set which is reused
+		// (like the master sets pooled by the residency manager) stops allocating once it has seen its largest workload.
+		bool Reserve(INT32 MinSize)
 		{
-			pSyncManager = pSyncManagerIn;
-			MaxResidencySetSize = MaxSize;
-
-			ppSet = new ManagedObject*[MaxResidencySetSize];
+			if (ppSet && MinSize <= MaxResidencySetSize)
+			{
+				return true;
+			}
 
-			return ppSet != nullptr;
-		}
+			const INT32 GrownSize = INT32(MaxResidencySetSize + (MaxResidencySetSize / 2.0f));
+			const INT32 NewSize = RESIDENCY_MAX(MinSize, GrownSize);
+			ManagedObject** ppNewAlloc = new ManagedObject*[RESIDENCY_MAX(NewSize, 1)];
 
-		inline void Realloc()
-		{
-			MaxResidencySetSize = (MaxResidencySetSize == 0) ? 4096 : INT32(MaxResidencySetSize + (MaxResidencySetSize / 2.0f));
-			ManagedObject** ppNewAlloc = new ManagedObject*[MaxResidencySetSize];
+			if (ppNewAlloc == nullptr)
+			{
+				return false;
+			}
 
-			if (ppSet && ppNewAlloc)
+			if (ppSet)
 			{
 				memcpy(ppNewAlloc, ppSet, CurrentSetSize * sizeof(ManagedObject*));
 				delete[](ppSet);
 			}
 
 			ppSet = ppNewAlloc;
+			MaxResidencySetSize = RESIDENCY_MAX(NewSize, 1);
+			return true;
+		}
+
+		inline void Realloc()
+		{
+			if (Reserve((MaxResidencySetSize == 0) ? 4096 : MaxResidencySetSize + 1) == false)
+			{
+				delete[](ppSet);
+				ppSet = nullptr;
+				MaxResidencySetSize = 0;
+			}
 		}
 
 		UINT32 CommandListIndex;
@@ -328,6 +701,9 @@ namespace D3DX12Residency
 		bool OutOfMemory;
 
 		Internal::SyncManager* pSyncManager;
+
+		// Links master sets into the residency manager's pool while they are not in use
+		LIST_ENTRY ListEntry;
 	};
 
 	namespace Internal
@@ -436,10 +812,9 @@ namespace D3DX12Residency
 
 			inline bool IsCompleted() { return LastUsedValue <= pFence->pFence->GetCompletedValue(); }
 
-			inline void WaitForCompletion(HANDLE Event)
+			inline void WaitForCompletion(Event& CompletionEvent)
 			{
-				RESIDENCY_CHECK_RESULT(pFence->pFence->SetEventOnCompletion(LastUsedValue, Event));
-				RESIDENCY_CHECK_RESULT(WaitForSingleObject(Event, INFINITE));
+				Internal::WaitForFence(pFence->pFence, LastUsedValue, CompletionEvent);
 			}
 
 			Fence* pFence;
@@ -466,6 +841,12 @@ namespace D3DX12Residency
 				return pSyncPoint;
 			}
 
+			static void DestroySyncPoint(DeviceWideSyncPoint* pSyncPoint)
+			{
+				pSyncPoint->~DeviceWideSyncPoint();
+				delete[](reinterpret_cast<BYTE*>(pSyncPoint));
+			}
+
 			// A device wide fence is completed if all of the queues that were active at that point are completed
 			inline bool IsCompleted()
 			{
@@ -479,13 +860,13 @@ namespace D3DX12Residency
 				return true;
 			}
 
-			inline void WaitForCompletion(HANDLE Event)
+			inline void WaitForCompletion(Event& CompletionEvent)
 			{
 				for (UINT32 i = 0; i < NumQueueSyncPoints; i++)
 				{
 					if (pQueueSyncPoints[i].IsCompleted() == false)
 					{
-						pQueueSyncPoints[i].WaitForCompletion(Event);
+						pQueueSyncPoints[i].WaitForCompletion(CompletionEvent);
 					}
 				}
 			}
@@ -497,26 +878,84 @@ namespace D3DX12Residency
 			QueueSyncPoint pQueueSyncPoints[1];
 		};
 
+		// Generate a result between the minimum period and the maximum period based on the current
+		// local memory pressure. I.e. when memory pressure is low, objects will persist longer before
+		// being evicted.
+		inline UINT64 ComputeEvictionGracePeriod(double Pressure, UINT64 MinPeriodTicks, UINT64 MaxPeriodTicks, double TrimPercentageMemoryUsageThreshold)
+		{
+			// 1 == full pressure, 0 == no pressure
+			Pressure = RESIDENCY_MIN(Pressure, 1.0);
+
+			if (Pressure > TrimPercentageMemoryUsageThreshold)
+			{
+				// Normalize the pressure for the range 0 to TrimPercentageMemoryUsageThreshold
+				Pressure = (Pressure - TrimPercentageMemoryUsageThreshold) / (1.0 - TrimPercentageMemoryUsageThreshold);
+
+				// Linearly interpolate between the min period and the max period based on the pressure
+				return UINT64((MaxPeriodTicks - MinPeriodTicks) * (1.0 - Pressure)) + MinPeriodTicks;
+			}
+			else
+			{
+				// Essentially don't trim at all
+				return MAXUINT64;
+			}
+		}
+
 		// A Least Recently Used Cache. Tracks all of the objects requested by the app so that objects
 		// that aren't used freqently can get evicted to help the app stay under buget.
+		// The eviction policy and each object's priority decide which of the stale objects go first.
 		class LRUCache
 		{
 		public:
 			LRUCache() :
 				NumResidentObjects(0),
 				NumEvictedObjects(0),
-				ResidentSize(0)
+				ResidentSize(0),
+				ProtectedSize(0),
+				TotalBytesEvicted(0),
+				Policy(EVICTION_POLICY::LRU)
 			{
 				Internal::InitializeListHead(&ResidentObjectListHead);
+				Internal::InitializeListHead(&ProtectedObjectListHead);
 				Internal::InitializeListHead(&EvictedObjectListHead);
+
+				for (UINT32 i = 0; i < ARRAYSIZE(NumResidentObjectsByPriority); i++)
+				{
+					NumResidentObjectsByPriority[i] = 0;
+				}
 			};
 
+			void SetPolicy(EVICTION_POLICY PolicyIn)
+			{
+				// Only the frequency policy uses the protected list
+				if (PolicyIn != EVICTION_POLICY::FREQUENCY)
+				{
+					while (Internal::IsListEmpty(&ProtectedObjectListHead) == false)
+					{
+						DemoteProtectedHead();
+					}
+				}
+				Policy = PolicyIn;
+			}
+
+			void SetPriority(ManagedObject* pObject, RESIDENCY_PRIORITY Priority)
+			{
+				if (pObject->ResidencyStatus == ManagedObject::RESIDENCY_STATUS::RESIDENT)
+				{
+					NumResidentObjectsByPriority[UINT32(pObject->Priority)]--;
+					NumResidentObjectsByPriority[UINT32(Priority)]++;
+				}
+				pObject->Priority = Priority;
+			}
+
 			void Insert(ManagedObject* pObject)
 			{
+				pObject->IsProtected = false;
 				if (pObject->ResidencyStatus == ManagedObject::RESIDENCY_STATUS::RESIDENT)
 				{
 					Internal::InsertHeadList(&ResidentObjectListHead, &pObject->ListEntry);
 					NumResidentObjects++;
+					NumResidentObjectsByPriority[UINT32(pObject->Priority)]++;
 					ResidentSize += pObject->Size;
 				}
 				else
@@ -532,7 +971,13 @@ namespace D3DX12Residency
 				if (pObject->ResidencyStatus == ManagedObject::RESIDENCY_STATUS::RESIDENT)
 				{
 					NumResidentObjects--;
+					NumResidentObjectsByPriority[UINT32(pObject->Priority)]--;
 					ResidentSize -= pObject->Size;
+					if (pObject->IsProtected)
+					{
+						ProtectedSize -= pObject->Size;
+						pObject->IsProtected = false;
+					}
 				}
 				else
 				{
@@ -548,7 +993,24 @@ namespace D3DX12Residency
 				RESIDENCY_CHECK(pObject->ResidencyStatus == ManagedObject::RESIDENCY_STATUS::RESIDENT);
 
 				Internal::RemoveEntryList(&pObject->ListEntry);
-				Internal::InsertTailList(&ResidentObjectListHead, &pObject->ListEntry);
+				if (pObject->UseCount < cMaxUseCount)
+				{
+					pObject->UseCount++;
+				}
+
+				if (Policy == EVICTION_POLICY::FREQUENCY && (pObject->IsProtected || pObject->UseCount > 1))
+				{
+					if (pObject->IsProtected == false)
+					{
+						pObject->IsProtected = true;
+						ProtectedSize += pObject->Size;
+					}
+					Internal::InsertTailList(&ProtectedObjectListHead, &pObject->ListEntry);
+				}
+				else
+				{
+					Internal::InsertTailList(&ResidentObjectListHead, &pObject->ListEntry);
+				}
 			}
 
 			void MakeResident(ManagedObject* pObject)
@@ -556,11 +1018,19 @@ namespace D3DX12Residency
 				RESIDENCY_CHECK(pObject->ResidencyStatus == ManagedObject::RESIDENCY_STATUS::EVICTED);
 
 				pObject->ResidencyStatus = ManagedObject::RESIDENCY_STATUS::RESIDENT;
+				pObject->IsProtected = false;
+
+				// If it would still have been resident had the cache been as large as it is now, count the eviction as a use
+				const bool GhostHit = pObject->EvictionStamp != MAXUINT64 && TotalBytesEvicted - pObject->EvictionStamp <= ResidentSize;
+				pObject->UseCount = GhostHit ? 1 : 0;
+				pObject->EvictionStamp = MAXUINT64;
+
 				Internal::RemoveEntryList(&pObject->ListEntry);
 				Internal::InsertTailList(&ResidentObjectListHead, &pObject->ListEntry);
 
 				NumEvictedObjects--;
 				NumResidentObjects++;
+				NumResidentObjectsByPriority[UINT32(pObject->Priority)]++;
 				ResidentSize += pObject->Size;
 			}
 
@@ -572,107 +1042,218 @@ namespace D3DX12Residency
 				Internal::RemoveEntryList(&pObject->ListEntry);
 				Internal::InsertTailList(&EvictedObjectListHead, &pObject->ListEntry);
 
+				if (pObject->IsProtected)
+				{
+					ProtectedSize -= pObject->Size;
+					pObject->IsProtected = false;
+				}
+				pObject->UseCount = 0;
+				pObject->EvictionStamp = TotalBytesEvicted;
+				TotalBytesEvicted += pObject->Size;
+
 				NumResidentObjects--;
+				NumResidentObjectsByPriority[UINT32(pObject->Priority)]--;
 				ResidentSize -= pObject->Size;
 				NumEvictedObjects++;
 			}
 
-			// Evict all of the resident objects used in sync points up to the specficied one (inclusive)
+			// Evict resident objects used in sync points up to the specficied one (inclusive) until usage is under budget.
+			// Lower priorities go first and, within a priority, objects on probation go before protected ones. The size
+			// weighted policy first looks for objects no larger than the overage so that a large object isn't paged out
+			// when a few smaller ones would do.
 			void TrimToSyncPointInclusive(INT64 CurrentUsage, INT64 CurrentBudget, ID3D12Pageable** EvictionList, UINT32& NumObjectsToEvict, UINT64 SyncPoint)
 			{
 				NumObjectsToEvict = 0;
 
-				LIST_ENTRY* pResourceEntry = ResidentObjectListHead.Flink;
-				while (pResourceEntry != &ResidentObjectListHead)
-				{
-					ManagedObject* pObject = CONTAINING_RECORD(pResourceEntry, ManagedObject, ListEntry);
+				LIST_ENTRY* ListHeads[] = { &ResidentObjectListHead, &ProtectedObjectListHead };
+				const UINT32 NumPasses = (Policy == EVICTION_POLICY::SIZE_WEIGHTED_LRU) ? 2 : 1;
 
-					if (pObject->LastGPUSyncPoint > SyncPoint || CurrentUsage < CurrentBudget)
+				for (UINT32 Priority = 0; Priority < UINT32(RESIDENCY_PRIORITY::COUNT); Priority++)
+				{
+					for (UINT32 Pass = 0; Pass < NumPasses; Pass++)
 					{
-						break;
-					}
+						const bool OnlyObjectsThatFit = (Pass + 1 < NumPasses);
 
-					RESIDENCY_CHECK(pObject->ResidencyStatus == ManagedObject::RESIDENCY_STATUS::RESIDENT);
+						for (UINT32 List = 0; List < ARRAYSIZE(ListHeads) && NumResidentObjectsByPriority[Priority] > 0; List++)
+						{
+							LIST_ENTRY* pResourceEntry = ListHeads[List]->Flink;
+							while (pResourceEntry != ListHeads[List])
+							{
+								ManagedObject* pObject = CONTAINING_RECORD(pResourceEntry, ManagedObject, ListEntry);
+
+								if (CurrentUsage < CurrentBudget)
+								{
+									return;
+								}
 
-					EvictionList[NumObjectsToEvict++] = pObject->pUnderlying;
-					Evict(pObject);
+								if (pObject->LastGPUSyncPoint > SyncPoint)
+								{
+									break;
+								}
 
-					CurrentUsage -= pObject->Size;
+								pResourceEntry = pResourceEntry->Flink;
 
-					pResourceEntry = ResidentObjectListHead.Flink;
+								if (UINT32(pObject->Priority) == Priority &&
+									(OnlyObjectsThatFit == false || pObject->Size <= UINT64(CurrentUsage - CurrentBudget) + 1))
+								{
+									RESIDENCY_CHECK(pObject->ResidencyStatus == ManagedObject::RESIDENCY_STATUS::RESIDENT);
+
+									EvictionList[NumObjectsToEvict++] = pObject->pUnderlying;
+									Evict(pObject);
+
+									CurrentUsage -= pObject->Size;
+								}
+							}
+						}
+					}
 				}
 			}
 
-			// Trim all objects which are older than the specified time
+			// Trim all objects which are older than the specified time, scaled by the object's priority and the policy
 			void TrimAgedAllocations(DeviceWideSyncPoint* MaxSyncPoint, ID3D12Pageable** EvictionList, UINT32& NumObjectsToEvict, UINT64 CurrentTimeStamp, UINT64 MinDelta)
 			{
-				LIST_ENTRY* pResourceEntry = ResidentObjectListHead.Flink;
-				while (pResourceEntry != &ResidentObjectListHead)
+				if (MinDelta == MAXUINT64)
 				{
-					ManagedObject* pObject = CONTAINING_RECORD(pResourceEntry, ManagedObject, ListEntry);
+					return;
+				}
+
+				// Nothing is kept for less than this, so the walk can stop at the first object which is younger
+				const UINT64 ShortestDelta = UINT64(MinDelta * GetPriorityGraceScale(RESIDENCY_PRIORITY::MINIMUM));
+				const double AverageSize = NumResidentObjects ? double(ResidentSize) / NumResidentObjects : 0.0;
 
-					if ((MaxSyncPoint && pObject->LastGPUSyncPoint >= MaxSyncPoint->GenerationID) || // Only trim allocations done on the GPU
-						CurrentTimeStamp - pObject->LastUsedTimestamp <= MinDelta) // Don't evict things which have been used recently
+				LIST_ENTRY* ListHeads[] = { &ResidentObjectListHead, &ProtectedObjectListHead };
+
+				for (UINT32 List = 0; List < ARRAYSIZE(ListHeads); List++)
+				{
+					LIST_ENTRY* pResourceEntry = ListHeads[List]->Flink;
+					while (pResourceEntry != ListHeads[List])
 					{
-						break;
-					}
+						ManagedObject* pObject = CONTAINING_RECORD(pResourceEntry, ManagedObject, ListEntry);
+
+						if ((MaxSyncPoint && pObject->LastGPUSyncPoint >= MaxSyncPoint->GenerationID) || // Only trim allocations done on the GPU
+							CurrentTimeStamp - pObject->LastUsedTimestamp <= ShortestDelta) // Don't evict things which have been used recently
+						{
+							break;
+						}
+
+						pResourceEntry = pResourceEntry->Flink;
+
+						double Scale = GetPriorityGraceScale(pObject->Priority);
+						if (Policy == EVICTION_POLICY::SIZE_WEIGHTED_LRU && AverageSize > 0.0)
+						{
+							Scale *= RESIDENCY_MIN(RESIDENCY_MAX(pObject->Size / AverageSize, 1.0), 4.0);
+						}
+						else if (pObject->IsProtected)
+						{
+							Scale *= 2.0;
+						}
 
-					RESIDENCY_CHECK(pObject->ResidencyStatus == ManagedObject::RESIDENCY_STATUS::RESIDENT);
-					EvictionList[NumObjectsToEvict++] = pObject->pUnderlying;
-					Evict(pObject);
+						if (double(CurrentTimeStamp - pObject->LastUsedTimestamp) > MinDelta * Scale)
+						{
+							RESIDENCY_CHECK(pObject->ResidencyStatus == ManagedObject::RESIDENCY_STATUS::RESIDENT);
+							EvictionList[NumObjectsToEvict++] = pObject->pUnderlying;
+							Evict(pObject);
 
-					pResourceEntry = ResidentObjectListHead.Flink;
+							// It fell out of use rather than being pushed out by memory pressure, so it isn't a ghost
+							pObject->EvictionStamp = MAXUINT64;
+						}
+					}
 				}
 			}
 
+			// Returns the stalest resident object
 			ManagedObject* GetResidentListHead()
 			{
-				if (IsListEmpty(&ResidentObjectListHead))
+				ManagedObject* pHead = nullptr;
+				if (IsListEmpty(&ResidentObjectListHead) == false)
 				{
-					return nullptr;
+					pHead = CONTAINING_RECORD(ResidentObjectListHead.Flink, ManagedObject, ListEntry);
+				}
+				if (IsListEmpty(&ProtectedObjectListHead) == false)
+				{
+					ManagedObject* pProtectedHead = CONTAINING_RECORD(ProtectedObjectListHead.Flink, ManagedObject, ListEntry);
+					if (pHead == nullptr || pProtectedHead->LastGPUSyncPoint < pHead->LastGPUSyncPoint)
+					{
+						pHead = pProtectedHead;
+					}
 				}
-				return CONTAINING_RECORD(ResidentObjectListHead.Flink, ManagedObject, ListEntry);
+				return pHead;
 			}
 
+			// Objects on probation, ordered from least to most recently used
 			LIST_ENTRY ResidentObjectListHead;
+			// Objects used more than once (EVICTION_POLICY::FREQUENCY only)
+			LIST_ENTRY ProtectedObjectListHead;
 			LIST_ENTRY EvictedObjectListHead;
 
 			UINT32 NumResidentObjects;
 			UINT32 NumEvictedObjects;
+			UINT32 NumResidentObjectsByPriority[UINT32(RESIDENCY_PRIORITY::COUNT)];
 
 			UINT64 ResidentSize;
+			UINT64 ProtectedSize;
+			UINT64 TotalBytesEvicted;
+
+			EVICTION_POLICY Policy;
+
+		private:
+			// Moves the least recently used protected object back on probation
+			void DemoteProtectedHead()
+			{
+				ManagedObject* pObject = CONTAINING_RECORD(Internal::RemoveHeadList(&ProtectedObjectListHead), ManagedObject, ListEntry);
+				pObject->IsProtected = false;
+				pObject->UseCount = 0;
+				ProtectedSize -= pObject->Size;
+
+				Internal::InsertTailList(&ResidentObjectListHead, &pObject->ListEntry);
+			}
+
+			// How long an unused object is kept relative to the current grace period
+			static double GetPriorityGraceScale(RESIDENCY_PRIORITY Priority)
+			{
+				static const double cScales[] = { 0.5, 0.75, 1.0, 2.0, 4.0 };
+				return cScales[UINT32(Priority)];
+			}
+
+			static const UINT32 cMaxUseCount = 2;
 		};
 
 		class ResidencyManagerInternal
 		{
 		public:
 			ResidencyManagerInternal(SyncManager* pSyncManagerIn) :
-				Device(nullptr),
-				AsyncThreadFence(1),
-				CompletionEvent(INVALID_HANDLE_VALUE),
-				AsyncThreadWorkCompletionEvent(INVALID_HANDLE_VALUE),
-				Adapter(nullptr),
-				AsyncWorkEvent(INVALID_HANDLE_VALUE),
-				AsyncWorkThread(INVALID_HANDLE_VALUE),
+				AsyncWorkQueueSize(7),
+				AsyncWorkQueue(nullptr),
 				FinishAsyncWork(false),
-				cStartEvicted(false),
-				CurrentSyncPointGeneration(0),
-				NumQueuesSeen(0),
-				NodeIndex(0),
 				CurrentAsyncWorkloadHead(0),
 				CurrentAsyncWorkloadTail(0),
+				NumQueuesSeen(0),
+				AsyncThreadFence(1),
+				CurrentSyncPointGeneration(0),
+				Device(nullptr),
+				NodeIndex(0),
+				Adapter(nullptr),
+				cStartEvicted(false),
 				cMinEvictionGracePeriod(1.0f),
 				cMaxEvictionGracePeriod(60.0f),
 				cTrimPercentageMemoryUsageThreshold(0.7f),
-				AsyncWorkQueue(nullptr),
 				MaxSoftwareQueueLatency(6),
-				AsyncWorkQueueSize(7),
-				pSyncManager(pSyncManagerIn)
+				pSyncManager(pSyncManagerIn),
+				StatisticsHistoryCount(0),
+				PagingFailure(S_OK),
+				pMakeResidentScratch(nullptr),
+				MakeResidentScratchSize(0),
+				pEvictionScratch(nullptr),
+				EvictionScratchSize(0)
 			{
+				ZeroMemory(&Totals, sizeof(Totals));
+
 				Internal::InitializeListHead(&QueueFencesListHead);
 				Internal::InitializeListHead(&InFlightSyncPointsHead);
+				Internal::InitializeListHead(&FreeSyncPointsHead);
+				Internal::InitializeListHead(&FreeMasterSetsHead);
 
-				ResidencyManagerUniqueID = InterlockedIncrement64(&g_ResidencyManagerUniqueID);
+				ResidencyManagerUniqueID = Internal::AtomicIncrement(&g_ResidencyManagerUniqueID);
 			};
 
 			// NOTE: DeviceNodeIndex is an index not a mask. The majority of D3D12 uses bit masks to identify a GPU node whereas DXGI uses 0 based indices.
@@ -691,52 +1272,34 @@ namespace D3DX12Residency
 					return E_OUTOFMEMORY;
 				}
 
-				LARGE_INTEGER Frequency;
-				QueryPerformanceFrequency(&Frequency);
+				const UINT64 Frequency = Internal::GetTimestampFrequency();
 
 				// Calculate how many QPC ticks are equivalent to the given time in seconds
-				MinEvictionGracePeriodTicks = UINT64(Frequency.QuadPart * cMinEvictionGracePeriod);
-				MaxEvictionGracePeriodTicks = UINT64(Frequency.QuadPart * cMaxEvictionGracePeriod);
+				MinEvictionGracePeriodTicks = UINT64(Frequency * cMinEvictionGracePeriod);
+				MaxEvictionGracePeriodTicks = UINT64(Frequency * cMaxEvictionGracePeriod);
 
 				HRESULT hr = S_OK;
 				hr = AsyncThreadFence.Initialize(Device);
 
 				if (SUCCEEDED(hr))
 				{
-					CompletionEvent = CreateEvent(nullptr, false, false, nullptr);
-					if (CompletionEvent == INVALID_HANDLE_VALUE)
-					{
-						hr = HRESULT_FROM_WIN32(GetLastError());
-					}
+					hr = CompletionEvent.Create(false);
 				}
 
 				if (SUCCEEDED(hr))
 				{
-					AsyncThreadWorkCompletionEvent = CreateEvent(nullptr, false, false, nullptr);
-					if (AsyncThreadWorkCompletionEvent == INVALID_HANDLE_VALUE)
-					{
-						hr = HRESULT_FROM_WIN32(GetLastError());
-					}
+					hr = AsyncThreadWorkCompletionEvent.Create(false);
 				}
 
 				if (SUCCEEDED(hr))
 				{
-					AsyncWorkEvent = CreateEvent(nullptr, true, false, nullptr);
-					if (AsyncWorkEvent == INVALID_HANDLE_VALUE)
-					{
-						hr = HRESULT_FROM_WIN32(GetLastError());
-					}
+					hr = AsyncWorkEvent.Create(true);
 				}
 
 #if !RESIDENCY_SINGLE_THREADED
 				if (SUCCEEDED(hr))
 				{
-					AsyncWorkThread = CreateThread(nullptr, 0, AsyncThreadStart, (void*) this, 0, nullptr);
-
-					if (AsyncWorkThread == INVALID_HANDLE_VALUE)
-					{
-						hr = HRESULT_FROM_WIN32(GetLastError());
-					}
+					hr = AsyncWorkThread.Start(AsyncThreadStart, (void*) this);
 				}
 #endif
 
@@ -745,49 +1308,28 @@ namespace D3DX12Residency
 
 			void Destroy()
 			{
-				AsyncThreadFence.Destroy();
-
-				if (CompletionEvent != INVALID_HANDLE_VALUE)
-				{
-					CloseHandle(CompletionEvent);
-					CompletionEvent = INVALID_HANDLE_VALUE;
-				}
-
 #if !RESIDENCY_SINGLE_THREADED
 				AsyncWorkload* pWork = DequeueAsyncWork();
 
 				while (pWork)
 				{
+					ReleaseMasterSet(pWork->pMasterSet);
 					pWork = DequeueAsyncWork();
 				}
 
 				FinishAsyncWork = true;
-				if (SetEvent(AsyncWorkEvent) == false)
-				{
-					RESIDENCY_CHECK_RESULT(HRESULT_FROM_WIN32(GetLastError()));
-				}
+				RESIDENCY_CHECK_RESULT(AsyncWorkEvent.Set());
 
 				// Make sure the async worker thread is finished to prevent dereferencing
 				// dangling pointers to ResidencyManagerInternal
-				WaitForSingleObject(AsyncWorkThread, INFINITE);
-				if (AsyncWorkThread != INVALID_HANDLE_VALUE)
-				{
-					CloseHandle(AsyncWorkThread);
-					AsyncWorkThread = INVALID_HANDLE_VALUE;
-				}
-
-				if (AsyncWorkEvent != INVALID_HANDLE_VALUE)
-				{
-					CloseHandle(AsyncWorkEvent);
-					AsyncWorkEvent = INVALID_HANDLE_VALUE;
-				}
+				AsyncWorkThread.Join();
 #endif
+				AsyncWorkEvent.Destroy();
+				AsyncThreadWorkCompletionEvent.Destroy();
 
-				if (AsyncThreadWorkCompletionEvent != INVALID_HANDLE_VALUE)
-				{
-					CloseHandle(AsyncThreadWorkCompletionEvent);
-					AsyncThreadWorkCompletionEvent = INVALID_HANDLE_VALUE;
-				}
+				// The worker thread signals this fence and waits on this event, so they can only go once it has exited
+				AsyncThreadFence.Destroy();
+				CompletionEvent.Destroy();
 
 				while (Internal::IsListEmpty(&QueueFencesListHead) == false)
 				{
@@ -798,6 +1340,37 @@ namespace D3DX12Residency
 					Internal::RemoveHeadList(&QueueFencesListHead);
 					delete(pObject);
 				}
+
+				while (Internal::IsListEmpty(&FreeMasterSetsHead) == false)
+				{
+					ResidencySet* pSet = CONTAINING_RECORD(Internal::RemoveHeadList(&FreeMasterSetsHead), ResidencySet, ListEntry);
+					delete(pSet);
+				}
+
+				while (Internal::IsListEmpty(&InFlightSyncPointsHead) == false)
+				{
+					Internal::DeviceWideSyncPoint* pPoint =
+						CONTAINING_RECORD(Internal::RemoveHeadList(&InFlightSyncPointsHead), Internal::DeviceWideSyncPoint, ListEntry);
+					Internal::DeviceWideSyncPoint::DestroySyncPoint(pPoint);
+				}
+
+				while (Internal::IsListEmpty(&FreeSyncPointsHead) == false)
+				{
+					Internal::DeviceWideSyncPoint* pPoint =
+						CONTAINING_RECORD(Internal::RemoveHeadList(&FreeSyncPointsHead), Internal::DeviceWideSyncPoint, ListEntry);
+					Internal::DeviceWideSyncPoint::DestroySyncPoint(pPoint);
+				}
+
+				delete[](pMakeResidentScratch);
+				pMakeResidentScratch = nullptr;
+				MakeResidentScratchSize = 0;
+
+				delete[](pEvictionScratch);
+				pEvictionScratch = nullptr;
+				EvictionScratchSize = 0;
+
+				delete[](AsyncWorkQueue);
+				AsyncWorkQueue = nullptr;
 			}
 
 			void BeginTrackingObject(ManagedObject* pObject)
@@ -824,6 +1397,63 @@ namespace D3DX12Residency
 				LRU.Remove(pObject);
 			}
 
+			void SetEvictionPolicy(EVICTION_POLICY Policy)
+			{
+				Internal::ScopedLock Lock(&Mutex);
+
+				LRU.SetPolicy(Policy);
+			}
+
+			void SetPriority(ManagedObject* pObject, RESIDENCY_PRIORITY Priority)
+			{
+				Internal::ScopedLock Lock(&Mutex);
+
+				LRU.SetPriority(pObject, Priority);
+			}
+
+			void GetStatistics(ResidencyStatistics* pStatistics)
+			{
+				{
+					Internal::ScopedLock Lock(&StatisticsCS);
+					*pStatistics = Totals;
+				}
+
+				{
+					Internal::ScopedLock Lock(&Mutex);
+					pStatistics->NumResidentObjects = LRU.NumResidentObjects;
+					pStatistics->NumEvictedObjects = LRU.NumEvictedObjects;
+					pStatistics->NumTrackedObjects = LRU.NumResidentObjects + LRU.NumEvictedObjects;
+					pStatistics->ResidentSize = LRU.ResidentSize;
+				}
+
+				pStatistics->QPCFrequency = Internal::GetTimestampFrequency();
+			}
+
+			// Copies up to MaxCount of the most recent sync points, oldest first, and returns how many were copied.
+			// Pass the generation of the newest sync point already seen as MinGeneration to only get new ones.
+			UINT32 GetStatisticsHistory(SyncPointStatistics* pHistory, UINT32 MaxCount, UINT64 MinGeneration = 0)
+			{
+#if RESIDENCY_STATISTICS_HISTORY_SIZE
+				Internal::ScopedLock Lock(&StatisticsCS);
+
+				const UINT64 NumAvailable = RESIDENCY_MIN(StatisticsHistoryCount, UINT64(RESIDENCY_STATISTICS_HISTORY_SIZE));
+				UINT64 First = StatisticsHistoryCount - RESIDENCY_MIN(NumAvailable, UINT64(MaxCount));
+
+				UINT32 NumCopied = 0;
+				for (UINT64 i = First; i < StatisticsHistoryCount; i++)
+				{
+					const SyncPointStatistics& Entry = StatisticsHistory[i % RESIDENCY_STATISTICS_HISTORY_SIZE];
+					if (Entry.SyncPointGeneration >= MinGeneration)
+					{
+						pHistory[NumCopied++] = Entry;
+					}
+				}
+				return NumCopied;
+#else
+				return 0;
+#endif
+			}
+
 			// One residency set per command-list
 			HRESULT ExecuteCommandLists(ID3D12CommandQueue* Queue, ID3D12CommandList** CommandLists, ResidencySet** ResidencySets, UINT32 Count)
 			{
@@ -853,7 +1483,7 @@ namespace D3DX12Residency
 				GUID FenceGuid = { 0xf0, 0, 0xd, { 0, 0, 0, 0, 0, 0, 0, 0 } };
 
 				// Generate a GUID based on this queue
-				memcpy((void*)FenceGuid.Data4, Queue, sizeof(ID3D12CommandQueue*));
+				memcpy((void*)FenceGuid.Data4, &Queue, sizeof(ID3D12CommandQueue*));
 
 				QueueFence = nullptr;
 				HRESULT hr = S_OK;
@@ -874,7 +1504,7 @@ namespace D3DX12Residency
 						hr = QueueFence->Initialize(Device);
 						Internal::InsertTailList(&QueueFencesListHead, &QueueFence->ListEntry);
 
-						InterlockedIncrement(&NumQueuesSeen);
+						Internal::AtomicIncrement(&NumQueuesSeen);
 
 						if (SUCCEEDED(hr))
 						{
@@ -934,9 +1564,9 @@ namespace D3DX12Residency
 					}
 				}
 
-				// Create a set to gather up all unique resources required by this call
-				ResidencySet* pMasterSet = new ResidencySet();
-				if (pMasterSet == nullptr || pMasterSet->Initialize(pSyncManager, MaxObjectsReferenced) == false)
+				// Gather up all unique resources required by this call into a set recycled from earlier submissions
+				ResidencySet* pMasterSet = AcquireMasterSet(MaxObjectsReferenced);
+				if (pMasterSet == nullptr)
 				{
 					return E_OUTOFMEMORY;
 				}
@@ -944,6 +1574,7 @@ namespace D3DX12Residency
 				hr = pMasterSet->Open();
 				if (FAILED(hr))
 				{
+					ReleaseMasterSet(pMasterSet);
 					return hr;
 				}
 
@@ -966,6 +1597,7 @@ namespace D3DX12Residency
 				hr = pMasterSet->Close();
 				if (FAILED(hr))
 				{
+					ReleaseMasterSet(pMasterSet);
 					return hr;
 				}
 
@@ -973,7 +1605,7 @@ namespace D3DX12Residency
 				// nothing we can do
 				if (Count > 1 && TotalSizeNeeded > LocalMemory.Budget + NonLocalMemory.Budget)
 				{
-					delete(pMasterSet);
+					ReleaseMasterSet(pMasterSet);
 
 					// Recursively try to find a small enough set to fit in memory
 					const UINT32 Half = Count / 2;
@@ -997,9 +1629,15 @@ namespace D3DX12Residency
 					hr = EnqueueAsyncWork(pMasterSet, AsyncThreadFence.FenceValue, CurrentSyncPointGeneration);
 #if RESIDENCY_SINGLE_THREADED
 					AsyncWorkload* pWorkload = DequeueAsyncWork();
-					ProcessPagingWork(pWorkload);
+					RecordPagingFailure(ProcessPagingWork(pWorkload));
 #endif
 
+					// Paging happens on the async thread, so a failure is reported by the first call after it
+					if (SUCCEEDED(hr))
+					{
+						hr = TakePagingFailure();
+					}
+
 					// If there are some things that need to be made resident we need to make sure that the GPU
 					// doesn't execute until the async thread signals that the MakeResident call has returned.
 					if (SUCCEEDED(hr))
@@ -1018,16 +1656,85 @@ namespace D3DX12Residency
 				return hr;
 			}
 
+			// Master sets are handed to the async thread and come back once their paging work is done. Rather than
+			// allocating one per submission they are pooled, and each keeps the storage it grew to last time.
+			ResidencySet* AcquireMasterSet(UINT32 MaxObjectsReferenced)
+			{
+				ResidencySet* pSet = nullptr;
+				{
+					Internal::ScopedLock Lock(&MasterSetPoolCS);
+					if (Internal::IsListEmpty(&FreeMasterSetsHead) == false)
+					{
+						pSet = CONTAINING_RECORD(Internal::RemoveHeadList(&FreeMasterSetsHead), ResidencySet, ListEntry);
+					}
+				}
+
+				if (pSet == nullptr)
+				{
+					// A set is out of the pool until the async thread is done with it, so when the pool runs dry
+					// restock it for a full async queue instead of one set at a time
+					for (SIZE_T i = 0; i < AsyncWorkQueueSize + 1; i++)
+					{
+						ResidencySet* pSpareSet = CreateMasterSet(MaxObjectsReferenced);
+						if (pSpareSet == nullptr)
+						{
+							break;
+						}
+						ReleaseMasterSet(pSpareSet);
+					}
+
+					return CreateMasterSet(MaxObjectsReferenced);
+				}
+
+				if (pSet->Reserve(INT32(MaxObjectsReferenced)) == false)
+				{
+					delete(pSet);
+					return nullptr;
+				}
+
+				return pSet;
+			}
+
+			ResidencySet* CreateMasterSet(UINT32 MaxObjectsReferenced)
+			{
+				ResidencySet* pSet = new ResidencySet();
+				if (pSet == nullptr)
+				{
+					return nullptr;
+				}
+				pSet->Initialize(pSyncManager);
+
+				if (pSet->Reserve(INT32(MaxObjectsReferenced)) == false)
+				{
+					delete(pSet);
+					return nullptr;
+				}
+
+				return pSet;
+			}
+
+			void ReleaseMasterSet(ResidencySet* pSet)
+			{
+				pSet->CurrentSetSize = 0;
+
+				Internal::ScopedLock Lock(&MasterSetPoolCS);
+				Internal::InsertHeadList(&FreeMasterSetsHead, &pSet->ListEntry);
+			}
+
 			struct AsyncWorkload
 			{
 				AsyncWorkload() :
+					SyncPointGeneration(0),
+					EnqueueTimestamp(0),
 					pMasterSet(nullptr),
-					FenceValueToSignal(0),
-					SyncPointGeneration(0)
+					FenceValueToSignal(0)
 				{}
 
 				UINT64 SyncPointGeneration;
 
+				// When ExecuteCommandLists queued the work, for statistics
+				UINT64 EnqueueTimestamp;
+
 				// List of objects to make resident
 				ResidencySet* pMasterSet;
 
@@ -1038,14 +1745,20 @@ namespace D3DX12Residency
 			SIZE_T AsyncWorkQueueSize;
 			AsyncWorkload* AsyncWorkQueue;
 
-			HANDLE AsyncWorkEvent;
-			HANDLE AsyncWorkThread;
+			Internal::Event AsyncWorkEvent;
+			Internal::Thread AsyncWorkThread;
 			Internal::CriticalSection AsyncWorkMutex;
 			volatile bool FinishAsyncWork;
-			volatile SIZE_T CurrentAsyncWorkloadHead;
-			volatile SIZE_T CurrentAsyncWorkloadTail;
+			// A slot is filled before Tail is released past it, and isn't refilled until Head has been released past it
+			// once more; the acquire loads on the other thread are what order the workloads themselves
+			std::atomic<SIZE_T> CurrentAsyncWorkloadHead;
+			std::atomic<SIZE_T> CurrentAsyncWorkloadTail;
 
+#if RESIDENCY_PORTABLE_THREADING
+			static unsigned long AsyncThreadStart(void* pData)
+#else
 			static unsigned long WINAPI AsyncThreadStart(void* pData)
+#endif
 			{
 				ResidencyManagerInternal* pManager = (ResidencyManagerInternal*)pData;
 
@@ -1056,22 +1769,16 @@ namespace D3DX12Residency
 					while (pWork)
 					{
 						// Submit the work
-						pManager->ProcessPagingWork(pWork);
-						if (SetEvent(pManager->AsyncThreadWorkCompletionEvent) == false)
-						{
-							RESIDENCY_CHECK_RESULT(HRESULT_FROM_WIN32(GetLastError()));
-						}
+						pManager->RecordPagingFailure(pManager->ProcessPagingWork(pWork));
+						RESIDENCY_CHECK_RESULT(pManager->AsyncThreadWorkCompletionEvent.Set());
 
 						// Get more work
 						pWork = pManager->DequeueAsyncWork();
 					}
 
 					//Wait until there is more work do be done
-					WaitForSingleObject(pManager->AsyncWorkEvent, INFINITE);
-					if (ResetEvent(pManager->AsyncWorkEvent) == false)
-					{
-						RESIDENCY_CHECK_RESULT(HRESULT_FROM_WIN32(GetLastError()));
-					}
+					pManager->AsyncWorkEvent.Wait();
+					RESIDENCY_CHECK_RESULT(pManager->AsyncWorkEvent.Reset());
 
 					if (pManager->FinishAsyncWork)
 					{
@@ -1084,16 +1791,11 @@ namespace D3DX12Residency
 
 			// This will be run from a worker thread and will emulate a software queue for making gpu resources resident or evicted.
 			// The GPU will be synchronized by this queue to ensure that it never executes using an evicted resource.
-			void ProcessPagingWork(AsyncWorkload* pWork)
+			HRESULT ProcessPagingWork(AsyncWorkload* pWork)
 			{
-				Internal::DeviceWideSyncPoint* FirstUncompletedSyncPoint = DequeueCompletedSyncPoints();
+				HRESULT PagingResult = S_OK;
 
-				// Use a union so that we only need 1 allocation
-				union ResidentScratchSpace
-				{
-					ManagedObject* pManagedObject;
-					ID3D12Pageable* pUnderlying;
-				};
+				Internal::DeviceWideSyncPoint* FirstUncompletedSyncPoint = DequeueCompletedSyncPoints();
 
 				ResidentScratchSpace* pMakeResidentList = nullptr;
 				UINT32 NumObjectsToMakeResident = 0;
@@ -1104,15 +1806,33 @@ namespace D3DX12Residency
 				// the size of all the objects which will need to be made resident in order to execute this set.
 				UINT64 SizeToMakeResident = 0;
 
-				LARGE_INTEGER CurrentTime;
-				QueryPerformanceCounter(&CurrentTime);
+				SyncPointStatistics Statistics;
+				ZeroMemory(&Statistics, sizeof(Statistics));
+				Statistics.SyncPointGeneration = pWork->SyncPointGeneration;
+
+				const UINT64 CurrentTime = Internal::GetTimestamp();
 
 				{
 					// A lock must be taken here as the state of the objects will be altered
 					Internal::ScopedLock Lock(&Mutex);
 
-					pMakeResidentList = new ResidentScratchSpace[pWork->pMasterSet->CurrentSetSize];
-					pEvictionList = new ID3D12Pageable*[LRU.NumResidentObjects];
+					// The scratch lists are only touched here, so they live with the manager and grow to the largest workload seen
+					PagingResult = GrowScratch(pMakeResidentScratch, MakeResidentScratchSize, UINT32(pWork->pMasterSet->CurrentSetSize));
+					if (SUCCEEDED(PagingResult))
+					{
+						PagingResult = GrowScratch(pEvictionScratch, EvictionScratchSize, LRU.NumResidentObjects);
+					}
+
+					if (FAILED(PagingResult))
+					{
+						// Nothing can be paged without the scratch lists. Let the GPU go ahead rather than wait forever.
+						CompletePagingWork(pWork, Statistics);
+						return PagingResult;
+					}
+					pMakeResidentList = pMakeResidentScratch;
+					pEvictionList = pEvictionScratch;
+
+					const UINT64 ResidentSizeBeforePaging = LRU.ResidentSize;
 
 					// Mark the objects used by this command list to be made resident
 					for (INT32 i = 0; i < pWork->pMasterSet->CurrentSetSize; i++)
@@ -1130,7 +1850,7 @@ namespace D3DX12Residency
 						// Update the last sync point that this was used on
 						pObject->LastGPUSyncPoint = pWork->SyncPointGeneration;
 
-						pObject->LastUsedTimestamp = CurrentTime.QuadPart;
+						pObject->LastUsedTimestamp = CurrentTime;
 						LRU.ObjectReferenced(pObject);
 					}
 
@@ -1139,14 +1859,18 @@ namespace D3DX12Residency
 					GetCurrentBudget(&LocalMemory, DXGI_MEMORY_SEGMENT_GROUP_LOCAL);
 
 					UINT64 EvictionGracePeriod = GetCurrentEvictionGracePeriod(&LocalMemory);
-					LRU.TrimAgedAllocations(FirstUncompletedSyncPoint, pEvictionList, NumObjectsToEvict, CurrentTime.QuadPart, EvictionGracePeriod);
+					LRU.TrimAgedAllocations(FirstUncompletedSyncPoint, pEvictionList, NumObjectsToEvict, CurrentTime, EvictionGracePeriod);
 
 					if (NumObjectsToEvict)
 					{
 						RESIDENCY_CHECK_RESULT(Device->Evict(NumObjectsToEvict, pEvictionList));
+						Statistics.ObjectsEvicted += NumObjectsToEvict;
 						NumObjectsToEvict = 0;
 					}
 
+					Statistics.BytesMadeResident = SizeToMakeResident;
+					Statistics.ObjectsMadeResident = NumObjectsToMakeResident;
+
 					if (NumObjectsToMakeResident)
 					{
 						UINT32 ObjectsMadeResident = 0;
@@ -1207,8 +1931,7 @@ namespace D3DX12Residency
 
 								// If there is nothing to trim OR the only objects 'Resident' are the ones about to be used by this execute.
 								if (pResidentHead == nullptr ||
-									pResidentHead->LastGPUSyncPoint >= pWork->SyncPointGeneration ||
-									FirstUncompletedSyncPoint == nullptr)
+									pResidentHead->LastGPUSyncPoint >= pWork->SyncPointGeneration)
 								{
 									// Make resident the rest of the objects as there is nothing left to trim
 									UINT32 NumObjects = NumObjectsToMakeResident - ObjectsMadeResident;
@@ -1225,11 +1948,13 @@ namespace D3DX12Residency
 										// TODO: What should we do if this fails? This is a catastrophic failure in which the app is trying to use more memory
 										//       in 1 command list than can possibly be made resident by the system.
 										RESIDENCY_CHECK_RESULT(hr);
+										PagingResult = hr;
 									}
 									break;
 								}
 
-								UINT64 GenerationToWaitFor = FirstUncompletedSyncPoint->GenerationID;
+								// If the GPU has finished everything submitted before this work, anything not used by it can be trimmed without waiting
+								UINT64 GenerationToWaitFor = FirstUncompletedSyncPoint ? FirstUncompletedSyncPoint->GenerationID : pWork->SyncPointGeneration;
 
 								// We can't wait for the sync-point that this work is intended for
 								if (GenerationToWaitFor == pWork->SyncPointGeneration)
@@ -1238,11 +1963,14 @@ namespace D3DX12Residency
 									GenerationToWaitFor -= 1;
 								}
 								// Wait until the GPU is done
+								const UINT64 WaitStart = Internal::GetTimestamp();
 								WaitForSyncPoint(GenerationToWaitFor);
+								Statistics.SyncPointWaitTicks += Internal::GetTimestamp() - WaitStart;
 
 								LRU.TrimToSyncPointInclusive(TotalUsage + INT64(SizeToMakeResident), TotalBudget, pEvictionList, NumObjectsToEvict, GenerationToWaitFor);
 
 								RESIDENCY_CHECK_RESULT(Device->Evict(NumObjectsToEvict, pEvictionList));
+								Statistics.ObjectsEvicted += NumObjectsToEvict;
 							}
 							else
 							{
@@ -1252,53 +1980,138 @@ namespace D3DX12Residency
 						}
 					}
 
-					delete[](pMakeResidentList);
-					delete[](pEvictionList);
+					Statistics.BytesEvicted = ResidentSizeBeforePaging + Statistics.BytesMadeResident - LRU.ResidentSize;
+					Statistics.NumResidentObjects = LRU.NumResidentObjects;
+					Statistics.NumEvictedObjects = LRU.NumEvictedObjects;
 				}
 
+				CompletePagingWork(pWork, Statistics);
+				return PagingResult;
+			}
+
+			// Lets the GPU execute the work, records its statistics and returns its master set to the pool
+			void CompletePagingWork(AsyncWorkload* pWork, SyncPointStatistics& Statistics)
+			{
 				// Tell the GPU that it's safe to execute since we made things resident
 				RESIDENCY_CHECK_RESULT(AsyncThreadFence.pFence->Signal(pWork->FenceValueToSignal));
 
-				delete(pWork->pMasterSet);
+				Statistics.Timestamp = Internal::GetTimestamp();
+				Statistics.GPUWaitTicks = Statistics.Timestamp - pWork->EnqueueTimestamp;
+				RecordStatistics(Statistics);
+
+				ReleaseMasterSet(pWork->pMasterSet);
 				pWork->pMasterSet = nullptr;
 			}
+
+			void RecordPagingFailure(HRESULT hr)
+			{
+				if (FAILED(hr))
+				{
+					Internal::ScopedLock Lock(&StatisticsCS);
+					if (SUCCEEDED(PagingFailure))
+					{
+						PagingFailure = hr;
+					}
+				}
+			}
+
+			HRESULT TakePagingFailure()
+			{
+				Internal::ScopedLock Lock(&StatisticsCS);
+				HRESULT hr = PagingFailure;
+				PagingFailure = S_OK;
+				return hr;
+			}
+
+			void RecordStatistics(SyncPointStatistics& Statistics)
+			{
+				GetCurrentBudget(&Statistics.LocalMemory, DXGI_MEMORY_SEGMENT_GROUP_LOCAL);
+				GetCurrentBudget(&Statistics.NonLocalMemory, DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL);
+
+				Internal::ScopedLock Lock(&StatisticsCS);
+
+				Totals.NumSyncPoints++;
+				Totals.TotalBytesMadeResident += Statistics.BytesMadeResident;
+				Totals.TotalBytesEvicted += Statistics.BytesEvicted;
+				Totals.TotalObjectsMadeResident += Statistics.ObjectsMadeResident;
+				Totals.TotalObjectsEvicted += Statistics.ObjectsEvicted;
+				Totals.TotalGPUWaitTicks += Statistics.GPUWaitTicks;
+				Totals.MaxGPUWaitTicks = RESIDENCY_MAX(Totals.MaxGPUWaitTicks, Statistics.GPUWaitTicks);
+				Totals.TotalSyncPointWaitTicks += Statistics.SyncPointWaitTicks;
+				Totals.LocalMemory = Statistics.LocalMemory;
+				Totals.NonLocalMemory = Statistics.NonLocalMemory;
+
+#if RESIDENCY_STATISTICS_HISTORY_SIZE
+				StatisticsHistory[StatisticsHistoryCount % RESIDENCY_STATISTICS_HISTORY_SIZE] = Statistics;
+				StatisticsHistoryCount++;
+#endif
+			}
+
+			// Use a union so that the make resident list can be converted in place to the array MakeResident expects
+			union ResidentScratchSpace
+			{
+				ManagedObject* pManagedObject;
+				ID3D12Pageable* pUnderlying;
+			};
+
+			// Grows a scratch array geometrically. The contents are not preserved.
+			template<typename T>
+			static HRESULT GrowScratch(T*& pScratch, UINT32& ScratchSize, UINT32 MinSize)
+			{
+				if (pScratch && MinSize <= ScratchSize)
+				{
+					return S_OK;
+				}
+
+				const UINT32 NewSize = RESIDENCY_MAX(RESIDENCY_MAX(MinSize, ScratchSize + ScratchSize / 2), 64u);
+				delete[](pScratch);
+				pScratch = new T[NewSize];
+				if (pScratch == nullptr)
+				{
+					ScratchSize = 0;
+					return E_OUTOFMEMORY;
+				}
+
+				ScratchSize = NewSize;
+				return S_OK;
+			}
 			// The Enqueue and Dequeue Async Work functions are threadsafe as there is only 1 producer and 1 consumer, if that changes
 			// Synchronisation will be required
 			HRESULT EnqueueAsyncWork(ResidencySet* pMasterSet, UINT64 FenceValueToSignal, UINT64 SyncPointGeneration)
 			{
+				const SIZE_T Tail = CurrentAsyncWorkloadTail.load(std::memory_order_relaxed);
+
 				// We can't get too far ahead of the worker thread otherwise huge hitches occur
-				while ((CurrentAsyncWorkloadTail - CurrentAsyncWorkloadHead) >= MaxSoftwareQueueLatency)
+				while ((Tail - CurrentAsyncWorkloadHead.load(std::memory_order_acquire)) >= MaxSoftwareQueueLatency)
 				{
-					WaitForSingleObject(AsyncThreadWorkCompletionEvent, INFINITE);
+					AsyncThreadWorkCompletionEvent.Wait();
 				}
 
-				RESIDENCY_CHECK(CurrentAsyncWorkloadTail >= CurrentAsyncWorkloadHead);
+				RESIDENCY_CHECK(Tail >= CurrentAsyncWorkloadHead.load(std::memory_order_relaxed));
 
-				const SIZE_T currentIndex = CurrentAsyncWorkloadTail % AsyncWorkQueueSize;
+				const SIZE_T currentIndex = Tail % AsyncWorkQueueSize;
 				AsyncWorkQueue[currentIndex].pMasterSet = pMasterSet;
 				AsyncWorkQueue[currentIndex].FenceValueToSignal = FenceValueToSignal;
 				AsyncWorkQueue[currentIndex].SyncPointGeneration = SyncPointGeneration;
 
-				CurrentAsyncWorkloadTail++;
-				if (SetEvent(AsyncWorkEvent) == false)
-				{
-					return HRESULT_FROM_WIN32(GetLastError());
-				}
+				AsyncWorkQueue[currentIndex].EnqueueTimestamp = Internal::GetTimestamp();
 
-				return S_OK;
+				CurrentAsyncWorkloadTail.store(Tail + 1, std::memory_order_release);
+				return AsyncWorkEvent.Set();
 			}
 
 			AsyncWorkload* DequeueAsyncWork()
 			{
-				if (CurrentAsyncWorkloadHead == CurrentAsyncWorkloadTail)
+				const SIZE_T Head = CurrentAsyncWorkloadHead.load(std::memory_order_relaxed);
+				if (Head == CurrentAsyncWorkloadTail.load(std::memory_order_acquire))
 				{
 					return nullptr;
 				}
 
-				const SIZE_T currentHead = CurrentAsyncWorkloadHead % AsyncWorkQueueSize;
+				const SIZE_T currentHead = Head % AsyncWorkQueueSize;
 				AsyncWorkload* pWork = &AsyncWorkQueue[currentHead];
 
-				CurrentAsyncWorkloadHead++;
+				CurrentAsyncWorkloadHead.store(Head + 1, std::memory_order_release);
 				return pWork;
 			}
 
@@ -1311,7 +2124,7 @@ namespace D3DX12Residency
 			{
 				Internal::ScopedLock Lock(&AsyncWorkMutex);
 
-				Internal::DeviceWideSyncPoint* pPoint = Internal::DeviceWideSyncPoint::CreateSyncPoint(NumQueuesSeen, CurrentSyncPointGeneration);
+				Internal::DeviceWideSyncPoint* pPoint = AllocateSyncPoint(NumQueuesSeen, CurrentSyncPointGeneration);
 				if (pPoint == nullptr)
 				{
 					return E_OUTOFMEMORY;
@@ -1349,7 +2162,7 @@ namespace D3DX12Residency
 					if (pPoint->IsCompleted())
 					{
 						Internal::RemoveHeadList(&InFlightSyncPointsHead);
-						delete pPoint;
+						FreeSyncPoint(pPoint);
 					}
 					else
 					{
@@ -1379,40 +2192,59 @@ namespace D3DX12Residency
 					{
 						// Keep popping off until we find the one to wait on
 						Internal::RemoveHeadList(&InFlightSyncPointsHead);
-						delete(pPoint);
+						FreeSyncPoint(pPoint);
 					}
 					else
 					{
 						pPoint->WaitForCompletion(CompletionEvent);
 						Internal::RemoveHeadList(&InFlightSyncPointsHead);
-						delete(pPoint);
+						FreeSyncPoint(pPoint);
 						return;
 					}
 				}
 			}
 
-			// Generate a result between the minimum period and the maximum period based on the current
-			// local memory pressure. I.e. when memory pressure is low, objects will persist longer before
-			// being evicted.
-			UINT64 GetCurrentEvictionGracePeriod(DXGI_QUERY_VIDEO_MEMORY_INFO* LocalMemoryState)
+			// Sync points are recycled through a free list guarded by AsyncWorkMutex. Their size depends on the number of
+			// queues seen, so a pooled one is only reused while that hasn't changed; stale ones are released.
+			Internal::DeviceWideSyncPoint* AllocateSyncPoint(UINT32 NumQueues, UINT64 Generation)
 			{
-				// 1 == full pressure, 0 == no pressure
-				double Pressure = (double(LocalMemoryState->CurrentUsage) / double(LocalMemoryState->Budget));
-				Pressure = RESIDENCY_MIN(Pressure, 1.0);
-
-				if (Pressure > cTrimPercentageMemoryUsageThreshold)
+				while (Internal::IsListEmpty(&FreeSyncPointsHead) == false)
 				{
-					// Normalize the pressure for the range 0 to cTrimPercentageMemoryUsageThreshold
-					Pressure = (Pressure - cTrimPercentageMemoryUsageThreshold) / (1.0 - cTrimPercentageMemoryUsageThreshold);
+					Internal::DeviceWideSyncPoint* pPoint =
+						CONTAINING_RECORD(Internal::RemoveHeadList(&FreeSyncPointsHead), Internal::DeviceWideSyncPoint, ListEntry);
 
-					// Linearly interpolate between the min period and the max period based on the pressure
-					return UINT64((MaxEvictionGracePeriodTicks - MinEvictionGracePeriodTicks) * (1.0 - Pressure)) + MinEvictionGracePeriodTicks;
+					if (pPoint->NumQueueSyncPoints == NumQueues)
+					{
+						pPoint->~DeviceWideSyncPoint();
+						return new (pPoint) Internal::DeviceWideSyncPoint(NumQueues, Generation);
+					}
+
+					Internal::DeviceWideSyncPoint::DestroySyncPoint(pPoint);
 				}
-				else
+
+				// No more than a full async queue of sync points are in flight, so allocate for all of them at once
+				for (SIZE_T i = 0; i < AsyncWorkQueueSize + 1; i++)
 				{
-					// Essentially don't trim at all
-					return MAXUINT64;
+					Internal::DeviceWideSyncPoint* pPoint = Internal::DeviceWideSyncPoint::CreateSyncPoint(NumQueues, Generation);
+					if (pPoint == nullptr)
+					{
+						break;
+					}
+					FreeSyncPoint(pPoint);
 				}
+
+				return Internal::DeviceWideSyncPoint::CreateSyncPoint(NumQueues, Generation);
+			}
+
+			void FreeSyncPoint(Internal::DeviceWideSyncPoint* pPoint)
+			{
+				Internal::InsertHeadList(&FreeSyncPointsHead, &pPoint->ListEntry);
+			}
+
+			UINT64 GetCurrentEvictionGracePeriod(DXGI_QUERY_VIDEO_MEMORY_INFO* LocalMemoryState)
+			{
+				double Pressure = (double(LocalMemoryState->CurrentUsage) / double(LocalMemoryState->Budget));
+				return Internal::ComputeEvictionGracePeriod(Pressure, MinEvictionGracePeriodTicks, MaxEvictionGracePeriodTicks, cTrimPercentageMemoryUsageThreshold);
 			}
 
 			LIST_ENTRY QueueFencesListHead;
@@ -1420,10 +2252,11 @@ namespace D3DX12Residency
 			Internal::Fence AsyncThreadFence;
 
 			LIST_ENTRY InFlightSyncPointsHead;
+			LIST_ENTRY FreeSyncPointsHead;
 			UINT64 CurrentSyncPointGeneration;
 
-			HANDLE CompletionEvent;
-			HANDLE AsyncThreadWorkCompletionEvent;
+			Internal::Event CompletionEvent;
+			Internal::Event AsyncThreadWorkCompletionEvent;
 
 			ID3D12Device* Device;
 			// NOTE: This is an index not a mask. The majority of D3D12 uses bit masks to identify a GPU node whereas DXGI uses 0 based indices.
@@ -1449,6 +2282,26 @@ namespace D3DX12Residency
 			INT64 ResidencyManagerUniqueID;
 
 			SyncManager* pSyncManager;
+
+			// Written by the paging thread and read by whoever polls the statistics
+			Internal::CriticalSection StatisticsCS;
+			ResidencyStatistics Totals;
+#if RESIDENCY_STATISTICS_HISTORY_SIZE
+			SyncPointStatistics StatisticsHistory[RESIDENCY_STATISTICS_HISTORY_SIZE];
+#endif
+			UINT64 StatisticsHistoryCount;
+			// The first paging failure since ExecuteCommandLists last reported one
+			HRESULT PagingFailure;
+
+			// Recycled master sets, returned by the async thread once their paging work completes
+			LIST_ENTRY FreeMasterSetsHead;
+			Internal::CriticalSection MasterSetPoolCS;
+
+			// Scratch space for ProcessPagingWork
+			ResidentScratchSpace* pMakeResidentScratch;
+			UINT32 MakeResidentScratchSize;
+			ID3D12Pageable** pEvictionScratch;
+			UINT32 EvictionScratchSize;
 		};
 	}
 
@@ -1481,6 +2334,30 @@ namespace D3DX12Residency
 			Manager.EndTrackingObject(pObject);
 		}
 
+		// Defaults to EVICTION_POLICY::LRU
+		FORCEINLINE void SetEvictionPolicy(EVICTION_POLICY Policy)
+		{
+			Manager.SetEvictionPolicy(Policy);
+		}
+
+		// Only valid for objects that are being tracked; set ManagedObject::Priority directly before then
+		FORCEINLINE void SetPriority(ManagedObject* pObject, RESIDENCY_PRIORITY Priority)
+		{
+			Manager.SetPriority(pObject, Priority);
+		}
+
+		// Paging totals since Initialize and the current budget and object counts. Safe to call from any thread.
+		FORCEINLINE void GetStatistics(ResidencyStatistics* pStatistics)
+		{
+			Manager.GetStatistics(pStatistics);
+		}
+
+		// The paging done for each of the last RESIDENCY_STATISTICS_HISTORY_SIZE sync points, oldest first
+		FORCEINLINE UINT32 GetStatisticsHistory(SyncPointStatistics* pHistory, UINT32 MaxCount, UINT64 MinGeneration = 0)
+		{
+			return Manager.GetStatisticsHistory(pHistory, MaxCount, MinGeneration);
+		}
+
 		HRESULT GetCurrentGPUSyncPoint(ID3D12CommandQueue* Queue, UINT64 *pCurrentGPUSyncPoint)
 		{
 			return Manager.GetCurrentGPUSyncPoint(Queue, pCurrentGPUSyncPoint);
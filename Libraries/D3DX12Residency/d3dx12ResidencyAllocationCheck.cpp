@@ -0,0 +1,174 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// Checks that ResidencyManager::ExecuteCommandLists doesn't allocate once the master sets, sync points and paging
+// scratch have grown to the workload.  Builds on hosts without the Windows SDK, using d3dx12ResidencyMock.h:
+//
+//     g++ -std=c++14 -O2 -pthread d3dx12ResidencyAllocationCheck.cpp -o d3dx12ResidencyAllocationCheck
+//
+// Every allocation made by the process, including on the paging thread, is counted while the steady state
+// submissions run.  Returns 0 if there were none.
+
+#include "d3dx12ResidencyMock.h"
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+static std::atomic<bool> g_CountAllocations(false);
+static std::atomic<UINT64> g_NumAllocations(0);
+
+static void* CountedAllocate(size_t Size)
+{
+	if (g_CountAllocations.load(std::memory_order_relaxed))
+	{
+		g_NumAllocations.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void* pMemory = malloc(Size ? Size : 1);
+	if (pMemory == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return pMemory;
+}
+
+void* operator new(size_t Size) { return CountedAllocate(Size); }
+void* operator new[](size_t Size) { return CountedAllocate(Size); }
+void operator delete(void* pMemory) noexcept { free(pMemory); }
+void operator delete[](void* pMemory) noexcept { free(pMemory); }
+void operator delete(void* pMemory, size_t) noexcept { free(pMemory); }
+void operator delete[](void* pMemory, size_t) noexcept { free(pMemory); }
+
+namespace
+{
+	using namespace D3DX12Residency;
+
+	struct CheckParameters
+	{
+		const char* pName;
+		// The local budget as a fraction of the size of all objects
+		float BudgetPercentage;
+	};
+
+	const UINT32 NumObjects = 10000;
+	const UINT64 ObjectSize = 64 * 1024;
+	const UINT32 CommandListsPerSubmission = 4;
+	const UINT32 ObjectsPerCommandList = 500;
+	const UINT32 WarmUpSubmissions = 100;
+	const UINT32 SteadyStateSubmissions = 300;
+
+	// Runs the warm-up and steady state submissions and returns the number of allocations made by the latter
+	HRESULT CountSteadyStateAllocations(const CheckParameters& Params, UINT64* pNumAllocations)
+	{
+		ID3D12Device Device;
+		IDXGIAdapter3 Adapter(&Device, UINT64(double(NumObjects) * double(ObjectSize) * Params.BudgetPercentage));
+		ID3D12CommandQueue* pQueue = Device.CreateCommandQueue();
+
+		ResidencyManager Manager;
+		HRESULT hr = Manager.Initialize(&Device, 0, &Adapter, 3);
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+
+		std::vector<ManagedObject> Objects(NumObjects);
+		for (UINT32 i = 0; i < NumObjects; i++)
+		{
+			Objects[i].Initialize(Device.CreatePageable(ObjectSize), ObjectSize);
+			Manager.BeginTrackingObject(&Objects[i]);
+		}
+
+		ResidencySet* Sets[CommandListsPerSubmission];
+		ID3D12CommandList CommandLists[CommandListsPerSubmission];
+		ID3D12CommandList* CommandListPointers[CommandListsPerSubmission];
+		for (UINT32 i = 0; i < CommandListsPerSubmission; i++)
+		{
+			Sets[i] = Manager.CreateResidencySet();
+			CommandListPointers[i] = &CommandLists[i];
+		}
+
+		// Each submission uses a window of objects that slides through the whole set, so that under a small budget
+		// every submission pages objects in and out
+		const UINT32 ObjectsPerSubmission = ObjectsPerCommandList * CommandListsPerSubmission;
+		UINT32 WindowStart = 0;
+		for (UINT32 Submission = 0; Submission < WarmUpSubmissions + SteadyStateSubmissions && SUCCEEDED(hr); Submission++)
+		{
+			if (Submission == WarmUpSubmissions)
+			{
+				g_NumAllocations = 0;
+				g_CountAllocations = true;
+			}
+
+			for (UINT32 List = 0; List < CommandListsPerSubmission; List++)
+			{
+				Sets[List]->Open();
+				for (UINT32 i = 0; i < ObjectsPerCommandList; i++)
+				{
+					Sets[List]->Insert(&Objects[(WindowStart + List * ObjectsPerCommandList + i) % NumObjects]);
+				}
+				Sets[List]->Close();
+			}
+
+			hr = Manager.ExecuteCommandLists(pQueue, CommandListPointers, Sets, CommandListsPerSubmission);
+			WindowStart = (WindowStart + ObjectsPerSubmission / 4) % NumObjects;
+		}
+
+		for (UINT32 i = 0; i < CommandListsPerSubmission; i++)
+		{
+			Manager.DestroyResidencySet(Sets[i]);
+		}
+
+		// Destroy waits for the paging thread, so its work for the last submissions is counted too
+		Manager.Destroy();
+
+		g_CountAllocations = false;
+		*pNumAllocations = g_NumAllocations;
+
+		for (UINT32 i = 0; i < NumObjects; i++)
+		{
+			Device.DestroyPageable(Objects[i].pUnderlying);
+		}
+
+		return hr;
+	}
+}
+
+int main()
+{
+	const CheckParameters Checks[] =
+	{
+		{ "Within budget", 2.0f },
+		{ "Over budget", 0.5f },
+	};
+
+	int Result = 0;
+	for (UINT32 i = 0; i < ARRAYSIZE(Checks); i++)
+	{
+		UINT64 NumAllocations = 0;
+		HRESULT hr = CountSteadyStateAllocations(Checks[i], &NumAllocations);
+		if (FAILED(hr))
+		{
+			printf("%-16s failed (0x%08x)\n", Checks[i].pName, unsigned(hr));
+			Result = 1;
+			continue;
+		}
+
+		printf("%-16s %llu allocations in %u steady state submissions\n", Checks[i].pName,
+			(unsigned long long)NumAllocations, SteadyStateSubmissions);
+		if (NumAllocations != 0)
+		{
+			Result = 1;
+		}
+	}
+
+	return Result;
+}
@@ -0,0 +1,590 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// Stand-ins for the handful of Win32, D3D12 and DXGI types the residency library uses, so that the library can be built
+// and profiled on hosts without the Windows SDK.  Include this header instead of the Windows and D3D12 headers, before
+// d3dx12Residency.h.  The library then uses its portable threading (RESIDENCY_PORTABLE_THREADING).
+//
+// The mock device counts the bytes made resident and evicted and reports them as local memory usage against a fixed
+// budget.  Command lists execute instantly: a queue only holds back its fence waits and signals until the fences it
+// waits on reach their values, which is enough to reproduce the library's synchronization with its paging thread.
+//
+// Mock::BenchmarkExecuteCommandLists measures the CPU cost of ResidencyManager::ExecuteCommandLists over a large
+// number of objects.
+
+#pragma once
+
+#ifdef _WIN32
+#error d3dx12ResidencyMock.h replaces the Windows SDK types and must not be used on Windows
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#ifndef RESIDENCY_PORTABLE_THREADING
+#define RESIDENCY_PORTABLE_THREADING 1
+#endif
+
+typedef int32_t HRESULT;
+typedef int32_t INT32;
+typedef uint32_t UINT32;
+typedef uint32_t UINT;
+typedef int64_t INT64;
+typedef uint64_t UINT64;
+typedef int32_t LONG;
+typedef unsigned char BYTE;
+typedef size_t SIZE_T;
+typedef void* HANDLE;
+
+#define S_OK ((HRESULT)0)
+#define E_FAIL ((HRESULT)0x80004005)
+#define E_INVALIDARG ((HRESULT)0x80070057)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000E)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr) (((HRESULT)(hr)) < 0)
+#define HRESULT_FROM_WIN32(x) ((HRESULT)(x) <= 0 ? ((HRESULT)(x)) : ((HRESULT)(((x) & 0x0000FFFF) | 0x80070000)))
+
+#define MAXUINT64 UINT64_MAX
+#define FORCEINLINE inline __attribute__((always_inline))
+#define ARRAYSIZE(a) (sizeof(a) / sizeof((a)[0]))
+#define ZeroMemory(Destination, Length) memset((Destination), 0, (Length))
+#define CONTAINING_RECORD(address, type, field) ((type*)((char*)(address) - offsetof(type, field)))
+#define IID_PPV_ARGS(ppType) (ppType)
+
+inline void DebugBreak() { __builtin_trap(); }
+
+struct LIST_ENTRY
+{
+	LIST_ENTRY* Flink;
+	LIST_ENTRY* Blink;
+};
+
+struct GUID
+{
+	UINT32 Data1;
+	uint16_t Data2;
+	uint16_t Data3;
+	BYTE Data4[8];
+};
+
+inline bool operator==(const GUID& A, const GUID& B) { return memcmp(&A, &B, sizeof(GUID)) == 0; }
+
+enum D3D12_FENCE_FLAGS
+{
+	D3D12_FENCE_FLAG_NONE = 0
+};
+
+enum DXGI_MEMORY_SEGMENT_GROUP
+{
+	DXGI_MEMORY_SEGMENT_GROUP_LOCAL = 0,
+	DXGI_MEMORY_SEGMENT_GROUP_NON_LOCAL = 1
+};
+
+struct DXGI_QUERY_VIDEO_MEMORY_INFO
+{
+	UINT64 Budget;
+	UINT64 CurrentUsage;
+	UINT64 AvailableForReservation;
+	UINT64 CurrentReservation;
+};
+
+class ID3D12Device;
+class ID3D12Fence;
+
+class ID3D12Pageable
+{
+public:
+	ID3D12Pageable(UINT64 SizeIn = 0) : Size(SizeIn), Resident(true) {}
+	virtual ~ID3D12Pageable() {}
+
+	void Release() { delete this; }
+
+	UINT64 Size;
+	bool Resident;
+};
+
+class ID3D12CommandList
+{
+};
+
+// All fences and queues created from a device share its lock, so that a signal from any thread can retire the waits
+// queued up on every queue.
+class ID3D12Fence : public ID3D12Pageable
+{
+public:
+	ID3D12Fence(ID3D12Device* pDeviceIn, UINT64 InitialValue) : pDevice(pDeviceIn), Value(InitialValue) {}
+
+	UINT64 GetCompletedValue();
+	HRESULT Signal(UINT64 NewValue);
+
+	// Only blocking waits (a null event) are supported
+	HRESULT SetEventOnCompletion(UINT64 WaitValue, HANDLE Event);
+
+private:
+	friend class ID3D12CommandQueue;
+	friend class ID3D12Device;
+
+	ID3D12Device* pDevice;
+	UINT64 Value;
+};
+
+class ID3D12CommandQueue
+{
+public:
+	ID3D12CommandQueue(ID3D12Device* pDeviceIn) : pDevice(pDeviceIn), PrivateDataSize(0)
+	{
+		// Waits and signals queue up behind the paging thread; keep the mock from allocating while they do so that
+		// allocation counts only reflect the residency manager
+		PendingOperations.reserve(256);
+	}
+
+	HRESULT Wait(ID3D12Fence* pFence, UINT64 Value);
+	HRESULT Signal(ID3D12Fence* pFence, UINT64 Value);
+	void ExecuteCommandLists(UINT, ID3D12CommandList* const*) {}
+
+	HRESULT GetPrivateData(const GUID& Guid, UINT* pDataSize, void* pData)
+	{
+		if (PrivateDataSize == 0 || !(Guid == PrivateDataGuid) || *pDataSize < PrivateDataSize)
+		{
+			return E_FAIL;
+		}
+
+		memcpy(pData, PrivateData, PrivateDataSize);
+		*pDataSize = PrivateDataSize;
+		return S_OK;
+	}
+
+	HRESULT SetPrivateData(const GUID& Guid, UINT DataSize, const void* pData)
+	{
+		if (DataSize > sizeof(PrivateData))
+		{
+			return E_INVALIDARG;
+		}
+
+		PrivateDataGuid = Guid;
+		memcpy(PrivateData, pData, DataSize);
+		PrivateDataSize = DataSize;
+		return S_OK;
+	}
+
+private:
+	friend class ID3D12Device;
+
+	struct FenceOperation
+	{
+		ID3D12Fence* pFence;
+		UINT64 Value;
+		bool IsWait;
+	};
+
+	// Returns true if any operation was retired
+	bool Retire()
+	{
+		size_t Retired = 0;
+		for (; Retired < PendingOperations.size(); Retired++)
+		{
+			FenceOperation& Operation = PendingOperations[Retired];
+			if (Operation.IsWait)
+			{
+				if (Operation.pFence->Value < Operation.Value)
+				{
+					break;
+				}
+			}
+			else if (Operation.pFence->Value < Operation.Value)
+			{
+				Operation.pFence->Value = Operation.Value;
+			}
+		}
+
+		PendingOperations.erase(PendingOperations.begin(), PendingOperations.begin() + Retired);
+		return Retired > 0;
+	}
+
+	ID3D12Device* pDevice;
+	std::vector<FenceOperation> PendingOperations;
+
+	GUID PrivateDataGuid;
+	BYTE PrivateData[64];
+	UINT PrivateDataSize;
+};
+
+class ID3D12Device
+{
+public:
+	ID3D12Device() : NumMakeResidentCalls(0), NumEvictCalls(0), BytesMadeResident(0), BytesEvicted(0), ResidentBytes(0) {}
+
+	~ID3D12Device()
+	{
+		for (ID3D12CommandQueue* pQueue : Queues)
+		{
+			delete pQueue;
+		}
+	}
+
+	HRESULT CreateFence(UINT64 InitialValue, D3D12_FENCE_FLAGS, ID3D12Fence** ppFence)
+	{
+		*ppFence = new ID3D12Fence(this, InitialValue);
+		return S_OK;
+	}
+
+	// Queues are owned by the device
+	ID3D12CommandQueue* CreateCommandQueue()
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		Queues.push_back(new ID3D12CommandQueue(this));
+		return Queues.back();
+	}
+
+	// Objects start resident, as they would after creation.  Pass ResidentAtCreation = false for objects created with
+	// D3D12_HEAP_FLAG_CREATE_NOT_RESIDENT.
+	ID3D12Pageable* CreatePageable(UINT64 Size, bool ResidentAtCreation = true)
+	{
+		ID3D12Pageable* pObject = new ID3D12Pageable(Size);
+		pObject->Resident = ResidentAtCreation;
+
+		std::lock_guard<std::mutex> Lock(Mutex);
+		if (ResidentAtCreation)
+		{
+			ResidentBytes += Size;
+		}
+		return pObject;
+	}
+
+	void DestroyPageable(ID3D12Pageable* pObject)
+	{
+		{
+			std::lock_guard<std::mutex> Lock(Mutex);
+			if (pObject->Resident)
+			{
+				ResidentBytes -= pObject->Size;
+			}
+		}
+		delete pObject;
+	}
+
+	HRESULT MakeResident(UINT NumObjects, ID3D12Pageable* const* ppObjects)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		NumMakeResidentCalls++;
+		for (UINT i = 0; i < NumObjects; i++)
+		{
+			if (ppObjects[i]->Resident == false)
+			{
+				ppObjects[i]->Resident = true;
+				ResidentBytes += ppObjects[i]->Size;
+				BytesMadeResident += ppObjects[i]->Size;
+			}
+		}
+		return S_OK;
+	}
+
+	HRESULT Evict(UINT NumObjects, ID3D12Pageable* const* ppObjects)
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		NumEvictCalls++;
+		for (UINT i = 0; i < NumObjects; i++)
+		{
+			if (ppObjects[i]->Resident)
+			{
+				ppObjects[i]->Resident = false;
+				ResidentBytes -= ppObjects[i]->Size;
+				BytesEvicted += ppObjects[i]->Size;
+			}
+		}
+		return S_OK;
+	}
+
+	UINT64 GetResidentBytes()
+	{
+		std::lock_guard<std::mutex> Lock(Mutex);
+		return ResidentBytes;
+	}
+
+	UINT64 NumMakeResidentCalls;
+	UINT64 NumEvictCalls;
+	UINT64 BytesMadeResident;
+	UINT64 BytesEvicted;
+
+private:
+	friend class ID3D12Fence;
+	friend class ID3D12CommandQueue;
+
+	// Called with the lock held after any fence value changes or a queue operation is added
+	void RetireQueues()
+	{
+		bool Progress = true;
+		while (Progress)
+		{
+			Progress = false;
+			for (ID3D12CommandQueue* pQueue : Queues)
+			{
+				Progress |= pQueue->Retire();
+			}
+		}
+		FenceCondition.notify_all();
+	}
+
+	std::mutex Mutex;
+	std::condition_variable FenceCondition;
+	std::vector<ID3D12CommandQueue*> Queues;
+	UINT64 ResidentBytes;
+};
+
+inline UINT64 ID3D12Fence::GetCompletedValue()
+{
+	std::lock_guard<std::mutex> Lock(pDevice->Mutex);
+	return Value;
+}
+
+inline HRESULT ID3D12Fence::Signal(UINT64 NewValue)
+{
+	std::lock_guard<std::mutex> Lock(pDevice->Mutex);
+	Value = NewValue;
+	pDevice->RetireQueues();
+	return S_OK;
+}
+
+inline HRESULT ID3D12Fence::SetEventOnCompletion(UINT64 WaitValue, HANDLE Event)
+{
+	if (Event != nullptr)
+	{
+		return E_INVALIDARG;
+	}
+
+	std::unique_lock<std::mutex> Lock(pDevice->Mutex);
+	pDevice->FenceCondition.wait(Lock, [this, WaitValue] { return Value >= WaitValue; });
+	return S_OK;
+}
+
+inline HRESULT ID3D12CommandQueue::Wait(ID3D12Fence* pFence, UINT64 Value)
+{
+	std::lock_guard<std::mutex> Lock(pDevice->Mutex);
+	PendingOperations.push_back({ pFence, Value, true });
+	pDevice->RetireQueues();
+	return S_OK;
+}
+
+inline HRESULT ID3D12CommandQueue::Signal(ID3D12Fence* pFence, UINT64 Value)
+{
+	std::lock_guard<std::mutex> Lock(pDevice->Mutex);
+	PendingOperations.push_back({ pFence, Value, false });
+	pDevice->RetireQueues();
+	return S_OK;
+}
+
+// Reports a fixed local budget and the device's resident bytes as its usage
+class IDXGIAdapter3
+{
+public:
+	IDXGIAdapter3(ID3D12Device* pDeviceIn, UINT64 LocalBudgetIn, UINT64 NonLocalBudgetIn = 0) :
+		pDevice(pDeviceIn),
+		LocalBudget(LocalBudgetIn),
+		NonLocalBudget(NonLocalBudgetIn)
+	{}
+
+	HRESULT QueryVideoMemoryInfo(UINT, DXGI_MEMORY_SEGMENT_GROUP Segment, DXGI_QUERY_VIDEO_MEMORY_INFO* pInfo)
+	{
+		ZeroMemory(pInfo, sizeof(*pInfo));
+		if (Segment == DXGI_MEMORY_SEGMENT_GROUP_LOCAL)
+		{
+			pInfo->Budget = LocalBudget;
+			pInfo->CurrentUsage = pDevice->GetResidentBytes();
+		}
+		else
+		{
+			pInfo->Budget = NonLocalBudget;
+		}
+		return S_OK;
+	}
+
+	ID3D12Device* pDevice;
+	UINT64 LocalBudget;
+	UINT64 NonLocalBudget;
+};
+
+#include "d3dx12Residency.h"
+
+namespace D3DX12Residency
+{
+	namespace Mock
+	{
+		struct BenchmarkParameters
+		{
+			BenchmarkParameters() :
+				NumObjects(10000),
+				ObjectSize(1024 * 1024),
+				NumSubmissions(1000),
+				ObjectsPerSubmission(2000),
+				CommandListsPerSubmission(4),
+				BudgetPercentage(0.5f),
+				MaxLatency(3)
+			{}
+
+			UINT32 NumObjects;
+			UINT64 ObjectSize;
+			UINT32 NumSubmissions;
+			// Each submission uses a window of objects that slides through the whole set, so every object is used
+			// but only some fit in the budget at a time
+			UINT32 ObjectsPerSubmission;
+			UINT32 CommandListsPerSubmission;
+			// The local budget as a fraction of the size of all objects
+			float BudgetPercentage;
+			UINT32 MaxLatency;
+		};
+
+		struct BenchmarkResult
+		{
+			// Time spent recording the residency sets
+			double RecordSeconds;
+			// Time spent in ResidencyManager::ExecuteCommandLists, including any stalls on the paging thread
+			double ExecuteSeconds;
+			double SubmissionsPerSecond;
+			double ObjectReferencesPerSecond;
+
+			UINT64 BytesMadeResident;
+			UINT64 BytesEvicted;
+			UINT64 NumMakeResidentCalls;
+			UINT64 NumEvictCalls;
+		};
+
+		inline HRESULT BenchmarkExecuteCommandLists(const BenchmarkParameters& Params, BenchmarkResult* pResult)
+		{
+			ZeroMemory(pResult, sizeof(*pResult));
+
+			if (Params.NumObjects == 0 || Params.CommandListsPerSubmission == 0 ||
+				Params.CommandListsPerSubmission > MAX_NUM_CONCURRENT_CMD_LISTS)
+			{
+				return E_INVALIDARG;
+			}
+
+			ID3D12Device Device;
+			IDXGIAdapter3 Adapter(&Device, UINT64(double(Params.NumObjects) * double(Params.ObjectSize) * Params.BudgetPercentage));
+			ID3D12CommandQueue* pQueue = Device.CreateCommandQueue();
+
+			ResidencyManager Manager;
+			HRESULT hr = Manager.Initialize(&Device, 0, &Adapter, Params.MaxLatency);
+			if (FAILED(hr))
+			{
+				return hr;
+			}
+
+			std::vector<ManagedObject> Objects(Params.NumObjects);
+			for (UINT32 i = 0; i < Params.NumObjects; i++)
+			{
+				Objects[i].Initialize(Device.CreatePageable(Params.ObjectSize), Params.ObjectSize);
+				Manager.BeginTrackingObject(&Objects[i]);
+			}
+
+			std::vector<ResidencySet*> Sets(Params.CommandListsPerSubmission);
+			std::vector<ID3D12CommandList> CommandLists(Params.CommandListsPerSubmission);
+			std::vector<ID3D12CommandList*> CommandListPointers(Params.CommandListsPerSubmission);
+			for (UINT32 i = 0; i < Params.CommandListsPerSubmission; i++)
+			{
+				Sets[i] = Manager.CreateResidencySet();
+				CommandListPointers[i] = &CommandLists[i];
+			}
+
+			const UINT32 ObjectsPerCommandList = Params.ObjectsPerSubmission / Params.CommandListsPerSubmission;
+			const UINT32 WindowStep = RESIDENCY_MAX(Params.ObjectsPerSubmission / 4, 1u);
+
+			std::chrono::steady_clock::duration RecordTime(0);
+			std::chrono::steady_clock::duration ExecuteTime(0);
+
+			UINT32 WindowStart = 0;
+			for (UINT32 Submission = 0; Submission < Params.NumSubmissions && SUCCEEDED(hr); Submission++)
+			{
+				const auto RecordStart = std::chrono::steady_clock::now();
+				for (UINT32 List = 0; List < Params.CommandListsPerSubmission; List++)
+				{
+					Sets[List]->Open();
+					for (UINT32 i = 0; i < ObjectsPerCommandList; i++)
+					{
+						Sets[List]->Insert(&Objects[(WindowStart + List * ObjectsPerCommandList + i) % Params.NumObjects]);
+					}
+					Sets[List]->Close();
+				}
+
+				const auto ExecuteStart = std::chrono::steady_clock::now();
+				hr = Manager.ExecuteCommandLists(pQueue, CommandListPointers.data(), Sets.data(), Params.CommandListsPerSubmission);
+				const auto ExecuteEnd = std::chrono::steady_clock::now();
+
+				RecordTime += ExecuteStart - RecordStart;
+				ExecuteTime += ExecuteEnd - ExecuteStart;
+				WindowStart = (WindowStart + WindowStep) % Params.NumObjects;
+			}
+
+			for (UINT32 i = 0; i < Params.CommandListsPerSubmission; i++)
+			{
+				Manager.DestroyResidencySet(Sets[i]);
+			}
+
+			// Destroy waits for the paging thread, so the device counters are final after it returns
+			Manager.Destroy();
+
+			for (UINT32 i = 0; i < Params.NumObjects; i++)
+			{
+				Device.DestroyPageable(Objects[i].pUnderlying);
+			}
+
+			pResult->RecordSeconds = std::chrono::duration<double>(RecordTime).count();
+			pResult->ExecuteSeconds = std::chrono::duration<double>(ExecuteTime).count();
+			if (pResult->ExecuteSeconds > 0.0)
+			{
+				pResult->SubmissionsPerSecond = Params.NumSubmissions / pResult->ExecuteSeconds;
+				pResult->ObjectReferencesPerSecond = double(Params.NumSubmissions) * ObjectsPerCommandList * Params.CommandListsPerSubmission / pResult->ExecuteSeconds;
+			}
+			pResult->BytesMadeResident = Device.BytesMadeResident;
+			pResult->BytesEvicted = Device.BytesEvicted;
+			pResult->NumMakeResidentCalls = Device.NumMakeResidentCalls;
+			pResult->NumEvictCalls = Device.NumEvictCalls;
+
+			return hr;
+		}
+
+		// Runs the benchmark at 10K, 25K, 50K and 100K objects, each submission using a fifth of them
+		inline void RunBenchmarks()
+		{
+			const UINT32 ObjectCounts[] = { 10000, 25000, 50000, 100000 };
+
+			printf("%10s %12s %12s %14s %12s %12s\n", "Objects", "Execute ms", "Submits/s", "Objects/s", "Paged in MB", "Evicted MB");
+			for (UINT32 i = 0; i < ARRAYSIZE(ObjectCounts); i++)
+			{
+				BenchmarkParameters Params;
+				Params.NumObjects = ObjectCounts[i];
+				Params.ObjectSize = 64 * 1024;
+				Params.ObjectsPerSubmission = ObjectCounts[i] / 5;
+				Params.NumSubmissions = 200;
+
+				BenchmarkResult Result;
+				if (FAILED(BenchmarkExecuteCommandLists(Params, &Result)))
+				{
+					printf("%10u failed\n", Params.NumObjects);
+					continue;
+				}
+
+				printf("%10u %12.2f %12.0f %14.0f %12llu %12llu\n",
+					Params.NumObjects,
+					Result.ExecuteSeconds * 1000.0,
+					Result.SubmissionsPerSecond,
+					Result.ObjectReferencesPerSecond,
+					(unsigned long long)(Result.BytesMadeResident >> 20),
+					(unsigned long long)(Result.BytesEvicted >> 20));
+			}
+		}
+	}
+}
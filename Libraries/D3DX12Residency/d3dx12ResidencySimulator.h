@@ -0,0 +1,172 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+// Replays a recorded residency workload through the residency library's LRU cache to compare eviction policies.
+// No device is needed: the budget is fixed, the GPU is assumed to finish each submission a set number of submissions
+// after it was made, and paging is counted rather than performed.
+//
+// To record a trace, give every ManagedObject an index and log its size and priority, then for each call to
+// ExecuteCommandLists log the QPC time and the indices of the objects in its residency sets.
+
+#pragma once
+#include "d3dx12Residency.h"
+
+namespace D3DX12Residency
+{
+	namespace Simulation
+	{
+		struct TraceObject
+		{
+			UINT64 Size;
+			RESIDENCY_PRIORITY Priority;
+		};
+
+		struct Trace
+		{
+			UINT32 NumObjects;
+			const TraceObject* pObjects;
+
+			UINT32 NumSubmissions;
+			// When each submission was made, in ticks of TicksPerSecond
+			const UINT64* pSubmissionTimes;
+			UINT64 TicksPerSecond;
+			// Submission i used the objects pObjectIndices[pSubmissionOffsets[i]] to pObjectIndices[pSubmissionOffsets[i + 1] - 1]
+			const UINT32* pSubmissionOffsets;
+			const UINT32* pObjectIndices;
+		};
+
+		struct Parameters
+		{
+			Parameters() :
+				Budget(0),
+				GPULatency(3),
+				MinEvictionGracePeriod(1.0f),
+				MaxEvictionGracePeriod(60.0f),
+				TrimPercentageMemoryUsageThreshold(0.7f)
+			{}
+
+			UINT64 Budget;
+			// How many submissions behind the CPU the GPU runs
+			UINT32 GPULatency;
+
+			// These match the residency manager's defaults
+			float MinEvictionGracePeriod;
+			float MaxEvictionGracePeriod;
+			float TrimPercentageMemoryUsageThreshold;
+		};
+
+		struct Result
+		{
+			UINT64 BytesMadeResident;
+			UINT64 BytesEvicted;
+			UINT32 ObjectsMadeResident;
+			UINT32 ObjectsEvicted;
+			UINT64 PeakResidentSize;
+
+			// Submissions which would have waited on the GPU to free up enough memory
+			UINT32 StalledSubmissions;
+			// Submissions which were still over budget after evicting everything the GPU was done with
+			UINT32 OverBudgetSubmissions;
+		};
+
+		// Objects start evicted, so the first use of every object counts as paging it in under every policy.
+		inline HRESULT Simulate(const Trace& Workload, EVICTION_POLICY Policy, const Parameters& Params, Result* pResult)
+		{
+			ZeroMemory(pResult, sizeof(*pResult));
+
+			ManagedObject* pObjects = new ManagedObject[Workload.NumObjects];
+			ID3D12Pageable** pEvictionList = new ID3D12Pageable*[Workload.NumObjects];
+			if (pObjects == nullptr || pEvictionList == nullptr)
+			{
+				delete[](pObjects);
+				delete[](pEvictionList);
+				return E_OUTOFMEMORY;
+			}
+
+			Internal::LRUCache LRU;
+			LRU.SetPolicy(Policy);
+
+			for (UINT32 i = 0; i < Workload.NumObjects; i++)
+			{
+				// The underlying object is never dereferenced, it just needs to be unique
+				pObjects[i].Initialize(reinterpret_cast<ID3D12Pageable*>(&pObjects[i]), Workload.pObjects[i].Size);
+				pObjects[i].Priority = Workload.pObjects[i].Priority;
+				pObjects[i].ResidencyStatus = ManagedObject::RESIDENCY_STATUS::EVICTED;
+				LRU.Insert(&pObjects[i]);
+			}
+
+			const UINT64 MinGracePeriodTicks = UINT64(Workload.TicksPerSecond * Params.MinEvictionGracePeriod);
+			const UINT64 MaxGracePeriodTicks = UINT64(Workload.TicksPerSecond * Params.MaxEvictionGracePeriod);
+
+			for (UINT32 Submission = 0; Submission < Workload.NumSubmissions; Submission++)
+			{
+				const UINT64 SyncPointGeneration = Submission;
+				const UINT64 CurrentTime = Workload.pSubmissionTimes[Submission];
+
+				for (UINT32 i = Workload.pSubmissionOffsets[Submission]; i < Workload.pSubmissionOffsets[Submission + 1]; i++)
+				{
+					ManagedObject* pObject = &pObjects[Workload.pObjectIndices[i]];
+					if (pObject->ResidencyStatus == ManagedObject::RESIDENCY_STATUS::EVICTED)
+					{
+						LRU.MakeResident(pObject);
+						pResult->BytesMadeResident += pObject->Size;
+						pResult->ObjectsMadeResident++;
+					}
+
+					pObject->LastGPUSyncPoint = SyncPointGeneration;
+					pObject->LastUsedTimestamp = CurrentTime;
+					LRU.ObjectReferenced(pObject);
+				}
+
+				// The first submission the GPU hasn't finished
+				Internal::DeviceWideSyncPoint FirstUncompletedSyncPoint(1, SyncPointGeneration > Params.GPULatency ? SyncPointGeneration - Params.GPULatency : 0);
+
+				const UINT64 ResidentSizeBeforeTrim = LRU.ResidentSize;
+				const UINT32 NumEvictedBeforeTrim = LRU.NumEvictedObjects;
+				UINT32 NumObjectsToEvict = 0;
+
+				const double Pressure = Params.Budget ? double(LRU.ResidentSize) / double(Params.Budget) : 1.0;
+				const UINT64 EvictionGracePeriod = Internal::ComputeEvictionGracePeriod(Pressure, MinGracePeriodTicks, MaxGracePeriodTicks, Params.TrimPercentageMemoryUsageThreshold);
+				LRU.TrimAgedAllocations(&FirstUncompletedSyncPoint, pEvictionList, NumObjectsToEvict, CurrentTime, EvictionGracePeriod);
+
+				if (LRU.ResidentSize > Params.Budget && FirstUncompletedSyncPoint.GenerationID > 0)
+				{
+					LRU.TrimToSyncPointInclusive(INT64(LRU.ResidentSize), INT64(Params.Budget), pEvictionList, NumObjectsToEvict, FirstUncompletedSyncPoint.GenerationID - 1);
+				}
+
+				// The manager would now wait for the GPU to finish everything but this submission
+				if (LRU.ResidentSize > Params.Budget && SyncPointGeneration > 0)
+				{
+					const UINT64 ResidentSizeBeforeWait = LRU.ResidentSize;
+					LRU.TrimToSyncPointInclusive(INT64(LRU.ResidentSize), INT64(Params.Budget), pEvictionList, NumObjectsToEvict, SyncPointGeneration - 1);
+					if (LRU.ResidentSize != ResidentSizeBeforeWait)
+					{
+						pResult->StalledSubmissions++;
+					}
+				}
+
+				if (LRU.ResidentSize > Params.Budget)
+				{
+					pResult->OverBudgetSubmissions++;
+				}
+
+				pResult->BytesEvicted += ResidentSizeBeforeTrim - LRU.ResidentSize;
+				pResult->ObjectsEvicted += LRU.NumEvictedObjects - NumEvictedBeforeTrim;
+				pResult->PeakResidentSize = RESIDENCY_MAX(pResult->PeakResidentSize, ResidentSizeBeforeTrim);
+			}
+
+			delete[](pObjects);
+			delete[](pEvictionList);
+
+			return S_OK;
+		}
+	}
+}
@@ -0,0 +1,324 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard 
+//
+
+#include "pch.h"
+#include "Benchmark.h"
+#include "SystemTime.h"
+#include "PerfSweep.h"
+
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+#include <shellapi.h>
+#pragma comment(lib, "shell32.lib")
+#endif
+
+using namespace std;
+using namespace Math;
+
+namespace
+{
+    struct CameraKey
+    {
+        float Time;
+        XMFLOAT3 Eye;
+        XMFLOAT3 At;
+    };
+
+    struct FrameRecord
+    {
+        float WallTime;
+        float CpuTime;
+        float GpuTime;
+    };
+
+    bool s_IsActive = false;
+    bool s_UseWarp = false;
+    float s_Timestep = 1.0f / 60.0f;
+    uint32_t s_WarmupFrames = 30;
+    uint32_t s_MeasuredFrames = 0;
+    uint32_t s_FrameCounter = 0;
+    int64_t s_LastFrameTick = 0;
+
+    wstring s_SettingsFile;
+    wstring s_SweepFile;
+    wstring s_ReportFile = L"BenchmarkReport.csv";
+    wstring s_RecordFile;
+    float s_RecordTime = 0.0f;
+
+    vector<CameraKey> s_CameraPath;
+    vector<FrameRecord> s_FrameRecords;
+
+    bool LoadCameraPath( const wstring& FileName )
+    {
+        FILE* File = nullptr;
+        if (0 != _wfopen_s(&File, FileName.c_str(), L"r"))
+            return false;
+
+        char Line[256];
+        while (fgets(Line, sizeof(Line), File) != nullptr)
+        {
+            CameraKey Key;
+            if (Line[0] == '#')
+                continue;
+            if (7 == sscanf_s(Line, "%f %f %f %f %f %f %f", &Key.Time,
+                &Key.Eye.x, &Key.Eye.y, &Key.Eye.z, &Key.At.x, &Key.At.y, &Key.At.z))
+            {
+                ASSERT(s_CameraPath.empty() || Key.Time > s_CameraPath.back().Time, "Camera path keys must be in time order");
+                s_CameraPath.push_back(Key);
+            }
+        }
+
+        fclose(File);
+        return !s_CameraPath.empty();
+    }
+
+    // Uniform Catmull-Rom spline through the keys, which passes through every recorded pose
+    Vector3 CatmullRom( Vector3 P0, Vector3 P1, Vector3 P2, Vector3 P3, float t )
+    {
+        float t2 = t * t;
+        float t3 = t2 * t;
+        return 0.5f * ((2.0f * P1) + (P2 - P0) * t + (2.0f * P0 - 5.0f * P1 + 4.0f * P2 - P3) * t2 +
+            (3.0f * P1 - P0 - 3.0f * P2 + P3) * t3);
+    }
+
+    void EvaluateCameraPath( float Time, Vector3& Eye, Vector3& At )
+    {
+        const size_t NumKeys = s_CameraPath.size();
+        size_t Next = 0;
+        while (Next < NumKeys && s_CameraPath[Next].Time <= Time)
+            ++Next;
+
+        if (Next == 0 || Next == NumKeys)
+        {
+            const CameraKey& Key = s_CameraPath[Next == 0 ? 0 : NumKeys - 1];
+            Eye = Vector3(Key.Eye);
+            At = Vector3(Key.At);
+            return;
+        }
+
+        const CameraKey& K1 = s_CameraPath[Next - 1];
+        const CameraKey& K2 = s_CameraPath[Next];
+        const CameraKey& K0 = s_CameraPath[Next > 1 ? Next - 2 : Next - 1];
+        const CameraKey& K3 = s_CameraPath[Next + 1 < NumKeys ? Next + 1 : Next];
+        float t = (Time - K1.Time) / (K2.Time - K1.Time);
+
+        Eye = CatmullRom(Vector3(K0.Eye), Vector3(K1.Eye), Vector3(K2.Eye), Vector3(K3.Eye), t);
+        At = CatmullRom(Vector3(K0.At), Vector3(K1.At), Vector3(K2.At), Vector3(K3.At), t);
+    }
+
+    void WriteReport( void )
+    {
+        FILE* File = nullptr;
+        if (0 != _wfopen_s(&File, s_ReportFile.c_str(), L"w"))
+        {
+            Utility::Printf(L"Unable to write benchmark report %ws\n", s_ReportFile.c_str());
+            return;
+        }
+
+        fprintf(File, "Frame,Wall (ms),CPU (ms),GPU (ms)\n");
+        for (size_t i = 0; i < s_FrameRecords.size(); ++i)
+        {
+            const FrameRecord& R = s_FrameRecords[i];
+            fprintf(File, "%u,%.3f,%.3f,%.3f\n", (uint32_t)i, R.WallTime, R.CpuTime, R.GpuTime);
+        }
+        fclose(File);
+
+        // Scope-level percentiles collected over the measured frames
+        EngineProfiling::SaveStatistics(s_ReportFile + L".stats.csv");
+
+        Utility::Printf(L"Benchmark complete:  %u frames, P99 frame time %.3f ms, %u hitches.  Report written to %ws\n",
+            (uint32_t)s_FrameRecords.size(), EngineProfiling::GetFrameTimeQuantile(0.99f),
+            EngineProfiling::GetHitchCount(), s_ReportFile.c_str());
+    }
+
+    void WriteRecordedPath( void )
+    {
+        FILE* File = nullptr;
+        if (0 != _wfopen_s(&File, s_RecordFile.c_str(), L"w"))
+            return;
+
+        fprintf(File, "# time eyeX eyeY eyeZ atX atY atZ\n");
+        for (const CameraKey& Key : s_CameraPath)
+        {
+            fprintf(File, "%.4f %.4f %.4f %.4f %.4f %.4f %.4f\n", Key.Time,
+                Key.Eye.x, Key.Eye.y, Key.Eye.z, Key.At.x, Key.At.y, Key.At.z);
+        }
+        fclose(File);
+    }
+}
+
+void Benchmark::Initialize( void )
+{
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+    int NumArgs = 0;
+    wchar_t** Args = CommandLineToArgvW(GetCommandLineW(), &NumArgs);
+    if (Args == nullptr)
+        return;
+
+    wstring PathFile;
+    uint32_t RequestedFrames = 0;
+
+    for (int i = 1; i < NumArgs; ++i)
+    {
+        const wchar_t* Arg = Args[i];
+        const wchar_t* Value = i + 1 < NumArgs ? Args[i + 1] : nullptr;
+
+        if (_wcsicmp(Arg, L"-warp") == 0)
+            s_UseWarp = true;
+        else if (Value == nullptr)
+            continue;
+        else if (_wcsicmp(Arg, L"-benchmark") == 0)
+            PathFile = Args[++i];
+        else if (_wcsicmp(Arg, L"-frames") == 0)
+            RequestedFrames = (uint32_t)_wtoi(Args[++i]);
+        else if (_wcsicmp(Arg, L"-warmup") == 0)
+            s_WarmupFrames = (uint32_t)_wtoi(Args[++i]);
+        else if (_wcsicmp(Arg, L"-timestep") == 0)
+            s_Timestep = (float)_wtof(Args[++i]);
+        else if (_wcsicmp(Arg, L"-settings") == 0)
+            s_SettingsFile = Args[++i];
+        else if (_wcsicmp(Arg, L"-sweep") == 0)
+            s_SweepFile = Args[++i];
+        else if (_wcsicmp(Arg, L"-report") == 0)
+            s_ReportFile = Args[++i];
+        else if (_wcsicmp(Arg, L"-recordpath") == 0)
+            s_RecordFile = Args[++i];
+    }
+
+    LocalFree(Args);
+
+    if (PathFile.empty())
+        return;
+
+    if (!LoadCameraPath(PathFile))
+    {
+        Utility::Printf(L"Unable to load benchmark camera path %ws\n", PathFile.c_str());
+        return;
+    }
+
+    if (s_Timestep <= 0.0f)
+        s_Timestep = 1.0f / 60.0f;
+
+    s_MeasuredFrames = RequestedFrames > 0 ? RequestedFrames :
+        (uint32_t)ceil(s_CameraPath.back().Time / s_Timestep) + 1;
+
+    s_FrameRecords.reserve(s_MeasuredFrames);
+    s_RecordFile.clear();
+    s_IsActive = true;
+#endif
+}
+
+void Benchmark::ApplyTuningSettings( void )
+{
+    if (!s_SettingsFile.empty() && !EngineTuning::LoadSettings(s_SettingsFile))
+        Utility::Printf(L"Unable to load tuning settings from %ws\n", s_SettingsFile.c_str());
+
+    // The settings just loaded are the sweep's baseline
+    if (s_IsActive && !s_SweepFile.empty() && PerfSweep::Load(s_SweepFile))
+        PerfSweep::BeginConfiguration();
+}
+
+void Benchmark::Shutdown( void )
+{
+    if (s_IsActive)
+    {
+        WriteReport();
+        PerfSweep::WriteReport(s_ReportFile);
+    }
+    else if (!s_RecordFile.empty())
+        WriteRecordedPath();
+}
+
+bool Benchmark::IsActive( void )
+{
+    return s_IsActive;
+}
+
+bool Benchmark::IsComplete( void )
+{
+    return s_IsActive && s_FrameRecords.size() >= s_MeasuredFrames;
+}
+
+bool Benchmark::UseWarpDevice( void )
+{
+    return s_UseWarp;
+}
+
+float Benchmark::GetFixedTimestep( void )
+{
+    return s_Timestep;
+}
+
+void Benchmark::Update( void )
+{
+    if (!s_IsActive)
+        return;
+
+    int64_t CurrentTick = SystemTime::GetCurrentTick();
+
+    // Timings gathered this frame belong to the previous frame
+    if (s_FrameCounter > s_WarmupFrames)
+    {
+        FrameRecord Record;
+        Record.WallTime = (float)SystemTime::TimeBetweenTicks(s_LastFrameTick, CurrentTick) * 1000.0f;
+        EngineProfiling::GetLastFrameTimes(Record.CpuTime, Record.GpuTime);
+        s_FrameRecords.push_back(Record);
+    }
+    else if (s_FrameCounter == s_WarmupFrames)
+    {
+        // Discard PSO compilation and other first-frame costs
+        EngineProfiling::ResetStatistics();
+    }
+
+    s_LastFrameTick = CurrentTick;
+    ++s_FrameCounter;
+
+    // Each configuration of a sweep replays the whole path, warmup included, so that PSOs and buffers rebuilt
+    // for the new settings are not measured
+    if (s_FrameRecords.size() >= s_MeasuredFrames && PerfSweep::IsRunning())
+    {
+        PerfSweep::EndConfiguration();
+        if (PerfSweep::BeginConfiguration())
+        {
+            s_FrameRecords.clear();
+            s_FrameCounter = 0;
+        }
+    }
+}
+
+bool Benchmark::GetCameraPose( Vector3& Eye, Vector3& At )
+{
+    if (!s_IsActive)
+        return false;
+
+    uint32_t MeasuredFrame = s_FrameCounter > s_WarmupFrames ? s_FrameCounter - s_WarmupFrames - 1 : 0;
+    EvaluateCameraPath(MeasuredFrame * s_Timestep, Eye, At);
+    return true;
+}
+
+void Benchmark::RecordCameraPose( Vector3 Eye, Vector3 Forward, float DeltaTime )
+{
+    if (s_RecordFile.empty())
+        return;
+
+    s_RecordTime += DeltaTime;
+
+    // A key every 1/10th of a second is plenty for the spline to reproduce the motion
+    if (!s_CameraPath.empty() && s_RecordTime - s_CameraPath.back().Time < 0.1f)
+        return;
+
+    CameraKey Key;
+    Key.Time = s_RecordTime;
+    XMStoreFloat3(&Key.Eye, Eye);
+    XMStoreFloat3(&Key.At, Eye + Forward * 100.0f);
+    s_CameraPath.push_back(Key);
+}
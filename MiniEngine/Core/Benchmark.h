@@ -0,0 +1,62 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard 
+//
+// Reproducible performance runs.  A benchmark replays a recorded camera path with a fixed
+// time step, then writes per-frame timings and profiler statistics to a report.  It is
+// configured from the command line:
+//
+//   -benchmark <path file>   Replay the camera path instead of reading live input
+//   -frames <count>          Frames to run (default: enough to cover the whole path)
+//   -warmup <count>          Frames to run at the first key before measuring (default 30)
+//   -timestep <seconds>      Fixed simulation time step (default 1/60)
+//   -settings <file>         EngineTuning settings to load before the run
+//   -tune <path>=<value>     Override one EngineTuning variable; repeatable (see EngineTuning.h)
+//   -sweep <file>            Replay the path once per configuration of a parameter sweep (see PerfSweep.h)
+//   -report <file>           Per-frame CSV report (default BenchmarkReport.csv)
+//   -recordpath <file>       Record the live camera to a path file for later replay
+//   -warp                    Use the WARP software rasterizer so no GPU is required
+//
+// A camera path file is plain text with one key per line:  time eyeX eyeY eyeZ atX atY atZ
+//
+
+#pragma once
+
+#include "VectorMath.h"
+
+namespace Benchmark
+{
+    using namespace Math;
+
+    // Parses the command line.  Call before the graphics device is created.
+    void Initialize( void );
+
+    // Loads the -settings file and starts a -sweep.  Call after EngineTuning::Initialize() has registered all
+    // variables.
+    void ApplyTuningSettings( void );
+
+    // Writes the report (or recorded path) if one is pending
+    void Shutdown( void );
+
+    bool IsActive( void );
+    bool IsComplete( void );
+    bool UseWarpDevice( void );
+    float GetFixedTimestep( void );
+
+    // Call once per frame after profiling data has been gathered for the previous frame
+    void Update( void );
+
+    // Returns true and the scripted camera pose if a benchmark is driving the camera
+    bool GetCameraPose( Vector3& Eye, Vector3& At );
+
+    // Records the live camera when -recordpath was given.  Otherwise does nothing.
+    void RecordCameraPose( Vector3 Eye, Vector3 Forward, float DeltaTime );
+}
@@ -15,6 +15,7 @@
 #include "CameraController.h"
 #include "Camera.h"
 #include "GameInput.h"
+#include "Benchmark.h"
 
 using namespace Math;
 using namespace GameCore;
@@ -57,6 +58,15 @@ void CameraController::Update( float deltaTime )
 {
     (deltaTime);
 
+    // A running benchmark replaces live input with its scripted camera path
+    Vector3 scriptedEye, scriptedAt;
+    if (Benchmark::GetCameraPose(scriptedEye, scriptedAt))
+    {
+        m_TargetCamera.SetEyeAtUp(scriptedEye, scriptedAt, m_WorldUp);
+        m_TargetCamera.Update();
+        return;
+    }
+
     float timeScale = Graphics::DebugZoom == 0 ? 1.0f : Graphics::DebugZoom == 1 ? 0.5f : 0.25f;
 
     if (GameInput::IsFirstPressed(GameInput::kLThumbClick) || GameInput::IsFirstPressed(GameInput::kKey_lshift))
@@ -114,6 +124,8 @@ void CameraController::Update( float deltaTime )
     Vector3 position = orientation * Vector3( strafe, ascent, -forward ) + m_TargetCamera.GetPosition();
     m_TargetCamera.SetTransform( AffineTransform( orientation, position ) );
     m_TargetCamera.Update();
+
+    Benchmark::RecordCameraPose(m_TargetCamera.GetPosition(), m_TargetCamera.GetForwardVec(), deltaTime);
 }
 
 void CameraController::ApplyMomentum( float& oldValue, float& newValue, float deltaTime )
@@ -121,15 +121,26 @@ public:
     void CopyBuffer( GpuResource& Dest, GpuResource& Src );
     void CopyBufferRegion( GpuResource& Dest, size_t DestOffset, GpuResource& Src, size_t SrcOffset, size_t NumBytes );
     void CopySubresource(GpuResource& Dest, UINT DestSubIndex, GpuResource& Src, UINT SrcSubIndex);
+    // Copies a subresource out of a buffer whose texels are laid out at SrcFootprint
+    void CopyTextureRegion(GpuResource& Dest, UINT DestSubIndex, GpuResource& Src, const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& SrcFootprint);
     void CopyCounter(GpuResource& Dest, size_t DestOffset, StructuredBuffer& Src);
     void ResetCounter(StructuredBuffer& Buf, uint32_t Value = 0);
 
-    DynAlloc ReserveUploadMemory(size_t SizeInBytes)
+    DynAlloc ReserveUploadMemory(size_t SizeInBytes, size_t Alignment = DEFAULT_ALIGN)
     {
-        return m_CpuLinearAllocator.Allocate(SizeInBytes);
+        return m_CpuLinearAllocator.Allocate(SizeInBytes, Alignment);
     }
 
     static void InitializeTexture( GpuResource& Dest, UINT NumSubresources, D3D12_SUBRESOURCE_DATA SubData[] );
+
+    // Initializes the first NumSubresources subresources by letting the caller write texels straight into upload
+    // memory.  Fill is called once per subresource, in order, with its mapped destination and footprint.
+    static void InitializeTexture( GpuResource& Dest, UINT NumSubresources,
+        const std::function<void (UINT Subresource, const D3DX12_MAPPED_SUBRESOURCE& Dest)>& Fill );
+
+    // Initializes the first subresource by letting the caller write texels straight into upload memory.
+    // Fill receives the mapped destination and its row pitch.
+    static void InitializeTexture( GpuResource& Dest, const std::function<void (void* Texels, size_t RowPitch)>& Fill );
     static void InitializeBuffer( GpuResource& Dest, const void* Data, size_t NumBytes, size_t Offset = 0);
     static void InitializeTextureArraySlice(GpuResource& Dest, UINT SliceIndex, GpuResource& Src);
     static void ReadbackTexture2D(GpuResource& ReadbackBuffer, PixelBuffer& SrcBuffer);
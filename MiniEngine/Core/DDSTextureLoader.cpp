@@ -1184,6 +1184,9 @@ static HRESULT CreateTextureFromDDS( _In_ ID3D12Device* d3dDevice,
 
         if (SUCCEEDED(hr))
         {
+            // Skipped mips were never filled in
+            subresourceCount = static_cast<UINT>(mipCount - skipMip) * arraySize;
+
             GpuResource DestTexture(*texture, D3D12_RESOURCE_STATE_COPY_DEST);
             CommandContext::InitializeTexture(DestTexture, subresourceCount, initData.get());
         }
@@ -1345,3 +1348,192 @@ HRESULT CreateDDSTextureFromFile(
 
     return hr;
 }
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT GetDDSMipLayout(
+    const uint8_t* ddsData,
+    size_t ddsDataSize,
+    DDS_MIP_LAYOUT* layout )
+{
+    if (!ddsData || !layout)
+    {
+        return E_INVALIDARG;
+    }
+
+    memset( layout, 0, sizeof(DDS_MIP_LAYOUT) );
+
+    if (ddsDataSize < (sizeof(uint32_t) + sizeof(DDS_HEADER)))
+    {
+        return E_FAIL;
+    }
+
+    uint32_t dwMagicNumber = *( const uint32_t* )( ddsData );
+    if (dwMagicNumber != DDS_MAGIC)
+    {
+        return E_FAIL;
+    }
+
+    auto header = reinterpret_cast<const DDS_HEADER*>( ddsData + sizeof( uint32_t ) );
+
+    if (header->size != sizeof(DDS_HEADER) ||
+        header->ddspf.size != sizeof(DDS_PIXELFORMAT))
+    {
+        return E_FAIL;
+    }
+
+    size_t offset = sizeof(DDS_HEADER) + sizeof(uint32_t);
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+
+    if ((header->ddspf.flags & DDS_FOURCC) && (MAKEFOURCC( 'D', 'X', '1', '0' ) == header->ddspf.fourCC))
+    {
+        offset += sizeof(DDS_HEADER_DXT10);
+        if (ddsDataSize < offset)
+        {
+            return E_FAIL;
+        }
+
+        auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>( (const char*)header + sizeof(DDS_HEADER) );
+
+        if (d3d10ext->resourceDimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D ||
+            d3d10ext->arraySize != 1 ||
+            (d3d10ext->miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE))
+        {
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+        }
+
+        format = d3d10ext->dxgiFormat;
+    }
+    else
+    {
+        if ((header->flags & DDS_HEADER_FLAGS_VOLUME) || (header->caps2 & DDS_CUBEMAP))
+        {
+            return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+        }
+
+        format = GetDXGIFormat( header->ddspf );
+    }
+
+    if (BitsPerPixel( format ) == 0)
+    {
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+    }
+
+    size_t mipCount = header->mipMapCount;
+    if (0 == mipCount)
+    {
+        mipCount = 1;
+    }
+
+    if (mipCount > D3D12_REQ_MIP_LEVELS ||
+        header->width > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION ||
+        header->height > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION)
+    {
+        return HRESULT_FROM_WIN32( ERROR_NOT_SUPPORTED );
+    }
+
+    layout->width = header->width;
+    layout->height = header->height;
+    layout->mipCount = static_cast<uint32_t>( mipCount );
+    layout->format = format;
+    layout->headerSize = offset;
+
+    size_t w = header->width;
+    size_t h = header->height;
+    for (size_t i = 0; i < mipCount; ++i)
+    {
+        size_t NumBytes = 0;
+        GetSurfaceInfo( w, h, format, &NumBytes, nullptr, nullptr );
+
+        layout->mipOffset[i] = offset;
+        offset += NumBytes;
+
+        w = std::max<size_t>( w >> 1, 1 );
+        h = std::max<size_t>( h >> 1, 1 );
+    }
+
+    layout->fileSize = offset;
+
+    // A block-compressed texture must be a whole number of 4x4 blocks, so it can only be cut down to a mip
+    // whose size still is
+    layout->maxFirstMip = layout->mipCount - 1;
+    if ((format >= DXGI_FORMAT_BC1_TYPELESS && format <= DXGI_FORMAT_BC5_SNORM) ||
+        (format >= DXGI_FORMAT_BC6H_TYPELESS && format <= DXGI_FORMAT_BC7_UNORM_SRGB))
+    {
+        uint32_t mip = 0;
+        while (mip + 1 < layout->mipCount)
+        {
+            const uint32_t mipWidth = layout->width >> (mip + 1);
+            const uint32_t mipHeight = layout->height >> (mip + 1);
+            if (mipWidth == 0 || mipHeight == 0 || (mipWidth & 3) != 0 || (mipHeight & 3) != 0)
+            {
+                break;
+            }
+            ++mip;
+        }
+        layout->maxFirstMip = mip;
+    }
+
+    return S_OK;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT CreateDDSTextureFromMipRange(
+    ID3D12Device* d3dDevice,
+    const uint8_t* headerData,
+    size_t headerSize,
+    const uint8_t* mipData,
+    size_t mipDataSize,
+    uint32_t firstMip,
+    bool forceSRGB,
+    ID3D12Resource** texture,
+    D3D12_CPU_DESCRIPTOR_HANDLE textureView )
+{
+    if ( texture )
+    {
+        *texture = nullptr;
+    }
+
+    if (!d3dDevice || !mipData)
+    {
+        return E_INVALIDARG;
+    }
+
+    DDS_MIP_LAYOUT layout;
+    HRESULT hr = GetDDSMipLayout( headerData, headerSize, &layout );
+    if ( FAILED(hr) )
+    {
+        return hr;
+    }
+
+    if (firstMip > layout.maxFirstMip)
+    {
+        return E_INVALIDARG;
+    }
+
+    if (mipDataSize < layout.fileSize - layout.mipOffset[firstMip])
+    {
+        return HRESULT_FROM_WIN32( ERROR_HANDLE_EOF );
+    }
+
+    // Describe the reduced texture with a patched copy of the headers
+    uint32_t reducedHeaders[DDS_MAX_HEADER_SIZE / sizeof(uint32_t)];
+    memcpy( reducedHeaders, headerData, layout.headerSize );
+
+    auto header = reinterpret_cast<DDS_HEADER*>( reducedHeaders + 1 );
+    header->width = std::max( layout.width >> firstMip, 1u );
+    header->height = std::max( layout.height >> firstMip, 1u );
+    header->mipMapCount = layout.mipCount - firstMip;
+
+    hr = CreateTextureFromDDS( d3dDevice, header, mipData, mipDataSize, 0, forceSRGB, texture, textureView );
+
+    if ( SUCCEEDED(hr) && texture != nullptr && *texture != nullptr )
+    {
+        (*texture)->SetName(L"DDSTextureLoader");
+    }
+
+    return hr;
+}
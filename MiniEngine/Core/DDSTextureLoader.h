@@ -55,4 +55,40 @@ HRESULT __cdecl CreateDDSTextureFromFile( _In_ ID3D12Device* d3dDevice,
                                             _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
                                             );
 
+// Magic number, DDS_HEADER and DDS_HEADER_DXT10
+const size_t DDS_MAX_HEADER_SIZE = 148;
+
+// Where the mips of a single 2D surface live in a DDS file.  Mips are stored largest first, so any mip
+// and all smaller ones form one contiguous range ending at fileSize.
+struct DDS_MIP_LAYOUT
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t mipCount;
+    uint32_t maxFirstMip;   // Deepest mip a reduced texture can start at; block-compressed tops must be block-aligned
+    DXGI_FORMAT format;
+    size_t headerSize;
+    size_t mipOffset[D3D12_REQ_MIP_LEVELS];
+    size_t fileSize;
+};
+
+// Only the headers need to be present in ddsData.  Arrays, cube maps and volumes are not supported.
+HRESULT __cdecl GetDDSMipLayout( _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+                                 _In_ size_t ddsDataSize,
+                                 _Out_ DDS_MIP_LAYOUT* layout
+                               );
+
+// Creates a texture from mip firstMip down.  headerData holds the file's headers and mipData holds the
+// file from layout.mipOffset[firstMip] to the end.
+HRESULT __cdecl CreateDDSTextureFromMipRange( _In_ ID3D12Device* d3dDevice,
+                                              _In_reads_bytes_(headerSize) const uint8_t* headerData,
+                                              _In_ size_t headerSize,
+                                              _In_reads_bytes_(mipDataSize) const uint8_t* mipData,
+                                              _In_ size_t mipDataSize,
+                                              _In_ uint32_t firstMip,
+                                              _In_ bool forceSRGB,
+                                              _Outptr_opt_ ID3D12Resource** texture,
+                                              _In_ D3D12_CPU_DESCRIPTOR_HANDLE textureView
+                                            );
+
 size_t BitsPerPixel(_In_ DXGI_FORMAT fmt);
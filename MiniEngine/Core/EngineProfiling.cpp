@@ -22,6 +22,8 @@
 #include <vector>
 #include <unordered_map>
 #include <array>
+#include <atomic>
+#include <mutex>
 
 using namespace Graphics;
 using namespace GraphRenderer;
@@ -32,8 +34,194 @@ using namespace std;
 namespace EngineProfiling
 {
     bool Paused = false;
+
+    NumVar FrameBudget("Statistics/Frame Budget (ms)", 16.6f, 1.0f, 100.0f, 0.5f);
+    NumVar StatsDumpInterval("Statistics/Dump Interval (s)", 0.0f, 0.0f, 600.0f, 5.0f);
 }
 
+// Single-producer ring of timestamped events.  Only the owning thread writes; SaveTraceCapture()
+// may read concurrently and discards anything that was overwritten while it was copying.
+class TraceBuffer
+{
+public:
+    struct Event
+    {
+        int64_t Tick;
+        const wchar_t* Name;	// nullptr marks the end of the innermost open scope
+    };
+
+    static const uint32_t kCapacity = 1 << 16;
+
+    TraceBuffer( uint32_t ThreadId ) : m_Head(0), m_ThreadId(ThreadId) {}
+
+    void Record( const wchar_t* Name )
+    {
+        uint64_t Head = m_Head.load(memory_order_relaxed);
+        Event& E = m_Events[Head & (kCapacity - 1)];
+        E.Tick = SystemTime::GetCurrentTick();
+        E.Name = Name;
+        m_Head.store(Head + 1, memory_order_release);
+    }
+
+    // Copies events no older than OldestTick.  Returns false if nothing usable was found.
+    bool Snapshot( int64_t OldestTick, vector<Event>& Events ) const
+    {
+        uint64_t End = m_Head.load(memory_order_acquire);
+        uint64_t Begin = End > kCapacity ? End - kCapacity : 0;
+
+        Events.clear();
+        Events.reserve((size_t)(End - Begin));
+        for (uint64_t i = Begin; i < End; ++i)
+            Events.push_back(m_Events[i & (kCapacity - 1)]);
+
+        // The writer may have lapped us while copying.  Drop entries that could be torn.  The fence keeps the
+        // copies above from being reordered after the re-read of the head.  Once the ring is full, the oldest
+        // slot is also the one the writer fills next, so it is suspect even if the head hasn't moved.
+        atomic_thread_fence(memory_order_acquire);
+        uint64_t Overwritten = m_Head.load(memory_order_relaxed) - End;
+        if (End >= kCapacity)
+            ++Overwritten;
+        if (Overwritten >= Events.size())
+            return false;
+        Events.erase(Events.begin(), Events.begin() + (size_t)Overwritten);
+
+        auto FirstValid = Events.begin();
+        while (FirstValid != Events.end() && FirstValid->Tick < OldestTick)
+            ++FirstValid;
+        Events.erase(Events.begin(), FirstValid);
+
+        return !Events.empty();
+    }
+
+    uint32_t GetThreadId( void ) const { return m_ThreadId; }
+
+private:
+    Event m_Events[kCapacity];
+    atomic<uint64_t> m_Head;
+    uint32_t m_ThreadId;
+};
+
+namespace
+{
+    mutex s_TraceBufferMutex;
+    vector<TraceBuffer*> s_TraceBuffers;
+    thread_local TraceBuffer* t_TraceBuffer = nullptr;
+
+    // Whether each open scope was recorded, so that toggling the trace mid-scope can't unbalance it.
+    // Scopes nested deeper than the mask are never recorded.
+    thread_local uint32_t t_TraceDepth = 0;
+    thread_local uint64_t t_TracedScopes = 0;
+
+    TraceBuffer* GetThreadTraceBuffer( void )
+    {
+        // Buffers are registered once per thread and intentionally never freed so that events
+        // from exited threads remain available for capture.
+        if (t_TraceBuffer == nullptr)
+        {
+            t_TraceBuffer = new TraceBuffer(GetCurrentThreadId());
+            lock_guard<mutex> LockGuard(s_TraceBufferMutex);
+            s_TraceBuffers.push_back(t_TraceBuffer);
+        }
+        return t_TraceBuffer;
+    }
+
+    void WriteJsonString( FILE* File, const wchar_t* Str )
+    {
+        fputc('"', File);
+        for (; *Str != L'\0'; ++Str)
+        {
+            wchar_t Ch = *Str;
+            if (Ch == L'"' || Ch == L'\\')
+                fprintf(File, "\\%c", (char)Ch);
+            else if (Ch >= 0x20 && Ch < 0x80)
+                fputc((char)Ch, File);
+            else
+                fprintf(File, "\\u%04x", (uint32_t)Ch);
+        }
+        fputc('"', File);
+    }
+}
+
+// Log-bucketed histogram of timings in milliseconds (in the spirit of an HDR histogram).  Each
+// power of two is split into kSubBuckets linear buckets, bounding the relative error of any
+// reported quantile to 1 / kSubBuckets while keeping recording O(1) and allocation-free.
+class StatHistogram
+{
+public:
+    StatHistogram() { Reset(); }
+
+    void Reset( void )
+    {
+        for (uint32_t i = 0; i < kNumBuckets; ++i)
+            m_Buckets[i] = 0;
+        m_Count = 0;
+        m_Sum = 0.0;
+        m_Maximum = 0.0f;
+    }
+
+    void Record( float Milliseconds )
+    {
+        m_Buckets[BucketIndex(Milliseconds)]++;
+        m_Count++;
+        m_Sum += Milliseconds;
+        m_Maximum = max(m_Maximum, Milliseconds);
+    }
+
+    // Returns the upper bound of the bucket containing the requested quantile (0-1)
+    float GetQuantile( float Quantile ) const
+    {
+        if (m_Count == 0)
+            return 0.0f;
+
+        uint64_t Target = (uint64_t)ceil(Quantile * (double)m_Count);
+        if (Target == 0)
+            Target = 1;
+
+        uint64_t Cumulative = 0;
+        for (uint32_t i = 0; i < kNumBuckets; ++i)
+        {
+            Cumulative += m_Buckets[i];
+            if (Cumulative >= Target)
+                return min(BucketUpperBound(i), m_Maximum);
+        }
+        return m_Maximum;
+    }
+
+    uint64_t GetCount( void ) const { return m_Count; }
+    float GetMax( void ) const { return m_Maximum; }
+    float GetMean( void ) const { return m_Count == 0 ? 0.0f : (float)(m_Sum / (double)m_Count); }
+
+private:
+    static const uint32_t kSubBuckets = 16;
+    static const uint32_t kNumOctaves = 20;		// 1/64 ms up to ~16 seconds
+    static const uint32_t kNumBuckets = kSubBuckets * kNumOctaves;
+    static const float kMinValue;
+
+    static uint32_t BucketIndex( float Milliseconds )
+    {
+        if (Milliseconds < kMinValue)
+            return 0;
+        int Exponent;
+        float Mantissa = frexpf(Milliseconds / kMinValue, &Exponent);	// Mantissa in [0.5, 1)
+        uint32_t Index = (uint32_t)(Exponent - 1) * kSubBuckets + (uint32_t)((Mantissa * 2.0f - 1.0f) * kSubBuckets);
+        return min(Index, kNumBuckets - 1);
+    }
+
+    static float BucketUpperBound( uint32_t Index )
+    {
+        uint32_t Octave = Index / kSubBuckets;
+        uint32_t SubBucket = Index % kSubBuckets;
+        return ldexpf(kMinValue * (1.0f + (float)(SubBucket + 1) / kSubBuckets), (int)Octave);
+    }
+
+    uint32_t m_Buckets[kNumBuckets];
+    uint64_t m_Count;
+    double m_Sum;
+    float m_Maximum;
+};
+
+const float StatHistogram::kMinValue = 1.0f / 64.0f;
+
 class StatHistory
 {
 public:
@@ -54,6 +242,10 @@ public:
         m_ExtendedHistory[FrameIndex % kExtendedHistorySize] = Value;
         m_Recent = Value;
 
+        // Zero means the scope did not execute this frame
+        if (Value > 0.0f)
+            m_Histogram.Record(Value);
+
         uint32_t ValidCount = 0;
         m_Minimum = FLT_MAX;
         m_Maximum = 0.0f;
@@ -84,6 +276,10 @@ public:
     const float* GetHistory(void) const { return m_ExtendedHistory; }
     uint32_t GetHistoryLength(void) const { return kExtendedHistorySize; }
 
+    // Distribution of every sample since the last ResetHistogram()
+    const StatHistogram& GetHistogram(void) const { return m_Histogram; }
+    void ResetHistogram(void) { m_Histogram.Reset(); }
+
 private:
     static const uint32_t kHistorySize = 64;
     static const uint32_t kExtendedHistorySize = 256;
@@ -93,6 +289,7 @@ private:
     float m_Average;
     float m_Minimum;
     float m_Maximum;
+    StatHistogram m_Histogram;
 };
 
 class StatPlot
@@ -345,7 +542,8 @@ public:
 
         GpuTimeManager::BeginReadBack();
         sm_RootScope.GatherTimes(FrameIndex);
-        s_FrameDelta.RecordStat(FrameIndex, GpuTimeManager::GetTime(0));
+        const float FrameTime = GpuTimeManager::GetTime(0);
+        s_FrameDelta.RecordStat(FrameIndex, FrameTime);
         GpuTimeManager::EndReadBack();
 
         float TotalCpuTime, TotalGpuTime;
@@ -353,12 +551,54 @@ public:
         s_TotalCpuTime.RecordStat(FrameIndex, TotalCpuTime);
         s_TotalGpuTime.RecordStat(FrameIndex, TotalGpuTime);
 
+        const float FrameTimeMs = 1000.0f * FrameTime;
+        if (FrameTimeMs > 0.0f)
+        {
+            s_FrameTimeHistogram.Record(FrameTimeMs);
+            if (FrameTimeMs > EngineProfiling::FrameBudget)
+                ++s_HitchCount;
+        }
+
         GraphRenderer::Update(XMFLOAT2(TotalCpuTime, TotalGpuTime), 0, GraphType::Global);
     }
 
     static float GetTotalCpuTime(void) { return s_TotalCpuTime.GetAvg(); }
     static float GetTotalGpuTime(void) { return s_TotalGpuTime.GetAvg(); }
     static float GetFrameDelta(void) { return s_FrameDelta.GetAvg(); }
+    static float GetLastCpuTime(void) { return s_TotalCpuTime.GetLast(); }
+    static float GetLastGpuTime(void) { return s_TotalGpuTime.GetLast(); }
+    static const StatHistogram& GetFrameTimeHistogram(void) { return s_FrameTimeHistogram; }
+    static uint32_t GetHitchCount(void) { return s_HitchCount; }
+
+    static void ResetStatistics(void)
+    {
+        s_FrameTimeHistogram.Reset();
+        s_HitchCount = 0;
+        s_TotalCpuTime.ResetHistogram();
+        s_TotalGpuTime.ResetHistogram();
+        sm_RootScope.ResetHistograms();
+    }
+
+    // Writes one CSV row per timing scope, depth first, with the scope path as the first column
+    static void WriteStatistics( FILE* File )
+    {
+        const StatHistogram& Frame = s_FrameTimeHistogram;
+        fprintf(File, "Scope,Samples,CPU Mean,CPU P50,CPU P95,CPU P99,CPU Max,GPU Mean,GPU P50,GPU P95,GPU P99,GPU Max,Hitches\n");
+        fprintf(File, "Frame,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,,,,,,%u\n", Frame.GetCount(), Frame.GetMean(),
+            Frame.GetQuantile(0.5f), Frame.GetQuantile(0.95f), Frame.GetQuantile(0.99f), Frame.GetMax(), s_HitchCount);
+        WriteStatRow(File, "Total", s_TotalCpuTime.GetHistogram(), s_TotalGpuTime.GetHistogram());
+        for (auto node : sm_RootScope.m_Children)
+            node->WriteNodeStatistics(File, "");
+    }
+
+    static void GatherStatistics( vector<EngineProfiling::ScopeStatistics>& Stats )
+    {
+        EngineProfiling::ScopeStatistics Total = { "Total", s_TotalCpuTime.GetHistogram().GetMean(),
+            s_TotalGpuTime.GetHistogram().GetMean() };
+        Stats.push_back(Total);
+        for (auto node : sm_RootScope.m_Children)
+            node->GatherNodeStatistics(Stats, "");
+    }
 
     static void Display( TextContext& Text, float x )
     {
@@ -382,6 +622,38 @@ private:
 
     void DisplayNode( TextContext& Text, float x, float indent );
     void StoreToGraph(void);
+    void ResetHistograms( void )
+    {
+        m_CpuTime.ResetHistogram();
+        m_GpuTime.ResetHistogram();
+        for (auto node : m_Children)
+            node->ResetHistograms();
+    }
+
+    void WriteNodeStatistics( FILE* File, const string& ParentPath )
+    {
+        string Path = ParentPath + string(m_Name.begin(), m_Name.end());
+        WriteStatRow(File, Path.c_str(), m_CpuTime.GetHistogram(), m_GpuTime.GetHistogram());
+        for (auto node : m_Children)
+            node->WriteNodeStatistics(File, Path + "/");
+    }
+
+    void GatherNodeStatistics( vector<EngineProfiling::ScopeStatistics>& Stats, const string& ParentPath )
+    {
+        EngineProfiling::ScopeStatistics Scope = { ParentPath + string(m_Name.begin(), m_Name.end()),
+            m_CpuTime.GetHistogram().GetMean(), m_GpuTime.GetHistogram().GetMean() };
+        Stats.push_back(Scope);
+        for (auto node : m_Children)
+            node->GatherNodeStatistics(Stats, Scope.Path + "/");
+    }
+
+    static void WriteStatRow( FILE* File, const char* Name, const StatHistogram& Cpu, const StatHistogram& Gpu )
+    {
+        fprintf(File, "\"%s\",%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,\n", Name, Cpu.GetCount(),
+            Cpu.GetMean(), Cpu.GetQuantile(0.5f), Cpu.GetQuantile(0.95f), Cpu.GetQuantile(0.99f), Cpu.GetMax(),
+            Gpu.GetMean(), Gpu.GetQuantile(0.5f), Gpu.GetQuantile(0.95f), Gpu.GetQuantile(0.99f), Gpu.GetMax());
+    }
+
     void DeleteChildren( void )
     {
         for (auto node : m_Children)
@@ -404,6 +676,8 @@ private:
     static StatHistory s_TotalCpuTime;
     static StatHistory s_TotalGpuTime;
     static StatHistory s_FrameDelta;
+    static StatHistogram s_FrameTimeHistogram;
+    static uint32_t s_HitchCount;
     static NestedTimingTree sm_RootScope;
     static NestedTimingTree* sm_CurrentNode;
     static NestedTimingTree* sm_SelectedScope;
@@ -415,6 +689,8 @@ private:
 StatHistory NestedTimingTree::s_TotalCpuTime;
 StatHistory NestedTimingTree::s_TotalGpuTime;
 StatHistory NestedTimingTree::s_FrameDelta;
+StatHistogram NestedTimingTree::s_FrameTimeHistogram;
+uint32_t NestedTimingTree::s_HitchCount = 0;
 NestedTimingTree NestedTimingTree::sm_RootScope(L"");
 NestedTimingTree* NestedTimingTree::sm_CurrentNode = &NestedTimingTree::sm_RootScope;
 NestedTimingTree* NestedTimingTree::sm_SelectedScope = &NestedTimingTree::sm_RootScope;
@@ -425,7 +701,15 @@ namespace EngineProfiling
     BoolVar DrawProfiler("Display Profiler", false);
     //BoolVar DrawPerfGraph("Display Performance Graph", false);
     const bool DrawPerfGraph = false;
-    
+    BoolVar EnableEventTrace("Event Trace/Enable", true);
+    NumVar TraceCaptureSeconds("Event Trace/Capture Seconds", 5.0f, 1.0f, 60.0f, 1.0f);
+
+    void SaveDefaultTraceCapture( void* )
+    {
+        SaveTraceCapture(L"EngineTrace.json", TraceCaptureSeconds);
+    }
+    CallbackTrigger SaveTrace("Event Trace/Save Capture", SaveDefaultTraceCapture);
+
     void Update( void )
     {
         if (GameInput::IsFirstPressed( GameInput::kStartButton ) 
@@ -433,7 +717,153 @@ namespace EngineProfiling
         {
             Paused = !Paused;
         }
+        if (GameInput::IsFirstPressed( GameInput::kKey_f12 ))
+            SaveDefaultTraceCapture(nullptr);
+
         NestedTimingTree::UpdateTimes();
+
+        // Periodically rewrite the stats file so unattended runs always have current numbers
+        static int64_t s_LastDumpTick = SystemTime::GetCurrentTick();
+        if (StatsDumpInterval > 0.0f)
+        {
+            int64_t CurrentTick = SystemTime::GetCurrentTick();
+            if (SystemTime::TimeBetweenTicks(s_LastDumpTick, CurrentTick) >= StatsDumpInterval)
+            {
+                SaveStatistics(L"EngineStats.csv");
+                s_LastDumpTick = CurrentTick;
+            }
+        }
+    }
+
+    bool SaveStatistics(const wstring& FileName)
+    {
+        FILE* File = nullptr;
+        if (0 != _wfopen_s(&File, FileName.c_str(), L"wb"))
+            return false;
+
+        NestedTimingTree::WriteStatistics(File);
+        fclose(File);
+        return true;
+    }
+
+    void ResetStatistics(void)
+    {
+        NestedTimingTree::ResetStatistics();
+    }
+
+    float GetFrameTimeQuantile(float Quantile)
+    {
+        return NestedTimingTree::GetFrameTimeHistogram().GetQuantile(Quantile);
+    }
+
+    uint32_t GetHitchCount(void)
+    {
+        return NestedTimingTree::GetHitchCount();
+    }
+
+    void GetLastFrameTimes(float& CpuTime, float& GpuTime)
+    {
+        CpuTime = NestedTimingTree::GetLastCpuTime();
+        GpuTime = NestedTimingTree::GetLastGpuTime();
+    }
+
+    float GetFrameTimeMean(void)
+    {
+        return NestedTimingTree::GetFrameTimeHistogram().GetMean();
+    }
+
+    void GetScopeStatistics(vector<ScopeStatistics>& Stats)
+    {
+        Stats.clear();
+        NestedTimingTree::GatherStatistics(Stats);
+    }
+
+    void TraceBegin(const wchar_t* StaticName)
+    {
+        const uint64_t ScopeBit = t_TraceDepth < 64 ? 1ull << t_TraceDepth : 0;
+        ++t_TraceDepth;
+
+        if (EnableEventTrace && ScopeBit != 0)
+        {
+            t_TracedScopes |= ScopeBit;
+            GetThreadTraceBuffer()->Record(StaticName);
+        }
+        else
+        {
+            t_TracedScopes &= ~ScopeBit;
+        }
+    }
+
+    void TraceEnd(void)
+    {
+        if (t_TraceDepth == 0)
+            return;
+
+        --t_TraceDepth;
+        if (t_TraceDepth < 64 && (t_TracedScopes & (1ull << t_TraceDepth)) != 0)
+            t_TraceBuffer->Record(nullptr);
+    }
+
+    bool SaveTraceCapture(const wstring& FileName, float Seconds)
+    {
+        const int64_t Now = SystemTime::GetCurrentTick();
+        const int64_t Window = (int64_t)(Seconds / SystemTime::TicksToSeconds(1));
+        const int64_t OldestTick = Now - Window;
+
+        FILE* File = nullptr;
+        if (0 != _wfopen_s(&File, FileName.c_str(), L"wb"))
+            return false;
+
+        fprintf(File, "{\"traceEvents\":[\n");
+        bool FirstEvent = true;
+
+        vector<TraceBuffer*> Buffers;
+        {
+            lock_guard<mutex> LockGuard(s_TraceBufferMutex);
+            Buffers = s_TraceBuffers;
+        }
+
+        vector<TraceBuffer::Event> Events;
+        vector<const wchar_t*> OpenScopes;
+        for (TraceBuffer* Buffer : Buffers)
+        {
+            if (!Buffer->Snapshot(OldestTick, Events))
+                continue;
+
+            OpenScopes.clear();
+            for (const TraceBuffer::Event& E : Events)
+            {
+                // Ends whose begin fell out of the window have nothing to pair with
+                if (E.Name == nullptr && OpenScopes.empty())
+                    continue;
+
+                const double Microseconds = SystemTime::TimeBetweenTicks(OldestTick, E.Tick) * 1000000.0;
+                if (!FirstEvent)
+                    fputs(",\n", File);
+                FirstEvent = false;
+
+                if (E.Name != nullptr)
+                {
+                    OpenScopes.push_back(E.Name);
+                    fprintf(File, "{\"ph\":\"B\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"name\":",
+                        Buffer->GetThreadId(), Microseconds);
+                    WriteJsonString(File, E.Name);
+                    fputc('}', File);
+                }
+                else
+                {
+                    OpenScopes.pop_back();
+                    fprintf(File, "{\"ph\":\"E\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}",
+                        Buffer->GetThreadId(), Microseconds);
+                }
+            }
+        }
+
+        fprintf(File, "\n]}\n");
+        fclose(File);
+
+        Utility::Printf(L"Saved %.1f seconds of event trace to %ws\n", Seconds, FileName.c_str());
+        return true;
     }
 
     void BeginBlock(const wstring& name, CommandContext* Context)
@@ -502,10 +932,15 @@ void NestedTimingTree::PushProfilingMarker( const wstring& name, CommandContext*
 {
     sm_CurrentNode = sm_CurrentNode->GetChild(name);
     sm_CurrentNode->StartTiming(Context);
+
+    // Timing nodes are never freed, so their names can be referenced by the event trace
+    EngineProfiling::TraceBegin(sm_CurrentNode->m_Name.c_str());
 }
 
 void NestedTimingTree::PopProfilingMarker( CommandContext* Context )
 {
+    EngineProfiling::TraceEnd();
+
     sm_CurrentNode->StopTiming(Context);
     sm_CurrentNode = sm_CurrentNode->m_Parent;
 }
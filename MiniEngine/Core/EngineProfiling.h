@@ -14,6 +14,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "TextRenderer.h"
 
 class CommandContext;
@@ -29,14 +30,66 @@ namespace EngineProfiling
     void DisplayPerfGraph(GraphicsContext& Text);
     void Display(TextContext& Text, float x, float y, float w, float h);
     bool IsPaused();
+
+    // Tail latency statistics.  Every scope keeps a histogram of its CPU and GPU times, and frames
+    // slower than the "Statistics/Frame Budget" tuning value are counted as hitches.  These are
+    // accumulated until ResetStatistics() is called.
+    float GetFrameTimeQuantile(float Quantile);	// Quantile in [0, 1], result in milliseconds
+    uint32_t GetHitchCount();
+    void ResetStatistics();
+
+    // Writes mean, P50, P95, P99, and max for every scope to a CSV file.  This also happens
+    // automatically to EngineStats.csv when "Statistics/Dump Interval" is non-zero.
+    bool SaveStatistics(const std::wstring& FileName);
+
+    // Total CPU and GPU milliseconds of all top-level scopes in the most recently gathered frame
+    void GetLastFrameTimes(float& CpuTime, float& GpuTime);
+
+    // Mean milliseconds per frame since ResetStatistics().  The first entry is "Total", followed by every
+    // scope depth first, named by its path (e.g. "Render Shadows/Sun Shadow Map").
+    struct ScopeStatistics
+    {
+        std::string Path;
+        float CpuMean;
+        float GpuMean;
+    };
+    float GetFrameTimeMean();
+    void GetScopeStatistics(std::vector<ScopeStatistics>& Stats);
+
+    // Always-on event trace.  Each thread records begin/end events into its own lock-free ring
+    // buffer so that the last few seconds can be saved after a hitch has already happened.  The
+    // name is stored by pointer, so it must have static storage (e.g. a string literal).
+    void TraceBegin(const wchar_t* StaticName);
+    void TraceEnd(void);
+
+    // Writes the events recorded in the last 'Seconds' to a Chrome trace event (JSON) file,
+    // viewable in chrome://tracing or Perfetto.
+    bool SaveTraceCapture(const std::wstring& FileName, float Seconds);
 }
 
 #ifdef RELEASE
 class ScopedTimer
 {
 public:
-    ScopedTimer(const std::wstring&) {}
-    ScopedTimer(const std::wstring&, CommandContext&) {}
+    // String literals are still recorded in the event trace.  Other names are compiled out.
+    template <size_t N> ScopedTimer(const wchar_t (&name)[N]) : m_Traced(true)
+    {
+        EngineProfiling::TraceBegin(name);
+    }
+    template <size_t N> ScopedTimer(const wchar_t (&name)[N], CommandContext&) : m_Traced(true)
+    {
+        EngineProfiling::TraceBegin(name);
+    }
+    ScopedTimer(const std::wstring&) : m_Traced(false) {}
+    ScopedTimer(const std::wstring&, CommandContext&) : m_Traced(false) {}
+    ~ScopedTimer()
+    {
+        if (m_Traced)
+            EngineProfiling::TraceEnd();
+    }
+
+private:
+    bool m_Traced;
 };
 #else
 class ScopedTimer
@@ -19,6 +19,8 @@
 #include "GraphicsCore.h"
 #include "CommandContext.h"
 #include "GraphRenderer.h"
+#include <unordered_map>
+#include <algorithm>
 
 using namespace std;
 using namespace Math;
@@ -43,6 +45,25 @@ namespace EngineTuning
 
     EngineVar* sm_SelectedVariable = nullptr;
     bool sm_IsVisible = false;
+
+    // Every registered variable by full path, so that settings files and overrides need not walk the group tree
+    unordered_map<string, EngineVar*> s_VariableIndex;
+
+    // Path and value of each -tune argument
+    vector<pair<string, string>> s_CommandLineOverrides;
+
+    // The settings file to reapply when it changes on disk
+    BoolVar s_HotReloadSettings("Hot Reload Settings", true);
+    wstring s_WatchedSettingsFile;
+    uint64_t s_WatchedWriteTime = 0;
+    float s_TimeSinceWatchCheck = 0.0f;
+    const float kWatchInterval = 0.5f;
+
+    void ParseCommandLine( void );
+    void ApplyCommandLineOverrides( void );
+    void ApplyOverride( EngineVar& var, const pair<string, string>& Override );
+    void ApplySettingsFromFile( FILE* file );
+    uint64_t GetLastWriteTime( const wstring& FileName );
 }
 
 // Not open to the public.  Groups are auto-created when a tweaker's path includes the group name.
@@ -66,7 +87,6 @@ public:
     void Display( TextContext& Text, float leftMargin, EngineVar* highlightedTweak );
 
     void SaveToFile( FILE* file, int fileMargin );
-    void LoadSettingsFromFile( FILE* file );
 
     EngineVar* NextVariable( EngineVar* currentVariable );
     EngineVar* PrevVariable( EngineVar* currentVariable );
@@ -79,8 +99,6 @@ public:
     virtual void Decrement( void ) override { m_IsExpanded = false; }
     virtual void Bang( void ) override { m_IsExpanded = !m_IsExpanded; }
 
-    virtual void SetValue( FILE*, const std::string& ) override {}
-    
     static VariableGroup sm_RootGroup;
 
 private:
@@ -172,24 +190,6 @@ void VariableGroup::SaveToFile( FILE* file, int fileMargin )
     }
 }
 
-void VariableGroup::LoadSettingsFromFile( FILE* file )
-{
-    for (auto iter = m_Children.begin(); iter != m_Children.end(); ++iter)
-    {
-        VariableGroup* subGroup = dynamic_cast<VariableGroup*>(iter->second);
-        if (subGroup != nullptr)
-        {
-            char skippedLines[100];
-            fscanf_s(file, "%*s %[^\n]", skippedLines, (int)_countof(skippedLines));
-            subGroup->LoadSettingsFromFile(file);
-        }
-        else
-        {	
-            iter->second->SetValue(file, iter->first);
-        }
-    }
-}
-
 EngineVar* VariableGroup::FirstVariable( void )
 {
     return m_Children.size() == 0 ? nullptr : m_Children.begin()->second;
@@ -266,6 +266,12 @@ EngineVar::EngineVar( const std::string& path ) : m_GroupPtr(nullptr)
     EngineTuning::RegisterVariable(path, *this);
 }
 
+void EngineVar::NotifyChanged( void )
+{
+    for (auto& Callback : m_ChangeCallbacks)
+        Callback(*this);
+}
+
 
 EngineVar* EngineVar::NextVar( void )
 {
@@ -308,20 +314,24 @@ std::string BoolVar::ToString( void ) const
     return m_Flag ? "on" : "off";
 } 
 
-void BoolVar::SetValue(FILE* file, const std::string& setting)
-{	
-    std::string pattern = "\n " + setting + ": %s";
-    char valstr[6];
-
-    // Search through the file for an entry that matches this setting's name
-    fscanf_s(file, pattern.c_str(), valstr, _countof(valstr));
+bool BoolVar::FromString( const std::string& value )
+{
+    const char* valstr = value.c_str();
 
     // Look for one of the many affirmations
-    m_Flag = (
+    Set(
         0 == _stricmp(valstr, "1") ||
         0 == _stricmp(valstr, "on") ||
         0 == _stricmp(valstr, "yes") ||
         0 == _stricmp(valstr, "true") );
+
+    return true;
+}
+
+void BoolVar::GetSweepValues( std::vector<std::string>& Values ) const
+{
+    Values.push_back("off");
+    Values.push_back("on");
 }
 
 NumVar::NumVar( const std::string& path, float val, float minVal, float maxVal, float stepSize )
@@ -346,14 +356,31 @@ std::string NumVar::ToString( void ) const
     return buf;
 } 
 
-void NumVar::SetValue(FILE* file, const std::string& setting) 
+bool NumVar::FromString( const std::string& value )
 {
-    std::string scanString = "\n" + setting + ": %f";
-    float valueRead;
-    
-    //If we haven't read correctly, just keep m_Value at default value
-    if (fscanf_s(file, scanString.c_str(), &valueRead))
-        *this = valueRead; 
+    char* end;
+    float valueRead = strtof(value.c_str(), &end);
+
+    //If we haven't read correctly, just keep m_Value at its current value
+    if (end == value.c_str())
+        return false;
+
+    *this = valueRead;
+    return true;
+}
+
+// The full range is rarely meaningful (or safe), so sweep half and double the current value
+void NumVar::GetSweepValues( std::vector<std::string>& Values ) const
+{
+    const float Candidates[3] = { m_Value * 0.5f, m_Value, m_Value * 2.0f };
+    for (float Candidate : Candidates)
+    {
+        float Clamped = Candidate > m_MaxValue ? m_MaxValue : Candidate < m_MinValue ? m_MinValue : Candidate;
+        char buf[128];
+        sprintf_s(buf, "%f", Clamped);
+        if (Values.empty() || Values.back() != buf)
+            Values.push_back(buf);
+    }
 }
 
 #if _MSC_VER < 1800
@@ -368,7 +395,7 @@ ExpVar::ExpVar( const std::string& path, float val, float minExp, float maxExp,
 
 ExpVar& ExpVar::operator=( float val )
 {
-    m_Value = Clamp(log2(val));
+    Set(log2(val));
     return *this;
 }
 
@@ -389,14 +416,31 @@ std::string ExpVar::ToString( void ) const
     return buf;
 } 
 
-void ExpVar::SetValue(FILE* file, const std::string& setting) 
+bool ExpVar::FromString( const std::string& value )
 {
-    std::string scanString = "\n" + setting + ": %f";
-    float valueRead;
-    
-    //If we haven't read correctly, just keep m_Value at default value
-    if (fscanf_s(file, scanString.c_str(), &valueRead))
-        *this = valueRead;
+    char* end;
+    float valueRead = strtof(value.c_str(), &end);
+
+    //If we haven't read correctly, just keep m_Value at its current value
+    if (end == value.c_str())
+        return false;
+
+    *this = valueRead;
+    return true;
+}
+
+// Steps of the exponent, so half and double the value
+void ExpVar::GetSweepValues( std::vector<std::string>& Values ) const
+{
+    const float Candidates[3] = { m_Value - 1.0f, m_Value, m_Value + 1.0f };
+    for (float Candidate : Candidates)
+    {
+        float Clamped = Candidate > m_MaxValue ? m_MaxValue : Candidate < m_MinValue ? m_MinValue : Candidate;
+        char buf[128];
+        sprintf_s(buf, "%f", exp2(Clamped));
+        if (Values.empty() || Values.back() != buf)
+            Values.push_back(buf);
+    }
 }
 
 IntVar::IntVar( const std::string& path, int32_t val, int32_t minVal, int32_t maxVal, int32_t stepSize )
@@ -421,13 +465,38 @@ std::string IntVar::ToString( void ) const
     return buf;
 } 
 
-void IntVar::SetValue(FILE* file, const std::string& setting) 
+bool IntVar::FromString( const std::string& value )
 {
-    std::string scanString = "\n" + setting + ": %d";
-    int32_t valueRead;
-    
-    if (fscanf_s(file, scanString.c_str(), &valueRead))
-        *this = valueRead;
+    char* end;
+    int32_t valueRead = (int32_t)strtol(value.c_str(), &end, 10);
+
+    if (end == value.c_str())
+        return false;
+
+    *this = valueRead;
+    return true;
+}
+
+// Every step of a short range, otherwise half and double the current value
+void IntVar::GetSweepValues( std::vector<std::string>& Values ) const
+{
+    const int32_t kMaxSteps = 8;
+    const int32_t Step = m_StepSize > 0 ? m_StepSize : 1;
+    if (((int64_t)m_MaxValue - m_MinValue) / Step < kMaxSteps)
+    {
+        for (int64_t Value = m_MinValue; Value <= m_MaxValue; Value += Step)
+            Values.push_back(std::to_string(Value));
+        return;
+    }
+
+    const int64_t Candidates[3] = { m_Value / 2, m_Value, (int64_t)m_Value * 2 };
+    for (int64_t Candidate : Candidates)
+    {
+        int32_t Clamped = (int32_t)(Candidate > m_MaxValue ? m_MaxValue : Candidate < m_MinValue ? m_MinValue : Candidate);
+        std::string Value = std::to_string(Clamped);
+        if (Values.empty() || Values.back() != Value)
+            Values.push_back(Value);
+    }
 }
 
 
@@ -450,27 +519,24 @@ std::string EnumVar::ToString( void ) const
     return m_EnumLabels[m_Value];
 } 
 
-void EnumVar::SetValue(FILE* file, const std::string& setting) 
+bool EnumVar::FromString( const std::string& value )
 {
-    std::string scanString = "\n" + setting + ": %[^\n]";
-    char valueRead[14];
-        
-    if (fscanf_s(file, scanString.c_str(), valueRead, _countof(valueRead)) == 1)
+    //if we don't find the string, then leave m_EnumLabels[m_Value] as it is
+    for (int32_t i = 0; i < m_EnumLength; ++i)
     {
-        std::string valueReadStr = valueRead;
-        valueReadStr = valueReadStr.substr(0, valueReadStr.length() - 1);
-
-        //if we don't find the string, then leave m_EnumLabes[m_Value] as default
-        for(int32_t i = 0; i < m_EnumLength; ++i)
+        if (value == m_EnumLabels[i])
         {
-            if (m_EnumLabels[i] == valueReadStr)
-            {
-                m_Value = i;
-                break;
-            }
+            Set(i);
+            return true;
         }
     }
+    return false;
+}
 
+void EnumVar::GetSweepValues( std::vector<std::string>& Values ) const
+{
+    for (int32_t i = 0; i < m_EnumLength; ++i)
+        Values.push_back(m_EnumLabels[i]);
 }
 
 CallbackTrigger::CallbackTrigger( const std::string& path, std::function<void (void*)> callback, void* args )
@@ -490,19 +556,12 @@ void CallbackTrigger::DisplayValue( TextContext& Text ) const
         --m_BangDisplay;
 }
 
-void CallbackTrigger::SetValue(FILE* file, const std::string& setting) 
-{
-    //Skip over setting without reading anything
-    std::string scanString = "\n" + setting + ": %[^\n]";
-    char skippedLines[100];
-    fscanf_s(file, scanString.c_str(), skippedLines, _countof(skippedLines));
-}
-
 //=====================================================================================================================
 // EngineTuning namespace methods
 
 void EngineTuning::Initialize( void )
 {
+    ParseCommandLine();
 
     for (int32_t i = 0; i < s_UnregisteredCount; ++i)
     {
@@ -512,6 +571,11 @@ void EngineTuning::Initialize( void )
     }
     s_UnregisteredCount = -1;
 
+    for (auto& Override : s_CommandLineOverrides)
+    {
+        if (FindVariable(Override.first) == nullptr)
+            Utility::Printf("EngineTuning:  -tune \"%s\" does not name a registered variable\n", Override.first.c_str());
+    }
 }
 
 void HandleDigitalButtonPress( GameInput::DigitalInput button, float timeDelta, std::function<void ()> action )
@@ -540,6 +604,22 @@ void HandleDigitalButtonPress( GameInput::DigitalInput button, float timeDelta,
 
 void EngineTuning::Update( float frameTime )
 {
+    // Poll rather than block on a change notification.  Editors often replace the file rather than write it.
+    if (s_HotReloadSettings && !s_WatchedSettingsFile.empty())
+    {
+        s_TimeSinceWatchCheck += frameTime;
+        if (s_TimeSinceWatchCheck >= kWatchInterval)
+        {
+            s_TimeSinceWatchCheck = 0.0f;
+            uint64_t WriteTime = GetLastWriteTime(s_WatchedSettingsFile);
+            if (WriteTime != 0 && WriteTime != s_WatchedWriteTime)
+            {
+                Utility::Printf(L"Reloading tuning settings from %ws\n", s_WatchedSettingsFile.c_str());
+                LoadSettings(s_WatchedSettingsFile);
+            }
+        }
+    }
+
     if (GameInput::IsFirstPressed( GameInput::kBackButton )
         || GameInput::IsFirstPressed( GameInput::kKey_back ))
         sm_IsVisible = !sm_IsVisible;
@@ -579,21 +659,173 @@ void StartSave(void*)
     {
         VariableGroup::sm_RootGroup.SaveToFile(settingsFile, 2 );
         fclose(settingsFile);
+
+        // Don't reload what was just written
+        if (EngineTuning::s_WatchedSettingsFile == L"engineTuning.txt")
+            EngineTuning::s_WatchedWriteTime = EngineTuning::GetLastWriteTime(L"engineTuning.txt");
     }
 }
 std::function<void(void*)> StartSaveFunc = StartSave;
 static CallbackTrigger Save("Save Settings", StartSaveFunc, nullptr); 
 
-void StartLoad(void*)
+bool EngineTuning::LoadSettings( const std::wstring& FileName )
 {
-    FILE* settingsFile;
-    fopen_s(&settingsFile, "engineTuning.txt", "rb");
-    if (settingsFile != nullptr)
+    // Note the time before reading so that a write that lands while reading is picked up next time
+    uint64_t WriteTime = GetLastWriteTime(FileName);
+
+    FILE* settingsFile = nullptr;
+    _wfopen_s(&settingsFile, FileName.c_str(), L"rb");
+    if (settingsFile == nullptr)
+        return false;
+
+    ApplySettingsFromFile(settingsFile);
+    fclose(settingsFile);
+
+    ApplyCommandLineOverrides();
+
+    s_WatchedSettingsFile = FileName;
+    s_WatchedWriteTime = WriteTime;
+    s_TimeSinceWatchCheck = 0.0f;
+    return true;
+}
+
+// Reads both the nested layout written by SaveToFile() and flat "Full/Path/Name:  value" lines.  Each line is
+// matched by path, so settings for variables that no longer exist are skipped and new ones keep their defaults.
+void EngineTuning::ApplySettingsFromFile( FILE* file )
+{
+    struct GroupLine
     {
-        VariableGroup::sm_RootGroup.LoadSettingsFromFile(settingsFile);
-        fclose(settingsFile);
+        size_t Indent;
+        string Path;
+    };
+    vector<GroupLine> groupStack;
+
+    char line[512];
+    while (fgets(line, _countof(line), file) != nullptr)
+    {
+        string text = line;
+        size_t indent = text.find_first_not_of(' ');
+        size_t last = text.find_last_not_of(" \t\r\n");
+        if (indent == string::npos || last == string::npos || last < indent)
+            continue;
+        text = text.substr(indent, last - indent + 1);
+
+        // Deeper lines belong to the innermost group above them with less indentation
+        while (!groupStack.empty() && groupStack.back().Indent >= indent)
+            groupStack.pop_back();
+
+        const string prefix = groupStack.empty() ? "" : groupStack.back().Path + "/";
+
+        if (text.compare(0, 2, "+ ") == 0 && text.length() > 6 && text.compare(text.length() - 4, 4, " ...") == 0)
+        {
+            GroupLine group = { indent, prefix + text.substr(2, text.length() - 6) };
+            groupStack.push_back(group);
+            continue;
+        }
+
+        size_t colon = text.find(':');
+        if (colon == string::npos)
+            continue;
+
+        size_t valueStart = text.find_first_not_of(' ', colon + 1);
+        if (valueStart == string::npos)
+            continue;
+
+        SetVariable(prefix + text.substr(0, colon), text.substr(valueStart));
     }
 }
+
+uint64_t EngineTuning::GetLastWriteTime( const wstring& FileName )
+{
+    WIN32_FILE_ATTRIBUTE_DATA Attributes;
+    if (!GetFileAttributesExW(FileName.c_str(), GetFileExInfoStandard, &Attributes))
+        return 0;
+
+    return (uint64_t)Attributes.ftLastWriteTime.dwHighDateTime << 32 | Attributes.ftLastWriteTime.dwLowDateTime;
+}
+
+EngineVar* EngineTuning::FindVariable( const std::string& Path )
+{
+    auto iter = s_VariableIndex.find(Path);
+    return iter == s_VariableIndex.end() ? nullptr : iter->second;
+}
+
+bool EngineTuning::SetVariable( const std::string& Path, const std::string& Value )
+{
+    EngineVar* var = FindVariable(Path);
+    return var != nullptr && var->FromString(Value);
+}
+
+void EngineTuning::EnumerateVariables( const std::string& Prefix, const std::function<void (const std::string& Path, EngineVar& Var)>& Callback )
+{
+    vector<pair<string, EngineVar*>> Matches;
+    for (auto& Entry : s_VariableIndex)
+    {
+        if (Entry.first.compare(0, Prefix.length(), Prefix) == 0)
+            Matches.push_back(Entry);
+    }
+
+    sort(Matches.begin(), Matches.end());
+
+    for (auto& Match : Matches)
+        Callback(Match.first, *Match.second);
+}
+
+void EngineTuning::ParseCommandLine( void )
+{
+#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+    int NumArgs = 0;
+    wchar_t** Args = CommandLineToArgvW(GetCommandLineW(), &NumArgs);
+    if (Args == nullptr)
+        return;
+
+    for (int i = 1; i + 1 < NumArgs; ++i)
+    {
+        if (_wcsicmp(Args[i], L"-tune") != 0)
+            continue;
+
+        char Override[512];
+        if (0 == WideCharToMultiByte(CP_UTF8, 0, Args[++i], -1, Override, _countof(Override), nullptr, nullptr))
+            continue;
+
+        const string Setting = Override;
+        const size_t Equals = Setting.find('=');
+        if (Equals == string::npos || Equals == 0)
+        {
+            Utility::Printf("EngineTuning:  expected -tune \"Path/To/Variable=value\", got \"%s\"\n", Override);
+            continue;
+        }
+
+        s_CommandLineOverrides.push_back(make_pair(Setting.substr(0, Equals), Setting.substr(Equals + 1)));
+    }
+
+    LocalFree(Args);
+#endif
+}
+
+void EngineTuning::ApplyCommandLineOverrides( void )
+{
+    for (auto& Override : s_CommandLineOverrides)
+    {
+        EngineVar* var = FindVariable(Override.first);
+        if (var != nullptr)
+            ApplyOverride(*var, Override);
+    }
+}
+
+void EngineTuning::ApplyOverride( EngineVar& var, const pair<string, string>& Override )
+{
+    if (!var.FromString(Override.second))
+    {
+        Utility::Printf("EngineTuning:  \"%s\" is not a valid value for %s\n",
+            Override.second.c_str(), Override.first.c_str());
+    }
+}
+
+void StartLoad(void*)
+{
+    EngineTuning::LoadSettings(L"engineTuning.txt");
+}
 std::function<void(void*)> StartLoadFunc = StartLoad;
 static CallbackTrigger Load("Load Settings", StartLoadFunc, nullptr); 
 
@@ -612,6 +844,7 @@ void EngineTuning::Display( GraphicsContext& Context, float x, float y, float w,
     if (!sm_IsVisible)
     {
         EngineProfiling::Display(Text, x, y, w, h);
+        Text.End();
         return;
     }
 
@@ -621,6 +854,8 @@ void EngineTuning::Display( GraphicsContext& Context, float x, float y, float w,
     float hScale = g_DisplayWidth / 1920.0f;
     float vScale = g_DisplayHeight / 1080.0f;
 
+    // Text drawn so far is not clipped
+    Text.Flush();
     Context.SetScissor((uint32_t)Floor(x * hScale), (uint32_t)Floor(y * vScale), 
         (uint32_t)Ceiling((x + w) * hScale), (uint32_t)Ceiling((y + h) * vScale));
 
@@ -630,6 +865,7 @@ void EngineTuning::Display( GraphicsContext& Context, float x, float y, float w,
     Text.SetTextSize(20.0f);
 
     VariableGroup::sm_RootGroup.Display( Text, x, sm_SelectedVariable );
+    Text.Flush();
     
     EngineProfiling::DisplayPerfGraph(Context);
 
@@ -679,6 +915,14 @@ void EngineTuning::AddToVariableGraph( const string& path, EngineVar& var )
     }
 
     group->AddChild(leafName, var);
+
+    s_VariableIndex[path] = &var;
+
+    for (auto& Override : s_CommandLineOverrides)
+    {
+        if (Override.first == path)
+            ApplyOverride(var, Override);
+    }
 }
 
 void EngineTuning::RegisterVariable( const std::string& path, EngineVar& var )
@@ -18,6 +18,8 @@
 #include <float.h>
 #include <map>
 #include <set>
+#include <vector>
+#include <functional>
 
 class VariableGroup;
 class TextContext;
@@ -34,36 +36,49 @@ public:
 
     virtual void DisplayValue( TextContext& ) const {}
     virtual std::string ToString( void ) const { return ""; }
-    virtual void SetValue( FILE* file, const std::string& setting) = 0; //set value read from file
+    virtual bool FromString( const std::string& ) { return false; }  // Parses a value written by ToString()
+
+    // Representative values for automated sweeps, from lowest to highest setting.  Empty if not sweepable.
+    virtual void GetSweepValues( std::vector<std::string>& ) const {}
 
     EngineVar* NextVar( void );
     EngineVar* PrevVar( void );
 
+    // Callback runs whenever the value actually changes, whether from the menu, code, a settings file or the
+    // command line.  Use it to rebuild PSOs or resize buffers only when needed rather than polling every frame.
+    void AddChangeCallback( const std::function<void (EngineVar&)>& Callback ) { m_ChangeCallbacks.push_back(Callback); }
+
 protected:
     EngineVar( void );
     EngineVar( const std::string& path );
 
+    void NotifyChanged( void );
+
 private:
     friend class VariableGroup;
     VariableGroup* m_GroupPtr;
+    std::vector<std::function<void (EngineVar&)>> m_ChangeCallbacks;
 };
 
 class BoolVar : public EngineVar
 {
 public:
     BoolVar( const std::string& path, bool val );
-    BoolVar& operator=( bool val ) { m_Flag = val; return *this; }
+    BoolVar& operator=( bool val ) { Set(val); return *this; }
     operator bool() const { return m_Flag; }
 
-    virtual void Increment( void ) override { m_Flag = true; }
-    virtual void Decrement( void ) override { m_Flag = false; }
-    virtual void Bang( void ) override { m_Flag = !m_Flag; }
+    virtual void Increment( void ) override { Set(true); }
+    virtual void Decrement( void ) override { Set(false); }
+    virtual void Bang( void ) override { Set(!m_Flag); }
 
     virtual void DisplayValue( TextContext& Text ) const override;
     virtual std::string ToString( void ) const override;
-    virtual void SetValue( FILE* file, const std::string& setting) override;
+    virtual bool FromString( const std::string& value ) override;
+    virtual void GetSweepValues( std::vector<std::string>& Values ) const override;
 
 private:
+    void Set( bool val ) { if (val != m_Flag) { m_Flag = val; NotifyChanged(); } }
+
     bool m_Flag;
 };
 
@@ -71,18 +86,20 @@ class NumVar : public EngineVar
 {
 public:
     NumVar( const std::string& path, float val, float minValue = -FLT_MAX, float maxValue = FLT_MAX, float stepSize = 1.0f );
-    NumVar& operator=( float val ) { m_Value = Clamp(val); return *this; }
+    NumVar& operator=( float val ) { Set(val); return *this; }
     operator float() const { return m_Value; }
 
-    virtual void Increment( void ) override { m_Value = Clamp(m_Value + m_StepSize); }
-    virtual void Decrement( void ) override { m_Value = Clamp(m_Value - m_StepSize); }
+    virtual void Increment( void ) override { Set(m_Value + m_StepSize); }
+    virtual void Decrement( void ) override { Set(m_Value - m_StepSize); }
 
     virtual void DisplayValue( TextContext& Text ) const override;
     virtual std::string ToString( void ) const override;
-    virtual void SetValue( FILE* file, const std::string& setting)  override;
+    virtual bool FromString( const std::string& value ) override;
+    virtual void GetSweepValues( std::vector<std::string>& Values ) const override;
 
 protected:
     float Clamp( float val ) { return val > m_MaxValue ? m_MaxValue : val < m_MinValue ? m_MinValue : val; }
+    void Set( float val ) { val = Clamp(val); if (val != m_Value) { m_Value = val; NotifyChanged(); } }
 
     float m_Value;
     float m_MinValue;
@@ -99,7 +116,8 @@ public:
 
     virtual void DisplayValue( TextContext& Text ) const override;
     virtual std::string ToString( void ) const override;
-    virtual void SetValue( FILE* file, const std::string& setting ) override;
+    virtual bool FromString( const std::string& value ) override;
+    virtual void GetSweepValues( std::vector<std::string>& Values ) const override;
 
 };
 
@@ -107,18 +125,20 @@ class IntVar : public EngineVar
 {
 public:
     IntVar( const std::string& path, int32_t val, int32_t minValue = 0, int32_t maxValue = (1 << 24) - 1, int32_t stepSize = 1 );
-    IntVar& operator=( int32_t val ) { m_Value = Clamp(val); return *this; }
+    IntVar& operator=( int32_t val ) { Set(val); return *this; }
     operator int32_t() const { return m_Value; }
 
-    virtual void Increment( void ) override { m_Value = Clamp(m_Value + m_StepSize); }
-    virtual void Decrement( void ) override { m_Value = Clamp(m_Value - m_StepSize); }
+    virtual void Increment( void ) override { Set(m_Value + m_StepSize); }
+    virtual void Decrement( void ) override { Set(m_Value - m_StepSize); }
 
     virtual void DisplayValue( TextContext& Text ) const override;
     virtual std::string ToString( void ) const override;
-    virtual void SetValue( FILE* file, const std::string& setting ) override;
+    virtual bool FromString( const std::string& value ) override;
+    virtual void GetSweepValues( std::vector<std::string>& Values ) const override;
 
 protected:
     int32_t Clamp( int32_t val ) { return val > m_MaxValue ? m_MaxValue : val < m_MinValue ? m_MinValue : val; }
+    void Set( int32_t val ) { val = Clamp(val); if (val != m_Value) { m_Value = val; NotifyChanged(); } }
 
     int32_t m_Value;
     int32_t m_MinValue;
@@ -130,20 +150,22 @@ class EnumVar : public EngineVar
 {
 public:
     EnumVar( const std::string& path, int32_t initialVal, int32_t listLength, const char** listLabels );
-    EnumVar& operator=( int32_t val ) { m_Value = Clamp(val); return *this; }
+    EnumVar& operator=( int32_t val ) { Set(val); return *this; }
     operator int32_t() const { return m_Value; }
 
-    virtual void Increment( void ) override { m_Value = (m_Value + 1) % m_EnumLength; }
-    virtual void Decrement( void ) override { m_Value = (m_Value + m_EnumLength - 1) % m_EnumLength; }
+    virtual void Increment( void ) override { Set((m_Value + 1) % m_EnumLength); }
+    virtual void Decrement( void ) override { Set((m_Value + m_EnumLength - 1) % m_EnumLength); }
 
     virtual void DisplayValue( TextContext& Text ) const override;
     virtual std::string ToString( void ) const override;
-    virtual void SetValue( FILE* file, const std::string& setting ) override;
+    virtual bool FromString( const std::string& value ) override;
+    virtual void GetSweepValues( std::vector<std::string>& Values ) const override;
 
-    void SetListLength(int32_t listLength) { m_EnumLength = listLength; m_Value = Clamp(m_Value); }
+    void SetListLength(int32_t listLength) { m_EnumLength = listLength; Set(m_Value); }
 
 private:
     int32_t Clamp( int32_t val ) { return val < 0 ? 0 : val >= m_EnumLength ? m_EnumLength - 1 : val; }
+    void Set( int32_t val ) { val = Clamp(val); if (val != m_Value) { m_Value = val; NotifyChanged(); } }
 
     int32_t m_Value;
     int32_t m_EnumLength;
@@ -158,7 +180,6 @@ public:
     virtual void Bang( void ) override { m_Callback(m_Arguments); m_BangDisplay = 64; }
 
     virtual void DisplayValue( TextContext& Text ) const override;
-    virtual void SetValue( FILE* file, const std::string& setting ) override;
 
 private:
     std::function<void (void*)> m_Callback;
@@ -170,9 +191,25 @@ class GraphicsContext;
 
 namespace EngineTuning
 {
+    // Also reads command line overrides, for scripted perf sweeps:  -tune "Graphics/SSAO/Enable=off" (repeatable).
+    // Overrides are applied as their variables register and again after every settings file, so they always win.
     void Initialize( void );
     void Update( float frameTime );
     void Display( GraphicsContext& Context, float x, float y, float w, float h );
     bool IsFocused( void );
 
+    // Applies settings previously written by "Save Settings".  Returns false if the file could not be opened.
+    // While "Hot Reload Settings" is on, the most recently loaded file is watched and reapplied when it changes.
+    bool LoadSettings( const std::wstring& FileName );
+
+    // Variables are indexed by their full path, e.g. "Graphics/SSAO/Enable".  Returns null if there is no such
+    // variable (yet).
+    EngineVar* FindVariable( const std::string& Path );
+
+    // Parses Value into the variable at Path.  Returns false if there is no such variable or Value is malformed.
+    bool SetVariable( const std::string& Path, const std::string& Value );
+
+    // Calls Callback for every registered variable whose path starts with Prefix, in path order
+    void EnumerateVariables( const std::string& Prefix, const std::function<void (const std::string& Path, EngineVar& Var)>& Callback );
+
 } // namespace EngineTuning
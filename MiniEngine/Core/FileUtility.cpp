@@ -137,3 +137,23 @@ task<ByteArray> Utility::ReadFileAsync(const wstring& fileName)
     shared_ptr<wstring> SharedPtr = make_shared<wstring>(fileName);
     return create_task( [=] { return ReadFileHelperEx(SharedPtr); } );
 }
+
+ByteArray Utility::ReadFileRangeSync( const wstring& fileName, size_t Offset, size_t Size )
+{
+    struct _stat64 fileStat;
+    int fileExists = _wstat64(fileName.c_str(), &fileStat);
+    if (fileExists == -1 || Offset >= (size_t)fileStat.st_size)
+        return NullFile;
+
+    ifstream file( fileName, ios::in | ios::binary );
+    if (!file)
+        return NullFile;
+
+    Size = min(Size, (size_t)fileStat.st_size - Offset);
+
+    Utility::ByteArray byteArray = make_shared<vector<byte> >( Size );
+    file.seekg(Offset, ios::beg).read( (char*)byteArray->data(), byteArray->size() );
+    file.close();
+
+    return byteArray;
+}
@@ -34,4 +34,8 @@ namespace Utility
     // Same as previous except that it does not block but instead returns a task.
     task<ByteArray> ReadFileAsync(const wstring& fileName);
 
+    // Reads up to Size bytes starting at Offset.  The result is shorter if the file ends first.  Compressed
+    // files cannot be read this way, so this returns NullFile when only a ".gz" version exists.
+    ByteArray ReadFileRangeSync(const wstring& fileName, size_t Offset, size_t Size);
+
 } // namespace Utility
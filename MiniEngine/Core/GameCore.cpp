@@ -19,6 +19,8 @@
 #include "BufferManager.h"
 #include "CommandContext.h"
 #include "PostEffects.h"
+#include "Benchmark.h"
+#include "TextureManager.h"
 
 #if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
     #pragma comment(lib, "runtimeobject.lib")
@@ -49,12 +51,15 @@ namespace GameCore
         SystemTime::Initialize();
         GameInput::Initialize();
         EngineTuning::Initialize();
+        Benchmark::ApplyTuningSettings();
 
         game.Startup();
     }
 
     void TerminateApplication( IGameApp& game )
     {
+        Benchmark::Shutdown();
+
         game.Cleanup();
 
         GameInput::Shutdown();
@@ -63,6 +68,8 @@ namespace GameCore
     bool UpdateApplication( IGameApp& game )
     {
         EngineProfiling::Update();
+        Benchmark::Update();
+        TextureManager::Update();
 
         float DeltaTime = Graphics::GetFrameTime();
     
@@ -103,7 +110,7 @@ namespace GameCore
 
         Graphics::Present();
 
-        return !game.IsDone();
+        return !game.IsDone() && !Benchmark::IsComplete();
     }
 
     // Default implementation to be overridden by the application
@@ -329,6 +336,9 @@ namespace GameCore
         wcex.hIconSm = LoadIcon(hInst, IDI_APPLICATION);
         ASSERT(0 != RegisterClassEx(&wcex), "Unable to register a window");
 
+        // Must come before device creation since it may request the WARP device
+        Benchmark::Initialize();
+
         // Create window
         RECT rc = { 0, 0, (LONG)g_DisplayWidth, (LONG)g_DisplayHeight };
         AdjustWindowRect(&rc, WS_OVERLAPPEDWINDOW, FALSE);
@@ -340,7 +350,9 @@ namespace GameCore
 
         InitializeApplication(app);
 
-        ShowWindow( g_hWnd, SW_SHOWDEFAULT );
+        // Benchmark runs are headless.  The swap chain still presents to the hidden window.
+        if (!Benchmark::IsActive())
+            ShowWindow( g_hWnd, SW_SHOWDEFAULT );
 
         do
         {
@@ -30,6 +30,8 @@
 #include "ParticleEffectManager.h"
 #include "GraphRenderer.h"
 #include "TemporalEffects.h"
+#include "Benchmark.h"
+#include "TextureManager.h"
 
 // This macro determines whether to detect if there is an HDR display and enable HDR10 output.
 // Currently, with HDR display enabled, the pixel magnfication functionality is broken.
@@ -315,7 +317,7 @@ void Graphics::Initialize(void)
     // Create the D3D graphics device
     Microsoft::WRL::ComPtr<IDXGIAdapter1> pAdapter;
 
-    static const bool bUseWarpDriver = false;
+    const bool bUseWarpDriver = Benchmark::UseWarpDevice();
 
     if (!bUseWarpDriver)
     {
@@ -588,6 +590,7 @@ void Graphics::Initialize(void)
 
 void Graphics::Terminate( void )
 {
+    TextureManager::StopStreaming();
     g_CommandManager.IdleGPU();
 #if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
     s_SwapChain1->SetFullscreenState(FALSE, nullptr);
@@ -779,7 +782,7 @@ void Graphics::Present(void)
 
     g_CurrentBuffer = (g_CurrentBuffer + 1) % SWAP_CHAIN_BUFFER_COUNT;
 
-    UINT PresentInterval = s_EnableVSync ? std::min(4, (int)Round(s_FrameTime * 60.0f)) : 0;
+    UINT PresentInterval = s_EnableVSync && !Benchmark::IsActive() ? std::min(4, (int)Round(s_FrameTime * 60.0f)) : 0;
 
     s_SwapChain1->Present(PresentInterval, 0);
 
@@ -792,7 +795,12 @@ void Graphics::Present(void)
 
     int64_t CurrentTick = SystemTime::GetCurrentTick();
 
-    if (s_EnableVSync)
+    if (Benchmark::IsActive())
+    {
+        // Benchmarks simulate with a fixed time step so that every run is identical
+        s_FrameTime = Benchmark::GetFixedTimestep();
+    }
+    else if (s_EnableVSync)
     {
         // With VSync enabled, the time step between frames becomes a multiple of 16.666 ms.  We need
         // to add logic to vary between 1 and 2 (or 3 fields).  This delta time also determines how
@@ -0,0 +1,447 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard 
+//
+
+#include "pch.h"
+#include "Hash.h"
+#include "SystemTime.h"
+#include <intrin.h>
+#include <algorithm>
+#include <random>
+
+using namespace Utility;
+
+namespace
+{
+    // All reads go through memcpy so that unaligned ranges are legal.  The compiler turns
+    // these into plain (unaligned) loads.
+    inline uint64_t Read64( const uint8_t* p ) { uint64_t v; memcpy(&v, p, 8); return v; }
+    inline uint32_t Read32( const uint8_t* p ) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+    inline uint64_t RotL64( uint64_t x, int r ) { return (x << r) | (x >> (64 - r)); }
+
+    const uint64_t kPrime64_1 = 0x9E3779B185EBCA87ull;
+    const uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4Full;
+    const uint64_t kPrime64_3 = 0x165667B19E3779F9ull;
+    const uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ull;
+    const uint64_t kPrime64_5 = 0x27D4EB2F165667C5ull;
+
+    inline uint64_t XXRound( uint64_t Acc, uint64_t Input )
+    {
+        Acc += Input * kPrime64_2;
+        Acc = RotL64(Acc, 31);
+        return Acc * kPrime64_1;
+    }
+
+    inline uint64_t XXMergeRound( uint64_t Acc, uint64_t Val )
+    {
+        Acc ^= XXRound(0, Val);
+        return Acc * kPrime64_1 + kPrime64_4;
+    }
+
+    inline uint64_t XXAvalanche( uint64_t h )
+    {
+        h ^= h >> 33;
+        h *= kPrime64_2;
+        h ^= h >> 29;
+        h *= kPrime64_3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    // Consumes the sub-32-byte tail and finalizes.  Shared by the one-shot and streaming paths.
+    uint64_t XXFinalize( uint64_t h, const uint8_t* p, size_t Size )
+    {
+        while (Size >= 8)
+        {
+            h ^= XXRound(0, Read64(p));
+            h = RotL64(h, 27) * kPrime64_1 + kPrime64_4;
+            p += 8;
+            Size -= 8;
+        }
+        if (Size >= 4)
+        {
+            h ^= (uint64_t)Read32(p) * kPrime64_1;
+            h = RotL64(h, 23) * kPrime64_2 + kPrime64_3;
+            p += 4;
+            Size -= 4;
+        }
+        while (Size > 0)
+        {
+            h ^= (*p++) * kPrime64_5;
+            h = RotL64(h, 11) * kPrime64_1;
+            --Size;
+        }
+        return XXAvalanche(h);
+    }
+
+    uint64_t XXMergeAccumulators( const uint64_t Acc[4] )
+    {
+        uint64_t h = RotL64(Acc[0], 1) + RotL64(Acc[1], 7) + RotL64(Acc[2], 12) + RotL64(Acc[3], 18);
+        h = XXMergeRound(h, Acc[0]);
+        h = XXMergeRound(h, Acc[1]);
+        h = XXMergeRound(h, Acc[2]);
+        h = XXMergeRound(h, Acc[3]);
+        return h;
+    }
+
+    inline uint64_t Fmix64( uint64_t k )
+    {
+        k ^= k >> 33;
+        k *= 0xFF51AFD7ED558CCDull;
+        k ^= k >> 33;
+        k *= 0xC4CEB9FE1A85EC53ull;
+        k ^= k >> 33;
+        return k;
+    }
+
+    // Lazily built lookup table for the software CRC32C path (reflected polynomial 0x82F63B78)
+    struct CRC32CTable
+    {
+        uint32_t Entries[256];
+
+        CRC32CTable()
+        {
+            for (uint32_t i = 0; i < 256; ++i)
+            {
+                uint32_t Crc = i;
+                for (int j = 0; j < 8; ++j)
+                    Crc = (Crc >> 1) ^ (0x82F63B78u & (0u - (Crc & 1u)));
+                Entries[i] = Crc;
+            }
+        }
+    };
+
+    bool QueryHardwareCRC32( void )
+    {
+#if defined(_M_X64) || defined(_M_IX86)
+        int CpuInfo[4];
+        __cpuid(CpuInfo, 1);
+        return (CpuInfo[2] & (1 << 20)) != 0;    // ECX.SSE42
+#else
+        return false;
+#endif
+    }
+}
+
+bool Utility::HasHardwareCRC32( void )
+{
+    static const bool s_HasCRC32 = QueryHardwareCRC32();
+    return s_HasCRC32;
+}
+
+uint32_t Utility::HashBytesCRC32C( const void* Data, size_t Size, uint32_t Crc )
+{
+    const uint8_t* p = (const uint8_t*)Data;
+    Crc = ~Crc;
+
+#if ENABLE_SSE_CRC32
+    if (HasHardwareCRC32())
+    {
+        uint64_t Crc64 = Crc;
+        for (; Size >= 8; Size -= 8, p += 8)
+            Crc64 = _mm_crc32_u64(Crc64, Read64(p));
+        Crc = (uint32_t)Crc64;
+        for (; Size > 0; --Size)
+            Crc = _mm_crc32_u8(Crc, *p++);
+        return ~Crc;
+    }
+#endif
+
+    static const CRC32CTable s_Table;
+    for (; Size > 0; --Size)
+        Crc = s_Table.Entries[(Crc ^ *p++) & 0xFF] ^ (Crc >> 8);
+    return ~Crc;
+}
+
+uint64_t Utility::HashBytes64( const void* Data, size_t Size, uint64_t Seed )
+{
+    const uint8_t* p = (const uint8_t*)Data;
+    const uint8_t* const End = p + Size;
+    uint64_t h;
+
+    if (Size >= 32)
+    {
+        uint64_t Acc[4] =
+        {
+            Seed + kPrime64_1 + kPrime64_2,
+            Seed + kPrime64_2,
+            Seed,
+            Seed - kPrime64_1
+        };
+
+        const uint8_t* const Limit = End - 32;
+        do
+        {
+            Acc[0] = XXRound(Acc[0], Read64(p +  0));
+            Acc[1] = XXRound(Acc[1], Read64(p +  8));
+            Acc[2] = XXRound(Acc[2], Read64(p + 16));
+            Acc[3] = XXRound(Acc[3], Read64(p + 24));
+            p += 32;
+        }
+        while (p <= Limit);
+
+        h = XXMergeAccumulators(Acc);
+    }
+    else
+    {
+        h = Seed + kPrime64_5;
+    }
+
+    h += (uint64_t)Size;
+    return XXFinalize(h, p, (size_t)(End - p));
+}
+
+Hash128 Utility::HashBytes128( const void* Data, size_t Size, uint64_t Seed )
+{
+    const uint8_t* p = (const uint8_t*)Data;
+    const size_t NumBlocks = Size / 16;
+
+    const uint64_t c1 = 0x87C37B91114253D5ull;
+    const uint64_t c2 = 0x4CF5AD432745937Full;
+
+    uint64_t h1 = Seed;
+    uint64_t h2 = Seed;
+
+    for (size_t i = 0; i < NumBlocks; ++i, p += 16)
+    {
+        uint64_t k1 = Read64(p);
+        uint64_t k2 = Read64(p + 8);
+
+        k1 *= c1; k1 = RotL64(k1, 31); k1 *= c2; h1 ^= k1;
+        h1 = RotL64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52DCE729;
+
+        k2 *= c2; k2 = RotL64(k2, 33); k2 *= c1; h2 ^= k2;
+        h2 = RotL64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495AB5;
+    }
+
+    // Tail bytes, little-endian packed into two lanes
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    const size_t Tail = Size & 15;
+    for (size_t i = Tail; i > 8; --i)
+        k2 |= (uint64_t)p[i - 1] << ((i - 9) * 8);
+    for (size_t i = Tail < 8 ? Tail : 8; i > 0; --i)
+        k1 |= (uint64_t)p[i - 1] << ((i - 1) * 8);
+
+    if (Tail > 8)
+    {
+        k2 *= c2; k2 = RotL64(k2, 33); k2 *= c1; h2 ^= k2;
+    }
+    if (Tail > 0)
+    {
+        k1 *= c1; k1 = RotL64(k1, 31); k1 *= c2; h1 ^= k1;
+    }
+
+    h1 ^= (uint64_t)Size;
+    h2 ^= (uint64_t)Size;
+
+    h1 += h2;
+    h2 += h1;
+
+    h1 = Fmix64(h1);
+    h2 = Fmix64(h2);
+
+    h1 += h2;
+    h2 += h1;
+
+    Hash128 Result = { h1, h2 };
+    return Result;
+}
+
+void HashStream64::Reset( uint64_t Seed )
+{
+    m_Seed = Seed;
+    m_Acc[0] = Seed + kPrime64_1 + kPrime64_2;
+    m_Acc[1] = Seed + kPrime64_2;
+    m_Acc[2] = Seed;
+    m_Acc[3] = Seed - kPrime64_1;
+    m_TotalSize = 0;
+    m_BufferSize = 0;
+}
+
+void HashStream64::Update( const void* Data, size_t Size )
+{
+    const uint8_t* p = (const uint8_t*)Data;
+    const uint8_t* const End = p + Size;
+    m_TotalSize += Size;
+
+    // Not enough to complete a stripe; just buffer it
+    if (m_BufferSize + Size < 32)
+    {
+        memcpy(m_Buffer + m_BufferSize, p, Size);
+        m_BufferSize += (uint32_t)Size;
+        return;
+    }
+
+    // Complete and consume the partially filled stripe
+    if (m_BufferSize > 0)
+    {
+        const size_t Fill = 32 - m_BufferSize;
+        memcpy(m_Buffer + m_BufferSize, p, Fill);
+        p += Fill;
+        m_Acc[0] = XXRound(m_Acc[0], Read64(m_Buffer +  0));
+        m_Acc[1] = XXRound(m_Acc[1], Read64(m_Buffer +  8));
+        m_Acc[2] = XXRound(m_Acc[2], Read64(m_Buffer + 16));
+        m_Acc[3] = XXRound(m_Acc[3], Read64(m_Buffer + 24));
+        m_BufferSize = 0;
+    }
+
+    for (; p + 32 <= End; p += 32)
+    {
+        m_Acc[0] = XXRound(m_Acc[0], Read64(p +  0));
+        m_Acc[1] = XXRound(m_Acc[1], Read64(p +  8));
+        m_Acc[2] = XXRound(m_Acc[2], Read64(p + 16));
+        m_Acc[3] = XXRound(m_Acc[3], Read64(p + 24));
+    }
+
+    if (p < End)
+    {
+        m_BufferSize = (uint32_t)(End - p);
+        memcpy(m_Buffer, p, m_BufferSize);
+    }
+}
+
+uint64_t HashStream64::Digest( void ) const
+{
+    uint64_t h = m_TotalSize >= 32 ? XXMergeAccumulators(m_Acc) : m_Seed + kPrime64_5;
+    h += m_TotalSize;
+    return XXFinalize(h, m_Buffer, m_BufferSize);
+}
+
+namespace
+{
+    // 64-byte keys, about the size of a small state description
+    struct BenchmarkKey
+    {
+        uint32_t Words[16];
+    };
+
+    // Keys resembling state descriptions: mostly zero, differing only in a few small fields
+    void MakeSparseKeys( std::vector<BenchmarkKey>& Keys )
+    {
+        for (size_t i = 0; i < Keys.size(); ++i)
+        {
+            memset(&Keys[i], 0, sizeof(BenchmarkKey));
+            Keys[i].Words[0] = (uint32_t)(i & 0xFF);
+            Keys[i].Words[7] = (uint32_t)(i >> 8 & 0xFF);
+            Keys[i].Words[13] = (uint32_t)(i >> 16);
+            Keys[i].Words[15] = 1;
+        }
+    }
+
+    void MakeRandomKeys( std::vector<BenchmarkKey>& Keys )
+    {
+        std::mt19937 Generator((uint32_t)Keys.size());
+        for (BenchmarkKey& Key : Keys)
+        {
+            for (uint32_t& Word : Key.Words)
+                Word = Generator();
+        }
+    }
+
+    // The number of keys whose hash matches that of another key
+    template <typename T>
+    uint32_t CountCollisions( std::vector<T>& Hashes )
+    {
+        std::sort(Hashes.begin(), Hashes.end());
+        return (uint32_t)(Hashes.end() - std::unique(Hashes.begin(), Hashes.end()));
+    }
+
+    void BenchmarkCollisions( const char* KeySetName, const std::vector<BenchmarkKey>& Keys )
+    {
+        std::vector<size_t> RangeHashes(Keys.size());
+        std::vector<uint32_t> CRC32CHashes(Keys.size());
+        std::vector<uint64_t> Hashes64(Keys.size());
+        std::vector<std::pair<uint64_t, uint64_t>> Hashes128(Keys.size());
+
+        for (size_t i = 0; i < Keys.size(); ++i)
+        {
+            RangeHashes[i] = HashState(&Keys[i]);
+            CRC32CHashes[i] = HashBytesCRC32C(&Keys[i], sizeof(BenchmarkKey));
+            Hashes64[i] = HashBytes64(&Keys[i], sizeof(BenchmarkKey));
+            const Hash128 Hash = HashBytes128(&Keys[i], sizeof(BenchmarkKey));
+            Hashes128[i] = std::make_pair(Hash.High, Hash.Low);
+        }
+
+        Utility::Printf("  %-7s %8u HashRange  %8u CRC32C  %8u HashBytes64  %8u HashBytes128\n", KeySetName,
+            CountCollisions(RangeHashes), CountCollisions(CRC32CHashes), CountCollisions(Hashes64), CountCollisions(Hashes128));
+    }
+
+    volatile size_t s_ThroughputSink;
+
+    // Hashes the buffer as consecutive keys and returns GB/s
+    template <typename HashFunction>
+    double MeasureThroughput( const std::vector<uint8_t>& Buffer, size_t KeySize, HashFunction Hash )
+    {
+        const size_t kNumPasses = 32;
+        const size_t NumKeys = Buffer.size() / KeySize;
+
+        // Accumulate the results so that the calls can't be optimized away
+        size_t Sink = 0;
+        const int64_t StartTick = SystemTime::GetCurrentTick();
+        for (size_t Pass = 0; Pass < kNumPasses; ++Pass)
+        {
+            for (size_t i = 0; i < NumKeys; ++i)
+                Sink += (size_t)Hash(Buffer.data() + i * KeySize, KeySize);
+        }
+        const double Seconds = SystemTime::TimeBetweenTicks(StartTick, SystemTime::GetCurrentTick());
+        s_ThroughputSink += Sink;
+
+        return (double)(kNumPasses * NumKeys * KeySize) / Seconds / 1e9;
+    }
+
+    void BenchmarkCallback( void* )
+    {
+        const uint32_t kNumCollisionKeys = 1 << 20;
+
+        std::vector<BenchmarkKey> Keys(kNumCollisionKeys);
+        Utility::Printf("Hash collisions among %u 64-byte keys:\n", kNumCollisionKeys);
+        MakeSparseKeys(Keys);
+        BenchmarkCollisions("Sparse", Keys);
+        MakeRandomKeys(Keys);
+        BenchmarkCollisions("Random", Keys);
+
+        // Small enough to stay in cache, so this measures the hash rather than memory bandwidth
+        std::vector<uint8_t> Buffer(1 << 20);
+        std::mt19937 Generator(0);
+        for (uint8_t& Byte : Buffer)
+            Byte = (uint8_t)Generator();
+
+        Utility::Printf("Hash throughput in GB/s (%s CRC32C):\n", HasHardwareCRC32() ? "hardware" : "software");
+        const size_t KeySizes[] = { 16, 64, 256, 4096 };
+        for (size_t KeySize : KeySizes)
+        {
+            const double RangeRate = MeasureThroughput(Buffer, KeySize, []( const uint8_t* Key, size_t Size )
+            {
+                return HashRange((const uint32_t*)Key, (const uint32_t*)(Key + Size), 2166136261U);
+            });
+            const double CRC32CRate = MeasureThroughput(Buffer, KeySize, []( const uint8_t* Key, size_t Size )
+            {
+                return HashBytesCRC32C(Key, Size);
+            });
+            const double Rate64 = MeasureThroughput(Buffer, KeySize, []( const uint8_t* Key, size_t Size )
+            {
+                return HashBytes64(Key, Size);
+            });
+            const double Rate128 = MeasureThroughput(Buffer, KeySize, []( const uint8_t* Key, size_t Size )
+            {
+                return HashBytes128(Key, Size).Low;
+            });
+
+            Utility::Printf("  %4u-byte keys  %6.2f HashRange  %6.2f CRC32C  %6.2f HashBytes64  %6.2f HashBytes128\n",
+                (uint32_t)KeySize, RangeRate, CRC32CRate, Rate64, Rate128);
+        }
+    }
+
+    CallbackTrigger s_BenchmarkTrigger("Hash/Benchmark", BenchmarkCallback);
+}
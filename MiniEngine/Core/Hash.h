@@ -63,4 +63,59 @@ namespace Utility
         return HashRange((uint32_t*)StateDesc, (uint32_t*)(StateDesc + Count), Hash);
     }
 
+    //
+    // Byte-range hashing.  HashRange() above is a fast CRC meant for word-aligned state
+    // descriptions.  The functions below accept arbitrary, unaligned byte ranges and are
+    // suitable for asset IDs, cache keys, and vertex deduplication where collisions matter.
+    //
+
+    struct Hash128
+    {
+        uint64_t Low;
+        uint64_t High;
+
+        bool operator==( const Hash128& rhs ) const { return Low == rhs.Low && High == rhs.High; }
+        bool operator!=( const Hash128& rhs ) const { return !(*this == rhs); }
+    };
+
+    // True when the CPU supports the SSE4.2 CRC32 instruction.  Queried once via CPUID.
+    bool HasHardwareCRC32( void );
+
+    // CRC32C (Castagnoli) of a byte range.  Uses the CRC32 instruction when present and
+    // a table-driven fallback otherwise.  Both paths produce identical results.
+    uint32_t HashBytesCRC32C( const void* Data, size_t Size, uint32_t Crc = 0 );
+
+    // xxHash64 of a byte range.  Pass a previous result as the seed to chain ranges.
+    uint64_t HashBytes64( const void* Data, size_t Size, uint64_t Seed = 0 );
+
+    // MurmurHash3 (x64, 128-bit) of a byte range.  Use when 64 bits of key space is not
+    // enough, e.g. content-addressed asset caches.
+    Hash128 HashBytes128( const void* Data, size_t Size, uint64_t Seed = 0 );
+
+    template <typename T> inline uint64_t HashObject64( const T& Object, uint64_t Seed = 0 )
+    {
+        return HashBytes64(&Object, sizeof(T), Seed);
+    }
+
+    // Streaming xxHash64.  Feeding the same bytes through any number of Update() calls
+    // yields the same digest as a single call to HashBytes64().
+    class HashStream64
+    {
+    public:
+        explicit HashStream64( uint64_t Seed = 0 ) { Reset(Seed); }
+
+        void Reset( uint64_t Seed = 0 );
+        void Update( const void* Data, size_t Size );
+        uint64_t Digest( void ) const;
+
+        template <typename T> void UpdateObject( const T& Object ) { Update(&Object, sizeof(T)); }
+
+    private:
+        uint64_t m_Acc[4];
+        uint64_t m_Seed;
+        uint64_t m_TotalSize;
+        uint8_t m_Buffer[32];
+        uint32_t m_BufferSize;
+    };
+
 } // namespace Utility
@@ -0,0 +1,390 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#include "pch.h"
+#include "ParticleCpuSimulator.h"
+#include "SystemTime.h"
+#include <ppl.h>
+#include <algorithm>
+#include <random>
+
+using namespace Math;
+
+namespace
+{
+    // Particles per task.  A multiple of four so that no SIMD group straddles two tasks.
+    const uint32_t kChunkSize = 16384;
+
+    // ParticleSpawnCS runs in groups of 64 threads
+    const uint32_t kSpawnGroupSize = 64;
+
+    const uint8_t kBitCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+    template <typename Function>
+    void ForEachChunk( uint32_t Count, Function ChunkFunction )
+    {
+        const uint32_t NumChunks = DivideByMultiple(Count, kChunkSize);
+        if (NumChunks == 1)
+            ChunkFunction(0u, 0u, Count);
+        else if (NumChunks > 1)
+        {
+            concurrency::parallel_for(0u, NumChunks, [&]( uint32_t Chunk )
+            {
+                const uint32_t Begin = Chunk * kChunkSize;
+                ChunkFunction(Chunk, Begin, std::min(Begin + kChunkSize, Count));
+            });
+        }
+    }
+
+    inline XMVECTOR LoadLanes( const std::vector<float>& Array, uint32_t Index )
+    {
+        return XMLoadFloat4((const XMFLOAT4*)&Array[Index]);
+    }
+
+    inline void StoreLanes( std::vector<float>& Array, uint32_t Index, FXMVECTOR Value )
+    {
+        XMStoreFloat4((XMFLOAT4*)&Array[Index], Value);
+    }
+}
+
+void ParticleCpuSimulator::ParticleState::Resize( size_t Count )
+{
+    PositionX.resize(Count);
+    PositionY.resize(Count);
+    PositionZ.resize(Count);
+    VelocityX.resize(Count);
+    VelocityY.resize(Count);
+    VelocityZ.resize(Count);
+    Mass.resize(Count);
+    Age.resize(Count);
+    AgeRate.resize(Count);
+    ResetDataIndex.resize(Count);
+}
+
+void ParticleCpuSimulator::Create( const ParticleSpawnData* SpawnData, uint32_t NumSpawnData, uint32_t MaxParticles )
+{
+    m_SpawnData.assign(SpawnData, SpawnData + NumSpawnData);
+    m_MaxParticles = MaxParticles;
+
+    // Padded so that the last SIMD group can be loaded and stored whole
+    m_State[0].Resize(AlignUp(MaxParticles, 4));
+    m_State[1].Resize(AlignUp(MaxParticles, 4));
+    m_CurrentState = 0;
+
+    Clear();
+}
+
+uint32_t ParticleCpuSimulator::UpdateRange( ParticleState& State, const EmissionProperties& EmitProperties,
+    float TimeDelta, uint32_t Begin, uint32_t End ) const
+{
+    const XMVECTOR ElapsedTime = XMVectorReplicate(TimeDelta);
+    const XMVECTOR GravityX = XMVectorReplicate(EmitProperties.Gravity.x);
+    const XMVECTOR GravityY = XMVectorReplicate(EmitProperties.Gravity.y);
+    const XMVECTOR GravityZ = XMVectorReplicate(EmitProperties.Gravity.z);
+    const XMVECTOR Restitution = XMVectorReplicate(EmitProperties.Restitution);
+    const XMVECTOR Zero = XMVectorZero();
+    const XMVECTOR One = XMVectorSplatOne();
+    const XMVECTOR LaneOffsets = XMVectorSet(0.0f, 1.0f, 2.0f, 3.0f);
+    const XMVECTOR ParticleCount = XMVectorReplicate((float)m_NumParticles);
+
+    uint32_t NumAlive = 0;
+
+    for (uint32_t i = Begin; i < End; i += 4)
+    {
+        XMVECTOR PosX = LoadLanes(State.PositionX, i);
+        XMVECTOR PosY = LoadLanes(State.PositionY, i);
+        XMVECTOR PosZ = LoadLanes(State.PositionZ, i);
+        XMVECTOR VelX = LoadLanes(State.VelocityX, i);
+        XMVECTOR VelY = LoadLanes(State.VelocityY, i);
+        XMVECTOR VelZ = LoadLanes(State.VelocityZ, i);
+        const XMVECTOR Mass = LoadLanes(State.Mass, i);
+
+        // Update age.  If normalized age exceeds 1, the particle does not renew its lease on life.
+        const XMVECTOR Age = XMVectorAdd(LoadLanes(State.Age, i), XMVectorMultiply(ElapsedTime, LoadLanes(State.AgeRate, i)));
+
+        // Compute two deltas to support rebounding off the ground plane
+        const XMVECTOR Falling = XMVectorAndInt(XMVectorGreater(PosY, Zero), XMVectorLess(VelY, Zero));
+        const XMVECTOR TimeToFloor = XMVectorMin(ElapsedTime, XMVectorDivide(PosY, XMVectorNegate(VelY)));
+        const XMVECTOR StepSize = XMVectorSelect(ElapsedTime, TimeToFloor, Falling);
+
+        PosX = XMVectorAdd(PosX, XMVectorMultiply(VelX, StepSize));
+        PosY = XMVectorAdd(PosY, XMVectorMultiply(VelY, StepSize));
+        PosZ = XMVectorAdd(PosZ, XMVectorMultiply(VelZ, StepSize));
+        VelX = XMVectorAdd(VelX, XMVectorMultiply(XMVectorMultiply(GravityX, Mass), StepSize));
+        VelY = XMVectorAdd(VelY, XMVectorMultiply(XMVectorMultiply(GravityY, Mass), StepSize));
+        VelZ = XMVectorAdd(VelZ, XMVectorMultiply(XMVectorMultiply(GravityZ, Mass), StepSize));
+
+        // Rebound off the ground if we didn't consume all of the elapsed time
+        const XMVECTOR Remaining = XMVectorSubtract(ElapsedTime, StepSize);
+        const XMVECTOR Rebound = XMVectorGreater(Remaining, Zero);
+
+        XMVECTOR BounceVelX = XMVectorMultiply(VelX, Restitution);
+        XMVECTOR BounceVelY = XMVectorMultiply(XMVectorNegate(VelY), Restitution);
+        XMVECTOR BounceVelZ = XMVectorMultiply(VelZ, Restitution);
+        const XMVECTOR BouncePosX = XMVectorAdd(PosX, XMVectorMultiply(BounceVelX, Remaining));
+        const XMVECTOR BouncePosY = XMVectorAdd(PosY, XMVectorMultiply(BounceVelY, Remaining));
+        const XMVECTOR BouncePosZ = XMVectorAdd(PosZ, XMVectorMultiply(BounceVelZ, Remaining));
+        BounceVelX = XMVectorAdd(BounceVelX, XMVectorMultiply(XMVectorMultiply(GravityX, Mass), Remaining));
+        BounceVelY = XMVectorAdd(BounceVelY, XMVectorMultiply(XMVectorMultiply(GravityY, Mass), Remaining));
+        BounceVelZ = XMVectorAdd(BounceVelZ, XMVectorMultiply(XMVectorMultiply(GravityZ, Mass), Remaining));
+
+        StoreLanes(State.PositionX, i, XMVectorSelect(PosX, BouncePosX, Rebound));
+        StoreLanes(State.PositionY, i, XMVectorSelect(PosY, BouncePosY, Rebound));
+        StoreLanes(State.PositionZ, i, XMVectorSelect(PosZ, BouncePosZ, Rebound));
+        StoreLanes(State.VelocityX, i, XMVectorSelect(VelX, BounceVelX, Rebound));
+        StoreLanes(State.VelocityY, i, XMVectorSelect(VelY, BounceVelY, Rebound));
+        StoreLanes(State.VelocityZ, i, XMVectorSelect(VelZ, BounceVelZ, Rebound));
+        StoreLanes(State.Age, i, Age);
+
+        // Padding past the last particle is updated too, but not counted
+        const XMVECTOR InRange = XMVectorLess(XMVectorAdd(LaneOffsets, XMVectorReplicate((float)i)), ParticleCount);
+        const XMVECTOR Alive = XMVectorAndInt(XMVectorLess(Age, One), InRange);
+        NumAlive += kBitCount[_mm_movemask_ps(Alive)];
+    }
+
+    return NumAlive;
+}
+
+void ParticleCpuSimulator::Update( const EmissionProperties& EmitProperties, float TimeDelta, uint32_t NumSpawnThreads )
+{
+    ASSERT(m_MaxParticles > 0, "Particle simulator has not been created");
+
+    ParticleState& Input = m_State[m_CurrentState];
+    ParticleState& Output = m_State[m_CurrentState ^ 1];
+    const uint32_t NumParticles = m_NumParticles;
+    const uint32_t NumChunks = DivideByMultiple(NumParticles, kChunkSize);
+
+    // Simulate in place and count the survivors of each chunk
+    m_ChunkOffsets.resize(NumChunks + 1);
+    ForEachChunk(NumParticles, [&]( uint32_t Chunk, uint32_t Begin, uint32_t End )
+    {
+        m_ChunkOffsets[Chunk + 1] = UpdateRange(Input, EmitProperties, TimeDelta, Begin, AlignUp(End, 4));
+    });
+
+    m_ChunkOffsets[0] = 0;
+    for (uint32_t Chunk = 1; Chunk <= NumChunks; ++Chunk)
+        m_ChunkOffsets[Chunk] += m_ChunkOffsets[Chunk - 1];
+
+    // Each chunk packs its survivors into its own range of the other buffer
+    ForEachChunk(NumParticles, [&]( uint32_t Chunk, uint32_t Begin, uint32_t End )
+    {
+        uint32_t Dest = m_ChunkOffsets[Chunk];
+        for (uint32_t i = Begin; i < End; ++i)
+        {
+            if (Input.Age[i] >= 1.0f)
+                continue;
+
+            Output.PositionX[Dest] = Input.PositionX[i];
+            Output.PositionY[Dest] = Input.PositionY[i];
+            Output.PositionZ[Dest] = Input.PositionZ[i];
+            Output.VelocityX[Dest] = Input.VelocityX[i];
+            Output.VelocityY[Dest] = Input.VelocityY[i];
+            Output.VelocityZ[Dest] = Input.VelocityZ[i];
+            Output.Mass[Dest] = Input.Mass[i];
+            Output.Age[Dest] = Input.Age[i];
+            Output.AgeRate[Dest] = Input.AgeRate[i];
+            Output.ResetDataIndex[Dest] = Input.ResetDataIndex[i];
+            ++Dest;
+        }
+    });
+
+    m_CurrentState ^= 1;
+    m_NumParticles = m_ChunkOffsets[NumChunks];
+    m_NumVertices = m_NumParticles;
+
+    Spawn(EmitProperties, NumSpawnThreads);
+}
+
+void ParticleCpuSimulator::Spawn( const EmissionProperties& EmitProperties, uint32_t NumSpawnThreads )
+{
+    // Whole thread groups are dispatched, and every thread spawns a particle while there is room
+    const uint32_t NumThreads = AlignUp(NumSpawnThreads, kSpawnGroupSize);
+    const uint32_t NumSpawned = std::min(NumThreads, m_MaxParticles - m_NumParticles);
+    if (NumSpawned == 0)
+        return;
+
+    ParticleState& State = m_State[m_CurrentState];
+    const uint32_t FirstParticle = m_NumParticles;
+
+    const XMVECTOR EmitPosW = XMLoadFloat3(&EmitProperties.EmitPosW);
+    const XMVECTOR EmitDirW = XMLoadFloat3(&EmitProperties.EmitDirW);
+    const XMVECTOR EmitRightW = XMLoadFloat3(&EmitProperties.EmitRightW);
+    const XMVECTOR EmitUpW = XMLoadFloat3(&EmitProperties.EmitUpW);
+    const XMVECTOR EmitterVelocity = XMVectorSubtract(EmitPosW, XMLoadFloat3(&EmitProperties.LastEmitPosW));
+    const XMVECTOR InitialVelocity = XMVectorScale(EmitDirW, EmitProperties.EmitSpeed);
+
+    ForEachChunk(NumSpawned, [&]( uint32_t, uint32_t Begin, uint32_t End )
+    {
+        for (uint32_t ThreadID = Begin; ThreadID < End; ++ThreadID)
+        {
+            // Only 64 random indices are supplied.  Reads past the end of the constant buffer return zero.
+            const uint32_t ResetDataIndex = ThreadID < _countof(EmitProperties.RandIndex) ? EmitProperties.RandIndex[ThreadID].x : 0;
+            ASSERT(ResetDataIndex < m_SpawnData.size());
+            const ParticleSpawnData& rd = m_SpawnData[ResetDataIndex];
+
+            const XMVECTOR RandDir = XMVectorAdd(XMVectorAdd(
+                XMVectorScale(EmitRightW, rd.Velocity.x),
+                XMVectorScale(EmitUpW, rd.Velocity.y)),
+                XMVectorScale(EmitDirW, rd.Velocity.z));
+            const XMVECTOR NewVelocity = XMVectorAdd(XMVectorScale(EmitterVelocity, EmitProperties.EmitterVelocitySensitivity), RandDir);
+            const XMVECTOR AdjustedPosition = XMVectorAdd(XMVectorSubtract(EmitPosW, XMVectorScale(EmitterVelocity, rd.Random)),
+                XMLoadFloat3(&rd.SpreadOffset));
+
+            XMFLOAT3 Position, Velocity;
+            XMStoreFloat3(&Position, AdjustedPosition);
+            XMStoreFloat3(&Velocity, XMVectorAdd(NewVelocity, InitialVelocity));
+
+            const uint32_t Index = FirstParticle + ThreadID;
+            State.PositionX[Index] = Position.x;
+            State.PositionY[Index] = Position.y;
+            State.PositionZ[Index] = Position.z;
+            State.VelocityX[Index] = Velocity.x;
+            State.VelocityY[Index] = Velocity.y;
+            State.VelocityZ[Index] = Velocity.z;
+            State.Mass[Index] = rd.Mass;
+            State.Age[Index] = 0.0f;
+            State.AgeRate[Index] = rd.AgeRate;
+            State.ResetDataIndex[Index] = ResetDataIndex;
+        }
+    });
+
+    m_NumParticles += NumSpawned;
+}
+
+uint32_t ParticleCpuSimulator::WriteVertices( ParticleVertex* Dest, uint32_t MaxVertices, uint32_t TextureID ) const
+{
+    const ParticleState& State = m_State[m_CurrentState];
+    const uint32_t NumVertices = std::min(m_NumVertices, MaxVertices);
+
+    ForEachChunk(NumVertices, [&]( uint32_t, uint32_t Begin, uint32_t End )
+    {
+        for (uint32_t i = Begin; i < End; ++i)
+        {
+            const ParticleSpawnData& rd = m_SpawnData[State.ResetDataIndex[i]];
+            const float Age = State.Age[i];
+
+            ParticleVertex Sprite;
+            Sprite.Position = XMFLOAT3(State.PositionX[i], State.PositionY[i], State.PositionZ[i]);
+            Sprite.TextureID = TextureID;
+
+            // Update size and color
+            Sprite.Size = rd.StartSize + Age * (rd.EndSize - rd.StartSize);
+            XMVECTOR Color = XMVectorLerp(rd.StartColor, rd.EndColor, Age);
+
+            // Use a trinomial to smoothly fade in a particle at birth and fade it out at death.
+            Color = XMVectorScale(Color, Age * (1.0f - Age) * (1.0f - Age) * 6.7f);
+            XMStoreFloat4(&Sprite.Color, Color);
+
+            Dest[i] = Sprite;
+        }
+    });
+
+    return NumVertices;
+}
+
+void ParticleCpuSimulator::WriteMotion( ParticleMotion* Dest ) const
+{
+    const ParticleState& State = m_State[m_CurrentState];
+
+    ForEachChunk(m_NumParticles, [&]( uint32_t, uint32_t Begin, uint32_t End )
+    {
+        for (uint32_t i = Begin; i < End; ++i)
+        {
+            ParticleMotion Motion;
+            Motion.Position = XMFLOAT3(State.PositionX[i], State.PositionY[i], State.PositionZ[i]);
+            Motion.Mass = State.Mass[i];
+            Motion.Velocity = XMFLOAT3(State.VelocityX[i], State.VelocityY[i], State.VelocityZ[i]);
+            Motion.Age = State.Age[i];
+            Motion.Rotation = 0.0f;		// The shaders never rotate particles
+            Motion.ResetDataIndex = State.ResetDataIndex[i];
+            Dest[i] = Motion;
+        }
+    });
+}
+
+namespace
+{
+    // Simulates NumParticles long lived particles and reports the time to update them and to write their sprite
+    // vertices.  The update does not branch on particle state, so how the particles move does not matter.
+    void BenchmarkSimulationCase( uint32_t NumParticles )
+    {
+        const uint32_t kNumSpawnData = 4096;
+        const uint32_t kFrames = 60;
+        const float kTimeDelta = 1.0f / 60.0f;
+
+        std::mt19937 Generator(1234);
+        std::uniform_real_distribution<float> Unit(0.0f, 1.0f);
+
+        std::vector<ParticleSpawnData> SpawnData(kNumSpawnData);
+        for (ParticleSpawnData& rd : SpawnData)
+        {
+            rd.AgeRate = 0.001f * (1.0f + Unit(Generator));
+            rd.RotationSpeed = 0.0f;
+            rd.StartSize = 0.1f;
+            rd.EndSize = 0.5f;
+            rd.Velocity = XMFLOAT3(Unit(Generator) - 0.5f, 2.0f + Unit(Generator), Unit(Generator) - 0.5f);
+            rd.Mass = 0.5f + 0.5f * Unit(Generator);
+            rd.SpreadOffset = XMFLOAT3(Unit(Generator), Unit(Generator), Unit(Generator));
+            rd.Random = Unit(Generator);
+            rd.StartColor = Color(1.0f, 0.8f, 0.5f);
+            rd.EndColor = Color(0.5f, 0.5f, 0.5f, 0.0f);
+        }
+
+        EmissionProperties* EmitProperties = CreateEmissionProperties();
+        EmitProperties->MaxParticles = NumParticles;
+        EmitProperties->EmitPosW = EmitProperties->LastEmitPosW = XMFLOAT3(0.0f, 1.0f, 0.0f);
+        for (uint32_t i = 0; i < _countof(EmitProperties->RandIndex); ++i)
+            EmitProperties->RandIndex[i].x = i * 61 % kNumSpawnData;
+
+        ParticleCpuSimulator Simulator;
+        Simulator.Create(SpawnData.data(), kNumSpawnData, NumParticles);
+
+        // Fill the effect, then let it settle
+        Simulator.Update(*EmitProperties, kTimeDelta, NumParticles);
+        for (uint32_t i = 0; i < 30; ++i)
+            Simulator.Update(*EmitProperties, kTimeDelta, 0);
+
+        std::vector<ParticleVertex> Vertices(NumParticles);
+
+        double UpdateSeconds = 0.0;
+        double VertexSeconds = 0.0;
+        for (uint32_t i = 0; i < kFrames; ++i)
+        {
+            int64_t StartTick = SystemTime::GetCurrentTick();
+            Simulator.Update(*EmitProperties, kTimeDelta, 0);
+            int64_t MidTick = SystemTime::GetCurrentTick();
+            Simulator.WriteVertices(Vertices.data(), NumParticles, 0);
+            int64_t EndTick = SystemTime::GetCurrentTick();
+
+            UpdateSeconds += SystemTime::TimeBetweenTicks(StartTick, MidTick);
+            VertexSeconds += SystemTime::TimeBetweenTicks(MidTick, EndTick);
+        }
+
+        delete EmitProperties;
+
+        Utility::Printf("  %8u particles  %7.3f ms update  %7.3f ms vertices  %8.1f M particles/s\n", NumParticles,
+            UpdateSeconds * 1000.0 / kFrames, VertexSeconds * 1000.0 / kFrames,
+            (double)NumParticles * kFrames / (UpdateSeconds + VertexSeconds) / 1000000.0);
+    }
+
+    void BenchmarkSimulationCallback( void* )
+    {
+        Utility::Printf("CPU particle simulation, per frame:\n");
+        BenchmarkSimulationCase(100000);
+        BenchmarkSimulationCase(250000);
+        BenchmarkSimulationCase(500000);
+        BenchmarkSimulationCase(1000000);
+    }
+
+    CallbackTrigger s_BenchmarkSimulationTrigger("Graphics/Particle Effects/Benchmark CPU Simulation", BenchmarkSimulationCallback);
+}
@@ -0,0 +1,75 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+// A CPU implementation of ParticleUpdateCS and ParticleSpawnCS.  Particles are stored as a structure of arrays
+// and updated four at a time, with large effects split across worker threads.  Unlike the shaders, which append
+// through a UAV counter, the particle order is deterministic:  survivors keep their previous order and new
+// particles follow them in dispatch thread order.
+//
+
+#pragma once
+
+#include "Color.h"
+#include "ParticleShaderStructs.h"
+#include <vector>
+
+class ParticleCpuSimulator
+{
+public:
+    ParticleCpuSimulator() : m_MaxParticles(0), m_NumParticles(0), m_NumVertices(0), m_CurrentState(0) {}
+
+    // Takes a copy of the spawn data table that ParticleSpawnCS reads
+    void Create( const ParticleSpawnData* SpawnData, uint32_t NumSpawnData, uint32_t MaxParticles );
+
+    // Kills every particle
+    void Clear( void ) { m_NumParticles = 0; m_NumVertices = 0; }
+
+    // Ages, moves and culls the particles as ParticleUpdateCS does, then emits new ones as a ParticleSpawnCS
+    // dispatch of NumSpawnThreads would.  The gravity, restitution and floor bounce follow the shader exactly.
+    void Update( const EmissionProperties& EmitProperties, float TimeDelta, uint32_t NumSpawnThreads );
+
+    uint32_t GetParticleCount( void ) const { return m_NumParticles; }
+
+    // The particles that survived the last update get sprite vertices.  New ones are drawn from the next frame.
+    uint32_t GetVertexCount( void ) const { return m_NumVertices; }
+
+    // Writes up to MaxVertices sprite vertices in the layout of ParticleUpdateCS output.  Returns the number written.
+    uint32_t WriteVertices( ParticleVertex* Dest, uint32_t MaxVertices, uint32_t TextureID ) const;
+
+    // Writes every particle in the layout of the GPU state buffers
+    void WriteMotion( ParticleMotion* Dest ) const;
+
+private:
+    struct ParticleState
+    {
+        std::vector<float> PositionX, PositionY, PositionZ;
+        std::vector<float> VelocityX, VelocityY, VelocityZ;
+        std::vector<float> Mass;
+        std::vector<float> Age;
+        std::vector<float> AgeRate;		// Copied from the spawn data to avoid a gather in the update
+        std::vector<uint32_t> ResetDataIndex;
+
+        void Resize( size_t Count );
+    };
+
+    uint32_t UpdateRange( ParticleState& State, const EmissionProperties& EmitProperties, float TimeDelta,
+        uint32_t Begin, uint32_t End ) const;
+    void Spawn( const EmissionProperties& EmitProperties, uint32_t NumSpawnThreads );
+
+    std::vector<ParticleSpawnData> m_SpawnData;
+    ParticleState m_State[2];
+    std::vector<uint32_t> m_ChunkOffsets;
+    uint32_t m_MaxParticles;
+    uint32_t m_NumParticles;
+    uint32_t m_NumVertices;
+    uint32_t m_CurrentState;
+};
@@ -37,6 +37,7 @@ ParticleEffect::ParticleEffect(ParticleEffectProperties& effectProperties)
 {
     m_ElapsedTime = 0.0;
     m_EffectProperties = effectProperties;
+    m_SimulatedOnCpu = false;
 }
 
 inline static Color RandColor( Color c0, Color c1 )
@@ -91,6 +92,7 @@ void ParticleEffect::LoadDeviceResources(ID3D12Device* device)
     }
     
     m_RandomStateBuffer.Create(L"ParticleSystem::SpawnDataBuffer", m_EffectProperties.EmitProperties.MaxParticles, sizeof(ParticleSpawnData), pSpawnData);
+    m_CpuSimulator.Create(pSpawnData, m_EffectProperties.EmitProperties.MaxParticles, m_EffectProperties.EmitProperties.MaxParticles);
     _freea(pSpawnData);
 
     m_StateBuffers[0].Create(L"ParticleSystem::Buffer0", m_EffectProperties.EmitProperties.MaxParticles, sizeof(ParticleMotion));
@@ -103,9 +105,8 @@ void ParticleEffect::LoadDeviceResources(ID3D12Device* device)
 
 }
 
-void ParticleEffect::Update(ComputeContext& CompContext,  float timeDelta)
+void ParticleEffect::PrepareEmission(float timeDelta)
 {
-
     m_ElapsedTime += timeDelta;
     m_EffectProperties.EmitProperties.LastEmitPosW = m_EffectProperties.EmitProperties.EmitPosW;
     
@@ -121,6 +122,27 @@ void ParticleEffect::Update(ComputeContext& CompContext,  float timeDelta)
         UINT random = (UINT)s_RNG.NextInt(m_EffectProperties.EmitProperties.MaxParticles - 1);
         m_EffectProperties.EmitProperties.RandIndex[i].x = random;
     }
+}
+
+void ParticleEffect::Update(ComputeContext& CompContext,  float timeDelta)
+{
+    if (m_SimulatedOnCpu)
+    {
+        // Continue from the CPU particles.  They become the input of this update.
+        const uint32_t NumParticles = m_CpuSimulator.GetParticleCount();
+        if (NumParticles > 0)
+        {
+            DynAlloc Motion = CompContext.ReserveUploadMemory(NumParticles * sizeof(ParticleMotion));
+            m_CpuSimulator.WriteMotion((ParticleMotion*)Motion.DataPtr);
+            CompContext.CopyBufferRegion(m_StateBuffers[m_CurrentStateBuffer], 0, Motion.Buffer, Motion.Offset, NumParticles * sizeof(ParticleMotion));
+        }
+        CompContext.ResetCounter(m_StateBuffers[m_CurrentStateBuffer], NumParticles);
+        CompContext.FillBuffer(m_DispatchIndirectArgs, 0, (NumParticles + 63) / 64, sizeof(UINT));
+        m_SimulatedOnCpu = false;
+    }
+
+    PrepareEmission(timeDelta);
+
     CompContext.SetDynamicConstantBufferView(2, sizeof(EmissionProperties), &m_EffectProperties.EmitProperties);	
 
     CompContext.TransitionResource(m_StateBuffers[m_CurrentStateBuffer], D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
@@ -158,6 +180,26 @@ void ParticleEffect::Update(ComputeContext& CompContext,  float timeDelta)
 }
 
 
+void ParticleEffect::UpdateOnCpu(float timeDelta)
+{
+    // The GPU particles are not read back
+    if (!m_SimulatedOnCpu)
+    {
+        m_CpuSimulator.Clear();
+        m_SimulatedOnCpu = true;
+    }
+
+    PrepareEmission(timeDelta);
+
+    UINT NumSpawnThreads = (UINT)(m_EffectProperties.EmitRate * timeDelta);
+    m_CpuSimulator.Update(m_EffectProperties.EmitProperties, timeDelta, NumSpawnThreads);
+}
+
+uint32_t ParticleEffect::WriteCpuVertices(ParticleVertex* Dest, uint32_t MaxVertices) const
+{
+    return m_CpuSimulator.WriteVertices(Dest, MaxVertices, m_EffectProperties.EmitProperties.TextureID);
+}
+
 void ParticleEffect::Reset()
 {
     m_EffectProperties = m_OriginalEffectProperties;
@@ -16,6 +16,7 @@
 #include "GpuBuffer.h"
 #include "ParticleEffectProperties.h"
 #include "ParticleShaderStructs.h"
+#include "ParticleCpuSimulator.h"
 
 class ParticleEffect 
 {
@@ -23,11 +24,19 @@ public:
     ParticleEffect(ParticleEffectProperties& effectProperties);
     void LoadDeviceResources(ID3D12Device* device);
     void Update(ComputeContext& CompContext, float timeDelta);
+
+    // Simulates the effect with the CPU instead.  Switching from the GPU starts over with no particles, while
+    // switching back uploads the CPU particles to the GPU state buffers.
+    void UpdateOnCpu(float timeDelta);
+    uint32_t GetCpuVertexCount() const { return m_CpuSimulator.GetVertexCount(); }
+    uint32_t WriteCpuVertices(ParticleVertex* Dest, uint32_t MaxVertices) const;
+
     float GetLifetime(){ return m_EffectProperties.TotalActiveLifetime; }
     float GetElapsedTime(){ return m_ElapsedTime; }
     void Reset();
 
 private:
+    void PrepareEmission(float timeDelta);
 
     StructuredBuffer m_StateBuffers[2];
     uint32_t m_CurrentStateBuffer;
@@ -37,6 +46,8 @@ private:
 
     ParticleEffectProperties m_EffectProperties;
     ParticleEffectProperties m_OriginalEffectProperties;
+    ParticleCpuSimulator m_CpuSimulator;
+    bool m_SimulatedOnCpu;
     float m_ElapsedTime;
     UINT m_effectID;
     
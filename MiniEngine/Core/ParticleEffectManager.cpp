@@ -80,6 +80,7 @@ namespace ParticleEffects
     BoolVar EnableSpriteSort("Graphics/Particle Effects/Sort Sprites", true);
     BoolVar EnableTiledRendering("Graphics/Particle Effects/Tiled Rendering", true);
     BoolVar PauseSim("Graphics/Particle Effects/Pause Simulation", false);
+    BoolVar CpuSimulation("Graphics/Particle Effects/CPU Simulation", false);
     const char* ResolutionLabels[] = { "High-Res", "Low-Res", "Dynamic" };
     EnumVar TiledRes("Graphics/Particle Effects/Tiled Sample Rate", 2, 3, ResolutionLabels);
     NumVar DynamicResLevel("Graphics/Particle Effects/Dynamic Resolution Cutoff", 0.0f, -4.0f, 4.0f, 0.5f);
@@ -663,9 +664,30 @@ void ParticleEffects::Update(ComputeContext& Context, float timeDelta )
     Context.TransitionResource(SpriteVertexBuffer, D3D12_RESOURCE_STATE_UNORDERED_ACCESS);
     Context.SetDynamicDescriptor(3, 0, SpriteVertexBuffer.GetUAV());
 
+    // With CPU simulation, each effect's sprites are copied into the vertex buffer after the previous effect's
+    uint32_t NumCpuVertices = 0;
+
     for (UINT i = 0; i < ParticleEffectsActive.size(); ++i)
     {	
-        ParticleEffectsActive[i]->Update(Context, timeDelta);
+        if (CpuSimulation)
+        {
+            ParticleEffect& Effect = *ParticleEffectsActive[i];
+            Effect.UpdateOnCpu(timeDelta);
+
+            const uint32_t NumVertices = std::min(Effect.GetCpuVertexCount(), MAX_TOTAL_PARTICLES - NumCpuVertices);
+            if (NumVertices > 0)
+            {
+                DynAlloc Vertices = Context.ReserveUploadMemory(NumVertices * sizeof(ParticleVertex));
+                Effect.WriteCpuVertices((ParticleVertex*)Vertices.DataPtr, NumVertices);
+                Context.CopyBufferRegion(SpriteVertexBuffer, NumCpuVertices * sizeof(ParticleVertex),
+                    Vertices.Buffer, Vertices.Offset, NumVertices * sizeof(ParticleVertex));
+                NumCpuVertices += NumVertices;
+            }
+        }
+        else
+        {
+            ParticleEffectsActive[i]->Update(Context, timeDelta);
+        }
 
         if (ParticleEffectsActive[i]->GetLifetime() <= ParticleEffectsActive[i]->GetElapsedTime())
         {
@@ -678,6 +700,9 @@ void ParticleEffects::Update(ComputeContext& Context, float timeDelta )
         }
     }
 
+    if (CpuSimulation)
+        Context.ResetCounter(SpriteVertexBuffer, NumCpuVertices);
+
     SetFinalBuffers(Context);
 }
 
@@ -40,6 +40,7 @@ namespace ParticleEffects
 
     extern BoolVar Enable;
     extern BoolVar PauseSim;
+    extern BoolVar CpuSimulation;
     extern BoolVar EnableTiledRendering;
     extern bool Reproducible; //If you want to repro set to true. When true, effect uses the same set of random numbers each run
     extern UINT ReproFrame;
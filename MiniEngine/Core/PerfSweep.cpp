@@ -0,0 +1,421 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#include "pch.h"
+#include "PerfSweep.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    struct SweepVariable
+    {
+        string Path;
+        EngineVar* Var;
+        vector<string> Values;      // As the variable's ToString() writes them
+        float Weight;
+        string Baseline;
+        int32_t BaselineIndex;      // Position of the baseline in Values, or -1 if it is not one of them
+    };
+
+    struct SweepResult
+    {
+        float Quality;
+        float FrameMean;
+        float FrameP99;
+        float CpuMean;
+        float GpuMean;
+        uint32_t Hitches;
+        vector<EngineProfiling::ScopeStatistics> Scopes;
+    };
+
+    enum CostMetric { kGpuCost, kCpuCost, kFrameCost };
+
+    // Runs more than this are almost certainly a mistake in the sweep file
+    const size_t kMaxConfigurations = 4096;
+
+    vector<SweepVariable> s_Variables;
+    vector<vector<int32_t>> s_Configurations;  // Value index per variable, -1 keeps the baseline
+    vector<SweepResult> s_Results;
+    CostMetric s_CostMetric = kGpuCost;
+    size_t s_NextConfiguration = 0;
+    bool s_IsRunning = false;
+
+    string Trim( const string& Text )
+    {
+        size_t First = Text.find_first_not_of(" \t\r\n");
+        if (First == string::npos)
+            return "";
+        size_t Last = Text.find_last_not_of(" \t\r\n");
+        return Text.substr(First, Last - First + 1);
+    }
+
+    // Keeps only the values the variable accepts, in the form it writes them, so they can be compared
+    void AddVariable( const string& Path, EngineVar& Var, const vector<string>& Values, float Weight )
+    {
+        SweepVariable Sweep;
+        Sweep.Path = Path;
+        Sweep.Var = &Var;
+        Sweep.Weight = Weight;
+        Sweep.Baseline = Var.ToString();
+        Sweep.BaselineIndex = -1;
+
+        for (const string& Value : Values)
+        {
+            if (!Var.FromString(Value))
+            {
+                Utility::Printf("PerfSweep:  \"%s\" is not a valid value for %s\n", Value.c_str(), Path.c_str());
+                continue;
+            }
+
+            string Canonical = Var.ToString();
+            if (find(Sweep.Values.begin(), Sweep.Values.end(), Canonical) == Sweep.Values.end())
+                Sweep.Values.push_back(Canonical);
+        }
+        Var.FromString(Sweep.Baseline);
+
+        if (Sweep.Values.empty())
+            return;
+
+        auto Match = find(Sweep.Values.begin(), Sweep.Values.end(), Sweep.Baseline);
+        if (Match != Sweep.Values.end())
+            Sweep.BaselineIndex = (int32_t)(Match - Sweep.Values.begin());
+
+        s_Variables.push_back(Sweep);
+    }
+
+    bool ParseSweepFile( const wstring& FileName, bool& Factorial )
+    {
+        FILE* File = nullptr;
+        if (0 != _wfopen_s(&File, FileName.c_str(), L"r"))
+            return false;
+
+        char Line[1024];
+        while (fgets(Line, sizeof(Line), File) != nullptr)
+        {
+            string Text = Line;
+            Text = Trim(Text.substr(0, Text.find('#')));
+            if (Text.empty())
+                continue;
+
+            const size_t Equals = Text.find('=');
+            const string Key = Trim(Text.substr(0, Equals));
+            string Values = Equals == string::npos ? "*" : Trim(Text.substr(Equals + 1));
+
+            if (Key == "design")
+            {
+                Factorial = Values == "factorial";
+                continue;
+            }
+            else if (Key == "cost")
+            {
+                s_CostMetric = Values == "cpu" ? kCpuCost : Values == "frame" ? kFrameCost : kGpuCost;
+                continue;
+            }
+
+            float Weight = 1.0f;
+            const size_t At = Values.rfind('@');
+            if (At != string::npos)
+            {
+                Weight = (float)atof(Values.c_str() + At + 1);
+                Values = Trim(Values.substr(0, At));
+            }
+
+            vector<string> ValueList;
+            if (Values != "*")
+            {
+                size_t Start = 0;
+                while (Start <= Values.length())
+                {
+                    size_t Comma = Values.find(',', Start);
+                    if (Comma == string::npos)
+                        Comma = Values.length();
+                    string Value = Trim(Values.substr(Start, Comma - Start));
+                    if (!Value.empty())
+                        ValueList.push_back(Value);
+                    Start = Comma + 1;
+                }
+            }
+
+            // A trailing "/*" names a group
+            if (Key.length() >= 2 && Key.compare(Key.length() - 2, 2, "/*") == 0)
+            {
+                EngineTuning::EnumerateVariables(Key.substr(0, Key.length() - 1), [&]( const string& Path, EngineVar& Var )
+                {
+                    vector<string> SweepValues;
+                    Var.GetSweepValues(SweepValues);
+                    if (SweepValues.size() > 1)
+                        AddVariable(Path, Var, SweepValues, Weight);
+                });
+                continue;
+            }
+
+            EngineVar* Var = EngineTuning::FindVariable(Key);
+            if (Var == nullptr)
+            {
+                Utility::Printf("PerfSweep:  \"%s\" does not name a registered variable\n", Key.c_str());
+                continue;
+            }
+
+            if (ValueList.empty())
+                Var->GetSweepValues(ValueList);
+
+            AddVariable(Key, *Var, ValueList, Weight);
+        }
+
+        fclose(File);
+        return true;
+    }
+
+    void PlanOneFactor( void )
+    {
+        s_Configurations.push_back(vector<int32_t>(s_Variables.size(), -1));
+
+        for (size_t i = 0; i < s_Variables.size(); ++i)
+        {
+            for (size_t j = 0; j < s_Variables[i].Values.size(); ++j)
+            {
+                if ((int32_t)j == s_Variables[i].BaselineIndex)
+                    continue;
+
+                vector<int32_t> Configuration(s_Variables.size(), -1);
+                Configuration[i] = (int32_t)j;
+                s_Configurations.push_back(Configuration);
+            }
+        }
+    }
+
+    bool PlanFactorial( void )
+    {
+        size_t Count = 1;
+        for (const SweepVariable& Sweep : s_Variables)
+        {
+            Count *= Sweep.Values.size();
+            if (Count > kMaxConfigurations)
+                return false;
+        }
+
+        // Count in mixed radix, last variable fastest
+        vector<int32_t> Configuration(s_Variables.size(), 0);
+        for (size_t n = 0; n < Count; ++n)
+        {
+            s_Configurations.push_back(Configuration);
+            for (size_t i = s_Variables.size(); i-- > 0; )
+            {
+                if (++Configuration[i] < (int32_t)s_Variables[i].Values.size())
+                    break;
+                Configuration[i] = 0;
+            }
+        }
+        return true;
+    }
+
+    const string& GetValue( size_t Config, size_t Variable )
+    {
+        int32_t Index = s_Configurations[Config][Variable];
+        const SweepVariable& Sweep = s_Variables[Variable];
+        return Index < 0 ? Sweep.Baseline : Sweep.Values[Index];
+    }
+
+    float ComputeQuality( const vector<int32_t>& Configuration )
+    {
+        float Quality = 0.0f;
+        float TotalWeight = 0.0f;
+        for (size_t i = 0; i < s_Variables.size(); ++i)
+        {
+            const SweepVariable& Sweep = s_Variables[i];
+            int32_t Index = Configuration[i] < 0 ? Sweep.BaselineIndex : Configuration[i];
+            if (Sweep.Values.size() > 1 && Index > 0)
+                Quality += Sweep.Weight * Index / (float)(Sweep.Values.size() - 1);
+            TotalWeight += Sweep.Weight;
+        }
+        return TotalWeight > 0.0f ? Quality / TotalWeight : 0.0f;
+    }
+
+    float GetCost( const SweepResult& Result )
+    {
+        switch (s_CostMetric)
+        {
+        case kCpuCost:      return Result.CpuMean;
+        case kFrameCost:    return Result.FrameMean;
+        default:            return Result.GpuMean;
+        }
+    }
+
+    // A configuration is on the front if nothing else is both cheaper (or as cheap) and at least as good
+    vector<bool> FindParetoFront( void )
+    {
+        vector<size_t> Order(s_Results.size());
+        for (size_t i = 0; i < Order.size(); ++i)
+            Order[i] = i;
+
+        sort(Order.begin(), Order.end(), []( size_t A, size_t B )
+        {
+            float CostA = GetCost(s_Results[A]), CostB = GetCost(s_Results[B]);
+            return CostA != CostB ? CostA < CostB : s_Results[A].Quality > s_Results[B].Quality;
+        });
+
+        vector<bool> OnFront(s_Results.size(), false);
+        float BestQuality = -1.0f;
+        for (size_t i : Order)
+        {
+            if (s_Results[i].Quality > BestQuality)
+            {
+                OnFront[i] = true;
+                BestQuality = s_Results[i].Quality;
+            }
+        }
+        return OnFront;
+    }
+}
+
+bool PerfSweep::Load( const std::wstring& FileName )
+{
+    s_Variables.clear();
+    s_Configurations.clear();
+    s_Results.clear();
+    s_NextConfiguration = 0;
+    s_IsRunning = false;
+
+    bool Factorial = false;
+    if (!ParseSweepFile(FileName, Factorial))
+    {
+        Utility::Printf(L"Unable to load sweep file %ws\n", FileName.c_str());
+        return false;
+    }
+
+    if (s_Variables.empty())
+    {
+        Utility::Printf(L"Sweep file %ws names no sweepable variables\n", FileName.c_str());
+        return false;
+    }
+
+    if (!Factorial)
+        PlanOneFactor();
+    else if (!PlanFactorial())
+    {
+        Utility::Printf("PerfSweep:  a factorial design over these variables exceeds %u configurations\n",
+            (uint32_t)kMaxConfigurations);
+        return false;
+    }
+
+    Utility::Printf("PerfSweep:  %u variables, %u configurations (%s)\n", (uint32_t)s_Variables.size(),
+        (uint32_t)s_Configurations.size(), Factorial ? "factorial" : "one factor at a time");
+
+    s_IsRunning = true;
+    return true;
+}
+
+bool PerfSweep::BeginConfiguration( void )
+{
+    if (!s_IsRunning)
+        return false;
+
+    const bool Finished = s_NextConfiguration >= s_Configurations.size();
+
+    // Variables at their baseline are set too, undoing the previous configuration
+    for (size_t i = 0; i < s_Variables.size(); ++i)
+    {
+        const string& Value = Finished ? s_Variables[i].Baseline : GetValue(s_NextConfiguration, i);
+        s_Variables[i].Var->FromString(Value);
+    }
+
+    if (Finished)
+    {
+        s_IsRunning = false;
+        return false;
+    }
+
+    ++s_NextConfiguration;
+    return true;
+}
+
+void PerfSweep::EndConfiguration( void )
+{
+    ASSERT(s_NextConfiguration > 0 && s_Results.size() == s_NextConfiguration - 1);
+
+    SweepResult Result;
+    Result.Quality = ComputeQuality(s_Configurations[s_NextConfiguration - 1]);
+    Result.FrameMean = EngineProfiling::GetFrameTimeMean();
+    Result.FrameP99 = EngineProfiling::GetFrameTimeQuantile(0.99f);
+    Result.Hitches = EngineProfiling::GetHitchCount();
+    EngineProfiling::GetScopeStatistics(Result.Scopes);
+    Result.CpuMean = Result.Scopes[0].CpuMean;
+    Result.GpuMean = Result.Scopes[0].GpuMean;
+    s_Results.push_back(Result);
+
+    Utility::Printf("PerfSweep:  configuration %u of %u, %.3f ms CPU, %.3f ms GPU\n", (uint32_t)s_Results.size(),
+        (uint32_t)s_Configurations.size(), Result.CpuMean, Result.GpuMean);
+}
+
+bool PerfSweep::IsRunning( void )
+{
+    return s_IsRunning;
+}
+
+void PerfSweep::WriteReport( const std::wstring& ReportFile )
+{
+    if (s_Results.empty())
+        return;
+
+    const vector<bool> OnFront = FindParetoFront();
+    const float BaseCost = GetCost(s_Results[0]);
+
+    FILE* File = nullptr;
+    if (0 != _wfopen_s(&File, (ReportFile + L".sweep.csv").c_str(), L"w"))
+    {
+        Utility::Printf(L"Unable to write sweep report %ws.sweep.csv\n", ReportFile.c_str());
+        return;
+    }
+
+    fprintf(File, "Config");
+    for (const SweepVariable& Sweep : s_Variables)
+        fprintf(File, ",\"%s\"", Sweep.Path.c_str());
+    fprintf(File, ",Quality,Frame Mean (ms),Frame P99 (ms),Hitches,CPU Mean (ms),GPU Mean (ms),Cost vs Config 0 (ms),Pareto\n");
+
+    for (size_t n = 0; n < s_Results.size(); ++n)
+    {
+        const SweepResult& R = s_Results[n];
+        fprintf(File, "%u", (uint32_t)n);
+        for (size_t i = 0; i < s_Variables.size(); ++i)
+            fprintf(File, ",\"%s\"", GetValue(n, i).c_str());
+        fprintf(File, ",%.3f,%.3f,%.3f,%u,%.3f,%.3f,%+.3f,%s\n", R.Quality, R.FrameMean, R.FrameP99, R.Hitches,
+            R.CpuMean, R.GpuMean, GetCost(R) - BaseCost, OnFront[n] ? "yes" : "no");
+    }
+    fclose(File);
+
+    if (0 == _wfopen_s(&File, (ReportFile + L".sweep_scopes.csv").c_str(), L"w"))
+    {
+        fprintf(File, "Config,Scope,CPU Mean (ms),GPU Mean (ms)\n");
+        for (size_t n = 0; n < s_Results.size(); ++n)
+        {
+            for (const EngineProfiling::ScopeStatistics& Scope : s_Results[n].Scopes)
+                fprintf(File, "%u,\"%s\",%.3f,%.3f\n", (uint32_t)n, Scope.Path.c_str(), Scope.CpuMean, Scope.GpuMean);
+        }
+        fclose(File);
+    }
+
+    Utility::Printf("Pareto front (%s cost):\n", s_CostMetric == kCpuCost ? "CPU" : s_CostMetric == kFrameCost ? "frame" : "GPU");
+    for (size_t n = 0; n < s_Results.size(); ++n)
+    {
+        if (!OnFront[n])
+            continue;
+
+        Utility::Printf("  Config %u:  quality %.3f, %.3f ms\n", (uint32_t)n, s_Results[n].Quality, GetCost(s_Results[n]));
+        for (size_t i = 0; i < s_Variables.size(); ++i)
+            Utility::Printf("    %s = %s\n", s_Variables[i].Path.c_str(), GetValue(n, i).c_str());
+    }
+
+    Utility::Printf(L"Sweep report written to %ws.sweep.csv\n", ReportFile.c_str());
+}
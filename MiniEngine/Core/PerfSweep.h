@@ -0,0 +1,55 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+// Parameter sweeps over EngineTuning variables.  A benchmark run with "-sweep <file>" replays its camera
+// path once per configuration, warmup included, and records frame and per-scope timings for each.  The
+// sweep file lists one variable per line, with its values from lowest to highest quality:
+//
+//   design = onefactor                  # Vary one variable at a time from the current settings (default),
+//                                       # or "factorial" to run every combination
+//   cost = gpu                          # Cost used for the Pareto front:  gpu (default), cpu or frame
+//   Graphics/SSAO/Enable = off, on
+//   Graphics/SSAO/Quality Level = Low, Medium, High @ 2    # "@ n" weighs its quality n times (default 1)
+//   Graphics/Bloom/Enable = *           # "*" uses the variable's own sweep values
+//   Graphics/DoF/*                      # Every sweepable variable whose path starts with Graphics/DoF/
+//
+// Each configuration's quality is the weighted mean of the position of each value in its list, so 0 is every
+// variable at its first value and 1 is every variable at its last.  With "onefactor", list the current value
+// too or the baseline counts as lowest quality for that variable.
+//
+// Results are written next to the benchmark report:
+//   <report>.sweep.csv          One row per configuration:  values, quality, timings, and Pareto membership
+//   <report>.sweep_scopes.csv   Mean CPU and GPU time of every profiling scope in every configuration
+//
+
+#pragma once
+
+#include <string>
+
+namespace PerfSweep
+{
+    // Parses a sweep file and plans its configurations.  Call after EngineTuning settings have been applied,
+    // because they are the baseline.  Returns false if the file is missing or names nothing to sweep.
+    bool Load( const std::wstring& FileName );
+
+    // Applies the next configuration.  Returns false, and restores the baseline, when all have run.
+    bool BeginConfiguration( void );
+
+    // Records the statistics gathered since EngineProfiling::ResetStatistics() for the current configuration
+    void EndConfiguration( void );
+
+    // True from Load() until BeginConfiguration() runs out of configurations
+    bool IsRunning( void );
+
+    // Writes the cost tables and prints the Pareto front.  Does nothing if no configuration has finished.
+    void WriteReport( const std::wstring& ReportFile );
+}
@@ -0,0 +1,548 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#include "pch.h"
+#include "PixelConversion.h"
+#include "SystemTime.h"
+#include <intrin.h>
+#include <immintrin.h>
+#include <ppl.h>
+#include <algorithm>
+
+using namespace std;
+using namespace PixelConversion;
+
+namespace
+{
+    typedef void (*RowKernel)( const uint8_t* Src, uint32_t* Dest, uint32_t Width );
+
+    enum KernelLevel
+    {
+        kScalar,
+        kSSSE3,
+        kAVX2,
+        kNumKernelLevels
+    };
+
+    const char* s_KernelNames[kNumKernelLevels] = { "Scalar", "SSSE3", "AVX2" };
+    const char* s_FormatNames[kNumSourceFormats] = { "Gray8", "BGR5X1", "BGR5A1", "BGR8", "BGRA8" };
+
+    KernelLevel QueryKernelLevel( void )
+    {
+#if defined(_M_X64) || defined(_M_IX86)
+        int CpuInfo[4];
+        __cpuid(CpuInfo, 0);
+        const int MaxLeaf = CpuInfo[0];
+
+        __cpuid(CpuInfo, 1);
+        const bool HasSSSE3 = (CpuInfo[2] & (1 << 9)) != 0;
+        const bool HasOSXSAVE = (CpuInfo[2] & (1 << 27)) != 0;
+        const bool HasAVX = (CpuInfo[2] & (1 << 28)) != 0;
+
+        // AVX2 also needs the OS to save YMM registers
+        if (MaxLeaf >= 7 && HasOSXSAVE && HasAVX && (_xgetbv(0) & 6) == 6)
+        {
+            __cpuidex(CpuInfo, 7, 0);
+            if (CpuInfo[1] & (1 << 5))	// EBX.AVX2
+                return kAVX2;
+        }
+
+        return HasSSSE3 ? kSSSE3 : kScalar;
+#else
+        return kScalar;
+#endif
+    }
+
+    KernelLevel GetKernelLevel( void )
+    {
+        static const KernelLevel s_KernelLevel = QueryKernelLevel();
+        return s_KernelLevel;
+    }
+
+    inline uint32_t Expand5( uint32_t x )
+    {
+        return x << 3 | x >> 2;
+    }
+
+    //
+    // Scalar kernels.  These also finish the pixels left over by the vector kernels.
+    //
+
+    void ConvertGray8_Scalar( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        for (uint32_t i = 0; i < Width; ++i)
+            Dest[i] = 0xFF000000 | Src[i] * 0x010101u;
+    }
+
+    template <bool HasAlpha>
+    void ConvertBGR5_Scalar( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        for (uint32_t i = 0; i < Width; ++i)
+        {
+            const uint32_t Pixel = Src[i * 2] | Src[i * 2 + 1] << 8;
+            const uint32_t Alpha = (!HasAlpha || (Pixel & 0x8000)) ? 0xFF000000 : 0;
+            Dest[i] = Alpha | Expand5(Pixel & 31) << 16 | Expand5(Pixel >> 5 & 31) << 8 | Expand5(Pixel >> 10 & 31);
+        }
+    }
+
+    void ConvertBGR8_Scalar( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        for (uint32_t i = 0; i < Width; ++i, Src += 3)
+            Dest[i] = 0xFF000000 | Src[0] << 16 | Src[1] << 8 | Src[2];
+    }
+
+    void ConvertBGRA8_Scalar( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        for (uint32_t i = 0; i < Width; ++i, Src += 4)
+            Dest[i] = Src[3] << 24 | Src[0] << 16 | Src[1] << 8 | Src[2];
+    }
+
+    //
+    // SSSE3 kernels
+    //
+
+    void ConvertGray8_SSSE3( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        const __m128i Alpha = _mm_set1_epi32((int)0xFF000000);
+        const __m128i Spread0 = _mm_setr_epi8(0, 0, 0, -1, 1, 1, 1, -1, 2, 2, 2, -1, 3, 3, 3, -1);
+        const __m128i Spread1 = _mm_setr_epi8(4, 4, 4, -1, 5, 5, 5, -1, 6, 6, 6, -1, 7, 7, 7, -1);
+        const __m128i Spread2 = _mm_setr_epi8(8, 8, 8, -1, 9, 9, 9, -1, 10, 10, 10, -1, 11, 11, 11, -1);
+        const __m128i Spread3 = _mm_setr_epi8(12, 12, 12, -1, 13, 13, 13, -1, 14, 14, 14, -1, 15, 15, 15, -1);
+
+        uint32_t i = 0;
+        for (; i + 16 <= Width; i += 16)
+        {
+            const __m128i Gray = _mm_loadu_si128((const __m128i*)(Src + i));
+            _mm_storeu_si128((__m128i*)(Dest + i + 0), _mm_or_si128(_mm_shuffle_epi8(Gray, Spread0), Alpha));
+            _mm_storeu_si128((__m128i*)(Dest + i + 4), _mm_or_si128(_mm_shuffle_epi8(Gray, Spread1), Alpha));
+            _mm_storeu_si128((__m128i*)(Dest + i + 8), _mm_or_si128(_mm_shuffle_epi8(Gray, Spread2), Alpha));
+            _mm_storeu_si128((__m128i*)(Dest + i + 12), _mm_or_si128(_mm_shuffle_epi8(Gray, Spread3), Alpha));
+        }
+
+        ConvertGray8_Scalar(Src + i, Dest + i, Width - i);
+    }
+
+    // Pixels are zero-extended to 32 bits
+    template <bool HasAlpha>
+    inline __m128i ExpandBGR5( __m128i Pixels )
+    {
+        const __m128i Mask5 = _mm_set1_epi32(31);
+        __m128i B = _mm_and_si128(Pixels, Mask5);
+        __m128i G = _mm_and_si128(_mm_srli_epi32(Pixels, 5), Mask5);
+        __m128i R = _mm_and_si128(_mm_srli_epi32(Pixels, 10), Mask5);
+        B = _mm_or_si128(_mm_slli_epi32(B, 3), _mm_srli_epi32(B, 2));
+        G = _mm_or_si128(_mm_slli_epi32(G, 3), _mm_srli_epi32(G, 2));
+        R = _mm_or_si128(_mm_slli_epi32(R, 3), _mm_srli_epi32(R, 2));
+
+        // Smear bit 15 across the alpha byte
+        const __m128i A = HasAlpha ? _mm_slli_epi32(_mm_srai_epi32(_mm_slli_epi32(Pixels, 16), 31), 24) :
+            _mm_set1_epi32((int)0xFF000000);
+
+        return _mm_or_si128(_mm_or_si128(R, _mm_slli_epi32(G, 8)), _mm_or_si128(_mm_slli_epi32(B, 16), A));
+    }
+
+    template <bool HasAlpha>
+    void ConvertBGR5_SSSE3( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        const __m128i Zero = _mm_setzero_si128();
+
+        uint32_t i = 0;
+        for (; i + 8 <= Width; i += 8)
+        {
+            const __m128i Packed = _mm_loadu_si128((const __m128i*)(Src + i * 2));
+            _mm_storeu_si128((__m128i*)(Dest + i), ExpandBGR5<HasAlpha>(_mm_unpacklo_epi16(Packed, Zero)));
+            _mm_storeu_si128((__m128i*)(Dest + i + 4), ExpandBGR5<HasAlpha>(_mm_unpackhi_epi16(Packed, Zero)));
+        }
+
+        ConvertBGR5_Scalar<HasAlpha>(Src + i * 2, Dest + i, Width - i);
+    }
+
+    void ConvertBGR8_SSSE3( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        const __m128i Alpha = _mm_set1_epi32((int)0xFF000000);
+        const __m128i Shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+
+        // Each step loads 16 bytes but consumes 12, so stop while a whole load still fits in the row
+        uint32_t i = 0;
+        for (; i + 6 <= Width; i += 4)
+        {
+            const __m128i Pixels = _mm_loadu_si128((const __m128i*)(Src + i * 3));
+            _mm_storeu_si128((__m128i*)(Dest + i), _mm_or_si128(_mm_shuffle_epi8(Pixels, Shuffle), Alpha));
+        }
+
+        ConvertBGR8_Scalar(Src + i * 3, Dest + i, Width - i);
+    }
+
+    void ConvertBGRA8_SSSE3( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        const __m128i Shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+        uint32_t i = 0;
+        for (; i + 4 <= Width; i += 4)
+        {
+            const __m128i Pixels = _mm_loadu_si128((const __m128i*)(Src + i * 4));
+            _mm_storeu_si128((__m128i*)(Dest + i), _mm_shuffle_epi8(Pixels, Shuffle));
+        }
+
+        ConvertBGRA8_Scalar(Src + i * 4, Dest + i, Width - i);
+    }
+
+    //
+    // AVX2 kernels.  Byte shuffles stay within 128-bit lanes, so both lanes use the same pattern.
+    //
+
+    void ConvertGray8_AVX2( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        const __m256i Alpha = _mm256_set1_epi32((int)0xFF000000);
+        const __m256i Replicate = _mm256_set1_epi32(0x010101);
+
+        uint32_t i = 0;
+        for (; i + 8 <= Width; i += 8)
+        {
+            const __m256i Gray = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(Src + i)));
+            _mm256_storeu_si256((__m256i*)(Dest + i), _mm256_or_si256(_mm256_mullo_epi32(Gray, Replicate), Alpha));
+        }
+
+        ConvertGray8_Scalar(Src + i, Dest + i, Width - i);
+    }
+
+    template <bool HasAlpha>
+    void ConvertBGR5_AVX2( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        const __m256i Mask5 = _mm256_set1_epi32(31);
+
+        uint32_t i = 0;
+        for (; i + 8 <= Width; i += 8)
+        {
+            const __m256i Pixels = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(Src + i * 2)));
+            __m256i B = _mm256_and_si256(Pixels, Mask5);
+            __m256i G = _mm256_and_si256(_mm256_srli_epi32(Pixels, 5), Mask5);
+            __m256i R = _mm256_and_si256(_mm256_srli_epi32(Pixels, 10), Mask5);
+            B = _mm256_or_si256(_mm256_slli_epi32(B, 3), _mm256_srli_epi32(B, 2));
+            G = _mm256_or_si256(_mm256_slli_epi32(G, 3), _mm256_srli_epi32(G, 2));
+            R = _mm256_or_si256(_mm256_slli_epi32(R, 3), _mm256_srli_epi32(R, 2));
+
+            const __m256i A = HasAlpha ? _mm256_slli_epi32(_mm256_srai_epi32(_mm256_slli_epi32(Pixels, 16), 31), 24) :
+                _mm256_set1_epi32((int)0xFF000000);
+
+            _mm256_storeu_si256((__m256i*)(Dest + i), _mm256_or_si256(
+                _mm256_or_si256(R, _mm256_slli_epi32(G, 8)), _mm256_or_si256(_mm256_slli_epi32(B, 16), A)));
+        }
+
+        ConvertBGR5_Scalar<HasAlpha>(Src + i * 2, Dest + i, Width - i);
+    }
+
+    void ConvertBGR8_AVX2( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        const __m256i Alpha = _mm256_set1_epi32((int)0xFF000000);
+        const __m256i Shuffle = _mm256_setr_epi8(
+            2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1,
+            2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+
+        // Four pixels per lane.  The upper lane loads 16 bytes starting 12 bytes in.
+        uint32_t i = 0;
+        for (; i + 10 <= Width; i += 8)
+        {
+            const __m128i Lo = _mm_loadu_si128((const __m128i*)(Src + i * 3));
+            const __m128i Hi = _mm_loadu_si128((const __m128i*)(Src + i * 3 + 12));
+            const __m256i Pixels = _mm256_inserti128_si256(_mm256_castsi128_si256(Lo), Hi, 1);
+            _mm256_storeu_si256((__m256i*)(Dest + i), _mm256_or_si256(_mm256_shuffle_epi8(Pixels, Shuffle), Alpha));
+        }
+
+        ConvertBGR8_Scalar(Src + i * 3, Dest + i, Width - i);
+    }
+
+    void ConvertBGRA8_AVX2( const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+    {
+        const __m256i Shuffle = _mm256_setr_epi8(
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+            2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+        uint32_t i = 0;
+        for (; i + 8 <= Width; i += 8)
+        {
+            const __m256i Pixels = _mm256_loadu_si256((const __m256i*)(Src + i * 4));
+            _mm256_storeu_si256((__m256i*)(Dest + i), _mm256_shuffle_epi8(Pixels, Shuffle));
+        }
+
+        ConvertBGRA8_Scalar(Src + i * 4, Dest + i, Width - i);
+    }
+
+    const RowKernel s_Kernels[kNumKernelLevels][kNumSourceFormats] =
+    {
+        { ConvertGray8_Scalar, ConvertBGR5_Scalar<false>, ConvertBGR5_Scalar<true>, ConvertBGR8_Scalar, ConvertBGRA8_Scalar },
+        { ConvertGray8_SSSE3, ConvertBGR5_SSSE3<false>, ConvertBGR5_SSSE3<true>, ConvertBGR8_SSSE3, ConvertBGRA8_SSSE3 },
+        { ConvertGray8_AVX2, ConvertBGR5_AVX2<false>, ConvertBGR5_AVX2<true>, ConvertBGR8_AVX2, ConvertBGRA8_AVX2 },
+    };
+
+    // Below this many pixels, handing rows to worker threads costs more than it saves
+    const size_t kParallelPixelThreshold = 256 * 1024;
+    const size_t kPixelsPerTask = 64 * 1024;
+
+    void ConvertImageWithKernel( RowKernel Kernel, uint32_t PixelSize, const uint8_t* Src, uint32_t Width,
+        uint32_t Height, void* Dest, size_t DestRowPitch, bool FlipVertical )
+    {
+        const size_t SrcRowPitch = (size_t)Width * PixelSize;
+
+        auto ConvertRows = [=]( uint32_t FirstRow, uint32_t EndRow )
+        {
+            for (uint32_t Row = FirstRow; Row < EndRow; ++Row)
+            {
+                const uint32_t DestRow = FlipVertical ? Height - 1 - Row : Row;
+                Kernel(Src + Row * SrcRowPitch, (uint32_t*)((uint8_t*)Dest + DestRow * DestRowPitch), Width);
+            }
+        };
+
+        if ((size_t)Width * Height < kParallelPixelThreshold)
+        {
+            ConvertRows(0, Height);
+            return;
+        }
+
+        const uint32_t RowsPerTask = (uint32_t)max<size_t>(kPixelsPerTask / Width, 1);
+        const uint32_t NumTasks = (Height + RowsPerTask - 1) / RowsPerTask;
+
+        concurrency::parallel_for(0u, NumTasks, [=]( uint32_t Task )
+        {
+            const uint32_t FirstRow = Task * RowsPerTask;
+            ConvertRows(FirstRow, min(FirstRow + RowsPerTask, Height));
+        });
+    }
+
+    void BenchmarkKernelsCallback( void* )
+    {
+        BenchmarkKernels();
+    }
+
+    CallbackTrigger s_BenchmarkTrigger("Texture Streaming/Benchmark Decode", BenchmarkKernelsCallback);
+}
+
+uint32_t PixelConversion::BytesPerPixel( SourceFormat Format )
+{
+    static const uint32_t s_BytesPerPixel[kNumSourceFormats] = { 1, 2, 2, 3, 4 };
+    return s_BytesPerPixel[Format];
+}
+
+void PixelConversion::ConvertRow( SourceFormat Format, const uint8_t* Src, uint32_t* Dest, uint32_t Width )
+{
+    s_Kernels[GetKernelLevel()][Format](Src, Dest, Width);
+}
+
+void PixelConversion::ConvertImage( SourceFormat Format, const uint8_t* Src, uint32_t Width, uint32_t Height,
+    void* Dest, size_t DestRowPitch, bool FlipVertical )
+{
+    ConvertImageWithKernel(s_Kernels[GetKernelLevel()][Format], BytesPerPixel(Format), Src, Width, Height,
+        Dest, DestRowPitch, FlipVertical);
+}
+
+bool PixelConversion::DecodeRLE( SourceFormat Format, const uint8_t* Src, size_t SrcSize, uint32_t Width, uint32_t Height,
+    void* Dest, size_t DestRowPitch, bool FlipVertical )
+{
+    const RowKernel Kernel = s_Kernels[GetKernelLevel()][Format];
+    const uint32_t PixelSize = BytesPerPixel(Format);
+    const uint8_t* SrcEnd = Src + SrcSize;
+
+    uint32_t Row = 0;
+    uint32_t Column = 0;
+    uint32_t* DestRow = (uint32_t*)((uint8_t*)Dest + (FlipVertical ? Height - 1 : 0) * DestRowPitch);
+
+    while (Row < Height)
+    {
+        if (Src >= SrcEnd)
+            return false;
+
+        // The high bit selects a run of one repeated pixel versus a span of literal pixels
+        const uint8_t Packet = *Src++;
+        const bool IsRun = (Packet & 0x80) != 0;
+        uint32_t Count = (Packet & 0x7F) + 1;
+
+        if ((size_t)(SrcEnd - Src) < (IsRun ? 1 : Count) * PixelSize)
+            return false;
+
+        uint32_t RunTexel = 0;
+        if (IsRun)
+        {
+            Kernel(Src, &RunTexel, 1);
+            Src += PixelSize;
+        }
+
+        // Packets may continue onto the next row
+        while (Count > 0)
+        {
+            if (Row == Height)
+                return false;
+
+            const uint32_t Span = min(Count, Width - Column);
+
+            if (IsRun)
+            {
+                fill_n(DestRow + Column, Span, RunTexel);
+            }
+            else
+            {
+                Kernel(Src, DestRow + Column, Span);
+                Src += Span * PixelSize;
+            }
+
+            Column += Span;
+            Count -= Span;
+
+            if (Column == Width)
+            {
+                Column = 0;
+                if (++Row < Height)
+                    DestRow = (uint32_t*)((uint8_t*)Dest + (FlipVertical ? Height - 1 - Row : Row) * DestRowPitch);
+            }
+        }
+    }
+
+    return true;
+}
+
+namespace
+{
+    // Walks the packet headers of a run-length encoded image without decoding it.  Accepts exactly the streams
+    // that DecodeRLE() does.
+    bool ValidateRLE( const uint8_t* Src, size_t SrcSize, uint32_t PixelSize, uint64_t NumPixels )
+    {
+        const uint8_t* SrcEnd = Src + SrcSize;
+
+        while (NumPixels > 0)
+        {
+            if (Src >= SrcEnd)
+                return false;
+
+            const uint8_t Packet = *Src++;
+            const bool IsRun = (Packet & 0x80) != 0;
+            const uint32_t Count = (Packet & 0x7F) + 1;
+
+            const size_t PacketBytes = (IsRun ? 1 : Count) * PixelSize;
+            if ((size_t)(SrcEnd - Src) < PacketBytes || Count > NumPixels)
+                return false;
+
+            Src += PacketBytes;
+            NumPixels -= Count;
+        }
+
+        return true;
+    }
+}
+
+bool PixelConversion::ParseTGA( const void* File, size_t FileSize, TGAImage& Image )
+{
+    const uint8_t* FilePtr = (const uint8_t*)File;
+
+    const size_t kHeaderSize = 18;
+    if (FileSize < kHeaderSize)
+        return false;
+
+    const uint8_t IdLength = FilePtr[0];
+    const uint8_t ColorMapType = FilePtr[1];
+    const uint8_t ImageType = FilePtr[2];
+    const uint8_t BitCount = FilePtr[16];
+    const uint8_t Descriptor = FilePtr[17];
+
+    Image.Width = FilePtr[12] | FilePtr[13] << 8;
+    Image.Height = FilePtr[14] | FilePtr[15] << 8;
+
+    // Types 2 and 3 are uncompressed true-color and grayscale.  Add 8 for run-length encoding.
+    // Color-mapped images are not supported.
+    Image.IsRLE = ImageType == 10 || ImageType == 11;
+    const bool IsGray = ImageType == 3 || ImageType == 11;
+    if (ColorMapType != 0 || (ImageType != 2 && ImageType != 3 && !Image.IsRLE) || Image.Width == 0 || Image.Height == 0)
+        return false;
+
+    if (IsGray && BitCount == 8)
+        Image.Format = kGray8;
+    else if (!IsGray && BitCount == 16)
+        Image.Format = (Descriptor & 0x0F) ? kBGR5A1 : kBGR5X1;
+    else if (!IsGray && BitCount == 24)
+        Image.Format = kBGR8;
+    else if (!IsGray && BitCount == 32)
+        Image.Format = kBGRA8;
+    else
+        return false;
+
+    // Rows are stored bottom-up unless bit 5 of the descriptor is set
+    Image.FlipVertical = (Descriptor & 0x20) == 0;
+
+    if (FileSize < kHeaderSize + IdLength)
+        return false;
+
+    Image.Pixels = FilePtr + kHeaderSize + IdLength;
+    Image.PixelBytes = FileSize - kHeaderSize - IdLength;
+
+    const uint64_t NumPixels = (uint64_t)Image.Width * Image.Height;
+    if (Image.IsRLE)
+        return ValidateRLE(Image.Pixels, Image.PixelBytes, BytesPerPixel(Image.Format), NumPixels);
+
+    return Image.PixelBytes >= NumPixels * BytesPerPixel(Image.Format);
+}
+
+bool PixelConversion::DecodeTGA( const TGAImage& Image, void* Dest, size_t DestRowPitch )
+{
+    if (Image.IsRLE)
+    {
+        return DecodeRLE(Image.Format, Image.Pixels, Image.PixelBytes, Image.Width, Image.Height,
+            Dest, DestRowPitch, Image.FlipVertical);
+    }
+
+    ConvertImage(Image.Format, Image.Pixels, Image.Width, Image.Height, Dest, DestRowPitch, Image.FlipVertical);
+    return true;
+}
+
+void PixelConversion::BenchmarkKernels( void )
+{
+    const uint32_t kWidth = 2048;
+    const uint32_t kHeight = 2048;
+    const uint32_t kIterations = 8;
+
+    vector<uint8_t> Source((size_t)kWidth * kHeight * 4);
+    vector<uint32_t> Converted((size_t)kWidth * kHeight);
+
+    uint32_t Seed = 0x12345678;
+    for (uint8_t& Byte : Source)
+    {
+        Seed = Seed * 1664525u + 1013904223u;
+        Byte = (uint8_t)(Seed >> 24);
+    }
+
+    Utility::Printf("Pixel conversion throughput, %ux%u images:\n", kWidth, kHeight);
+
+    for (uint32_t Format = 0; Format < kNumSourceFormats; ++Format)
+    {
+        const uint32_t PixelSize = BytesPerPixel((SourceFormat)Format);
+
+        for (uint32_t Level = 0; Level <= (uint32_t)GetKernelLevel(); ++Level)
+        {
+            const RowKernel Kernel = s_Kernels[Level][Format];
+
+            int64_t StartTick = SystemTime::GetCurrentTick();
+            for (uint32_t i = 0; i < kIterations; ++i)
+            {
+                for (uint32_t Row = 0; Row < kHeight; ++Row)
+                    Kernel(Source.data() + (size_t)Row * kWidth * PixelSize, Converted.data() + (size_t)Row * kWidth, kWidth);
+            }
+            const double SerialSeconds = SystemTime::TimeBetweenTicks(StartTick, SystemTime::GetCurrentTick());
+
+            StartTick = SystemTime::GetCurrentTick();
+            for (uint32_t i = 0; i < kIterations; ++i)
+                ConvertImageWithKernel(Kernel, PixelSize, Source.data(), kWidth, kHeight, Converted.data(), kWidth * 4, false);
+            const double ParallelSeconds = SystemTime::TimeBetweenTicks(StartTick, SystemTime::GetCurrentTick());
+
+            const double MegaPixels = (double)kWidth * kHeight * kIterations / 1000000.0;
+            Utility::Printf("  %-6s %-6s  %8.1f Mpixel/s  %8.1f Mpixel/s threaded\n", s_FormatNames[Format],
+                s_KernelNames[Level], MegaPixels / SerialSeconds, MegaPixels / ParallelSeconds);
+        }
+    }
+}
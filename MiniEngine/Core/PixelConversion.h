@@ -0,0 +1,71 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+// Conversion of uncompressed image pixels to R8G8B8A8.  Rows are converted with AVX2 or SSSE3 kernels
+// when the CPU has them, and large images are split across worker threads.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace PixelConversion
+{
+    // Source layouts found in TGA files
+    enum SourceFormat
+    {
+        kGray8,			// Luminance, replicated to RGB
+        kBGR5X1,		// 16-bit, top bit ignored
+        kBGR5A1,		// 16-bit with 1-bit alpha
+        kBGR8,
+        kBGRA8,
+        kNumSourceFormats
+    };
+
+    uint32_t BytesPerPixel( SourceFormat Format );
+
+    // Converts one row of Width pixels
+    void ConvertRow( SourceFormat Format, const uint8_t* Src, uint32_t* Dest, uint32_t Width );
+
+    // Converts tightly packed pixels into rows DestRowPitch bytes apart, such as a mapped upload buffer.
+    // FlipVertical is for images stored bottom row first.
+    void ConvertImage( SourceFormat Format, const uint8_t* Src, uint32_t Width, uint32_t Height,
+        void* Dest, size_t DestRowPitch, bool FlipVertical );
+
+    // Same as ConvertImage() for TGA run-length encoded pixels.  Returns false if the source ends early or
+    // a packet runs past the end of the image.
+    bool DecodeRLE( SourceFormat Format, const uint8_t* Src, size_t SrcSize, uint32_t Width, uint32_t Height,
+        void* Dest, size_t DestRowPitch, bool FlipVertical );
+
+    // Where the pixels of a TGA file are and how they are stored
+    struct TGAImage
+    {
+        uint32_t Width;
+        uint32_t Height;
+        SourceFormat Format;
+        bool IsRLE;
+        bool FlipVertical;		// Rows are stored bottom-up
+        const uint8_t* Pixels;
+        size_t PixelBytes;
+    };
+
+    // Reads the header of a true-color or grayscale TGA file, uncompressed or run-length encoded.  Returns
+    // false for color-mapped images, unsupported bit depths, files too short to hold their pixels and
+    // malformed run-length packets, so that DecodeTGA() cannot fail on an image that parsed.
+    bool ParseTGA( const void* File, size_t FileSize, TGAImage& Image );
+
+    // Converts the pixels of a parsed TGA file into R8G8B8A8 rows DestRowPitch bytes apart, top row first
+    bool DecodeTGA( const TGAImage& Image, void* Dest, size_t DestRowPitch );
+
+    // Times each kernel the CPU supports on synthetic images and prints the throughput.  Touches no GPU state.
+    void BenchmarkKernels( void );
+}
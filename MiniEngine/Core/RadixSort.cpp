@@ -0,0 +1,345 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#include "pch.h"
+#include "RadixSort.h"
+#include "SystemTime.h"
+#include <ppl.h>
+#include <algorithm>
+#include <random>
+#include <thread>
+
+namespace
+{
+    const uint32_t kDigitBits = 8;
+    const uint32_t kNumDigits = 1 << kDigitBits;
+    const uint32_t kMaxPasses = 32 / kDigitBits;
+
+    // Lists this short are insertion sorted
+    const size_t kInsertionSortLimit = 64;
+
+    // Lists shorter than this are sorted on one thread.  They fit in the L2 cache along with their scratch list.
+    const size_t kParallelSortLimit = 64 * 1024;
+
+    // Each worker thread gets at least this many elements
+    const size_t kMinBlockSize = 16 * 1024;
+
+    struct RadixPass
+    {
+        uint32_t Shift;
+        uint32_t Mask;
+        uint32_t Flip;		// Reverses the digit order when sorting descending
+    };
+
+    template <typename T>
+    inline uint32_t GetDigit( T Element, const RadixPass& Pass )
+    {
+        return ((uint32_t)(Element >> Pass.Shift) & Pass.Mask) ^ Pass.Flip;
+    }
+
+    template <typename T>
+    void InsertionSort( T* List, size_t NumElements, uint32_t KeyShift, bool SortAscending )
+    {
+        for (size_t i = 1; i < NumElements; ++i)
+        {
+            const T Element = List[i];
+            const T Key = Element >> KeyShift;
+
+            size_t j = i;
+            for (; j > 0; --j)
+            {
+                const T PrevKey = List[j - 1] >> KeyShift;
+                if (SortAscending ? PrevKey <= Key : PrevKey >= Key)
+                    break;
+                List[j] = List[j - 1];
+            }
+            List[j] = Element;
+        }
+    }
+
+    // Turns digit counts into the offsets where each digit's elements begin.  Returns false if every element has
+    // the same digit, in which case the pass would not move anything.
+    bool CountsToOffsets( size_t* Counts, size_t NumElements )
+    {
+        size_t Offset = 0;
+        for (uint32_t Digit = 0; Digit < kNumDigits; ++Digit)
+        {
+            const size_t Count = Counts[Digit];
+            if (Count == NumElements)
+                return false;
+
+            Counts[Digit] = Offset;
+            Offset += Count;
+        }
+        return true;
+    }
+
+    template <typename T>
+    void SortSingleThreaded( T* List, T* Scratch, size_t NumElements, const RadixPass* Passes, uint32_t NumPasses )
+    {
+        // Build every histogram in one read of the list
+        size_t Counts[kMaxPasses][kNumDigits] = {};
+        for (size_t i = 0; i < NumElements; ++i)
+        {
+            const T Element = List[i];
+            for (uint32_t Pass = 0; Pass < NumPasses; ++Pass)
+                ++Counts[Pass][GetDigit(Element, Passes[Pass])];
+        }
+
+        T* Src = List;
+        T* Dst = Scratch;
+
+        for (uint32_t Pass = 0; Pass < NumPasses; ++Pass)
+        {
+            size_t* Offsets = Counts[Pass];
+            if (!CountsToOffsets(Offsets, NumElements))
+                continue;
+
+            for (size_t i = 0; i < NumElements; ++i)
+            {
+                const T Element = Src[i];
+                Dst[Offsets[GetDigit(Element, Passes[Pass])]++] = Element;
+            }
+
+            std::swap(Src, Dst);
+        }
+
+        if (Src != List)
+            memcpy(List, Src, NumElements * sizeof(T));
+    }
+
+    template <typename T>
+    void SortMultiThreaded( T* List, T* Scratch, size_t NumElements, const RadixPass* Passes, uint32_t NumPasses )
+    {
+        const size_t MaxBlocks = std::max(std::thread::hardware_concurrency(), 1u);
+        const uint32_t NumBlocks = (uint32_t)std::min(MaxBlocks, NumElements / kMinBlockSize);
+        const size_t BlockSize = (NumElements + NumBlocks - 1) / NumBlocks;
+
+        std::vector<size_t> Histograms(NumBlocks * kNumDigits);
+        std::vector<size_t> Totals(kNumDigits);
+
+        T* Src = List;
+        T* Dst = Scratch;
+
+        for (uint32_t Pass = 0; Pass < NumPasses; ++Pass)
+        {
+            const RadixPass& CurrentPass = Passes[Pass];
+
+            concurrency::parallel_for(0u, NumBlocks, [&]( uint32_t Block )
+            {
+                size_t* Counts = &Histograms[Block * kNumDigits];
+                std::fill(Counts, Counts + kNumDigits, 0);
+
+                const size_t End = std::min((Block + 1) * BlockSize, NumElements);
+                for (size_t i = Block * BlockSize; i < End; ++i)
+                    ++Counts[GetDigit(Src[i], CurrentPass)];
+            });
+
+            // Skip the pass if it would not move anything
+            std::fill(Totals.begin(), Totals.end(), 0);
+            for (uint32_t Block = 0; Block < NumBlocks; ++Block)
+            {
+                for (uint32_t Digit = 0; Digit < kNumDigits; ++Digit)
+                    Totals[Digit] += Histograms[Block * kNumDigits + Digit];
+            }
+            if (!CountsToOffsets(Totals.data(), NumElements))
+                continue;
+
+            // Each block's elements of a digit follow those of the blocks before it
+            for (uint32_t Digit = 0; Digit < kNumDigits; ++Digit)
+            {
+                size_t Offset = Totals[Digit];
+                for (uint32_t Block = 0; Block < NumBlocks; ++Block)
+                {
+                    const size_t Count = Histograms[Block * kNumDigits + Digit];
+                    Histograms[Block * kNumDigits + Digit] = Offset;
+                    Offset += Count;
+                }
+            }
+
+            concurrency::parallel_for(0u, NumBlocks, [&]( uint32_t Block )
+            {
+                size_t* Offsets = &Histograms[Block * kNumDigits];
+
+                const size_t End = std::min((Block + 1) * BlockSize, NumElements);
+                for (size_t i = Block * BlockSize; i < End; ++i)
+                {
+                    const T Element = Src[i];
+                    Dst[Offsets[GetDigit(Element, CurrentPass)]++] = Element;
+                }
+            });
+
+            std::swap(Src, Dst);
+        }
+
+        if (Src != List)
+        {
+            concurrency::parallel_for(0u, NumBlocks, [&]( uint32_t Block )
+            {
+                const size_t Begin = Block * BlockSize;
+                const size_t End = std::min(Begin + BlockSize, NumElements);
+                memcpy(List + Begin, Src + Begin, (End - Begin) * sizeof(T));
+            });
+        }
+    }
+
+    template <typename T>
+    void SortKeyIndexList( T* List, T* Scratch, size_t NumElements, uint32_t KeyBits, bool SortAscending )
+    {
+        ASSERT(KeyBits > 0 && KeyBits <= 32, "Radix sort keys must be 1 to 32 bits");
+        ASSERT(NumElements == 0 || (List != nullptr && Scratch != nullptr));
+
+        const uint32_t KeyShift = sizeof(T) * 8 - KeyBits;
+
+        if (NumElements <= kInsertionSortLimit)
+        {
+            InsertionSort(List, NumElements, KeyShift, SortAscending);
+            return;
+        }
+
+        RadixPass Passes[kMaxPasses];
+        uint32_t NumPasses = 0;
+        for (uint32_t Bit = 0; Bit < KeyBits; Bit += kDigitBits)
+        {
+            RadixPass& Pass = Passes[NumPasses++];
+            Pass.Shift = KeyShift + Bit;
+            Pass.Mask = (1u << std::min(kDigitBits, KeyBits - Bit)) - 1;
+            Pass.Flip = SortAscending ? 0 : Pass.Mask;
+        }
+
+        if (NumElements < kParallelSortLimit)
+            SortSingleThreaded(List, Scratch, NumElements, Passes, NumPasses);
+        else
+            SortMultiThreaded(List, Scratch, NumElements, Passes, NumPasses);
+    }
+
+    template <typename T>
+    bool TestCase( std::mt19937_64& Generator, size_t NumElements, uint32_t KeyBits, bool SortAscending )
+    {
+        std::vector<T> List(NumElements);
+        for (T& Element : List)
+            Element = (T)Generator();
+
+        std::vector<T> Expected(List);
+        const uint32_t KeyShift = sizeof(T) * 8 - KeyBits;
+        std::stable_sort(Expected.begin(), Expected.end(), [=]( T A, T B )
+        {
+            return SortAscending ? (A >> KeyShift) < (B >> KeyShift) : (A >> KeyShift) > (B >> KeyShift);
+        });
+
+        std::vector<T> Scratch(NumElements);
+        RadixSort::Sort(List.data(), Scratch.data(), NumElements, KeyBits, SortAscending);
+
+        return List == Expected;
+    }
+
+    template <typename T>
+    void BenchmarkCase( size_t NumElements )
+    {
+        // Sort at least 20M elements in all so that the small cases are measurable
+        const size_t NumIterations = std::max<size_t>(20000000 / NumElements, 1);
+
+        std::mt19937_64 Generator(NumElements);
+        std::vector<T> Source(NumElements);
+        for (size_t i = 0; i < NumElements; ++i)
+        {
+            // Random 32-bit key over the element's index
+            Source[i] = sizeof(T) == 8 ? (T)((uint64_t)(uint32_t)Generator() << 32 | i) : (T)Generator();
+        }
+
+        std::vector<T> List(NumElements);
+        std::vector<T> Scratch(NumElements);
+        std::vector<T> Reference(NumElements);
+
+        double RadixSeconds = 0.0;
+        double StdSeconds = 0.0;
+        for (size_t n = 0; n < NumIterations; ++n)
+        {
+            List = Source;
+            int64_t StartTick = SystemTime::GetCurrentTick();
+            RadixSort::Sort(List.data(), Scratch.data(), NumElements);
+            RadixSeconds += SystemTime::TimeBetweenTicks(StartTick, SystemTime::GetCurrentTick());
+
+            Reference = Source;
+            StartTick = SystemTime::GetCurrentTick();
+            std::sort(Reference.begin(), Reference.end());
+            StdSeconds += SystemTime::TimeBetweenTicks(StartTick, SystemTime::GetCurrentTick());
+        }
+
+        Utility::Printf("  %2u-bit %9u elements  %9.3f ms radix  %9.3f ms std::sort  %5.1fx%s\n",
+            (uint32_t)sizeof(T) * 8, (uint32_t)NumElements, RadixSeconds * 1000.0 / NumIterations,
+            StdSeconds * 1000.0 / NumIterations, StdSeconds / RadixSeconds, List == Reference ? "" : "  MISMATCH");
+    }
+
+    void BenchmarkCallback( void* )
+    {
+        Utility::Printf("Radix sort versus std::sort, per sort:\n");
+        for (size_t NumElements = 1000; NumElements <= 10000000; NumElements *= 10)
+        {
+            BenchmarkCase<uint32_t>(NumElements);
+            BenchmarkCase<uint64_t>(NumElements);
+        }
+    }
+
+    void TestCallback( void* )
+    {
+        RadixSort::Test();
+    }
+
+    CallbackTrigger s_BenchmarkTrigger("Radix Sort/Benchmark", BenchmarkCallback);
+    CallbackTrigger s_TestTrigger("Radix Sort/Test", TestCallback);
+}
+
+void RadixSort::Sort( uint32_t* KeyIndexList, uint32_t* ScratchList, size_t NumElements, uint32_t KeyBits, bool SortAscending )
+{
+    SortKeyIndexList(KeyIndexList, ScratchList, NumElements, KeyBits, SortAscending);
+}
+
+void RadixSort::Sort( uint64_t* KeyIndexList, uint64_t* ScratchList, size_t NumElements, uint32_t KeyBits, bool SortAscending )
+{
+    SortKeyIndexList(KeyIndexList, ScratchList, NumElements, KeyBits, SortAscending);
+}
+
+void RadixSort::Test( void )
+{
+    std::mt19937_64 Generator(12345);
+
+    // Sizes on either side of the insertion sort and multithreading limits
+    const size_t Sizes[] = { 0, 1, 2, 63, 64, 65, 1000, 65535, 65536, 100000, 1000003 };
+    const uint32_t KeyBits[] = { 32, 24, 13, 8, 2 };
+
+    uint32_t NumFailures = 0;
+    for (size_t NumElements : Sizes)
+    {
+        for (uint32_t Bits : KeyBits)
+        {
+            for (int Ascending = 0; Ascending < 2; ++Ascending)
+            {
+                if (!TestCase<uint32_t>(Generator, NumElements, Bits, Ascending != 0))
+                {
+                    Utility::Printf("Radix sort failed:  %u 32-bit elements, %u-bit keys\n", (uint32_t)NumElements, Bits);
+                    ++NumFailures;
+                }
+                if (!TestCase<uint64_t>(Generator, NumElements, Bits, Ascending != 0))
+                {
+                    Utility::Printf("Radix sort failed:  %u 64-bit elements, %u-bit keys\n", (uint32_t)NumElements, Bits);
+                    ++NumFailures;
+                }
+            }
+        }
+    }
+
+    ASSERT(NumFailures == 0, "Radix sort test failed");
+    if (NumFailures == 0)
+        Utility::Printf("Radix sort test passed\n");
+}
@@ -0,0 +1,68 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+// Radix Sort is the CPU counterpart to BitonicSort.  It sorts the same key/index
+// pairs:  32-bit elements with the key in the most significant bits and the index
+// in the rest, or 64-bit elements with the key in the upper 4 bytes.  Only the
+// key bits are examined, so the sort is stable with respect to the indices.
+//
+// A least significant digit radix sort makes one pass per byte of key.  Each pass
+// counts how many keys have each digit value (the histogram), turns the counts
+// into output offsets with a prefix sum, and then scatters every element to its
+// offset.  The cost is O( N * KeyBytes ) regardless of how the keys are ordered,
+// which beats comparison sorts once lists are larger than a few thousand items.
+//
+// Large lists are split into one block per worker thread.  Each thread builds the
+// histogram of its block, the offsets are summed digit by digit across blocks, and
+// then each thread scatters its own block.  Processing the blocks in order keeps
+// the sort stable.  Passes in which every key has the same digit are skipped, so
+// short keys (say a light type in the top byte) only cost the passes they need.
+//
+// Small lists are sorted on one thread, with all of the histograms built in a
+// single read while the list is still in cache, and tiny lists use an insertion
+// sort.
+//
+// The sort ping-pongs between the list and a scratch buffer of the same size.  The
+// sorted result is always returned in the original list.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace RadixSort
+{
+    void Sort(
+        // List to be sorted.  The key is in the most significant KeyBits bits.
+        uint32_t* KeyIndexList,
+
+        // Temporary storage for as many elements as the list
+        uint32_t* ScratchList,
+
+        size_t NumElements,
+
+        // How many of the upper bits hold the key.  The remaining bits are not compared.
+        uint32_t KeyBits = 32,
+
+        // True to sort in ascending order (smallest to largest).  False to sort in descending order.
+        bool SortAscending = true
+    );
+
+    // The key is in the upper 4 bytes (i.e. uint2.y), and KeyBits counts down from bit 63
+    void Sort( uint64_t* KeyIndexList, uint64_t* ScratchList, size_t NumElements, uint32_t KeyBits = 32,
+        bool SortAscending = true );
+
+    // Sorts random lists of many sizes and compares the results with std::stable_sort
+    void Test( void );
+
+} // namespace RadixSort
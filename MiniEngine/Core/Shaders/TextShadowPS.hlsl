@@ -15,11 +15,9 @@
 
 cbuffer cbFontParams : register(b0)
 {
-    float4 Color;
     float2 ShadowOffset;
     float ShadowHardness;
     float ShadowOpacity;
-    float HeightRange;	// The range of the signed distance field.
 }
 
 Texture2D<float> SignedDistanceFieldTex : register( t0 );
@@ -29,6 +27,8 @@ struct PS_INPUT
 {
     float4 pos : SV_POSITION;
     float2 uv : TEXCOORD0;
+    nointerpolation float4 Color : COLOR;
+    nointerpolation float HeightRange : HEIGHTRANGE;
 };
 
 float GetAlpha( float2 uv, float range )
@@ -39,7 +39,7 @@ float GetAlpha( float2 uv, float range )
 [RootSignature(Text_RootSig)]
 float4 main( PS_INPUT Input ) : SV_Target
 {
-    float alpha1 = GetAlpha(Input.uv, HeightRange) * Color.a;
-    float alpha2 = GetAlpha(Input.uv - ShadowOffset, HeightRange * ShadowHardness) * ShadowOpacity * Color.a;
-    return float4( Color.rgb * alpha1, lerp(alpha2, 1, alpha1) );
+    float alpha1 = GetAlpha(Input.uv, Input.HeightRange) * Input.Color.a;
+    float alpha2 = GetAlpha(Input.uv - ShadowOffset, Input.HeightRange * ShadowHardness) * ShadowOpacity * Input.Color.a;
+    return float4( Input.Color.rgb * alpha1, lerp(alpha2, 1, alpha1) );
 }
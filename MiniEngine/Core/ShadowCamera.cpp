@@ -46,3 +46,71 @@ void GameCore::ShadowCamera::UpdateMatrix(
     // Transform from clip space to texture space
     m_ShadowMatrix =  Matrix4( AffineTransform( Matrix3::MakeScale( 0.5f, -0.5f, 1.0f ), Vector3(0.5f, 0.5f, 0.0f) ) ) * m_ViewProjMatrix;
 }
+
+void GameCore::CascadedShadowCamera::UpdateCascades(
+    const Camera& ViewCamera, Vector3 LightDirection, uint32_t NumCascades, float SplitLambda,
+    float MaxDistance, float CasterExtension, uint32_t BufferSize, uint32_t BufferPrecision )
+{
+    ASSERT(NumCascades > 0 && NumCascades <= kMaxCascades);
+    m_NumCascades = NumCascades;
+
+    const float NearClip = ViewCamera.GetNearClip();
+    const float FarClip = ViewCamera.GetFarClip();
+    const float ShadowFar = MaxDistance < FarClip ? MaxDistance : FarClip;
+    const float RcpDepthRange = 1.0f / (FarClip - NearClip);
+
+    // World-space frustum rays.  Corner i of the near plane and corner i + 4 of the far plane
+    // lie on the same ray, so any intermediate slice is a linear interpolation between them.
+    const Frustum& ViewFrustum = ViewCamera.GetWorldSpaceFrustum();
+    Vector3 NearCorners[4], FarCorners[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        NearCorners[i] = ViewFrustum.GetFrustumCorner((Frustum::CornerID)(Frustum::kNearLowerLeft + i));
+        FarCorners[i] = ViewFrustum.GetFrustumCorner((Frustum::CornerID)(Frustum::kFarLowerLeft + i));
+    }
+
+    const Vector3 LightDir = Normalize(LightDirection);
+    float SliceNear = NearClip;
+
+    for (uint32_t Cascade = 0; Cascade < NumCascades; ++Cascade)
+    {
+        // Blend between logarithmic and uniform split schemes
+        const float Fraction = (float)(Cascade + 1) / (float)NumCascades;
+        const float LogSplit = NearClip * powf(ShadowFar / NearClip, Fraction);
+        const float UniformSplit = NearClip + (ShadowFar - NearClip) * Fraction;
+        const float SliceFar = Lerp(UniformSplit, LogSplit, SplitLambda);
+        m_SplitDistances[Cascade] = SliceFar;
+
+        Vector3 SliceCorners[8];
+        for (int i = 0; i < 4; ++i)
+        {
+            Vector3 Ray = FarCorners[i] - NearCorners[i];
+            SliceCorners[i] = NearCorners[i] + Ray * ((SliceNear - NearClip) * RcpDepthRange);
+            SliceCorners[i + 4] = NearCorners[i] + Ray * ((SliceFar - NearClip) * RcpDepthRange);
+        }
+
+        // Bound the slice with a sphere rather than a light-aligned box.  The sphere does not
+        // change size as the view rotates, so the texel size stays constant and the quantized
+        // position in ShadowCamera::UpdateMatrix keeps shadow edges from shimmering.
+        Vector3 Center(kZero);
+        for (int i = 0; i < 8; ++i)
+            Center += SliceCorners[i];
+        Center = Center * 0.125f;
+
+        float Radius = 0.0f;
+        for (int i = 0; i < 8; ++i)
+            Radius = Max(Radius, (float)Length(SliceCorners[i] - Center));
+
+        // Round the radius up so that floating point noise does not change the texel size
+        Radius = ceilf(Radius * 16.0f) / 16.0f;
+
+        // UpdateMatrix expects the center of the far bounding plane (along the direction of travel)
+        Vector3 ShadowCenter = Center + LightDir * Radius;
+        Vector3 ShadowBounds(2.0f * Radius, 2.0f * Radius, 2.0f * Radius + CasterExtension);
+
+        m_Cascades[Cascade].UpdateMatrix(LightDirection, ShadowCenter, ShadowBounds,
+            BufferSize, BufferSize, BufferPrecision);
+
+        SliceNear = SliceFar;
+    }
+}
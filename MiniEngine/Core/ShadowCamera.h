@@ -42,4 +42,42 @@ namespace GameCore
         Matrix4 m_ShadowMatrix;
     };
 
+    // Splits the view frustum into depth slices and fits a tight, texel-snapped ShadowCamera
+    // around each one.  Near cascades get most of the resolution, so each cascade can use a
+    // much smaller buffer than a single shadow map covering the whole view.
+    class CascadedShadowCamera
+    {
+    public:
+
+        static const uint32_t kMaxCascades = 4;
+
+        CascadedShadowCamera() : m_NumCascades(0) {}
+
+        void UpdateCascades(
+            const Camera& ViewCamera,	// The camera whose frustum will be covered
+            Vector3 LightDirection,		// Direction parallel to light, in direction of travel
+            uint32_t NumCascades,		// Between 1 and kMaxCascades
+            float SplitLambda,			// 0 = uniform splits, 1 = logarithmic splits
+            float MaxDistance,			// Shadows are not rendered beyond this view distance (clamped to the far clip)
+            float CasterExtension,		// Extra depth toward the light to catch off-screen shadow casters
+            uint32_t BufferSize,		// Per-cascade shadow buffer width and height
+            uint32_t BufferPrecision	// Bit depth of shadow buffer--usually 16 or 24
+            );
+
+        uint32_t GetNumCascades() const { return m_NumCascades; }
+
+        // Each cascade camera exposes its view-projection matrix, shadow matrix, and a
+        // world-space frustum for culling shadow casters.
+        const ShadowCamera& GetCascade( uint32_t Index ) const { return m_Cascades[Index]; }
+
+        // View-space distance of the far end of a cascade.  Use it to pick a cascade per pixel.
+        float GetSplitDistance( uint32_t Index ) const { return m_SplitDistances[Index]; }
+
+    private:
+
+        ShadowCamera m_Cascades[kMaxCascades];
+        float m_SplitDistances[kMaxCascades];
+        uint32_t m_NumCascades;
+    };
+
 }
@@ -26,9 +26,11 @@
 #include "CompiledShaders/TextShadowPS.h"
 #include "Fonts/consola24.h"
 #include <map>
+#include <unordered_map>
 #include <string>
 #include <cstdio>
 #include <memory>
+#include <atomic>
 #include <malloc.h>
 
 using namespace Graphics;
@@ -50,20 +52,31 @@ namespace TextRenderer
             m_BorderSize = 0;
             m_TextureWidth = 0;
             m_TextureHeight = 0;
+            m_TexelData = nullptr;
+            m_IsParsed = false;
+            m_IsReady = false;
+            m_HasLoadTask = false;
         }
 
         ~Font()
         {
-            m_Dictionary.clear();
+            // The file may still be loading on another thread
+            if (m_HasLoadTask)
+                m_LoadTask.wait();
         }
 
-        void LoadFromBinary( const wchar_t* fontName, const uint8_t* pBinary, const size_t binarySize )
+        bool LoadFromBinary( const wchar_t* fontName, const uint8_t* pBinary, const size_t binarySize )
         {
-            (fontName);
+            if (!ParseBinary( fontName, pBinary, binarySize ))
+                return false;
 
-            // We should at least use this to assert that we have a complete file
-            (binarySize);
+            CreateTexture();
+            return true;
+        }
 
+        // Reads the metrics and glyphs.  The texels are left in place until CreateTexture().
+        bool ParseBinary( const wchar_t* fontName, const uint8_t* pBinary, const size_t binarySize )
+        {
             struct FontHeader
             {
                 char FileDescriptor[8];		// "SDFFONT\0"
@@ -79,43 +92,72 @@ namespace TextRenderer
             };
 
             FontHeader* header = (FontHeader*)pBinary;
+            if (binarySize < sizeof(FontHeader) || binarySize < sizeof(FontHeader) +
+                header->numGlyphs * (sizeof(wchar_t) + sizeof(Glyph)) + (size_t)header->textureWidth * header->textureHeight)
+            {
+                ERROR( "Font file %ls is truncated", fontName );
+                return false;
+            }
+
             m_NormalizeXCoord = 1.0f / (header->textureWidth * 16);
             m_NormalizeYCoord = 1.0f / (header->textureHeight * 16);
             m_FontHeight = header->fontHeight;
             m_FontLineSpacing = (float)header->advanceY / (float)header->fontHeight;
             m_BorderSize = header->borderSize * 16;
             m_AntialiasRange = (float)header->searchDist / header->fontHeight;
-            uint16_t textureWidth = header->textureWidth;
-            uint16_t textureHeight = header->textureHeight;
+            m_TextureWidth = header->textureWidth;
+            m_TextureHeight = header->textureHeight;
             uint16_t NumGlyphs = header->numGlyphs;
 
             const wchar_t* wcharList = (wchar_t*)(pBinary + sizeof(FontHeader));
             const Glyph* glyphData = (Glyph*)(wcharList + NumGlyphs);
-            const void* texelData = glyphData + NumGlyphs;
+            m_TexelData = glyphData + NumGlyphs;
 
+            // Index every code point directly rather than searching for each character
+            m_Glyphs.assign(glyphData, glyphData + NumGlyphs);
+            m_GlyphIndex.assign(kNumCodePoints, kNoGlyph);
             for (uint16_t i = 0; i < NumGlyphs; ++i)
-                m_Dictionary[wcharList[i]] = glyphData[i];
-
-            m_Texture.Create( textureWidth, textureHeight, DXGI_FORMAT_R8_SNORM, texelData );
+                m_GlyphIndex[(uint16_t)wcharList[i]] = i;
 
             DEBUGPRINT( "Loaded SDF font:  %ls (ver. %d.%d)", fontName, header->majorVersion, header->minorVersion);
+
+            return true;
         }
 
-        bool Load( const wstring& fileName )
+        // Creating the texture allocates a descriptor and a command context, so it is done on the rendering thread
+        void CreateTexture( void )
         {
-            Utility::ByteArray ba = Utility::ReadFileSync( fileName );
+            m_Texture.Create( m_TextureWidth, m_TextureHeight, DXGI_FORMAT_R8_SNORM, m_TexelData );
+            m_TexelData = nullptr;
+            m_FileData = nullptr;
+            m_IsReady.store(true, memory_order_release);
+        }
 
-            if (ba->size() == 0)
+        // Reads and parses the font on a worker thread.  IsParsed() becomes true when the rendering thread
+        // can create its texture.
+        void LoadAsync( const wstring& fileName )
+        {
+            m_HasLoadTask = true;
+            m_LoadTask = Utility::ReadFileAsync( fileName ).then( [this, fileName]( Utility::ByteArray ba )
             {
-                ERROR( "Cannot open file %ls", fileName.c_str() );
-                return false;
-            }
-
-            LoadFromBinary( fileName.c_str(), ba->data(), ba->size() );
-
-            return true;
+                if (ba->size() == 0)
+                {
+                    ERROR( "Cannot open file %ls", fileName.c_str() );
+                    return;
+                }
+
+                if (ParseBinary( fileName.c_str(), ba->data(), ba->size() ))
+                {
+                    // The texels point into the file data
+                    m_FileData = ba;
+                    m_IsParsed.store(true, memory_order_release);
+                }
+            });
         }
 
+        bool IsParsed( void ) const { return m_IsParsed.load(memory_order_acquire); }
+        bool IsReady( void ) const { return m_IsReady.load(memory_order_acquire); }
+
         // Each character has an XY start offset, a width, and they all share the same height
         struct Glyph
         {
@@ -126,8 +168,8 @@ namespace TextRenderer
 
         const Glyph* GetGlyph( wchar_t ch ) const
         {
-            auto it = m_Dictionary.find( ch );
-            return it == m_Dictionary.end() ? nullptr : &it->second;
+            uint16_t index = m_GlyphIndex[(uint16_t)ch];
+            return index == kNoGlyph ? nullptr : &m_Glyphs[index];
         }
 
         // Get the texel height of the font in 12.4 fixed point
@@ -146,11 +188,15 @@ namespace TextRenderer
         float GetYNormalizationFactor() const { return m_NormalizeYCoord; }
 
         // Get the range in terms of height values centered on the midline that represents a pixel
-        // in screen space (according to the specified font size.)
+        // in screen space per unit of font size.  The vertex shader scales it by each glyph's size.
         // The pixel alpha should range from 0 to 1 over the height range 0.5 +/- 0.5 * aaRange.
-        float GetAntialiasRange( float size ) const { return Max( 1.0f, size * m_AntialiasRange ); }
+        float GetAntialiasRange( void ) const { return m_AntialiasRange; }
 
     private:
+        // wchar_t is 16 bits, so this covers the Basic Multilingual Plane
+        static const uint32_t kNumCodePoints = 65536;
+        static const uint16_t kNoGlyph = 0xFFFF;
+
         float m_NormalizeXCoord;
         float m_NormalizeYCoord;
         float m_FontLineSpacing;
@@ -160,7 +206,14 @@ namespace TextRenderer
         uint16_t m_TextureWidth;
         uint16_t m_TextureHeight;
         Texture m_Texture;
-        map<wchar_t, Glyph> m_Dictionary;
+        vector<Glyph> m_Glyphs;
+        vector<uint16_t> m_GlyphIndex;
+        const void* m_TexelData;
+        Utility::ByteArray m_FileData;
+        atomic<bool> m_IsParsed;
+        atomic<bool> m_IsReady;
+        bool m_HasLoadTask;
+        concurrency::task<void> m_LoadTask;
     };
 
     map< wstring, unique_ptr<Font> > LoadedFonts;
@@ -168,16 +221,167 @@ namespace TextRenderer
     const Font* GetOrLoadFont(const wstring& filename)
     {
         auto fontIter = LoadedFonts.find( filename );
-        if (fontIter != LoadedFonts.end())
-            return fontIter->second.get();
-
-        Font* newFont = new Font();
-        if (filename == L"default")
-            newFont->LoadFromBinary(L"default", g_pconsola24, sizeof(g_pconsola24));
-        else
-            newFont->Load(L"Fonts/" + filename + L".fnt");
-        LoadedFonts[filename].reset(newFont);
-        return newFont;
+        if (fontIter == LoadedFonts.end())
+        {
+            Font* newFont = new Font();
+            if (filename == L"default")
+                newFont->LoadFromBinary(L"default", g_pconsola24, sizeof(g_pconsola24));
+            else
+                newFont->LoadAsync(L"Fonts/" + filename + L".fnt");
+            fontIter = LoadedFonts.emplace(filename, unique_ptr<Font>(newFont)).first;
+        }
+
+        Font* LoadedFont = fontIter->second.get();
+        if (!LoadedFont->IsReady() && LoadedFont->IsParsed())
+            LoadedFont->CreateTexture();
+
+        // Stand in with the default font until this one has loaded
+        if (!LoadedFont->IsReady() && filename != L"default")
+            return GetOrLoadFont(L"default");
+
+        return LoadedFont;
+    }
+
+    // Layouts of recently drawn strings, relative to the cursor.  The overlays draw mostly the same strings every
+    // frame, and reusing a layout only takes adding the cursor position to each glyph.
+    struct CachedGlyph
+    {
+        float X;				// Relative to the start of its line
+        uint16_t Line;
+        uint16_t U, V, W;
+    };
+
+    struct CachedString
+    {
+        vector<CachedGlyph> Glyphs;
+        float EndX;				// Cursor position on the last line
+        uint32_t NumLines;
+        uint64_t LastUsedFrame;
+
+        // To tell hash collisions apart
+        const Font* TextFont;
+        float Size;
+        size_t Stride;
+        string Bytes;
+    };
+
+    // Strings longer than this are rarely redrawn unchanged
+    const size_t kMaxCachedLength = 256;
+    const size_t kMaxCachedStrings = 1024;
+
+    unordered_map<uint64_t, CachedString> s_StringCache;
+
+    uint64_t HashString( const Font* TextFont, float Size, size_t Stride, const char* Bytes, size_t NumBytes )
+    {
+        // FNV-1a
+        uint64_t Hash = 14695981039346656037ull;
+        auto Mix = [&Hash]( const void* Data, size_t Length )
+        {
+            for (size_t i = 0; i < Length; ++i)
+                Hash = (Hash ^ ((const uint8_t*)Data)[i]) * 1099511628211ull;
+        };
+
+        Mix(&TextFont, sizeof(TextFont));
+        Mix(&Size, sizeof(Size));
+        Mix(&Stride, sizeof(Stride));
+        Mix(Bytes, NumBytes);
+        return Hash;
+    }
+
+    // Drops strings that were not drawn last frame.  Returns true if that made room for another.
+    bool EvictStaleStrings( uint64_t Frame )
+    {
+        for (auto iter = s_StringCache.begin(); iter != s_StringCache.end(); )
+        {
+            if (iter->second.LastUsedFrame + 1 < Frame)
+                iter = s_StringCache.erase(iter);
+            else
+                ++iter;
+        }
+        return s_StringCache.size() < kMaxCachedStrings;
+    }
+
+    void LayoutString( CachedString& Layout, const Font* TextFont, float Size, const char* str, size_t stride, size_t slen )
+    {
+        const float UVtoPixel = Size / TextFont->GetHeight();
+
+        Layout.Glyphs.clear();
+        float curX = 0.0f;
+        uint32_t curLine = 0;
+
+        for (size_t i = 0; i < slen; ++i)
+        {
+            wchar_t wc = (stride == 2 ? ((const wchar_t*)str)[i] : (wchar_t)(uint8_t)str[i]);
+
+            // Terminate on null character (this really shouldn't happen with string or wstring)
+            if (wc == L'\0')
+                break;
+
+            // Handle newlines by inserting a carriage return and line feed
+            if (wc == L'\n')
+            {
+                curX = 0.0f;
+                ++curLine;
+                continue;
+            }
+
+            const Font::Glyph* gi = TextFont->GetGlyph(wc);
+
+            // Ignore missing characters
+            if (nullptr == gi)
+                continue;
+
+            CachedGlyph Glyph = { curX + (float)gi->bearing * UVtoPixel, (uint16_t)curLine, gi->x, gi->y, gi->w };
+            Layout.Glyphs.push_back(Glyph);
+
+            // Advance the cursor position
+            curX += (float)gi->advance * UVtoPixel;
+        }
+
+        Layout.EndX = curX;
+        Layout.NumLines = curLine + 1;
+    }
+
+    const CachedString& GetStringLayout( const Font* TextFont, float Size, const char* str, size_t stride, size_t slen )
+    {
+        static CachedString s_Uncached;
+
+        const uint64_t Frame = Graphics::GetFrameCount();
+        const size_t NumBytes = stride * slen;
+
+        if (slen > kMaxCachedLength)
+        {
+            LayoutString(s_Uncached, TextFont, Size, str, stride, slen);
+            return s_Uncached;
+        }
+
+        const uint64_t Key = HashString(TextFont, Size, stride, str, NumBytes);
+        auto iter = s_StringCache.find(Key);
+        if (iter != s_StringCache.end())
+        {
+            CachedString& Cached = iter->second;
+            if (Cached.TextFont == TextFont && Cached.Size == Size && Cached.Stride == stride &&
+                Cached.Bytes.size() == NumBytes && memcmp(Cached.Bytes.data(), str, NumBytes) == 0)
+            {
+                Cached.LastUsedFrame = Frame;
+                return Cached;
+            }
+        }
+        else if (s_StringCache.size() >= kMaxCachedStrings && !EvictStaleStrings(Frame))
+        {
+            LayoutString(s_Uncached, TextFont, Size, str, stride, slen);
+            return s_Uncached;
+        }
+
+        // New string, or a hash collision that replaces the old one
+        CachedString& Layout = s_StringCache[Key];
+        LayoutString(Layout, TextFont, Size, str, stride, slen);
+        Layout.LastUsedFrame = Frame;
+        Layout.TextFont = TextFont;
+        Layout.Size = Size;
+        Layout.Stride = stride;
+        Layout.Bytes.assign(str, NumBytes);
+        return Layout;
     }
 
     RootSignature s_RootSignature;
@@ -200,7 +404,9 @@ void TextRenderer::Initialize( void )
     D3D12_INPUT_ELEMENT_DESC vertElem[] =
     {
         { "POSITION", 0, DXGI_FORMAT_R32G32_FLOAT     , 0, 0, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
-        { "TEXCOORD", 0, DXGI_FORMAT_R16G16B16A16_UINT, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 }
+        { "TEXCOORD", 0, DXGI_FORMAT_R16G16B16A16_UINT, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+        { "TEXTSIZE", 0, DXGI_FORMAT_R32_FLOAT        , 0, 16, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 },
+        { "COLOR",    0, DXGI_FORMAT_R8G8B8A8_UNORM   , 0, 20, D3D12_INPUT_CLASSIFICATION_PER_INSTANCE_DATA, 1 }
     };
 
     s_TextPSO[0].SetRootSignature(s_RootSignature);
@@ -229,6 +435,7 @@ void TextRenderer::Initialize( void )
 
 void TextRenderer::Shutdown( void )
 {
+    s_StringCache.clear();
     LoadedFonts.clear();
 }
 
@@ -237,6 +444,7 @@ TextContext::TextContext( GraphicsContext& CmdContext, float ViewWidth, float Vi
 {
     m_HDR = FALSE;
     m_CurrentFont = nullptr;
+    m_TextSize = 0.0f;
     m_ViewWidth = ViewWidth;
     m_ViewHeight = ViewHeight;
 
@@ -251,24 +459,30 @@ TextContext::TextContext( GraphicsContext& CmdContext, float ViewWidth, float Vi
     m_VSParams.NormalizeX = 1.0f;
     m_VSParams.NormalizeY = 1.0f;
 
+    m_Batch.reserve(1024);
+
     ResetSettings();
 }
 
+TextContext::~TextContext()
+{
+    ASSERT(m_Batch.empty(), "Text was drawn without calling End()");
+}
+
 void TextContext::ResetSettings( void )
 {
+    Flush();
+
     m_EnableShadow = true;
     ResetCursor(0.0f, 0.0f);
     m_ShadowOffsetX = 0.05f;
     m_ShadowOffsetY = 0.05f;
     m_PSParams.ShadowHardness = 0.5f;
     m_PSParams.ShadowOpacity = 1.0f;
-    m_PSParams.TextColor = Color(1.0f, 1.0f, 1.0f, 1.0f);
-
-    m_VSConstantBufferIsStale = true;
-    m_PSConstantBufferIsStale = true;
-    m_TextureIsStale = true;
+    m_TextColor = Color(1.0f, 1.0f, 1.0f, 1.0f).R8G8B8A8();
 
     SetFont( L"default", 24.0f );
+    UpdateFontParams();
 }
 
 void  TextContext::SetLeftMargin( float x ) { m_LeftMargin = x; }
@@ -292,31 +506,29 @@ void TextContext::EnableDropShadow(bool enable)
     if (m_EnableShadow == enable)
         return;
 
+    Flush();
     m_EnableShadow = enable;
-
-    m_Context.SetPipelineState( m_EnableShadow ? TextRenderer::s_ShadowPSO[m_HDR] : TextRenderer::s_TextPSO[m_HDR] );
 }
 
 void TextContext::SetShadowOffset(float xPercent, float yPercent)
 {
+    Flush();
     m_ShadowOffsetX = xPercent;
     m_ShadowOffsetY = yPercent;
     m_PSParams.ShadowOffsetX = m_CurrentFont->GetHeight() * m_ShadowOffsetX * m_VSParams.NormalizeX;
     m_PSParams.ShadowOffsetY = m_CurrentFont->GetHeight() * m_ShadowOffsetY * m_VSParams.NormalizeY;
-    m_PSConstantBufferIsStale = true;
 }
 
 void TextContext::SetShadowParams(float opacity, float width)
 {
+    Flush();
     m_PSParams.ShadowHardness = 1.0f / width;
     m_PSParams.ShadowOpacity = opacity;
-    m_PSConstantBufferIsStale = true;
 }
 
 void TextContext::SetColor( Color c )
 {
-    m_PSParams.TextColor = c;
-    m_PSConstantBufferIsStale = true;
+    m_TextColor = c.R8G8B8A8();
 }
 
 float TextContext::GetVerticalSpacing( void )
@@ -329,67 +541,51 @@ void TextContext::Begin( bool EnableHDR )
     ResetSettings();
 
     m_HDR = (BOOL)EnableHDR;
-
-    m_Context.SetRootSignature(TextRenderer::s_RootSignature);
-    m_Context.SetPipelineState(TextRenderer::s_ShadowPSO[m_HDR]);
-    m_Context.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 }
 
 void TextContext::SetFont( const wstring& fontName, float size )
 {
+    // Check to see if a new size was specified
+    if (size > 0.0f)
+        SetTextSize(size);
+
     // If that font is already set or doesn't exist, return.
     const TextRenderer::Font* NextFont = TextRenderer::GetOrLoadFont( fontName );
     if (NextFont == m_CurrentFont || NextFont == nullptr)
-    {
-        if (size > 0.0f)
-            SetTextSize(size);
-
         return;
-    }
 
+    Flush();
     m_CurrentFont = NextFont;
+    UpdateFontParams();
+}
 
-    // Check to see if a new size was specified
-    if (size > 0.0f)
-        m_VSParams.TextSize = size;
-
-    // Update constants directly tied to the font or the font size
-    m_LineHeight = NextFont->GetVerticalSpacing( m_VSParams.TextSize );
+// Update constants directly tied to the font
+void TextContext::UpdateFontParams( void )
+{
     m_VSParams.NormalizeX = m_CurrentFont->GetXNormalizationFactor();
     m_VSParams.NormalizeY = m_CurrentFont->GetYNormalizationFactor();
-    m_VSParams.Scale = m_VSParams.TextSize / m_CurrentFont->GetHeight();
-    m_VSParams.DstBorder = m_CurrentFont->GetBorderSize() * m_VSParams.Scale;
+    m_VSParams.FontHeight = (float)m_CurrentFont->GetHeight();
+    m_VSParams.AntialiasRange = m_CurrentFont->GetAntialiasRange();
     m_VSParams.SrcBorder = m_CurrentFont->GetBorderSize();
     m_PSParams.ShadowOffsetX = m_CurrentFont->GetHeight() * m_ShadowOffsetX * m_VSParams.NormalizeX;
     m_PSParams.ShadowOffsetY = m_CurrentFont->GetHeight() * m_ShadowOffsetY * m_VSParams.NormalizeY;
-    m_PSParams.HeightRange = m_CurrentFont->GetAntialiasRange( m_VSParams.TextSize );
-    m_VSConstantBufferIsStale = true;
-    m_PSConstantBufferIsStale = true;
-    m_TextureIsStale = true;
+    m_LineHeight = m_CurrentFont->GetVerticalSpacing( m_TextSize );
 }
 
+// The size travels with each glyph, so changing it does not start a new draw
 void TextContext::SetTextSize( float size )
 {
-    if (m_VSParams.TextSize == size)
+    if (m_TextSize == size)
         return;
 
-    m_VSParams.TextSize = size;
-    m_VSConstantBufferIsStale = true;
-
-    if (m_CurrentFont != nullptr)
-    {
-        m_PSParams.HeightRange = m_CurrentFont->GetAntialiasRange( m_VSParams.TextSize );
-        m_VSParams.Scale = m_VSParams.TextSize / m_CurrentFont->GetHeight();
-        m_VSParams.DstBorder = m_CurrentFont->GetBorderSize() * m_VSParams.Scale;
-        m_PSConstantBufferIsStale = true;
-        m_LineHeight = m_CurrentFont->GetVerticalSpacing( size );
-    }
-    else
-        m_LineHeight = 0.0f;
+    m_TextSize = size;
+    m_LineHeight = m_CurrentFont != nullptr ? m_CurrentFont->GetVerticalSpacing( size ) : 0.0f;
 }
 
 void TextContext::SetViewSize( float ViewWidth, float ViewHeight )
 {
+    Flush();
+
     m_ViewWidth = ViewWidth;
     m_ViewHeight = ViewHeight;
 
@@ -400,126 +596,80 @@ void TextContext::SetViewSize( float ViewWidth, float ViewHeight )
 
     // Essentially transform from screen coordinates to to clip space with W = 1.
     m_VSParams.ViewportTransform = Vector4(twoDivW, -twoDivH, -vpX * twoDivW - 1.0f, vpY * twoDivH + 1.0f);
-    m_VSConstantBufferIsStale = true;
 }
 
 void TextContext::End( void )
 {
-    m_VSConstantBufferIsStale = true;
-    m_PSConstantBufferIsStale = true;
-    m_TextureIsStale = true;
+    Flush();
 }
 
-void TextContext::SetRenderState( void )
+void TextContext::Flush( void )
 {
-    WARN_ONCE_IF(nullptr == m_CurrentFont, "Attempted to draw text without a font");
-
-    if (m_VSConstantBufferIsStale)
-    {
-        m_Context.SetDynamicConstantBufferView(0, sizeof(m_VSParams), &m_VSParams);
-        m_VSConstantBufferIsStale = false;
-    }
-
-    if (m_PSConstantBufferIsStale)
-    {
-        m_Context.SetDynamicConstantBufferView(1, sizeof(m_PSParams), &m_PSParams);
-        m_PSConstantBufferIsStale = false;
-    }
+    if (m_Batch.empty())
+        return;
 
-    if (m_TextureIsStale)
-    {
-        m_Context.SetDynamicDescriptors(2, 0, 1, &m_CurrentFont->GetTexture().GetSRV());
-        m_TextureIsStale = false;
-    }
+    // Other rendering may have changed any of this since the last batch
+    m_Context.SetRootSignature(TextRenderer::s_RootSignature);
+    m_Context.SetPipelineState( m_EnableShadow ? TextRenderer::s_ShadowPSO[m_HDR] : TextRenderer::s_TextPSO[m_HDR] );
+    m_Context.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    m_Context.SetDynamicConstantBufferView(0, sizeof(m_VSParams), &m_VSParams);
+    m_Context.SetDynamicConstantBufferView(1, sizeof(m_PSParams), &m_PSParams);
+    m_Context.SetDynamicDescriptors(2, 0, 1, &m_CurrentFont->GetTexture().GetSRV());
+
+    const size_t BufferSize = m_Batch.size() * sizeof(TextVert);
+    DynAlloc vb = m_Context.ReserveUploadMemory(BufferSize);
+    memcpy(vb.DataPtr, m_Batch.data(), BufferSize);
+
+    D3D12_VERTEX_BUFFER_VIEW VBView;
+    VBView.BufferLocation = vb.GpuAddress;
+    VBView.SizeInBytes = (UINT)BufferSize;
+    VBView.StrideInBytes = sizeof(TextVert);
+    m_Context.SetVertexBuffer(0, VBView);
+
+    m_Context.DrawInstanced( 4, (UINT)m_Batch.size() );
+    m_Batch.clear();
 }
 
-// These are made with templates to handle char and wchar_t simultaneously.
-UINT TextContext::FillVertexBuffer( TextVert volatile* verts, const char* str, size_t stride, size_t slen )
+// Handles char and wchar_t strings alike.  The string's layout comes from the cache when it was drawn recently.
+void TextContext::AppendText( const char* str, size_t stride, size_t slen )
 {
-    UINT charsDrawn = 0;
-
-    const float UVtoPixel = m_VSParams.Scale;
+    WARN_ONCE_IF(nullptr == m_CurrentFont, "Attempted to draw text without a font");
+    if (m_CurrentFont == nullptr)
+        return;
 
-    float curX = m_TextPosX;
-    float curY = m_TextPosY;
+    const TextRenderer::CachedString& Layout = TextRenderer::GetStringLayout(m_CurrentFont, m_TextSize, str, stride, slen);
 
     const uint16_t texelHeight = m_CurrentFont->GetHeight();
 
-    const char* iter = str;
-    for (size_t i = 0; i < slen; ++i)
-    {
-        wchar_t wc = (stride == 2 ? *(wchar_t*)iter : *iter);
-        iter += stride;
-
-        // Terminate on null character (this really shouldn't happen with string or wstring)
-        if (wc == L'\0')
-            break;
-
-        // Handle newlines by inserting a carriage return and line feed
-        if (wc == L'\n')
-        {
-            curX = m_LeftMargin;
-            curY += m_LineHeight;
-            continue;
-        }
-
-        const TextRenderer::Font::Glyph* gi = m_CurrentFont->GetGlyph(wc);
+    size_t FirstVert = m_Batch.size();
+    m_Batch.resize(FirstVert + Layout.Glyphs.size());
+    TextVert* verts = m_Batch.data() + FirstVert;
 
-        // Ignore missing characters
-        if (nullptr == gi)
-            continue;
-
-        verts->X = curX + (float)gi->bearing * UVtoPixel;
-        verts->Y = curY;
-        verts->U = gi->x;
-        verts->V = gi->y;
-        verts->W = gi->w;
+    for (const TextRenderer::CachedGlyph& Glyph : Layout.Glyphs)
+    {
+        verts->X = (Glyph.Line == 0 ? m_TextPosX : m_LeftMargin) + Glyph.X;
+        verts->Y = m_TextPosY + Glyph.Line * m_LineHeight;
+        verts->U = Glyph.U;
+        verts->V = Glyph.V;
+        verts->W = Glyph.W;
         verts->H = texelHeight;
+        verts->Size = m_TextSize;
+        verts->Color = m_TextColor;
         ++verts;
-
-        // Advance the cursor position
-        curX += (float)gi->advance * UVtoPixel;
-        ++charsDrawn;
     }
 
-    m_TextPosX = curX;
-    m_TextPosY = curY;
-
-    return charsDrawn;
+    m_TextPosX = (Layout.NumLines == 1 ? m_TextPosX : m_LeftMargin) + Layout.EndX;
+    m_TextPosY += (Layout.NumLines - 1) * m_LineHeight;
 }
 
 void TextContext::DrawString( const std::wstring& str )
 {
-    SetRenderState();
-
-    void* stackMem = _malloca((str.size() + 1) * 16);
-    TextVert* vbPtr = Math::AlignUp((TextVert*)stackMem, 16);
-    UINT primCount = FillVertexBuffer(vbPtr, (char*)str.c_str(), 2, str.size());
-
-    if (primCount > 0)
-    {
-        m_Context.SetDynamicVB(0, primCount, sizeof(TextVert), vbPtr);
-        m_Context.DrawInstanced( 4, primCount );
-    }
-
-    _freea(stackMem);
+    AppendText((const char*)str.c_str(), 2, str.size());
 }
 
 void TextContext::DrawString( const std::string& str )
 {
-    SetRenderState();
-
-    void* stackMem = _malloca((str.size() + 1) * 16);
-    TextVert* vbPtr = Math::AlignUp((TextVert*)stackMem, 16);
-    UINT primCount = FillVertexBuffer(vbPtr, (char*)str.c_str(), 1, str.size());
-
-    if (primCount > 0)
-    {
-        m_Context.SetDynamicVB(0, primCount, sizeof(TextVert), vbPtr);
-        m_Context.DrawInstanced( 4, primCount );
-    }
-
-    _freea(stackMem);
+    AppendText(str.c_str(), 1, str.size());
 }
 
 void TextContext::DrawFormattedString( const wchar_t* format, ... )
@@ -16,6 +16,7 @@
 #include "Color.h"
 #include "Math/Vector.h"
 #include <string>
+#include <vector>
 
 class Color;
 class GraphicsContext;
@@ -37,6 +38,7 @@ class TextContext
 {
 public:
     TextContext( GraphicsContext& CmdContext, float CanvasWidth = 1920.0f, float CanvasHeight = 1080.0f );
+    ~TextContext();
 
     GraphicsContext& GetCommandContext() const { return m_Context; }
 
@@ -47,7 +49,8 @@ public:
     // Control various text properties
     //
 
-    // Choose a font from the Fonts folder.  Previously loaded fonts are cached in memory.
+    // Choose a font from the Fonts folder.  Previously loaded fonts are cached in memory.  Fonts load in the
+    // background, and text is drawn with the default font until the requested one is ready.
     void SetFont( const std::wstring& fontName, float TextSize = 0.0f );
 
     // Resize the view space.  This determines the coordinate space of the cursor position and font size.  You can always
@@ -90,6 +93,12 @@ public:
     void Begin( bool EnableHDR = false );
     void End( void );
 
+    // Text is batched into as few draws as possible, and each glyph carries its own color and size.  Only
+    // changing the font, the shadow settings or the view size starts a new draw.  Nothing is drawn until End()
+    // or Flush(), so call Flush() before changing the command context's state (scissor, viewport, PSO) between
+    // strings.
+    void Flush( void );
+
     // Draw a string
     void DrawString( const std::wstring& str );
     void DrawString( const std::string& str );
@@ -104,40 +113,38 @@ private:
     __declspec(align(16)) struct VertexShaderParams
     {
         Math::Vector4 ViewportTransform;
-        float NormalizeX, NormalizeY, TextSize;
-        float Scale, DstBorder;
+        float NormalizeX, NormalizeY;
+        float FontHeight;			// Texel height of the font in 12.4 fixed point
+        float AntialiasRange;		// Signed distance range per unit of text size
         uint32_t SrcBorder;
     };
 
     __declspec(align(16)) struct PixelShaderParams
     {
-        Color TextColor;
         float ShadowOffsetX, ShadowOffsetY;
         float ShadowHardness;		// More than 1 will cause aliasing
         float ShadowOpacity;		// Should make less opaque when making softer
-        float HeightRange;
     };
 
-    void SetRenderState(void);
-
-    // 16 Byte structure to represent an entire glyph in the text vertex buffer
-    __declspec(align(16)) struct TextVert
+    // 24 byte structure to represent an entire glyph in the text vertex buffer
+    struct TextVert
     {
         float X, Y;				// Upper-left glyph position in screen space
         uint16_t U, V, W, H;	// Upper-left glyph UV and the width in texture space
+        float Size;				// Height of the text in screen space
+        uint32_t Color;			// R8G8B8A8_UNORM
     };
 
-    UINT FillVertexBuffer( TextVert volatile* verts, const char* str, size_t stride, size_t slen );
-    void DrawStringInternal( const std::string& str );
-    void DrawStringInternal( const std::wstring& str );
+    void AppendText( const char* str, size_t stride, size_t slen );
+    void UpdateFontParams( void );
 
     GraphicsContext& m_Context;
     const TextRenderer::Font* m_CurrentFont;
     VertexShaderParams m_VSParams;
     PixelShaderParams m_PSParams;
-    bool m_VSConstantBufferIsStale;	// Tracks when the CB needs updating
-    bool m_PSConstantBufferIsStale;	// Tracks when the CB needs updating
-    bool m_TextureIsStale;
+    std::vector<TextVert> m_Batch;	// Glyphs waiting for Flush()
+    uint32_t m_TextColor;
+    float m_TextSize;
     bool m_EnableShadow;
     float m_LeftMargin;
     float m_TextPosX;
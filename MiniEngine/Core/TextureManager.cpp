@@ -18,8 +18,14 @@
 #include "DDSTextureLoader.h"
 #include "GraphicsCore.h"
 #include "CommandContext.h"
+#include "SystemTime.h"
+#include "PixelConversion.h"
+#include "TexturePackage.h"
 #include <map>
 #include <thread>
+#include <queue>
+#include <condition_variable>
+#include <algorithm>
 
 using namespace std;
 using namespace Graphics;
@@ -29,7 +35,7 @@ static UINT BytesPerPixel( DXGI_FORMAT Format )
     return (UINT)BitsPerPixel(Format) / 8;
 };
 
-void Texture::Create( size_t Pitch, size_t Width, size_t Height, DXGI_FORMAT Format, const void* InitialData )
+void Texture::CreateResource( size_t Width, size_t Height, DXGI_FORMAT Format, uint32_t MipLevels )
 {
     m_UsageState = D3D12_RESOURCE_STATE_COPY_DEST;
 
@@ -38,7 +44,7 @@ void Texture::Create( size_t Pitch, size_t Width, size_t Height, DXGI_FORMAT For
     texDesc.Width = Width;
     texDesc.Height = (UINT)Height;
     texDesc.DepthOrArraySize = 1;
-    texDesc.MipLevels = 1;
+    texDesc.MipLevels = (UINT16)MipLevels;
     texDesc.Format = Format;
     texDesc.SampleDesc.Count = 1;
     texDesc.SampleDesc.Quality = 0;
@@ -56,69 +62,67 @@ void Texture::Create( size_t Pitch, size_t Width, size_t Height, DXGI_FORMAT For
         m_UsageState, nullptr, MY_IID_PPV_ARGS(m_pResource.ReleaseAndGetAddressOf())));
 
     m_pResource->SetName(L"Texture");
+}
 
-    D3D12_SUBRESOURCE_DATA texResource;
-    texResource.pData = InitialData;
-    texResource.RowPitch = Pitch * BytesPerPixel(Format);
-    texResource.SlicePitch = texResource.RowPitch * Height;
-
-    CommandContext::InitializeTexture(*this, 1, &texResource);
-
+void Texture::CreateSRV( void )
+{
     if (m_hCpuDescriptorHandle.ptr == D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN)
         m_hCpuDescriptorHandle = AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
     g_Device->CreateShaderResourceView(m_pResource.Get(), nullptr, m_hCpuDescriptorHandle);
 }
 
-void Texture::CreateTGAFromMemory( const void* _filePtr, size_t, bool sRGB )
+void Texture::Create( size_t Pitch, size_t Width, size_t Height, DXGI_FORMAT Format, const void* InitialData )
 {
-    const uint8_t* filePtr = (const uint8_t*)_filePtr;
+    CreateResource(Width, Height, Format);
 
-    // Skip first two bytes
-    filePtr += 2;
+    D3D12_SUBRESOURCE_DATA texResource;
+    texResource.pData = InitialData;
+    texResource.RowPitch = Pitch * BytesPerPixel(Format);
+    texResource.SlicePitch = texResource.RowPitch * Height;
 
-    /*uint8_t imageTypeCode =*/ *filePtr++;
+    CommandContext::InitializeTexture(*this, 1, &texResource);
 
-    // Ignore another 9 bytes
-    filePtr += 9;
+    CreateSRV();
+}
 
-    uint16_t imageWidth = *(uint16_t*)filePtr;
-    filePtr += sizeof(uint16_t);
-    uint16_t imageHeight = *(uint16_t*)filePtr;
-    filePtr += sizeof(uint16_t);
-    uint8_t bitCount = *filePtr++;
+void Texture::Create( size_t Width, size_t Height, DXGI_FORMAT Format, const std::function<void (void*, size_t)>& Fill )
+{
+    CreateResource(Width, Height, Format);
+    CommandContext::InitializeTexture(*this, Fill);
+    CreateSRV();
+}
 
-    // Ignore another byte
-    filePtr++;
+bool Texture::CreateTGAFromMemory( const void* filePtr, size_t fileSize, bool sRGB )
+{
+    // Descriptors are never freed, so the whole file is validated before the texture is created
+    PixelConversion::TGAImage image;
+    if (!PixelConversion::ParseTGA(filePtr, fileSize, image))
+        return false;
+
+    // Pixels are converted straight into the upload heap
+    bool decoded = true;
+    Create( image.Width, image.Height, sRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM,
+        [&]( void* texels, size_t rowPitch )
+    {
+        decoded = PixelConversion::DecodeTGA(image, texels, rowPitch);
+    });
 
-    uint32_t* formattedData = new uint32_t[imageWidth * imageHeight];
-    uint32_t* iter = formattedData;
+    return decoded;
+}
 
-    uint8_t numChannels = bitCount / 8;
-    uint32_t numBytes = imageWidth * imageHeight * numChannels;
+bool Texture::CreateDDSFromMipRange( const void* headerData, size_t headerSize, const void* mipData, size_t mipDataSize,
+    uint32_t firstMip, bool sRGB )
+{
+    if (m_hCpuDescriptorHandle.ptr == D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN)
+        m_hCpuDescriptorHandle = AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
-    switch (numChannels)
-    {
-    default:
-        break;
-    case 3:
-        for (uint32_t byteIdx = 0; byteIdx < numBytes; byteIdx += 3)
-        {
-            *iter++ = 0xff000000 | filePtr[0] << 16 | filePtr[1] << 8 | filePtr[2];
-            filePtr += 3;
-        }
-        break;
-    case 4:
-        for (uint32_t byteIdx = 0; byteIdx < numBytes; byteIdx += 4)
-        {
-            *iter++ = filePtr[3] << 24 | filePtr[0] << 16 | filePtr[1] << 8 | filePtr[2];
-            filePtr += 4;
-        }
-        break;
-    }
+    HRESULT hr = CreateDDSTextureFromMipRange( Graphics::g_Device, (const uint8_t*)headerData, headerSize,
+        (const uint8_t*)mipData, mipDataSize, firstMip, sRGB, &m_pResource, m_hCpuDescriptorHandle );
 
-    Create( imageWidth, imageHeight, sRGB ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM, formattedData );
+    if (SUCCEEDED(hr))
+        m_UsageState = D3D12_RESOURCE_STATE_GENERIC_READ;
 
-    delete [] formattedData;
+    return SUCCEEDED(hr);
 }
 
 bool Texture::CreateDDSFromMemory( const void* filePtr, size_t fileSize, bool sRGB )
@@ -149,6 +153,23 @@ void Texture::CreatePIXImageFromMemory( const void* memBuffer, size_t fileSize )
     Create(header.Pitch, header.Width, header.Height, header.Format, (uint8_t*)memBuffer + sizeof(Header));
 }
 
+void Texture::CreateFromFootprints( CommandContext& Context, GpuResource& Upload, size_t UploadOffset, size_t Width,
+    size_t Height, uint32_t MipCount, DXGI_FORMAT Format, const D3D12_PLACED_SUBRESOURCE_FOOTPRINT* Footprints )
+{
+    CreateResource(Width, Height, Format, MipCount);
+
+    for (uint32_t Mip = 0; Mip < MipCount; ++Mip)
+    {
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT Footprint = Footprints[Mip];
+        Footprint.Offset += UploadOffset;
+        Context.CopyTextureRegion(*this, Mip, Upload, Footprint);
+    }
+
+    Context.TransitionResource(*this, D3D12_RESOURCE_STATE_GENERIC_READ);
+
+    CreateSRV();
+}
+
 namespace TextureManager
 {
     wstring s_RootPath = L"";
@@ -159,15 +180,20 @@ namespace TextureManager
         s_RootPath = TextureLibRoot;
     }
 
+    void ReleaseStreamingResources( void );
+
     void Shutdown( void )
     {
+        StopStreaming();
+        ReleaseStreamingResources();
         s_TextureCache.clear();
     }
 
+    mutex s_CacheMutex;
+
     pair<ManagedTexture*, bool> FindOrLoadTexture( const wstring& fileName )
     {
-        static mutex s_Mutex;
-        lock_guard<mutex> Guard(s_Mutex);
+        lock_guard<mutex> Guard(s_CacheMutex);
 
         auto iter = s_TextureCache.find(fileName);
 
@@ -182,6 +208,13 @@ namespace TextureManager
         return make_pair(NewTexture, true);
     }
 
+    // Packaged textures are in the cache without a file of their own
+    bool IsCached( const wstring& fileName )
+    {
+        lock_guard<mutex> Guard(s_CacheMutex);
+        return s_TextureCache.find(fileName) != s_TextureCache.end();
+    }
+
     const Texture& GetBlackTex2D(void)
     {
         auto ManagedTex = FindOrLoadTexture(L"DefaultBlackTexture");
@@ -238,8 +271,676 @@ namespace TextureManager
 
 } // namespace TextureManager
 
+//
+// Asynchronous texture streaming
+//
+// One I/O thread reads files in priority order into a bounded set of buffers.  Decode workers turn
+// those buffers into GPU textures.  Finished textures are published on the rendering thread by
+// TextureManager::Update() so that descriptors are never rewritten while a frame is reading them.
+// The exception is a texture somebody is blocked on in WaitForLoad(), which is published right away.
+//
+
+namespace TextureManager
+{
+    struct StreamRequest
+    {
+        ManagedTexture* Target;
+        wstring FilePath;
+        bool IsDDS;
+        bool sRGB;
+        bool Dispatched;
+        bool Finished;
+        int64_t RequestTick;
+        Utility::ByteArray FileData;
+        unique_ptr<ManagedTexture> LoadedTexture;
+
+        // Progressive DDS loads read only the mips from FirstMip down
+        bool IsRefinement;
+        uint32_t FirstMip;
+        Utility::ByteArray HeaderData;
+        DDS_MIP_LAYOUT Layout;
+        Microsoft::WRL::ComPtr<ID3D12Resource> LoadedResource;
+    };
+
+    // A texture that was loaded progressively and the part of its mip chain that is resident
+    struct ProgressiveTexture
+    {
+        ManagedTexture* Texture;
+        wstring FilePath;
+        bool sRGB;
+        Utility::ByteArray HeaderData;
+        DDS_MIP_LAYOUT Layout;
+        uint32_t TailMip;			// Most detailed mip loaded up front
+        uint32_t ResidentMip;		// Most detailed mip on the GPU
+        uint32_t RequiredMip;		// Most detailed mip requested in LastNeededFrame
+        uint64_t LastNeededFrame;
+        bool RefinementPending;
+    };
+
+    struct RetiredResource
+    {
+        uint64_t FenceValue;
+        Microsoft::WRL::ComPtr<ID3D12Resource> Resource;
+    };
+
+    struct QueueEntry
+    {
+        LoadPriority Priority;
+        uint64_t Sequence;
+        StreamRequest* Request;
+
+        // priority_queue pops the largest element, so "less than" means "load later"
+        bool operator<( const QueueEntry& rhs ) const
+        {
+            return Priority != rhs.Priority ? Priority > rhs.Priority : Sequence > rhs.Sequence;
+        }
+    };
+
+    // Bounds the memory held by files that have been read but not yet decoded
+    const size_t kMaxBufferedFiles = 8;
+
+    mutex s_StreamMutex;
+    condition_variable s_ReadCV;		// Signals the I/O thread: request queued or buffer space freed
+    condition_variable s_DecodeCV;		// Signals decode workers: file data ready
+    condition_variable s_FinishedCV;	// Signals waiters: a request finished decoding
+
+    priority_queue<QueueEntry> s_ReadQueue;
+    deque<StreamRequest*> s_DecodeQueue;
+    vector<StreamRequest*> s_FinishedRequests;
+    map<const ManagedTexture*, StreamRequest*> s_ActiveRequests;
+    uint64_t s_NextSequence = 0;
+    uint32_t s_QueuedCount = 0;
+    bool s_StopStreaming = false;
+
+    vector<thread> s_StreamingThreads;
+
+    uint32_t s_CompletedLoads = 0;
+    uint32_t s_FailedLoads = 0;
+    double s_TotalLatencyMs = 0.0;
+    float s_MaxLatencyMs = 0.0f;
+
+    BoolVar ProgressiveLoading("Texture Streaming/Progressive Mips", true);
+    IntVar InitialMipSize("Texture Streaming/Initial Mip Size", 64, 1, 4096, 16);
+    NumVar ResidencyBudgetMB("Texture Streaming/Budget (MB)", 1024.0f, 16.0f, 16384.0f, 64.0f);
+    NumVar DetailBias("Texture Streaming/Detail Bias", 0.0f, -4.0f, 4.0f, 0.5f);
+
+    map<const ManagedTexture*, ProgressiveTexture> s_ProgressiveTextures;
+    deque<RetiredResource> s_RetiredResources;
+    uint64_t s_ResidencyFrame = 1;
+    uint64_t s_ProgressiveBytes = 0;
+    uint64_t s_PendingRefinementBytes = 0;
+    uint32_t s_EvictedTextures = 0;
+
+    // Bytes of mips from Mip down.  Mip == mipCount means nothing is resident.
+    uint64_t MipChainBytes( const DDS_MIP_LAYOUT& Layout, uint32_t Mip )
+    {
+        return Mip < Layout.mipCount ? Layout.fileSize - Layout.mipOffset[Mip] : 0;
+    }
+
+    uint32_t FindTailMip( const DDS_MIP_LAYOUT& Layout )
+    {
+        uint32_t Mip = 0;
+        while (Mip < Layout.maxFirstMip && max(Layout.width >> Mip, Layout.height >> Mip) > (uint32_t)InitialMipSize)
+            ++Mip;
+        return Mip;
+    }
+
+    // Reads the part of the file the request needs.  DDS files with a mip chain are read progressively:
+    // just the headers first, then the range holding the requested mips.
+    void ReadRequestData( StreamRequest* Request )
+    {
+        if (Request->IsDDS && Request->HeaderData == nullptr && ProgressiveLoading)
+        {
+            Utility::ByteArray Header = Utility::ReadFileRangeSync(Request->FilePath, 0, DDS_MAX_HEADER_SIZE);
+            if (Header->size() > 0 && SUCCEEDED(GetDDSMipLayout(Header->data(), Header->size(), &Request->Layout))
+                && Request->Layout.maxFirstMip > 0)
+            {
+                Request->HeaderData = Header;
+                Request->FirstMip = FindTailMip(Request->Layout);
+            }
+        }
+
+        if (Request->HeaderData != nullptr)
+        {
+            const size_t Offset = Request->Layout.mipOffset[Request->FirstMip];
+            Request->FileData = Utility::ReadFileRangeSync(Request->FilePath, Offset, Request->Layout.fileSize - Offset);
+        }
+        else
+        {
+            Request->FileData = Utility::ReadFileSync(Request->FilePath);
+        }
+    }
+
+    // The old resource may still be referenced by frames in flight
+    void RetireResource( ID3D12Resource* Resource )
+    {
+        RetiredResource Retired = { g_CommandManager.GetGraphicsQueue().GetNextFenceValue(), Resource };
+        s_RetiredResources.push_back(Retired);
+    }
+
+    void SetResidentMip( ProgressiveTexture& Progressive, uint32_t Mip )
+    {
+        s_ProgressiveBytes -= MipChainBytes(Progressive.Layout, Progressive.ResidentMip);
+        s_ProgressiveBytes += MipChainBytes(Progressive.Layout, Mip);
+        Progressive.ResidentMip = Mip;
+    }
+
+    bool FileExists( const wstring& fileName )
+    {
+        // ReadFileSync() also accepts a gzipped copy of the file
+        return GetFileAttributesW(fileName.c_str()) != INVALID_FILE_ATTRIBUTES ||
+            GetFileAttributesW((fileName + L".gz").c_str()) != INVALID_FILE_ATTRIBUTES;
+    }
+
+    void IOThreadMain( void )
+    {
+        for (;;)
+        {
+            StreamRequest* Request = nullptr;
+            {
+                unique_lock<mutex> Lock(s_StreamMutex);
+                s_ReadCV.wait(Lock, []{ return s_StopStreaming ||
+                    (!s_ReadQueue.empty() && s_DecodeQueue.size() < kMaxBufferedFiles); });
+
+                if (s_StopStreaming)
+                    return;
+
+                Request = s_ReadQueue.top().Request;
+                s_ReadQueue.pop();
+
+                // A request can be queued more than once when its priority is raised
+                if (Request->Dispatched)
+                    continue;
+
+                Request->Dispatched = true;
+                --s_QueuedCount;
+            }
+
+            ReadRequestData(Request);
+
+            lock_guard<mutex> Lock(s_StreamMutex);
+            s_DecodeQueue.push_back(Request);
+            s_DecodeCV.notify_one();
+        }
+    }
+
+    void DecodeThreadMain( void )
+    {
+        // Progressive loads need an SRV to create the resource.  The managed texture's own SRV is
+        // rebuilt when the resource is published.
+        D3D12_CPU_DESCRIPTOR_HANDLE ScratchSRV = AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+        for (;;)
+        {
+            StreamRequest* Request = nullptr;
+            {
+                unique_lock<mutex> Lock(s_StreamMutex);
+                s_DecodeCV.wait(Lock, []{ return s_StopStreaming || !s_DecodeQueue.empty(); });
+
+                if (s_StopStreaming)
+                    return;
+
+                Request = s_DecodeQueue.front();
+                s_DecodeQueue.pop_front();
+                s_ReadCV.notify_one();
+            }
+
+            const Utility::ByteArray& Data = Request->FileData;
+            bool Succeeded = Data->size() > 0;
+
+            unique_ptr<ManagedTexture> Loaded;
+            Microsoft::WRL::ComPtr<ID3D12Resource> LoadedResource;
+
+            if (Succeeded && Request->HeaderData != nullptr)
+            {
+                const Utility::ByteArray& Header = Request->HeaderData;
+                Succeeded = SUCCEEDED(CreateDDSTextureFromMipRange(g_Device, Header->data(), Header->size(),
+                    Data->data(), Data->size(), Request->FirstMip, Request->sRGB, &LoadedResource, ScratchSRV));
+
+                if (Succeeded)
+                    LoadedResource->SetName(Request->FilePath.c_str());
+            }
+            else if (Succeeded)
+            {
+                // The loaded texture gets its own descriptor.  It is copied over the placeholder on publish.
+                Loaded.reset(new ManagedTexture(Request->FilePath));
+
+                if (Request->IsDDS)
+                    Succeeded = Loaded->CreateDDSFromMemory(Data->data(), Data->size(), Request->sRGB);
+                else
+                    Succeeded = Loaded->CreateTGAFromMemory(Data->data(), Data->size(), Request->sRGB);
+
+                if (Succeeded)
+                    Loaded->GetResource()->SetName(Request->FilePath.c_str());
+            }
+
+            lock_guard<mutex> Lock(s_StreamMutex);
+            Request->FileData = nullptr;
+            if (Succeeded)
+            {
+                Request->LoadedTexture = move(Loaded);
+                Request->LoadedResource = LoadedResource;
+            }
+            Request->Finished = true;
+            s_FinishedRequests.push_back(Request);
+            s_FinishedCV.notify_all();
+        }
+    }
+
+    void StartStreaming( void )
+    {
+        if (!s_StreamingThreads.empty())
+            return;
+
+        s_StopStreaming = false;
+        s_StreamingThreads.emplace_back(IOThreadMain);
+
+        const uint32_t NumDecoders = min(4u, max(1u, thread::hardware_concurrency() / 2));
+        for (uint32_t i = 0; i < NumDecoders; ++i)
+            s_StreamingThreads.emplace_back(DecodeThreadMain);
+    }
+
+    // Called with s_StreamMutex held
+    void QueueRequest( StreamRequest* Request, LoadPriority Priority )
+    {
+        QueueEntry Entry = { Priority, s_NextSequence++, Request };
+        s_ReadQueue.push(Entry);
+        s_ReadCV.notify_one();
+    }
+
+    // Called with s_StreamMutex held
+    void PublishRefinement( StreamRequest* Request )
+    {
+        ProgressiveTexture& Progressive = s_ProgressiveTextures[Request->Target];
+        Progressive.RefinementPending = false;
+        s_PendingRefinementBytes -= MipChainBytes(Progressive.Layout, Request->FirstMip) -
+            MipChainBytes(Progressive.Layout, Progressive.ResidentMip);
+
+        // A failed refinement leaves the lower mips in place
+        if (Request->LoadedResource != nullptr)
+        {
+            RetireResource(Request->Target->GetResource());
+            Request->Target->ReplaceResource(Request->LoadedResource.Get(), D3D12_RESOURCE_STATE_GENERIC_READ);
+            SetResidentMip(Progressive, Request->FirstMip);
+        }
+
+        s_ActiveRequests.erase(Request->Target);
+        delete Request;
+    }
+
+    // Called with s_StreamMutex held
+    void PublishRequest( StreamRequest* Request )
+    {
+        if (Request->IsRefinement)
+        {
+            PublishRefinement(Request);
+            return;
+        }
+
+        if (Request->LoadedResource != nullptr)
+        {
+            Request->Target->ReplaceResource(Request->LoadedResource.Get(), D3D12_RESOURCE_STATE_GENERIC_READ);
+            ++s_CompletedLoads;
+
+            ProgressiveTexture& Progressive = s_ProgressiveTextures[Request->Target];
+            Progressive.Texture = Request->Target;
+            Progressive.FilePath = Request->FilePath;
+            Progressive.sRGB = Request->sRGB;
+            Progressive.HeaderData = Request->HeaderData;
+            Progressive.Layout = Request->Layout;
+            Progressive.TailMip = Request->FirstMip;
+            Progressive.ResidentMip = Request->Layout.mipCount;
+            Progressive.RequiredMip = Request->FirstMip;
+            Progressive.LastNeededFrame = 0;
+            Progressive.RefinementPending = false;
+            SetResidentMip(Progressive, Request->FirstMip);
+        }
+        else if (Request->LoadedTexture)
+        {
+            Request->Target->FinishStreaming(*Request->LoadedTexture);
+            ++s_CompletedLoads;
+        }
+        else
+        {
+            Request->Target->FailStreaming();
+            ++s_FailedLoads;
+        }
+
+        float LatencyMs = (float)SystemTime::TicksToMillisecs(SystemTime::GetCurrentTick() - Request->RequestTick);
+        s_TotalLatencyMs += LatencyMs;
+        s_MaxLatencyMs = max(s_MaxLatencyMs, LatencyMs);
+
+        s_ActiveRequests.erase(Request->Target);
+        delete Request;
+    }
+
+    // Waits until the texture has been decoded and publishes it without waiting for the next Update().  The
+    // caller needs the resource now, so this is the one place a texture is published off the rendering thread.
+    // The request is looked up again after every wake-up because Update() may publish and free it meanwhile.
+    void WaitForStreamingTexture( const ManagedTexture* Texture )
+    {
+        unique_lock<mutex> Lock(s_StreamMutex);
+
+        auto iter = s_ActiveRequests.find(Texture);
+        if (iter == s_ActiveRequests.end())
+            return;
+
+        // Somebody is blocked on this texture, so move it to the front of the line
+        if (!iter->second->Dispatched)
+            QueueRequest(iter->second, kPriorityVisible);
+
+        s_FinishedCV.wait(Lock, [=]
+        {
+            auto Active = s_ActiveRequests.find(Texture);
+            return Active == s_ActiveRequests.end() || Active->second->Finished || s_StopStreaming;
+        });
+
+        iter = s_ActiveRequests.find(Texture);
+        if (iter == s_ActiveRequests.end() || !iter->second->Finished)
+            return;
+
+        StreamRequest* Request = iter->second;
+        s_FinishedRequests.erase(find(s_FinishedRequests.begin(), s_FinishedRequests.end(), Request));
+        PublishRequest(Request);
+    }
+
+    const ManagedTexture* LoadFromFileAsync( const wstring& fileName, bool sRGB,
+        const Texture& Placeholder, LoadPriority Priority )
+    {
+        // Pick the file format up front so that callers can fall back on a missing file immediately
+        wstring ResolvedName = fileName + L".dds";
+        bool IsDDS = IsCached(ResolvedName) || FileExists(s_RootPath + ResolvedName);
+        if (!IsDDS)
+            ResolvedName = fileName + L".tga";
+
+        auto ManagedTex = FindOrLoadTexture(ResolvedName);
+
+        ManagedTexture* ManTex = ManagedTex.first;
+        const bool RequestsLoad = ManagedTex.second;
+
+        if (!RequestsLoad)
+        {
+            // Already loaded or in flight.  Raise its priority if it is still waiting for I/O.
+            lock_guard<mutex> Lock(s_StreamMutex);
+            auto iter = s_ActiveRequests.find(ManTex);
+            if (iter != s_ActiveRequests.end() && !iter->second->Dispatched)
+                QueueRequest(iter->second, Priority);
+            return ManTex;
+        }
+
+        if (!IsDDS && !FileExists(s_RootPath + ResolvedName))
+        {
+            ManTex->SetToInvalidTexture();
+            return ManTex;
+        }
+
+        ManTex->BeginStreaming(Placeholder);
+
+        StreamRequest* Request = new StreamRequest;
+        Request->Target = ManTex;
+        Request->FilePath = s_RootPath + ResolvedName;
+        Request->IsDDS = IsDDS;
+        Request->sRGB = sRGB;
+        Request->Dispatched = false;
+        Request->Finished = false;
+        Request->RequestTick = SystemTime::GetCurrentTick();
+        Request->IsRefinement = false;
+        Request->FirstMip = 0;
+
+        lock_guard<mutex> Lock(s_StreamMutex);
+        StartStreaming();
+        s_ActiveRequests[ManTex] = Request;
+        ++s_QueuedCount;
+        QueueRequest(Request, Priority);
+
+        return ManTex;
+    }
+
+    // Copies the texture into a smaller resource without the mips above NewMip.  Called with s_StreamMutex held.
+    void EvictMips( ProgressiveTexture& Progressive, uint32_t NewMip )
+    {
+        ASSERT(NewMip <= Progressive.Layout.maxFirstMip, "Block-compressed mip chains cannot start below a block-aligned mip");
+
+        ManagedTexture& Texture = *Progressive.Texture;
+        const uint32_t DroppedMips = NewMip - Progressive.ResidentMip;
+
+        D3D12_RESOURCE_DESC Desc = Texture.GetResource()->GetDesc();
+        Desc.Width = max<UINT64>(Desc.Width >> DroppedMips, 1);
+        Desc.Height = max<UINT>(Desc.Height >> DroppedMips, 1);
+        Desc.MipLevels -= (UINT16)DroppedMips;
+
+        D3D12_HEAP_PROPERTIES HeapProps;
+        HeapProps.Type = D3D12_HEAP_TYPE_DEFAULT;
+        HeapProps.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+        HeapProps.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+        HeapProps.CreationNodeMask = 1;
+        HeapProps.VisibleNodeMask = 1;
+
+        Microsoft::WRL::ComPtr<ID3D12Resource> Reduced;
+        ASSERT_SUCCEEDED(g_Device->CreateCommittedResource(&HeapProps, D3D12_HEAP_FLAG_NONE, &Desc,
+            D3D12_RESOURCE_STATE_COPY_DEST, nullptr, MY_IID_PPV_ARGS(Reduced.GetAddressOf())));
+        Reduced->SetName(Progressive.FilePath.c_str());
+
+        GpuResource Dest(Reduced.Get(), D3D12_RESOURCE_STATE_COPY_DEST);
+
+        CommandContext& Context = CommandContext::Begin(L"Evict Texture Mips");
+        Context.TransitionResource(Texture, D3D12_RESOURCE_STATE_COPY_SOURCE);
+        for (UINT Mip = 0; Mip < Desc.MipLevels; ++Mip)
+            Context.CopySubresource(Dest, Mip, Texture, Mip + DroppedMips);
+        Context.TransitionResource(Dest, D3D12_RESOURCE_STATE_GENERIC_READ);
+        Context.Finish();
+
+        RetireResource(Texture.GetResource());
+        Texture.ReplaceResource(Reduced.Get(), D3D12_RESOURCE_STATE_GENERIC_READ);
+        SetResidentMip(Progressive, NewMip);
+        ++s_EvictedTextures;
+    }
+
+    // Called with s_StreamMutex held
+    void UpdateResidency( void )
+    {
+        const uint64_t Budget = (uint64_t)(ResidencyBudgetMB * 1024.0f * 1024.0f);
+        const uint64_t CurrentFrame = s_ResidencyFrame;
+
+        // Drop the top mips of the least recently needed textures until back under budget.  Textures that
+        // were not drawn last frame fall back to their tail.  Those that were keep what they still need.
+        if (s_ProgressiveBytes + s_PendingRefinementBytes > Budget)
+        {
+            vector<ProgressiveTexture*> Candidates;
+            for (auto& Entry : s_ProgressiveTextures)
+            {
+                ProgressiveTexture& Progressive = Entry.second;
+                if (!Progressive.RefinementPending && Progressive.ResidentMip < Progressive.TailMip)
+                    Candidates.push_back(&Progressive);
+            }
+
+            sort(Candidates.begin(), Candidates.end(), []( const ProgressiveTexture* a, const ProgressiveTexture* b )
+                { return a->LastNeededFrame < b->LastNeededFrame; });
+
+            for (ProgressiveTexture* Progressive : Candidates)
+            {
+                if (s_ProgressiveBytes + s_PendingRefinementBytes <= Budget)
+                    break;
+
+                uint32_t NewMip = Progressive->TailMip;
+                if (Progressive->LastNeededFrame == CurrentFrame)
+                    NewMip = min(NewMip, Progressive->RequiredMip);
+
+                if (NewMip > Progressive->ResidentMip)
+                    EvictMips(*Progressive, NewMip);
+            }
+        }
+
+        // Queue refinements for textures drawn last frame with too little detail, as long as they fit
+        for (auto& Entry : s_ProgressiveTextures)
+        {
+            ProgressiveTexture& Progressive = Entry.second;
+            if (Progressive.LastNeededFrame != CurrentFrame || Progressive.RefinementPending ||
+                Progressive.RequiredMip >= Progressive.ResidentMip)
+                continue;
+
+            const uint64_t AddedBytes = MipChainBytes(Progressive.Layout, Progressive.RequiredMip) -
+                MipChainBytes(Progressive.Layout, Progressive.ResidentMip);
+            if (s_ProgressiveBytes + s_PendingRefinementBytes + AddedBytes > Budget)
+                continue;
+
+            StreamRequest* Request = new StreamRequest;
+            Request->Target = Progressive.Texture;
+            Request->FilePath = Progressive.FilePath;
+            Request->IsDDS = true;
+            Request->sRGB = Progressive.sRGB;
+            Request->Dispatched = false;
+            Request->Finished = false;
+            Request->RequestTick = SystemTime::GetCurrentTick();
+            Request->IsRefinement = true;
+            Request->FirstMip = Progressive.RequiredMip;
+            Request->HeaderData = Progressive.HeaderData;
+            Request->Layout = Progressive.Layout;
+
+            Progressive.RefinementPending = true;
+            s_PendingRefinementBytes += AddedBytes;
+            s_ActiveRequests[Progressive.Texture] = Request;
+            ++s_QueuedCount;
+            QueueRequest(Request, kPriorityVisible);
+        }
+
+        ++s_ResidencyFrame;
+    }
+
+    void Update( void )
+    {
+        lock_guard<mutex> Lock(s_StreamMutex);
+
+        for (StreamRequest* Request : s_FinishedRequests)
+            PublishRequest(Request);
+
+        s_FinishedRequests.clear();
+
+        if (!s_StopStreaming)
+            UpdateResidency();
+
+        while (!s_RetiredResources.empty() &&
+            g_CommandManager.IsFenceComplete(s_RetiredResources.front().FenceValue))
+        {
+            s_RetiredResources.pop_front();
+        }
+    }
+
+    void RequestTextureDetail( const ManagedTexture* Texture, float ScreenSize )
+    {
+        lock_guard<mutex> Lock(s_StreamMutex);
+
+        auto iter = s_ProgressiveTextures.find(Texture);
+        if (iter == s_ProgressiveTextures.end())
+            return;
+
+        ProgressiveTexture& Progressive = iter->second;
+        const DDS_MIP_LAYOUT& Layout = Progressive.Layout;
+
+        // One texel per pixel
+        float Mip = log2f((float)max(Layout.width, Layout.height) / max(ScreenSize, 1.0f)) + DetailBias;
+        uint32_t RequiredMip = (uint32_t)min(max(floorf(Mip), 0.0f), (float)Layout.maxFirstMip);
+
+        if (Progressive.LastNeededFrame != s_ResidencyFrame)
+        {
+            Progressive.LastNeededFrame = s_ResidencyFrame;
+            Progressive.RequiredMip = RequiredMip;
+        }
+        else
+        {
+            Progressive.RequiredMip = min(Progressive.RequiredMip, RequiredMip);
+        }
+    }
+
+    // Called after the GPU is idle
+    void ReleaseStreamingResources( void )
+    {
+        s_RetiredResources.clear();
+        s_ProgressiveTextures.clear();
+        s_ProgressiveBytes = 0;
+        s_PendingRefinementBytes = 0;
+    }
+
+    void StopStreaming( void )
+    {
+        {
+            lock_guard<mutex> Lock(s_StreamMutex);
+            s_StopStreaming = true;
+            s_ReadCV.notify_all();
+            s_DecodeCV.notify_all();
+            s_FinishedCV.notify_all();
+        }
+
+        for (thread& Thread : s_StreamingThreads)
+            Thread.join();
+        s_StreamingThreads.clear();
+
+        // Whatever did not finish keeps its placeholder
+        for (auto& Active : s_ActiveRequests)
+            delete Active.second;
+        s_ActiveRequests.clear();
+        s_FinishedRequests.clear();
+        s_DecodeQueue.clear();
+        s_ReadQueue = priority_queue<QueueEntry>();
+        s_QueuedCount = 0;
+    }
+
+    void GetStreamingStats( StreamingStats& Stats )
+    {
+        lock_guard<mutex> Lock(s_StreamMutex);
+
+        const uint32_t NumPublished = s_CompletedLoads + s_FailedLoads;
+        Stats.QueuedRequests = s_QueuedCount;
+        Stats.PendingDecodes = (uint32_t)s_ActiveRequests.size() - s_QueuedCount;
+        Stats.CompletedLoads = s_CompletedLoads;
+        Stats.FailedLoads = s_FailedLoads;
+        Stats.AverageLatencyMs = NumPublished == 0 ? 0.0f : (float)(s_TotalLatencyMs / NumPublished);
+        Stats.MaxLatencyMs = s_MaxLatencyMs;
+        Stats.ProgressiveTextures = (uint32_t)s_ProgressiveTextures.size();
+        Stats.ProgressiveBytes = s_ProgressiveBytes;
+        Stats.EvictedTextures = s_EvictedTextures;
+    }
+
+} // namespace TextureManager
+
+void ManagedTexture::BeginStreaming( const Texture& Placeholder )
+{
+    m_IsStreaming = true;
+    m_hCpuDescriptorHandle = AllocateDescriptor(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    g_Device->CopyDescriptorsSimple(1, m_hCpuDescriptorHandle, Placeholder.GetSRV(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+void ManagedTexture::FinishStreaming( ManagedTexture& LoadedTexture )
+{
+    m_pResource = LoadedTexture.m_pResource;
+    m_UsageState = LoadedTexture.m_UsageState;
+    g_Device->CopyDescriptorsSimple(1, m_hCpuDescriptorHandle, LoadedTexture.m_hCpuDescriptorHandle, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    m_IsStreaming = false;
+}
+
+void ManagedTexture::ReplaceResource( ID3D12Resource* Resource, D3D12_RESOURCE_STATES UsageState )
+{
+    m_pResource = Resource;
+    m_UsageState = UsageState;
+    g_Device->CreateShaderResourceView(Resource, nullptr, m_hCpuDescriptorHandle);
+    m_IsStreaming = false;
+}
+
+void ManagedTexture::FailStreaming( void )
+{
+    g_Device->CopyDescriptorsSimple(1, m_hCpuDescriptorHandle, TextureManager::GetMagentaTex2D().GetSRV(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    m_IsValid = false;
+    m_IsStreaming = false;
+}
+
 void ManagedTexture::WaitForLoad( void ) const
 {
+    if (m_IsStreaming)
+    {
+        TextureManager::WaitForStreamingTexture(this);
+        return;
+    }
+
     volatile D3D12_CPU_DESCRIPTOR_HANDLE& VolHandle = (volatile D3D12_CPU_DESCRIPTOR_HANDLE&)m_hCpuDescriptorHandle;
     volatile bool& VolValid = (volatile bool&)m_IsValid;
     while (VolHandle.ptr == D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN && VolValid)
@@ -252,6 +953,61 @@ void ManagedTexture::SetToInvalidTexture( void )
     m_IsValid = false;
 }
 
+bool TextureManager::LoadPackage( const std::wstring& FilePath )
+{
+    using namespace TexturePackage;
+
+    Utility::ByteArray ba = Utility::ReadFileSync(FilePath);
+    if (ba->size() < sizeof(Header))
+        return false;
+
+    const uint8_t* FileData = ba->data();
+    const Header& PackageHeader = *(const Header*)FileData;
+
+    if (PackageHeader.Magic != kMagic || PackageHeader.Version != kVersion ||
+        GetTableSize(PackageHeader.TextureCount, PackageHeader.SubresourceCount) > PackageHeader.DataOffset ||
+        PackageHeader.DataOffset + PackageHeader.DataSize > ba->size())
+    {
+        Utility::Printf("Invalid texture package:  %ls\n", FilePath.c_str());
+        return false;
+    }
+
+    const TextureEntry* Entries = (const TextureEntry*)(FileData + sizeof(Header));
+    const D3D12_PLACED_SUBRESOURCE_FOOTPRINT* Footprints =
+        (const D3D12_PLACED_SUBRESOURCE_FOOTPRINT*)(Entries + PackageHeader.TextureCount);
+
+    CommandContext& InitContext = CommandContext::Begin(L"Load Texture Package");
+
+    // The texel data is already laid out for the copy engine, so it moves to the upload heap in one piece
+    DynAlloc mem = InitContext.ReserveUploadMemory((size_t)PackageHeader.DataSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    memcpy(mem.DataPtr, FileData + PackageHeader.DataOffset, (size_t)PackageHeader.DataSize);
+
+    for (uint32_t TexIdx = 0; TexIdx < PackageHeader.TextureCount; ++TexIdx)
+    {
+        const TextureEntry& Entry = Entries[TexIdx];
+        if (Entry.MipCount == 0 || Entry.FirstSubresource + Entry.MipCount > PackageHeader.SubresourceCount)
+            continue;
+
+        // Registered under the name a loose .dds file would have, which is the first one looked for
+        const wstring TextureName = MakeWStr(string(Entry.Name, strnlen(Entry.Name, kMaxNameLength))) + L".dds";
+
+        auto ManagedTex = FindOrLoadTexture(TextureName);
+
+        // Keep whatever was loaded from loose files before the package
+        if (!ManagedTex.second)
+            continue;
+
+        ManagedTexture* ManTex = ManagedTex.first;
+        ManTex->CreateFromFootprints(InitContext, mem.Buffer, mem.Offset, Entry.Width, Entry.Height, Entry.MipCount,
+            Entry.Format, Footprints + Entry.FirstSubresource);
+        ManTex->GetResource()->SetName(TextureName.c_str());
+    }
+
+    InitContext.Finish(true);
+
+    return true;
+}
+
 const ManagedTexture* TextureManager::LoadFromFile( const std::wstring& fileName, bool sRGB )
 {
     std::wstring CatPath = fileName;
@@ -299,11 +1055,8 @@ const ManagedTexture* TextureManager::LoadTGAFromFile( const std::wstring& fileN
     }
 
     Utility::ByteArray ba = Utility::ReadFileSync( s_RootPath + fileName );
-    if (ba->size() > 0)
-    {
-        ManTex->CreateTGAFromMemory( ba->data(), ba->size(), sRGB );
+    if (ba->size() > 0 && ManTex->CreateTGAFromMemory( ba->data(), ba->size(), sRGB ))
         ManTex->GetResource()->SetName(fileName.c_str());
-    }
     else
         ManTex->SetToInvalidTexture();
 
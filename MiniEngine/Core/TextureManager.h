@@ -18,6 +18,8 @@
 #include "GpuResource.h"
 #include "Utility.h"
 
+class CommandContext;
+
 class Texture : public GpuResource
 {
     friend class CommandContext;
@@ -34,10 +36,20 @@ public:
         Create(Width, Width, Height, Format, InitData);
     }
 
-    void CreateTGAFromMemory( const void* memBuffer, size_t fileSize, bool sRGB );
+    // Create a 1-level 2D texture whose texels Fill writes straight into upload memory
+    void Create(size_t Width, size_t Height, DXGI_FORMAT Format, const std::function<void (void* Texels, size_t RowPitch)>& Fill );
+
+    bool CreateTGAFromMemory( const void* memBuffer, size_t fileSize, bool sRGB );
     bool CreateDDSFromMemory( const void* memBuffer, size_t fileSize, bool sRGB );
+    bool CreateDDSFromMipRange( const void* headerData, size_t headerSize, const void* mipData, size_t mipDataSize,
+        uint32_t firstMip, bool sRGB );
     void CreatePIXImageFromMemory( const void* memBuffer, size_t fileSize );
 
+    // Creates a texture with MipCount levels and records copies of each of them on Context.  Footprints hold
+    // texels already laid out for the copy engine, at offsets relative to UploadOffset in Upload.
+    void CreateFromFootprints( CommandContext& Context, GpuResource& Upload, size_t UploadOffset, size_t Width,
+        size_t Height, uint32_t MipCount, DXGI_FORMAT Format, const D3D12_PLACED_SUBRESOURCE_FOOTPRINT* Footprints );
+
     virtual void Destroy() override
     {
         GpuResource::Destroy();
@@ -50,13 +62,16 @@ public:
 
 protected:
 
+    void CreateResource( size_t Width, size_t Height, DXGI_FORMAT Format, uint32_t MipLevels = 1 );
+    void CreateSRV( void );
+
     D3D12_CPU_DESCRIPTOR_HANDLE m_hCpuDescriptorHandle;
 };
 
 class ManagedTexture : public Texture
 {
 public:
-    ManagedTexture( const std::wstring& FileName ) : m_MapKey(FileName), m_IsValid(true) {}
+    ManagedTexture( const std::wstring& FileName ) : m_MapKey(FileName), m_IsValid(true), m_IsStreaming(false) {}
 
     void operator= ( const Texture& Texture );
 
@@ -66,9 +81,23 @@ public:
     void SetToInvalidTexture(void);
     bool IsValid(void) const { return m_IsValid; }
 
+    // True while the SRV still refers to a placeholder and the real texture is in flight
+    bool IsStreaming(void) const { return m_IsStreaming; }
+
+    // Used by the texture streamer.  BeginStreaming() gives this texture its own descriptor holding a
+    // copy of the placeholder's SRV.  FinishStreaming() adopts a loaded texture and overwrites that
+    // descriptor in place, so handles already handed out pick up the real texture.
+    void BeginStreaming( const Texture& Placeholder );
+    void FinishStreaming( ManagedTexture& LoadedTexture );
+    void FailStreaming( void );
+
+    // Swaps in a 2D resource with a different set of mips and rebuilds the SRV in place
+    void ReplaceResource( ID3D12Resource* Resource, D3D12_RESOURCE_STATES UsageState );
+
 private:
     std::wstring m_MapKey;		// For deleting from the map later
     bool m_IsValid;
+    volatile bool m_IsStreaming;
 };
 
 namespace TextureManager
@@ -76,6 +105,60 @@ namespace TextureManager
     void Initialize( const std::wstring& TextureLibRoot );
     void Shutdown(void);
 
+    // Lower values are loaded first
+    enum LoadPriority
+    {
+        kPriorityVisible,		// Needed on screen now
+        kPriorityNormal,
+        kPriorityPrefetch,		// Speculative; may be needed later
+        kNumPriorities
+    };
+
+    struct StreamingStats
+    {
+        uint32_t QueuedRequests;		// Waiting for file I/O
+        uint32_t PendingDecodes;		// File read, waiting for or being decoded and uploaded
+        uint32_t CompletedLoads;
+        uint32_t FailedLoads;
+        float AverageLatencyMs;			// Request to first usable SRV
+        float MaxLatencyMs;
+        uint32_t ProgressiveTextures;		// Textures with only part of their mip chain resident
+        uint64_t ProgressiveBytes;			// GPU memory held by their resident mips
+        uint32_t EvictedTextures;			// Times top mips were dropped to stay within budget
+    };
+
+    // Returns immediately with a texture whose SRV refers to the given placeholder.  The file is read
+    // on an I/O thread, decoded and uploaded on worker threads, and the real SRV is swapped in during a
+    // later Update().  IsValid() is false right away if neither a .dds nor a .tga version exists.
+    const ManagedTexture* LoadFromFileAsync( const std::wstring& fileName, bool sRGB,
+        const Texture& Placeholder, LoadPriority Priority = kPriorityNormal );
+
+    inline const ManagedTexture* LoadFromFileAsync( const std::string& fileName, bool sRGB,
+        const Texture& Placeholder, LoadPriority Priority = kPriorityNormal )
+    {
+        return LoadFromFileAsync(MakeWStr(fileName), sRGB, Placeholder, Priority);
+    }
+
+    // Publishes textures that finished streaming.  Call once per frame on the rendering thread.
+    void Update(void);
+
+    // Cancels queued loads and stops the streaming threads.  Called before the GPU is torn down.
+    void StopStreaming(void);
+
+    void GetStreamingStats( StreamingStats& Stats );
+
+    // Streamed single-surface DDS textures start out with only the mips no larger than "Initial Mip Size".
+    // Higher mips are loaded as they are requested here.  When "Budget (MB)" is exceeded, the top mips of
+    // the least recently requested textures are dropped first.  ScreenSize is roughly the number of pixels
+    // the texture spans on screen.  Call every frame for each texture that is drawn.
+    void RequestTextureDetail( const ManagedTexture* Texture, float ScreenSize );
+
+    // Loads every texture of a package written by texture_cook with one read and one upload.  The textures are
+    // registered under the names materials refer to them by, so later LoadFromFile() and LoadFromFileAsync()
+    // calls find them already resident.  FilePath is not relative to the texture root.  Returns false if the
+    // package does not exist or is not valid.
+    bool LoadPackage( const std::wstring& FilePath );
+
     const ManagedTexture* LoadFromFile( const std::wstring& fileName, bool sRGB = false );
     const ManagedTexture* LoadDDSFromFile( const std::wstring& fileName, bool sRGB = false );
     const ManagedTexture* LoadTGAFromFile( const std::wstring& fileName, bool sRGB = false );
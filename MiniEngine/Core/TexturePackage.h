@@ -0,0 +1,64 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+// The file format written by texture_cook.  A package holds every texture of a model with all mips already
+// block compressed and laid out the way CopyTextureRegion() wants them in an upload buffer:
+//
+//     Header
+//     TextureEntry[TextureCount]
+//     D3D12_PLACED_SUBRESOURCE_FOOTPRINT[SubresourceCount]
+//     (padding)
+//     Texel data, DataSize bytes starting at DataOffset
+//
+// Footprint offsets are relative to DataOffset and aligned to D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, and rows
+// are D3D12_TEXTURE_DATA_PITCH_ALIGNMENT aligned.  Loading is one read, one copy of the texel data into upload
+// memory and one CopyTextureRegion() per mip.
+//
+
+#pragma once
+
+namespace TexturePackage
+{
+    const uint32_t kMagic = 0x4B505854;		// "TXPK"
+    const uint32_t kVersion = 1;
+
+    // Matches Model::Material::maxTexPath
+    enum { kMaxNameLength = 128 };
+
+    struct Header
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        uint32_t TextureCount;
+        uint32_t SubresourceCount;
+        uint64_t DataOffset;
+        uint64_t DataSize;
+    };
+
+    struct TextureEntry
+    {
+        char Name[kMaxNameLength];		// Relative to the texture root, without extension
+        DXGI_FORMAT Format;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t MipCount;
+        uint32_t FirstSubresource;		// Index of the footprint of mip 0
+        uint32_t Reserved;				// Keeps the footprints that follow 8-byte aligned
+    };
+
+    // Where the footprint table ends and the texel data may begin
+    inline uint64_t GetTableSize( uint32_t TextureCount, uint32_t SubresourceCount )
+    {
+        return sizeof(Header) + TextureCount * sizeof(TextureEntry) +
+            SubresourceCount * sizeof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT);
+    }
+}
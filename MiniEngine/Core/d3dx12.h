@@ -1832,6 +1832,175 @@ inline UINT64 UpdateSubresources(
     return UpdateSubresources(pCmdList, pDestinationResource, pIntermediate, FirstSubresource, NumSubresources, RequiredSize, Layouts, NumRows, RowSizesInBytes, pSrcData);
 }
 
+//------------------------------------------------------------------------------------------------
+// Where one subresource goes in a mapped intermediate buffer
+struct D3DX12_MAPPED_SUBRESOURCE
+{
+    BYTE* pData;                                // Mapped address of the first row of the first slice
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT Layout;  // Offset is relative to the start of the intermediate buffer
+    UINT NumRows;                               // Per slice; rows of blocks for block-compressed formats
+    UINT64 RowSizeInBytes;                      // Bytes to fill in each row.  The rest of RowPitch is padding.
+};
+
+//------------------------------------------------------------------------------------------------
+// Records the copies from the intermediate buffer once it has been filled
+inline void CopySubresourcesFromIntermediate(
+    _In_ ID3D12GraphicsCommandList* pCmdList,
+    _In_ ID3D12Resource* pDestinationResource,
+    _In_ ID3D12Resource* pIntermediate,
+    _In_range_(0,D3D12_REQ_SUBRESOURCES) UINT FirstSubresource,
+    _In_range_(0,D3D12_REQ_SUBRESOURCES-FirstSubresource) UINT NumSubresources,
+    _In_reads_(NumSubresources) const D3D12_PLACED_SUBRESOURCE_FOOTPRINT* pLayouts)
+{
+    D3D12_RESOURCE_DESC DestinationDesc = pDestinationResource->GetDesc();
+    if (DestinationDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+    {
+        pCmdList->CopyBufferRegion(
+            pDestinationResource, 0, pIntermediate, pLayouts[0].Offset, pLayouts[0].Footprint.Width);
+    }
+    else
+    {
+        for (UINT i = 0; i < NumSubresources; ++i)
+        {
+            CD3DX12_TEXTURE_COPY_LOCATION Dst(pDestinationResource, i + FirstSubresource);
+            CD3DX12_TEXTURE_COPY_LOCATION Src(pIntermediate, pLayouts[i]);
+            pCmdList->CopyTextureRegion(&Dst, 0, 0, 0, &Src, nullptr);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+// Zero-copy UpdateSubresources.  Rather than copying from D3D12_SUBRESOURCE_DATA, this maps the intermediate
+// buffer and calls WriteSubresource(UINT Subresource, const D3DX12_MAPPED_SUBRESOURCE& Dest) for each
+// subresource, so that decoders and file reads can produce their texels directly at their final row-pitched
+// location.  WriteSubresource returns false to abandon the upload, in which case no copies are recorded and 0
+// is returned.  Otherwise the required size of the intermediate buffer is returned.
+template <typename WriteFunction>
+inline UINT64 UpdateSubresourcesInPlace(
+    _In_ ID3D12GraphicsCommandList* pCmdList,
+    _In_ ID3D12Resource* pDestinationResource,
+    _In_ ID3D12Resource* pIntermediate,
+    UINT64 IntermediateOffset,
+    _In_range_(0,D3D12_REQ_SUBRESOURCES) UINT FirstSubresource,
+    _In_range_(1,D3D12_REQ_SUBRESOURCES-FirstSubresource) UINT NumSubresources,
+    WriteFunction WriteSubresource)
+{
+    UINT64 MemToAlloc = static_cast<UINT64>(sizeof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT) + sizeof(UINT) + sizeof(UINT64)) * NumSubresources;
+    if (MemToAlloc > SIZE_MAX)
+    {
+       return 0;
+    }
+    void* pMem = HeapAlloc(GetProcessHeap(), 0, static_cast<SIZE_T>(MemToAlloc));
+    if (pMem == NULL)
+    {
+       return 0;
+    }
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT* pLayouts = reinterpret_cast<D3D12_PLACED_SUBRESOURCE_FOOTPRINT*>(pMem);
+    UINT64* pRowSizesInBytes = reinterpret_cast<UINT64*>(pLayouts + NumSubresources);
+    UINT* pNumRows = reinterpret_cast<UINT*>(pRowSizesInBytes + NumSubresources);
+
+    UINT64 RequiredSize = 0;
+    D3D12_RESOURCE_DESC Desc = pDestinationResource->GetDesc();
+    ID3D12Device* pDevice;
+    pDestinationResource->GetDevice(__uuidof(*pDevice), reinterpret_cast<void**>(&pDevice));
+    pDevice->GetCopyableFootprints(&Desc, FirstSubresource, NumSubresources, IntermediateOffset, pLayouts, pNumRows, pRowSizesInBytes, &RequiredSize);
+    pDevice->Release();
+
+    // Minor validation
+    D3D12_RESOURCE_DESC IntermediateDesc = pIntermediate->GetDesc();
+    BYTE* pData = nullptr;
+    bool Succeeded =
+        IntermediateDesc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER &&
+        IntermediateDesc.Width >= RequiredSize + pLayouts[0].Offset &&
+        RequiredSize <= (SIZE_T)-1 &&
+        (Desc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER || (FirstSubresource == 0 && NumSubresources == 1)) &&
+        SUCCEEDED(pIntermediate->Map(0, NULL, reinterpret_cast<void**>(&pData)));
+
+    if (Succeeded)
+    {
+        for (UINT i = 0; i < NumSubresources && Succeeded; ++i)
+        {
+            D3DX12_MAPPED_SUBRESOURCE Dest = { pData + pLayouts[i].Offset, pLayouts[i], pNumRows[i], pRowSizesInBytes[i] };
+            Succeeded = WriteSubresource(i + FirstSubresource, Dest);
+        }
+        pIntermediate->Unmap(0, NULL);
+    }
+
+    if (Succeeded)
+        CopySubresourcesFromIntermediate(pCmdList, pDestinationResource, pIntermediate, FirstSubresource, NumSubresources, pLayouts);
+
+    HeapFree(GetProcessHeap(), 0, pMem);
+    return Succeeded ? RequiredSize : 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// Copies many subresources into mapped memory at once, for when a copy cannot be avoided.  The rows of all
+// subresources are split into chunks of about ChunkSize bytes, and ParallelFor(UINT Count, Body) must call
+// Body(UINT Chunk) once for each Chunk in [0, Count), from as many threads as it likes.  For example:
+//     [](UINT Count, const std::function<void(UINT)>& Body) { concurrency::parallel_for(0u, Count, Body); }
+template <typename ParallelForFunction>
+inline void MemcpySubresourcesParallel(
+    _In_reads_(NumSubresources) const D3DX12_MAPPED_SUBRESOURCE* pDests,
+    _In_reads_(NumSubresources) const D3D12_SUBRESOURCE_DATA* pSrcData,
+    UINT NumSubresources,
+    ParallelForFunction ParallelFor,
+    SIZE_T ChunkSize = 256 * 1024)
+{
+    // A chunk is a run of rows within one slice of one subresource.  Count them first so that every chunk can
+    // be found from its index alone.
+    UINT64 NumChunks = 0;
+    for (UINT i = 0; i < NumSubresources; ++i)
+    {
+        const SIZE_T RowSize = (SIZE_T)pDests[i].RowSizeInBytes;
+        const UINT RowsPerChunk = RowSize >= ChunkSize ? 1 : (UINT)(ChunkSize / (RowSize > 0 ? RowSize : 1));
+        const UINT ChunksPerSlice = (pDests[i].NumRows + RowsPerChunk - 1) / RowsPerChunk;
+        NumChunks += (UINT64)ChunksPerSlice * pDests[i].Layout.Footprint.Depth;
+    }
+
+    if (NumChunks == 0 || NumChunks > UINT_MAX)
+    {
+        for (UINT i = 0; i < NumSubresources; ++i)
+        {
+            D3D12_MEMCPY_DEST DestData = { pDests[i].pData, pDests[i].Layout.Footprint.RowPitch, (SIZE_T)pDests[i].Layout.Footprint.RowPitch * pDests[i].NumRows };
+            MemcpySubresource(&DestData, &pSrcData[i], (SIZE_T)pDests[i].RowSizeInBytes, pDests[i].NumRows, pDests[i].Layout.Footprint.Depth);
+        }
+        return;
+    }
+
+    ParallelFor((UINT)NumChunks, [=](UINT Chunk)
+    {
+        // Walk to the subresource that holds this chunk
+        UINT i = 0;
+        UINT RowsPerChunk = 1;
+        UINT ChunksPerSlice = 0;
+        for (;; ++i)
+        {
+            const SIZE_T RowSize = (SIZE_T)pDests[i].RowSizeInBytes;
+            RowsPerChunk = RowSize >= ChunkSize ? 1 : (UINT)(ChunkSize / (RowSize > 0 ? RowSize : 1));
+            ChunksPerSlice = (pDests[i].NumRows + RowsPerChunk - 1) / RowsPerChunk;
+            const UINT SubresourceChunks = ChunksPerSlice * pDests[i].Layout.Footprint.Depth;
+            if (Chunk < SubresourceChunks)
+                break;
+            Chunk -= SubresourceChunks;
+        }
+
+        const D3DX12_MAPPED_SUBRESOURCE& Dest = pDests[i];
+        const D3D12_SUBRESOURCE_DATA& Src = pSrcData[i];
+        const UINT Slice = Chunk / ChunksPerSlice;
+        const UINT FirstRow = (Chunk % ChunksPerSlice) * RowsPerChunk;
+        const UINT EndRow = FirstRow + RowsPerChunk < Dest.NumRows ? FirstRow + RowsPerChunk : Dest.NumRows;
+
+        BYTE* pDestSlice = Dest.pData + (SIZE_T)Dest.Layout.Footprint.RowPitch * Dest.NumRows * Slice;
+        const BYTE* pSrcSlice = reinterpret_cast<const BYTE*>(Src.pData) + Src.SlicePitch * Slice;
+        for (UINT y = FirstRow; y < EndRow; ++y)
+        {
+            memcpy(pDestSlice + (SIZE_T)Dest.Layout.Footprint.RowPitch * y,
+                   pSrcSlice + Src.RowPitch * y,
+                   (SIZE_T)Dest.RowSizeInBytes);
+        }
+    });
+}
+
 //------------------------------------------------------------------------------------------------
 inline bool D3D12IsLayoutOpaque( D3D12_TEXTURE_LAYOUT Layout )
 { return Layout == D3D12_TEXTURE_LAYOUT_UNKNOWN || Layout == D3D12_TEXTURE_LAYOUT_64KB_UNDEFINED_SWIZZLE; }
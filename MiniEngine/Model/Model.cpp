@@ -13,6 +13,7 @@
 
 #include "pch.h"
 #include "Model.h"
+#include "Camera.h"
 #include <string.h>
 #include <float.h>
 
@@ -52,6 +53,7 @@ Model::Model()
     , m_pVertexDataDepth(nullptr)
     , m_pIndexDataDepth(nullptr)
     , m_SRVs(nullptr)
+    , m_MaterialTextures(nullptr)
 {
     Clear();
 }
@@ -217,4 +219,36 @@ void Model::LoadPostProcess(bool needToOptimize)
     }
 }
 
+void Model::RequestTextureDetail( const Math::Camera& Camera, float ViewportHeight ) const
+{
+    if (m_MaterialTextures == nullptr)
+        return;
+
+    // Pixels spanned by one world unit at a distance of one unit
+    const float PixelsPerUnit = ViewportHeight * 0.5f / tanf(Camera.GetFOV() * 0.5f);
+    const Vector3 Eye = Camera.GetPosition();
+    const Frustum& ViewFrustum = Camera.GetWorldSpaceFrustum();
+
+    for (uint32_t meshIndex = 0; meshIndex < m_Header.meshCount; ++meshIndex)
+    {
+        const Mesh& mesh = m_pMesh[meshIndex];
+
+        if (!ViewFrustum.IntersectBoundingBox(mesh.boundingBox.min, mesh.boundingBox.max))
+            continue;
+
+        // Assume the texture is mapped once across the mesh's extent
+        const Vector3 Center = (mesh.boundingBox.min + mesh.boundingBox.max) * 0.5f;
+        const float Radius = Length(mesh.boundingBox.max - mesh.boundingBox.min) * 0.5f;
+        const float Distance = Max((float)Length(Center - Eye) - Radius, Camera.GetNearClip());
+        const float ScreenSize = 2.0f * Radius * PixelsPerUnit / Distance;
+
+        const ManagedTexture** Textures = m_MaterialTextures + mesh.materialIndex * Material::texCount;
+        for (int n = 0; n < Material::texCount; ++n)
+        {
+            if (Textures[n] != nullptr)
+                TextureManager::RequestTextureDetail(Textures[n], ScreenSize);
+        }
+    }
+}
+
 } // namespace Graphics
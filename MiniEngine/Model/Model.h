@@ -18,6 +18,11 @@
 #include "TextureManager.h"
 #include "GpuBuffer.h"
 
+namespace Math
+{
+    class Camera;
+}
+
 namespace Graphics
 {
     using namespace Math;
@@ -207,6 +212,10 @@ public:
         return m_SRVs + materialIdx * 6;
     }
 
+    // Estimates how large each visible mesh is on screen and requests matching texture detail from the
+    // texture streamer.  Call once per frame.
+    void RequestTextureDetail( const Math::Camera& Camera, float ViewportHeight ) const;
+
 private:
 
     bool LoadH3D(const char *filename);
@@ -233,6 +242,7 @@ private:
     void ReleaseTextures();
     void LoadTextures();
     D3D12_CPU_DESCRIPTOR_HANDLE* m_SRVs;
+    const ManagedTexture** m_MaterialTextures;
 };
 
 }
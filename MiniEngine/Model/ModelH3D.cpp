@@ -96,6 +96,14 @@ bool Model::LoadH3D(const char *filename)
     delete [] m_pIndexDataDepth;
     m_pIndexDataDepth = nullptr;
 
+    // Textures cooked by texture_cook are packaged next to the model.  They are uploaded in one piece, and
+    // LoadTextures() finds them already resident.
+    {
+        std::string PackagePath = filename;
+        PackagePath = PackagePath.substr(0, PackagePath.rfind('.')) + ".texpak";
+        TextureManager::LoadPackage(MakeWStr(PackagePath));
+    }
+
     LoadTextures();
 
     ok = true;
@@ -145,6 +153,9 @@ h3d_save_fail:
 
 void Model::ReleaseTextures()
 {
+    delete [] m_MaterialTextures;
+    m_MaterialTextures = nullptr;
+
     /*
     if (m_Textures != nullptr)
     {
@@ -167,37 +178,43 @@ void Model::LoadTextures(void)
     ReleaseTextures();
 
     m_SRVs = new D3D12_CPU_DESCRIPTOR_HANDLE[m_Header.materialCount * 6];
+    m_MaterialTextures = new const ManagedTexture*[m_Header.materialCount * Material::texCount];
 
     const ManagedTexture* MatTextures[6] = {};
 
+    // The defaults are loaded up front and stand in for the real textures while they stream
+    const ManagedTexture* DefaultDiffuse = TextureManager::LoadFromFile("default", true);
+    const ManagedTexture* DefaultSpecular = TextureManager::LoadFromFile("default_specular", true);
+    const ManagedTexture* DefaultNormal = TextureManager::LoadFromFile("default_normal", false);
+
     for (uint32_t materialIdx = 0; materialIdx < m_Header.materialCount; ++materialIdx)
     {
         const Material& pMaterial = m_pMaterial[materialIdx];
 
         // Load diffuse
-        MatTextures[0] = TextureManager::LoadFromFile(pMaterial.texDiffusePath, true);
+        MatTextures[0] = TextureManager::LoadFromFileAsync(pMaterial.texDiffusePath, true, *DefaultDiffuse);
         if (!MatTextures[0]->IsValid())
-            MatTextures[0] = TextureManager::LoadFromFile("default", true);
+            MatTextures[0] = DefaultDiffuse;
 
         // Load specular
-        MatTextures[1] = TextureManager::LoadFromFile(pMaterial.texSpecularPath, true);
+        MatTextures[1] = TextureManager::LoadFromFileAsync(pMaterial.texSpecularPath, true, *DefaultSpecular);
         if (!MatTextures[1]->IsValid())
         {
-            MatTextures[1] = TextureManager::LoadFromFile(std::string(pMaterial.texDiffusePath) + "_specular", true);
+            MatTextures[1] = TextureManager::LoadFromFileAsync(std::string(pMaterial.texDiffusePath) + "_specular", true, *DefaultSpecular);
             if (!MatTextures[1]->IsValid())
-                MatTextures[1] = TextureManager::LoadFromFile("default_specular", true);
+                MatTextures[1] = DefaultSpecular;
         }
 
         // Load emissive
         //MatTextures[2] = TextureManager::LoadFromFile(pMaterial.texEmissivePath, true);
 
         // Load normal
-        MatTextures[3] = TextureManager::LoadFromFile(pMaterial.texNormalPath, false);
+        MatTextures[3] = TextureManager::LoadFromFileAsync(pMaterial.texNormalPath, false, *DefaultNormal);
         if (!MatTextures[3]->IsValid())
         {
-            MatTextures[3] = TextureManager::LoadFromFile(std::string(pMaterial.texDiffusePath) + "_normal", false);
+            MatTextures[3] = TextureManager::LoadFromFileAsync(std::string(pMaterial.texDiffusePath) + "_normal", false, *DefaultNormal);
             if (!MatTextures[3]->IsValid())
-                MatTextures[3] = TextureManager::LoadFromFile("default_normal", false);
+                MatTextures[3] = DefaultNormal;
         }
 
         // Load lightmap
@@ -206,6 +223,17 @@ void Model::LoadTextures(void)
         // Load reflection
         //MatTextures[5] = TextureManager::LoadFromFile(pMaterial.texReflectionPath, true);
 
+        // The defaults are shared and never refined, so only track what was streamed
+        const ManagedTexture** Tracked = m_MaterialTextures + materialIdx * Material::texCount;
+        for (int n = 0; n < Material::texCount; ++n)
+            Tracked[n] = nullptr;
+        if (MatTextures[0] != DefaultDiffuse)
+            Tracked[0] = MatTextures[0];
+        if (MatTextures[1] != DefaultSpecular)
+            Tracked[1] = MatTextures[1];
+        if (MatTextures[3] != DefaultNormal)
+            Tracked[3] = MatTextures[3];
+
         m_SRVs[materialIdx * 6 + 0] = MatTextures[0]->GetSRV();
         m_SRVs[materialIdx * 6 + 1] = MatTextures[1]->GetSRV();
         m_SRVs[materialIdx * 6 + 2] = MatTextures[0]->GetSRV();
@@ -18,6 +18,7 @@
 #include "CommandContext.h"
 #include "Camera.h"
 #include "BufferManager.h"
+#include "RadixSort.h"
 
 #include "CompiledShaders/FillLightGridCS_8.h"
 #include "CompiledShaders/FillLightGridCS_16.h"
@@ -202,28 +203,28 @@ void Lighting::CreateRandomLights( const Vector3 minBound, const Vector3 maxBoun
         //*(Matrix4*)(m_LightData[n].shadowTextureMatrix) = shadowTextureMatrix;
     }
     // sort lights by type, needed for efficiency in the BIT_MASK approach
-    /*	{
-    Matrix4 copyLightShadowMatrix[MaxLights];
-    memcpy(copyLightShadowMatrix, m_LightShadowMatrix, sizeof(Matrix4) * MaxLights);
-    LightData copyLightData[MaxLights];
-    memcpy(copyLightData, m_LightData, sizeof(LightData) * MaxLights);
-
-    uint32_t sortArray[MaxLights];
-    for (uint32_t n = 0; n < MaxLights; n++)
-    {
-    sortArray[n] = n;
-    }
-    std::sort(sortArray, sortArray + MaxLights,
-    [this](const uint32_t &a, const uint32_t &b) -> bool
-    {
-    return this->m_LightData[a].type < this->m_LightData[b].type;
-    });
-    for (uint32_t n = 0; n < MaxLights; n++)
     {
-    m_LightShadowMatrix[n] = copyLightShadowMatrix[sortArray[n]];
-    m_LightData[n] = copyLightData[sortArray[n]];
+        Matrix4 copyLightShadowMatrix[MaxLights];
+        memcpy(copyLightShadowMatrix, m_LightShadowMatrix, sizeof(Matrix4) * MaxLights);
+        LightData copyLightData[MaxLights];
+        memcpy(copyLightData, m_LightData, sizeof(LightData) * MaxLights);
+
+        // The type is the key in the top two bits, and the light index is in the rest
+        uint32_t sortArray[MaxLights];
+        uint32_t scratchArray[MaxLights];
+        for (uint32_t n = 0; n < MaxLights; n++)
+        {
+            sortArray[n] = m_LightData[n].type << 30 | n;
+        }
+        RadixSort::Sort(sortArray, scratchArray, MaxLights, 2);
+
+        for (uint32_t n = 0; n < MaxLights; n++)
+        {
+            uint32_t index = sortArray[n] & 0x3FFFFFFF;
+            m_LightShadowMatrix[n] = copyLightShadowMatrix[index];
+            m_LightData[n] = copyLightData[index];
+        }
     }
-    }*/
     for (uint32_t n = 0; n < MaxLights; n++)
     {
         if (m_LightData[n].type == 1)
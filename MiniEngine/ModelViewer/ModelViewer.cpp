@@ -276,6 +276,8 @@ void ModelViewer::Update( float deltaT )
     m_CameraController->Update(deltaT);
     m_ViewProjMatrix = m_Camera.GetViewProjMatrix();
 
+    m_Model.RequestTextureDetail(m_Camera, (float)g_SceneColorBuffer.GetHeight());
+
     float costheta = cosf(m_SunOrientation);
     float sintheta = sinf(m_SunOrientation);
     float cosphi = cosf(m_SunInclination * 3.14159f * 0.5f);
@@ -0,0 +1,518 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#include "BlockCompress.h"
+
+#include <cmath>
+#include <cfloat>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    inline int Channel( uint32_t Texel, int c )
+    {
+        return (Texel >> (c * 8)) & 0xFF;
+    }
+
+    inline int Clamp( int x, int Lo, int Hi )
+    {
+        return x < Lo ? Lo : (x > Hi ? Hi : x);
+    }
+
+    inline float Saturate255( float x )
+    {
+        return x < 0.0f ? 0.0f : (x > 255.0f ? 255.0f : x);
+    }
+
+    // Finds the mean and the dominant direction of the first NumChannels channels of the block.  Returns false
+    // when every texel is the same.
+    bool FindPrincipalAxis( const uint32_t Texels[16], int NumChannels, float Mean[4], float Axis[4] )
+    {
+        int Min[4] = { 255, 255, 255, 255 };
+        int Max[4] = { 0, 0, 0, 0 };
+        int Sum[4] = { 0, 0, 0, 0 };
+
+        for (int i = 0; i < 16; ++i)
+        {
+            for (int c = 0; c < NumChannels; ++c)
+            {
+                const int v = Channel(Texels[i], c);
+                Sum[c] += v;
+                Min[c] = min(Min[c], v);
+                Max[c] = max(Max[c], v);
+            }
+        }
+
+        bool IsSolid = true;
+        for (int c = 0; c < NumChannels; ++c)
+        {
+            Mean[c] = Sum[c] / 16.0f;
+            Axis[c] = (float)(Max[c] - Min[c]);
+            IsSolid = IsSolid && Min[c] == Max[c];
+        }
+
+        if (IsSolid)
+            return false;
+
+        float Covariance[4][4] = {};
+        for (int i = 0; i < 16; ++i)
+        {
+            float d[4];
+            for (int c = 0; c < NumChannels; ++c)
+                d[c] = Channel(Texels[i], c) - Mean[c];
+
+            for (int r = 0; r < NumChannels; ++r)
+                for (int c = 0; c < NumChannels; ++c)
+                    Covariance[r][c] += d[r] * d[c];
+        }
+
+        // Power iteration, starting from the diagonal of the bounding box
+        for (int Iteration = 0; Iteration < 8; ++Iteration)
+        {
+            float Next[4] = {};
+            float Largest = 0.0f;
+            for (int r = 0; r < NumChannels; ++r)
+            {
+                for (int c = 0; c < NumChannels; ++c)
+                    Next[r] += Covariance[r][c] * Axis[c];
+                Largest = max(Largest, fabsf(Next[r]));
+            }
+
+            // The bounding box diagonal is orthogonal to all variation, which is rare but possible
+            if (Largest == 0.0f)
+                break;
+
+            for (int c = 0; c < NumChannels; ++c)
+                Axis[c] = Next[c] / Largest;
+        }
+
+        float LengthSq = 0.0f;
+        for (int c = 0; c < NumChannels; ++c)
+            LengthSq += Axis[c] * Axis[c];
+
+        if (LengthSq == 0.0f)
+            return false;
+
+        const float InvLength = 1.0f / sqrtf(LengthSq);
+        for (int c = 0; c < NumChannels; ++c)
+            Axis[c] *= InvLength;
+
+        return true;
+    }
+
+    // Places the endpoints at the extremes of the texels projected onto the axis
+    void FitEndpointsToAxis( const uint32_t Texels[16], int NumChannels, const float Mean[4], const float Axis[4],
+        float Endpoint0[4], float Endpoint1[4] )
+    {
+        float MinProj = 0.0f;
+        float MaxProj = 0.0f;
+        for (int i = 0; i < 16; ++i)
+        {
+            float Proj = 0.0f;
+            for (int c = 0; c < NumChannels; ++c)
+                Proj += (Channel(Texels[i], c) - Mean[c]) * Axis[c];
+            MinProj = min(MinProj, Proj);
+            MaxProj = max(MaxProj, Proj);
+        }
+
+        for (int c = 0; c < NumChannels; ++c)
+        {
+            Endpoint0[c] = Saturate255(Mean[c] + Axis[c] * MaxProj);
+            Endpoint1[c] = Saturate255(Mean[c] + Axis[c] * MinProj);
+        }
+    }
+
+    // Solves for the endpoints that best reproduce the texels given how far each one lies between them.  Weights
+    // are the fraction of Endpoint1 in each texel.  Returns false if the weights are all the same.
+    bool LeastSquaresEndpoints( const uint32_t Texels[16], int NumChannels, const float Weights[16],
+        float Endpoint0[4], float Endpoint1[4] )
+    {
+        float AA = 0.0f, AB = 0.0f, BB = 0.0f;
+        float AX[4] = {}, BX[4] = {};
+
+        for (int i = 0; i < 16; ++i)
+        {
+            const float b = Weights[i];
+            const float a = 1.0f - b;
+            AA += a * a;
+            AB += a * b;
+            BB += b * b;
+            for (int c = 0; c < NumChannels; ++c)
+            {
+                AX[c] += a * Channel(Texels[i], c);
+                BX[c] += b * Channel(Texels[i], c);
+            }
+        }
+
+        const float Det = AA * BB - AB * AB;
+        if (fabsf(Det) < 1e-6f)
+            return false;
+
+        const float InvDet = 1.0f / Det;
+        for (int c = 0; c < NumChannels; ++c)
+        {
+            Endpoint0[c] = Saturate255((BB * AX[c] - AB * BX[c]) * InvDet);
+            Endpoint1[c] = Saturate255((AA * BX[c] - AB * AX[c]) * InvDet);
+        }
+
+        return true;
+    }
+
+    // Returns the index of the closest palette entry and adds its squared error to Error
+    int FindClosest( uint32_t Texel, int NumChannels, const int Palette[][4], int PaletteSize, int& Error )
+    {
+        int Best = 0;
+        int BestError = INT32_MAX;
+        for (int i = 0; i < PaletteSize; ++i)
+        {
+            int Dist = 0;
+            for (int c = 0; c < NumChannels; ++c)
+            {
+                const int d = Channel(Texel, c) - Palette[i][c];
+                Dist += d * d;
+            }
+            if (Dist < BestError)
+            {
+                BestError = Dist;
+                Best = i;
+            }
+        }
+        Error += BestError;
+        return Best;
+    }
+
+    //
+    // BC1 color
+    //
+
+    inline uint16_t Pack565( const float Color[3] )
+    {
+        const int r = Clamp((int)(Color[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+        const int g = Clamp((int)(Color[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+        const int b = Clamp((int)(Color[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+        return (uint16_t)(r << 11 | g << 5 | b);
+    }
+
+    inline void Unpack565( uint16_t Packed, int Color[4] )
+    {
+        const int r = Packed >> 11 & 31;
+        const int g = Packed >> 5 & 63;
+        const int b = Packed & 31;
+        Color[0] = r << 3 | r >> 2;
+        Color[1] = g << 2 | g >> 4;
+        Color[2] = b << 3 | b >> 2;
+        Color[3] = 255;
+    }
+
+    // Fraction of the second endpoint selected by each BC1 index
+    const float s_BC1Weights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    // Quantizes the endpoints, picks indices and returns the squared error.  Always produces a four-color block.
+    int EncodeColorBlock( const uint32_t Texels[16], const float Endpoint0[3], const float Endpoint1[3], uint8_t Block[8] )
+    {
+        uint16_t Color0 = Pack565(Endpoint0);
+        uint16_t Color1 = Pack565(Endpoint1);
+
+        // Color0 > Color1 selects four-color mode.  If they are equal, every index is 0 and the mode is moot.
+        if (Color0 < Color1)
+            swap(Color0, Color1);
+
+        int Palette[4][4];
+        Unpack565(Color0, Palette[0]);
+        Unpack565(Color1, Palette[1]);
+        for (int c = 0; c < 3; ++c)
+        {
+            Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+            Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+        }
+
+        int Error = 0;
+        uint32_t Indices = 0;
+        if (Color0 != Color1)
+        {
+            for (int i = 0; i < 16; ++i)
+                Indices |= FindClosest(Texels[i], 3, Palette, 4, Error) << (i * 2);
+        }
+        else
+        {
+            for (int i = 0; i < 16; ++i)
+                FindClosest(Texels[i], 3, Palette, 1, Error);
+        }
+
+        Block[0] = (uint8_t)Color0;
+        Block[1] = (uint8_t)(Color0 >> 8);
+        Block[2] = (uint8_t)Color1;
+        Block[3] = (uint8_t)(Color1 >> 8);
+        memcpy(Block + 4, &Indices, 4);
+
+        return Error;
+    }
+
+    void EncodeColor( const uint32_t Texels[16], uint8_t Block[8] )
+    {
+        float Mean[4], Axis[4];
+        if (!FindPrincipalAxis(Texels, 3, Mean, Axis))
+        {
+            EncodeColorBlock(Texels, Mean, Mean, Block);
+            return;
+        }
+
+        float Endpoint0[4], Endpoint1[4];
+        FitEndpointsToAxis(Texels, 3, Mean, Axis, Endpoint0, Endpoint1);
+        int Error = EncodeColorBlock(Texels, Endpoint0, Endpoint1, Block);
+
+        // Refit the endpoints to the chosen indices and keep the result if it is better
+        for (int Pass = 0; Pass < 2 && Error > 0; ++Pass)
+        {
+            uint32_t Indices;
+            memcpy(&Indices, Block + 4, 4);
+
+            float Weights[16];
+            for (int i = 0; i < 16; ++i)
+                Weights[i] = s_BC1Weights[Indices >> (i * 2) & 3];
+
+            // The indices refer to the endpoints in the order they were packed
+            if (!LeastSquaresEndpoints(Texels, 3, Weights, Endpoint0, Endpoint1))
+                break;
+
+            uint8_t Refined[8];
+            const int RefinedError = EncodeColorBlock(Texels, Endpoint0, Endpoint1, Refined);
+            if (RefinedError >= Error)
+                break;
+
+            Error = RefinedError;
+            memcpy(Block, Refined, 8);
+        }
+    }
+
+    //
+    // BC4 single channel
+    //
+
+    void EncodeSingleChannel( const uint32_t Texels[16], int c, uint8_t Block[8] )
+    {
+        int Lo = 255, Hi = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            Lo = min(Lo, Channel(Texels[i], c));
+            Hi = max(Hi, Channel(Texels[i], c));
+        }
+
+        // Value0 > Value1 selects eight interpolated values
+        Block[0] = (uint8_t)Hi;
+        Block[1] = (uint8_t)Lo;
+
+        uint64_t Indices = 0;
+        if (Hi > Lo)
+        {
+            int Palette[8];
+            Palette[0] = Hi;
+            Palette[1] = Lo;
+            for (int k = 1; k < 7; ++k)
+                Palette[k + 1] = ((7 - k) * Hi + k * Lo + 3) / 7;
+
+            for (int i = 0; i < 16; ++i)
+            {
+                const int v = Channel(Texels[i], c);
+                int Best = 0;
+                int BestDist = abs(v - Palette[0]);
+                for (int k = 1; k < 8; ++k)
+                {
+                    const int Dist = abs(v - Palette[k]);
+                    if (Dist < BestDist)
+                    {
+                        BestDist = Dist;
+                        Best = k;
+                    }
+                }
+                Indices |= (uint64_t)Best << (i * 3);
+            }
+        }
+
+        for (int i = 0; i < 6; ++i)
+            Block[2 + i] = (uint8_t)(Indices >> (i * 8));
+    }
+
+    //
+    // BC7 mode 6
+    //
+
+    const int s_BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // Mode 6 endpoints are 7 bits per channel plus one low bit shared by all four channels
+    struct Mode6Endpoint
+    {
+        int Value[4];		// 7 bits
+        int PBit;
+
+        int Expanded( int c ) const { return Value[c] << 1 | PBit; }
+    };
+
+    Mode6Endpoint QuantizeMode6( const float Endpoint[4] )
+    {
+        Mode6Endpoint Best = {};
+        float BestError = FLT_MAX;
+
+        for (int PBit = 0; PBit < 2; ++PBit)
+        {
+            Mode6Endpoint Candidate;
+            Candidate.PBit = PBit;
+
+            float Error = 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                Candidate.Value[c] = Clamp((int)floorf((Endpoint[c] - PBit) * 0.5f + 0.5f), 0, 127);
+                const float d = Candidate.Expanded(c) - Endpoint[c];
+                Error += d * d;
+            }
+
+            if (Error < BestError)
+            {
+                BestError = Error;
+                Best = Candidate;
+            }
+        }
+
+        return Best;
+    }
+
+    struct BitWriter
+    {
+        uint8_t* Block;
+        uint32_t Position;
+
+        void Write( uint32_t Value, uint32_t NumBits )
+        {
+            for (uint32_t b = 0; b < NumBits; ++b, ++Position)
+            {
+                if (Value >> b & 1)
+                    Block[Position >> 3] |= (uint8_t)(1 << (Position & 7));
+            }
+        }
+    };
+
+    int EncodeMode6Block( const uint32_t Texels[16], const float Endpoint0[4], const float Endpoint1[4], uint8_t Block[16] )
+    {
+        Mode6Endpoint E[2] = { QuantizeMode6(Endpoint0), QuantizeMode6(Endpoint1) };
+
+        int Palette[16][4];
+        for (int i = 0; i < 16; ++i)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                Palette[i][c] = ((64 - s_BC7Weights[i]) * E[0].Expanded(c) + s_BC7Weights[i] * E[1].Expanded(c) + 32) >> 6;
+            }
+        }
+
+        int Error = 0;
+        int Indices[16];
+        for (int i = 0; i < 16; ++i)
+            Indices[i] = FindClosest(Texels[i], 4, Palette, 16, Error);
+
+        // The top bit of the first index is implied to be zero, so flip the block around if it is set
+        if (Indices[0] & 8)
+        {
+            swap(E[0], E[1]);
+            for (int i = 0; i < 16; ++i)
+                Indices[i] = 15 - Indices[i];
+        }
+
+        memset(Block, 0, 16);
+        BitWriter Writer = { Block, 0 };
+
+        Writer.Write(1 << 6, 7);
+        for (int c = 0; c < 4; ++c)
+        {
+            Writer.Write(E[0].Value[c], 7);
+            Writer.Write(E[1].Value[c], 7);
+        }
+        Writer.Write(E[0].PBit, 1);
+        Writer.Write(E[1].PBit, 1);
+
+        Writer.Write(Indices[0], 3);
+        for (int i = 1; i < 16; ++i)
+            Writer.Write(Indices[i], 4);
+
+        return Error;
+    }
+
+    int ReadMode6Index( const uint8_t Block[16], int i )
+    {
+        // Index 0 starts at bit 65 and is three bits.  The rest follow at four bits each.
+        const uint32_t Start = i == 0 ? 65 : 68 + (i - 1) * 4;
+        const uint32_t NumBits = i == 0 ? 3 : 4;
+
+        int Value = 0;
+        for (uint32_t b = 0; b < NumBits; ++b)
+            Value |= (Block[(Start + b) >> 3] >> ((Start + b) & 7) & 1) << b;
+        return Value;
+    }
+}
+
+void BlockCompress::EncodeBC1( const uint32_t Texels[16], uint8_t Block[8] )
+{
+    EncodeColor(Texels, Block);
+}
+
+void BlockCompress::EncodeBC3( const uint32_t Texels[16], uint8_t Block[16] )
+{
+    EncodeSingleChannel(Texels, 3, Block);
+    EncodeColor(Texels, Block + 8);
+}
+
+void BlockCompress::EncodeBC4( const uint32_t Texels[16], uint8_t Block[8] )
+{
+    EncodeSingleChannel(Texels, 0, Block);
+}
+
+void BlockCompress::EncodeBC5( const uint32_t Texels[16], uint8_t Block[16] )
+{
+    EncodeSingleChannel(Texels, 0, Block);
+    EncodeSingleChannel(Texels, 1, Block + 8);
+}
+
+void BlockCompress::EncodeBC7( const uint32_t Texels[16], uint8_t Block[16] )
+{
+    float Mean[4], Axis[4];
+    if (!FindPrincipalAxis(Texels, 4, Mean, Axis))
+    {
+        EncodeMode6Block(Texels, Mean, Mean, Block);
+        return;
+    }
+
+    float Endpoint0[4], Endpoint1[4];
+    FitEndpointsToAxis(Texels, 4, Mean, Axis, Endpoint0, Endpoint1);
+    int Error = EncodeMode6Block(Texels, Endpoint0, Endpoint1, Block);
+
+    for (int Pass = 0; Pass < 2 && Error > 0; ++Pass)
+    {
+        float Weights[16];
+        for (int i = 0; i < 16; ++i)
+            Weights[i] = s_BC7Weights[ReadMode6Index(Block, i)] / 64.0f;
+
+        if (!LeastSquaresEndpoints(Texels, 4, Weights, Endpoint0, Endpoint1))
+            break;
+
+        uint8_t Refined[16];
+        const int RefinedError = EncodeMode6Block(Texels, Endpoint0, Endpoint1, Refined);
+        if (RefinedError >= Error)
+            break;
+
+        Error = RefinedError;
+        memcpy(Block, Refined, 16);
+    }
+}
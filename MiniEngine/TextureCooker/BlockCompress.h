@@ -0,0 +1,39 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+// Block compression encoders.  Each one takes a 4x4 block of R8G8B8A8 texels in row order (red in the low
+// byte) and writes one compressed block.  Endpoints are fit along the principal axis of the block's colors and
+// then refined with a least squares pass over the chosen indices.  The encoders keep no state, so blocks can be
+// encoded on any number of threads at once.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace BlockCompress
+{
+    // 8 bytes.  Opaque, four-color mode only.
+    void EncodeBC1( const uint32_t Texels[16], uint8_t Block[8] );
+
+    // 16 bytes.  BC4 alpha followed by a BC1 color block.
+    void EncodeBC3( const uint32_t Texels[16], uint8_t Block[16] );
+
+    // 8 bytes.  Red channel only.
+    void EncodeBC4( const uint32_t Texels[16], uint8_t Block[8] );
+
+    // 16 bytes.  Red and green as two BC4 blocks, for tangent space normals.
+    void EncodeBC5( const uint32_t Texels[16], uint8_t Block[16] );
+
+    // 16 bytes.  Always uses mode 6:  one subset, RGBA endpoints and 16 interpolation steps.
+    void EncodeBC7( const uint32_t Texels[16], uint8_t Block[16] );
+}
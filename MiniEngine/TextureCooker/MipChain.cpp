@@ -0,0 +1,265 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#include "MipChain.h"
+
+#include <cmath>
+#include <algorithm>
+#include <ppl.h>
+
+using namespace std;
+using namespace MipChain;
+
+namespace
+{
+    struct Color
+    {
+        float r, g, b, a;
+
+        Color operator+( const Color& o ) const { Color c = { r + o.r, g + o.g, b + o.b, a + o.a }; return c; }
+        Color operator*( float s ) const { Color c = { r * s, g * s, b * s, a * s }; return c; }
+    };
+
+    // What sampling an R8G8B8A8_UNORM_SRGB texture returns
+    float SRGBToLinear( uint32_t x )
+    {
+        static float s_Table[256];
+        static bool s_Initialized = []()
+        {
+            for (int i = 0; i < 256; ++i)
+            {
+                const float c = i / 255.0f;
+                s_Table[i] = c < 0.04045f ? c / 12.92f : powf((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return true;
+        }();
+        (void)s_Initialized;
+
+        return s_Table[x];
+    }
+
+    // GenerateMipsCS writes sRGB mips through a UNORM view and applies this approximation of the curve itself
+    float ApplySRGBCurve( float x )
+    {
+        return x < 0.0031308f ? 12.92f * x : 1.13005f * sqrtf(fabsf(x - 0.00228f)) - 0.13448f * x + 0.005719f;
+    }
+
+    uint32_t ToUNORM8( float x )
+    {
+        x = x < 0.0f ? 0.0f : (x > 1.0f ? 1.0f : x);
+        return (uint32_t)(x * 255.0f + 0.5f);
+    }
+
+    Color Unpack( uint32_t Texel, bool sRGB )
+    {
+        Color c;
+        if (sRGB)
+        {
+            c.r = SRGBToLinear(Texel & 0xFF);
+            c.g = SRGBToLinear(Texel >> 8 & 0xFF);
+            c.b = SRGBToLinear(Texel >> 16 & 0xFF);
+        }
+        else
+        {
+            c.r = (Texel & 0xFF) / 255.0f;
+            c.g = (Texel >> 8 & 0xFF) / 255.0f;
+            c.b = (Texel >> 16 & 0xFF) / 255.0f;
+        }
+        c.a = (Texel >> 24) / 255.0f;
+        return c;
+    }
+
+    uint32_t Pack( const Color& c, bool sRGB )
+    {
+        if (sRGB)
+        {
+            return ToUNORM8(ApplySRGBCurve(c.r)) | ToUNORM8(ApplySRGBCurve(c.g)) << 8 |
+                ToUNORM8(ApplySRGBCurve(c.b)) << 16 | ToUNORM8(c.a) << 24;
+        }
+        else
+        {
+            return ToUNORM8(c.r) | ToUNORM8(c.g) << 8 | ToUNORM8(c.b) << 16 | ToUNORM8(c.a) << 24;
+        }
+    }
+
+    // Bilinear filtering with clamp addressing, as with the static sampler of GenerateMipsCS
+    Color SampleBilinear( const vector<Color>& Src, uint32_t Width, uint32_t Height, float u, float v )
+    {
+        const float x = u * Width - 0.5f;
+        const float y = v * Height - 0.5f;
+        const float fx = floorf(x);
+        const float fy = floorf(y);
+        const float wx = x - fx;
+        const float wy = y - fy;
+
+        const int x0 = min(max((int)fx, 0), (int)Width - 1);
+        const int x1 = min(max((int)fx + 1, 0), (int)Width - 1);
+        const int y0 = min(max((int)fy, 0), (int)Height - 1);
+        const int y1 = min(max((int)fy + 1, 0), (int)Height - 1);
+
+        const Color Top = Src[y0 * Width + x0] * (1.0f - wx) + Src[y0 * Width + x1] * wx;
+        const Color Bottom = Src[y1 * Width + x0] * (1.0f - wx) + Src[y1 * Width + x1] * wx;
+        return Top * (1.0f - wy) + Bottom * wy;
+    }
+
+    template <typename Function>
+    void ForEachRow( uint32_t Width, uint32_t Height, Function RowFunction )
+    {
+        if ((size_t)Width * Height < 64 * 1024)
+        {
+            for (uint32_t y = 0; y < Height; ++y)
+                RowFunction(y);
+        }
+        else
+        {
+            concurrency::parallel_for(0u, Height, RowFunction);
+        }
+    }
+
+    inline uint32_t AlignUp( uint32_t Value, uint32_t Alignment )
+    {
+        return (Value + Alignment - 1) & ~(Alignment - 1);
+    }
+
+    uint32_t CountTrailingZeros( uint32_t Value )
+    {
+        uint32_t Count = 0;
+        while (Count < 32 && (Value & (1u << Count)) == 0)
+            ++Count;
+        return Count;
+    }
+}
+
+uint32_t MipChain::CountMips( uint32_t Width, uint32_t Height )
+{
+    uint32_t Count = 1;
+    while (Width > 1 || Height > 1)
+    {
+        Width = max(Width >> 1, 1u);
+        Height = max(Height >> 1, 1u);
+        ++Count;
+    }
+    return Count;
+}
+
+void MipChain::Generate( vector<Image>& Mips, bool sRGB )
+{
+    const uint32_t Width = Mips[0].Width;
+    const uint32_t Height = Mips[0].Height;
+    const uint32_t NumMipMaps = CountMips(Width, Height) - 1;
+
+    Mips.resize(NumMipMaps + 1);
+
+    // This follows ColorBuffer::GenerateMipMaps() dispatch for dispatch.  Each dispatch reads one stored level
+    // and writes up to four more, keeping the intermediate results at full precision.
+    for (uint32_t TopMip = 0; TopMip < NumMipMaps; )
+    {
+        const uint32_t SrcWidth = Width >> TopMip;
+        const uint32_t SrcHeight = Height >> TopMip;
+        uint32_t DstWidth = SrcWidth >> 1;
+        uint32_t DstHeight = SrcHeight >> 1;
+
+        // An odd source dimension means the first downsample is more than 2:1 and needs two samples per axis
+        const uint32_t NonPowerOfTwo = (SrcWidth & 1) | (SrcHeight & 1) << 1;
+
+        const uint32_t AdditionalMips = CountTrailingZeros(
+            (DstWidth == 1 ? DstHeight : DstWidth) | (DstHeight == 1 ? DstWidth : DstHeight));
+        uint32_t NumMips = 1 + (AdditionalMips > 3 ? 3 : AdditionalMips);
+        if (TopMip + NumMips > NumMipMaps)
+            NumMips = NumMipMaps - TopMip;
+
+        if (DstWidth == 0)
+            DstWidth = 1;
+        if (DstHeight == 0)
+            DstHeight = 1;
+
+        const uint32_t SrcW = max(SrcWidth, 1u);
+        const uint32_t SrcH = max(SrcHeight, 1u);
+        const Image& Source = Mips[TopMip];
+
+        vector<Color> Src(Source.Texels.size());
+        for (size_t i = 0; i < Src.size(); ++i)
+            Src[i] = Unpack(Source.Texels[i], sRGB);
+
+        // The shader runs whole 8x8 groups, and the threads past the edge still sample (with clamping) and feed
+        // the later downsamples.  Evaluating the same padded region reproduces its results at the borders.
+        const uint32_t Padding = 1u << (NumMips - 1);
+        uint32_t PaddedWidth = AlignUp(DstWidth, Padding);
+        uint32_t PaddedHeight = AlignUp(DstHeight, Padding);
+
+        const float TexelSizeX = 1.0f / DstWidth;
+        const float TexelSizeY = 1.0f / DstHeight;
+
+        const float OffsetsX[2] = { (NonPowerOfTwo & 1) ? 0.25f : 0.5f, 0.75f };
+        const float OffsetsY[2] = { (NonPowerOfTwo & 2) ? 0.25f : 0.5f, 0.75f };
+        const uint32_t SamplesX = (NonPowerOfTwo & 1) ? 2 : 1;
+        const uint32_t SamplesY = (NonPowerOfTwo & 2) ? 2 : 1;
+        const float SampleWeight = 1.0f / (SamplesX * SamplesY);
+
+        vector<Color> Level((size_t)PaddedWidth * PaddedHeight);
+        ForEachRow(PaddedWidth, PaddedHeight, [&]( uint32_t y )
+        {
+            for (uint32_t x = 0; x < PaddedWidth; ++x)
+            {
+                Color Sum = {};
+                for (uint32_t sy = 0; sy < SamplesY; ++sy)
+                {
+                    for (uint32_t sx = 0; sx < SamplesX; ++sx)
+                    {
+                        Sum = Sum + SampleBilinear(Src, SrcW, SrcH,
+                            TexelSizeX * (x + OffsetsX[sx]), TexelSizeY * (y + OffsetsY[sy]));
+                    }
+                }
+                Level[y * PaddedWidth + x] = Sum * SampleWeight;
+            }
+        });
+
+        for (uint32_t n = 0; n < NumMips; ++n)
+        {
+            // Later levels are 2x2 averages of the unquantized level before
+            if (n > 0)
+            {
+                const uint32_t NextWidth = PaddedWidth >> 1;
+                const uint32_t NextHeight = PaddedHeight >> 1;
+                vector<Color> Next((size_t)NextWidth * NextHeight);
+
+                ForEachRow(NextWidth, NextHeight, [&]( uint32_t y )
+                {
+                    for (uint32_t x = 0; x < NextWidth; ++x)
+                    {
+                        const Color* Row0 = &Level[(2 * y) * PaddedWidth + 2 * x];
+                        const Color* Row1 = Row0 + PaddedWidth;
+                        Next[y * NextWidth + x] = (Row0[0] + Row0[1] + Row1[0] + Row1[1]) * 0.25f;
+                    }
+                });
+
+                Level.swap(Next);
+                PaddedWidth = NextWidth;
+                PaddedHeight = NextHeight;
+            }
+
+            Image& Dest = Mips[TopMip + 1 + n];
+            Dest.Width = max(Width >> (TopMip + 1 + n), 1u);
+            Dest.Height = max(Height >> (TopMip + 1 + n), 1u);
+            Dest.Texels.resize((size_t)Dest.Width * Dest.Height);
+
+            for (uint32_t y = 0; y < Dest.Height; ++y)
+            {
+                for (uint32_t x = 0; x < Dest.Width; ++x)
+                    Dest.Texels[y * Dest.Width + x] = Pack(Level[y * PaddedWidth + x], sRGB);
+            }
+        }
+
+        TopMip += NumMips;
+    }
+}
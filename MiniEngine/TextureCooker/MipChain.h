@@ -0,0 +1,38 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+// Builds mip chains on the CPU with the same filters ColorBuffer::GenerateMipMaps() runs on the GPU, so that
+// cooked textures look the same as ones whose mips were generated at runtime.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace MipChain
+{
+    // One tightly packed level of R8G8B8A8 texels
+    struct Image
+    {
+        uint32_t Width;
+        uint32_t Height;
+        std::vector<uint32_t> Texels;
+    };
+
+    // Number of levels in a full chain down to 1x1
+    uint32_t CountMips( uint32_t Width, uint32_t Height );
+
+    // Appends the rest of the chain to Mips, which holds level 0.  sRGB textures are filtered in linear space
+    // like GenerateMipsGammaCS; everything else is filtered as stored like GenerateMipsLinearCS.
+    void Generate( std::vector<Image>& Mips, bool sRGB );
+}
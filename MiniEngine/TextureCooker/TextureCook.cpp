@@ -0,0 +1,508 @@
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+// Developed by Minigraph
+//
+// Author:  James Stanard
+//
+
+#include "pch.h"
+#include "Model.h"
+#include "FileUtility.h"
+#include "PixelConversion.h"
+#include "TexturePackage.h"
+#include "BlockCompress.h"
+#include "MipChain.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <map>
+#include <chrono>
+#include <ppl.h>
+
+using namespace std;
+using namespace Graphics;
+
+namespace
+{
+    enum TextureUsage
+    {
+        kUsageColor,		// Diffuse and specular maps, sampled as sRGB
+        kUsageNormal,
+    };
+
+    struct Options
+    {
+        string ColorFormat;
+        string NormalFormat;
+        string TextureRoot;
+    };
+
+    typedef void (*BlockEncoder)( const uint32_t Texels[16], uint8_t* Block );
+
+    struct CookedTexture
+    {
+        string Name;
+        TextureUsage Usage;
+        bool Succeeded;
+
+        DXGI_FORMAT Format;
+        uint32_t Width;
+        uint32_t Height;
+
+        // Mips are stored as tightly packed rows of blocks until the package is laid out
+        vector< vector<uint8_t> > Mips;
+        vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> Footprints;
+        vector<uint32_t> RowSizes;
+    };
+
+    void PrintHelp()
+    {
+        printf("texture_cook\n");
+
+        printf("usage:\n");
+        printf("texture_cook [options] model_file output_file\n");
+        printf("\n");
+        printf("options:\n");
+        printf("  -color bc7|bc1          diffuse and specular maps (default bc7).  bc1 uses bc3 for maps with alpha.\n");
+        printf("  -normal bc7|bc5|bc1     normal maps (default bc7).  bc5 keeps only X and Y, so shaders must rebuild Z.\n");
+        printf("  -root path              where the model's textures are (default Textures/)\n");
+        printf("\n");
+        printf("Name the output after the model with a .texpak extension to have it loaded along with the model.\n");
+    }
+
+    bool FileExists( const string& Path )
+    {
+        return GetFileAttributesA(Path.c_str()) != INVALID_FILE_ATTRIBUTES;
+    }
+
+    bool ReadMaterials( const char* ModelFile, vector<Model::Material>& Materials )
+    {
+        FILE* file = nullptr;
+        if (0 != fopen_s(&file, ModelFile, "rb"))
+            return false;
+
+        bool ok = false;
+
+        Model::Header header;
+        if (1 == fread(&header, sizeof(Model::Header), 1, file) &&
+            0 == fseek(file, (long)(sizeof(Model::Mesh) * header.meshCount), SEEK_CUR))
+        {
+            Materials.resize(header.materialCount);
+            ok = header.materialCount == 0 ||
+                1 == fread(Materials.data(), sizeof(Model::Material) * header.materialCount, 1, file);
+        }
+
+        fclose(file);
+        return ok;
+    }
+
+    // Returns true if TextureManager would find the texture.  Only .tga sources are cooked; a .dds is already
+    // compressed and is left to be loaded on its own.
+    bool AddTexture( map<string, TextureUsage>& Textures, const string& Name, TextureUsage Usage, const Options& Opts )
+    {
+        if (Name.empty())
+            return false;
+
+        if (FileExists(Opts.TextureRoot + Name + ".dds"))
+        {
+            if (Textures.find(Name) == Textures.end())
+                printf("keeping %s.dds\n", Name.c_str());
+            return true;
+        }
+
+        if (!FileExists(Opts.TextureRoot + Name + ".tga"))
+            return false;
+
+        if (Name.size() >= TexturePackage::kMaxNameLength)
+        {
+            printf("skipping %s: name is too long\n", Name.c_str());
+            return true;
+        }
+
+        Textures.insert(make_pair(Name, Usage));
+        return true;
+    }
+
+    // The same lookups with the same fallbacks as Model::LoadTextures()
+    void GatherTextures( const vector<Model::Material>& Materials, const Options& Opts, map<string, TextureUsage>& Textures )
+    {
+        AddTexture(Textures, "default", kUsageColor, Opts);
+        AddTexture(Textures, "default_specular", kUsageColor, Opts);
+        AddTexture(Textures, "default_normal", kUsageNormal, Opts);
+
+        for (const Model::Material& Material : Materials)
+        {
+            const string DiffusePath = Material.texDiffusePath;
+
+            AddTexture(Textures, DiffusePath, kUsageColor, Opts);
+
+            if (!AddTexture(Textures, Material.texSpecularPath, kUsageColor, Opts))
+                AddTexture(Textures, DiffusePath + "_specular", kUsageColor, Opts);
+
+            if (!AddTexture(Textures, Material.texNormalPath, kUsageNormal, Opts))
+                AddTexture(Textures, DiffusePath + "_normal", kUsageNormal, Opts);
+        }
+    }
+
+    bool HasTranslucency( const MipChain::Image& Image )
+    {
+        for (uint32_t Texel : Image.Texels)
+        {
+            if ((Texel >> 24) != 0xFF)
+                return true;
+        }
+        return false;
+    }
+
+    void ChooseFormat( CookedTexture& Texture, const MipChain::Image& TopMip, const Options& Opts,
+        BlockEncoder& Encoder, uint32_t& BlockBytes )
+    {
+        const bool IsColor = Texture.Usage == kUsageColor;
+
+        // Block compressed textures must have dimensions that are multiples of the block size
+        if (Texture.Width % 4 != 0 || Texture.Height % 4 != 0)
+        {
+            printf("%s: %ux%u is not a multiple of 4, leaving it uncompressed\n", Texture.Name.c_str(),
+                Texture.Width, Texture.Height);
+            Texture.Format = IsColor ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+            Encoder = nullptr;
+            BlockBytes = 4;
+            return;
+        }
+
+        const string& Choice = IsColor ? Opts.ColorFormat : Opts.NormalFormat;
+
+        if (Choice == "bc5")
+        {
+            Texture.Format = DXGI_FORMAT_BC5_UNORM;
+            Encoder = BlockCompress::EncodeBC5;
+            BlockBytes = 16;
+        }
+        else if (Choice == "bc1" && HasTranslucency(TopMip))
+        {
+            Texture.Format = IsColor ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+            Encoder = BlockCompress::EncodeBC3;
+            BlockBytes = 16;
+        }
+        else if (Choice == "bc1")
+        {
+            Texture.Format = IsColor ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+            Encoder = BlockCompress::EncodeBC1;
+            BlockBytes = 8;
+        }
+        else
+        {
+            Texture.Format = IsColor ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+            Encoder = BlockCompress::EncodeBC7;
+            BlockBytes = 16;
+        }
+    }
+
+    void CompressMip( const MipChain::Image& Mip, BlockEncoder Encoder, uint32_t BlockBytes, vector<uint8_t>& Blocks,
+        D3D12_SUBRESOURCE_FOOTPRINT& Footprint, uint32_t& RowSize )
+    {
+        if (Encoder == nullptr)
+        {
+            Blocks.resize(Mip.Texels.size() * 4);
+            memcpy(Blocks.data(), Mip.Texels.data(), Blocks.size());
+            Footprint.Width = Mip.Width;
+            Footprint.Height = Mip.Height;
+            RowSize = Mip.Width * 4;
+            return;
+        }
+
+        // Mips smaller than a block still take up a whole one, with the edge texels repeated
+        const uint32_t BlocksWide = (Mip.Width + 3) / 4;
+        const uint32_t BlocksHigh = (Mip.Height + 3) / 4;
+
+        Blocks.resize((size_t)BlocksWide * BlocksHigh * BlockBytes);
+
+        concurrency::parallel_for(0u, BlocksHigh, [&]( uint32_t BlockY )
+        {
+            uint32_t Texels[16];
+            for (uint32_t BlockX = 0; BlockX < BlocksWide; ++BlockX)
+            {
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    const uint32_t x = min(BlockX * 4 + (i & 3), Mip.Width - 1);
+                    const uint32_t y = min(BlockY * 4 + (i >> 2), Mip.Height - 1);
+                    Texels[i] = Mip.Texels[(size_t)y * Mip.Width + x];
+                }
+                Encoder(Texels, Blocks.data() + ((size_t)BlockY * BlocksWide + BlockX) * BlockBytes);
+            }
+        });
+
+        Footprint.Width = BlocksWide * 4;
+        Footprint.Height = BlocksHigh * 4;
+        RowSize = BlocksWide * BlockBytes;
+    }
+
+    void CookTexture( CookedTexture& Texture, const Options& Opts )
+    {
+        Texture.Succeeded = false;
+
+        const string SourcePath = Opts.TextureRoot + Texture.Name + ".tga";
+        Utility::ByteArray File = Utility::ReadFileSync(MakeWStr(SourcePath));
+
+        PixelConversion::TGAImage Source;
+        if (File->size() == 0 || !PixelConversion::ParseTGA(File->data(), File->size(), Source))
+        {
+            printf("failed to read %s\n", SourcePath.c_str());
+            return;
+        }
+
+        vector<MipChain::Image> Mips(1);
+        Mips[0].Width = Source.Width;
+        Mips[0].Height = Source.Height;
+        Mips[0].Texels.resize((size_t)Source.Width * Source.Height);
+
+        if (!PixelConversion::DecodeTGA(Source, Mips[0].Texels.data(), Source.Width * 4))
+        {
+            printf("failed to decode %s\n", SourcePath.c_str());
+            return;
+        }
+
+        Texture.Width = Source.Width;
+        Texture.Height = Source.Height;
+
+        BlockEncoder Encoder;
+        uint32_t BlockBytes;
+        ChooseFormat(Texture, Mips[0], Opts, Encoder, BlockBytes);
+
+        MipChain::Generate(Mips, Texture.Usage == kUsageColor);
+
+        const uint32_t MipCount = (uint32_t)Mips.size();
+        Texture.Mips.resize(MipCount);
+        Texture.Footprints.resize(MipCount);
+        Texture.RowSizes.resize(MipCount);
+
+        for (uint32_t Mip = 0; Mip < MipCount; ++Mip)
+        {
+            D3D12_SUBRESOURCE_FOOTPRINT& Footprint = Texture.Footprints[Mip].Footprint;
+            CompressMip(Mips[Mip], Encoder, BlockBytes, Texture.Mips[Mip], Footprint, Texture.RowSizes[Mip]);
+
+            Footprint.Format = Texture.Format;
+            Footprint.Depth = 1;
+            Footprint.RowPitch = Math::AlignUp(Texture.RowSizes[Mip], D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+        }
+
+        Texture.Succeeded = true;
+    }
+
+    const char* FormatName( DXGI_FORMAT Format )
+    {
+        switch (Format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB: return "BC1";
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB: return "BC3";
+        case DXGI_FORMAT_BC5_UNORM: return "BC5";
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB: return "BC7";
+        default: return "RGBA8";
+        }
+    }
+
+    // Assigns every mip its place in the texel data, one after another
+    uint64_t LayoutPackage( vector<CookedTexture*>& Textures, uint32_t& SubresourceCount )
+    {
+        uint64_t DataSize = 0;
+        SubresourceCount = 0;
+
+        for (CookedTexture* Texture : Textures)
+        {
+            for (size_t Mip = 0; Mip < Texture->Mips.size(); ++Mip)
+            {
+                D3D12_PLACED_SUBRESOURCE_FOOTPRINT& Placed = Texture->Footprints[Mip];
+                const uint32_t NumRows = (uint32_t)(Texture->Mips[Mip].size() / Texture->RowSizes[Mip]);
+
+                Placed.Offset = Math::AlignUp(DataSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+                DataSize = Placed.Offset + (uint64_t)Placed.Footprint.RowPitch * NumRows;
+            }
+            SubresourceCount += (uint32_t)Texture->Mips.size();
+        }
+
+        return DataSize;
+    }
+
+    bool WritePackage( const char* OutputFile, vector<CookedTexture*>& Textures )
+    {
+        using namespace TexturePackage;
+
+        uint32_t SubresourceCount;
+        const uint64_t DataSize = LayoutPackage(Textures, SubresourceCount);
+
+        Header PackageHeader = {};
+        PackageHeader.Magic = kMagic;
+        PackageHeader.Version = kVersion;
+        PackageHeader.TextureCount = (uint32_t)Textures.size();
+        PackageHeader.SubresourceCount = SubresourceCount;
+        PackageHeader.DataOffset = Math::AlignUp(GetTableSize(PackageHeader.TextureCount, SubresourceCount),
+            D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+        PackageHeader.DataSize = DataSize;
+
+        vector<TextureEntry> Entries(Textures.size());
+        vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> Footprints;
+        Footprints.reserve(SubresourceCount);
+
+        // The texel data is assembled exactly as it will sit in the upload buffer, row padding included
+        vector<uint8_t> Data((size_t)DataSize, 0);
+
+        for (size_t TexIdx = 0; TexIdx < Textures.size(); ++TexIdx)
+        {
+            const CookedTexture& Texture = *Textures[TexIdx];
+
+            TextureEntry& Entry = Entries[TexIdx];
+            memset(&Entry, 0, sizeof(Entry));
+            strncpy_s(Entry.Name, Texture.Name.c_str(), kMaxNameLength - 1);
+            Entry.Format = Texture.Format;
+            Entry.Width = Texture.Width;
+            Entry.Height = Texture.Height;
+            Entry.MipCount = (uint32_t)Texture.Mips.size();
+            Entry.FirstSubresource = (uint32_t)Footprints.size();
+
+            for (size_t Mip = 0; Mip < Texture.Mips.size(); ++Mip)
+            {
+                const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& Placed = Texture.Footprints[Mip];
+                const vector<uint8_t>& Rows = Texture.Mips[Mip];
+                const uint32_t RowSize = Texture.RowSizes[Mip];
+
+                for (size_t Row = 0; Row * RowSize < Rows.size(); ++Row)
+                    memcpy(&Data[(size_t)Placed.Offset + Row * Placed.Footprint.RowPitch], &Rows[Row * RowSize], RowSize);
+
+                Footprints.push_back(Placed);
+            }
+        }
+
+        FILE* file = nullptr;
+        if (0 != fopen_s(&file, OutputFile, "wb"))
+            return false;
+
+        const vector<uint8_t> Padding((size_t)(PackageHeader.DataOffset -
+            GetTableSize(PackageHeader.TextureCount, SubresourceCount)), 0);
+
+        bool ok = 1 == fwrite(&PackageHeader, sizeof(PackageHeader), 1, file);
+        if (ok && !Entries.empty())
+            ok = 1 == fwrite(Entries.data(), sizeof(TextureEntry) * Entries.size(), 1, file);
+        if (ok && !Footprints.empty())
+            ok = 1 == fwrite(Footprints.data(), sizeof(D3D12_PLACED_SUBRESOURCE_FOOTPRINT) * Footprints.size(), 1, file);
+        if (ok && !Padding.empty())
+            ok = 1 == fwrite(Padding.data(), Padding.size(), 1, file);
+        if (ok && !Data.empty())
+            ok = 1 == fwrite(Data.data(), Data.size(), 1, file);
+
+        if (EOF == fclose(file))
+            ok = false;
+
+        return ok;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options Opts;
+    Opts.ColorFormat = "bc7";
+    Opts.NormalFormat = "bc7";
+    Opts.TextureRoot = "Textures/";
+
+    int argIdx = 1;
+    for (; argIdx + 1 < argc && argv[argIdx][0] == '-'; argIdx += 2)
+    {
+        if (0 == strcmp(argv[argIdx], "-color") && (0 == strcmp(argv[argIdx + 1], "bc7") || 0 == strcmp(argv[argIdx + 1], "bc1")))
+            Opts.ColorFormat = argv[argIdx + 1];
+        else if (0 == strcmp(argv[argIdx], "-normal") && (0 == strcmp(argv[argIdx + 1], "bc7") ||
+            0 == strcmp(argv[argIdx + 1], "bc5") || 0 == strcmp(argv[argIdx + 1], "bc1")))
+            Opts.NormalFormat = argv[argIdx + 1];
+        else if (0 == strcmp(argv[argIdx], "-root"))
+            Opts.TextureRoot = argv[argIdx + 1];
+        else
+            break;
+    }
+
+    if (argc - argIdx != 2)
+    {
+        PrintHelp();
+        return -1;
+    }
+
+    const char *input_file = argv[argIdx];
+    const char *output_file = argv[argIdx + 1];
+
+    if (!Opts.TextureRoot.empty() && Opts.TextureRoot.back() != '/' && Opts.TextureRoot.back() != '\\')
+        Opts.TextureRoot += '/';
+
+    printf("input file %s\n", input_file);
+    printf("output file %s\n", output_file);
+
+    vector<Model::Material> Materials;
+    if (!ReadMaterials(input_file, Materials))
+    {
+        printf("failed to read materials: %s\n", input_file);
+        return -1;
+    }
+
+    map<string, TextureUsage> TextureNames;
+    GatherTextures(Materials, Opts, TextureNames);
+
+    vector<CookedTexture> Textures;
+    for (auto& Name : TextureNames)
+    {
+        CookedTexture Texture;
+        Texture.Name = Name.first;
+        Texture.Usage = Name.second;
+        Textures.push_back(Texture);
+    }
+
+    printf("cooking %u textures...\n", (uint32_t)Textures.size());
+
+    auto StartTime = chrono::high_resolution_clock::now();
+
+    // Textures are cooked side by side, and the mips and blocks of each are spread across the cores as well
+    concurrency::parallel_for(size_t(0), Textures.size(), [&]( size_t TexIdx )
+    {
+        CookTexture(Textures[TexIdx], Opts);
+    });
+
+    const double Seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - StartTime).count();
+
+    vector<CookedTexture*> Cooked;
+    uint64_t SourceBytes = 0;
+    uint64_t CookedBytes = 0;
+    for (CookedTexture& Texture : Textures)
+    {
+        if (!Texture.Succeeded)
+            continue;
+
+        Cooked.push_back(&Texture);
+
+        uint64_t Bytes = 0;
+        for (auto& Mip : Texture.Mips)
+            Bytes += Mip.size();
+        CookedBytes += Bytes;
+        SourceBytes += (uint64_t)Texture.Width * Texture.Height * 4;
+
+        printf("%-48s %5ux%-5u %2u mips  %-5s %8.1f KB\n", Texture.Name.c_str(), Texture.Width, Texture.Height,
+            (uint32_t)Texture.Mips.size(), FormatName(Texture.Format), Bytes / 1024.0);
+    }
+
+    printf("cooked %u of %u textures in %.2f seconds (%.1f MB of top mips, %.1f MB cooked)\n",
+        (uint32_t)Cooked.size(), (uint32_t)Textures.size(), Seconds, SourceBytes / 1048576.0, CookedBytes / 1048576.0);
+
+    printf("saving...\n");
+    if (!WritePackage(output_file, Cooked))
+    {
+        printf("failed to save package: %s\n", output_file);
+        return -1;
+    }
+
+    printf("done\n");
+
+    return 0;
+}
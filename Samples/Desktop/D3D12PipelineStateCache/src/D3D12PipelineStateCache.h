@@ -106,6 +106,19 @@ private:
 	PSOLibrary m_psoLibrary;
 	DynamicConstantBuffer m_dynamicCB;
 
+	// Frame time statistics, split by whether PSOs were being compiled.
+	enum FrameTimeBucket
+	{
+		FrameTimeIdle,
+		FrameTimeCompiling,
+		FrameTimeBucketCount
+	};
+
+	double m_frameTimeTotals[FrameTimeBucketCount];
+	UINT m_frameTimeCounts[FrameTimeBucketCount];
+	double m_frameTimeAverages[FrameTimeBucketCount];
+	double m_statsStartTime;
+
 	inline float GetRandomColor() { return (rand() % 100) / 100.0f; }
 
 	void LoadPipeline();
@@ -113,6 +126,7 @@ private:
 	void PopulateCommandList();
 	void ToggleEffect(EffectPipelineType type);
 	void UpdateWindowTextPso();
+	void UpdateFrameStats();
 	void WaitForGpu();
 	void MoveToNextFrame();
 };
@@ -12,31 +12,90 @@
 #include "stdafx.h"
 #include "PSOLibrary.h"
 
-using namespace Microsoft::WRL::Wrappers;
+static UINT64 GetTicks()
+{
+	LARGE_INTEGER ticks;
+	QueryPerformanceCounter(&ticks);
+	return ticks.QuadPart;
+}
 
 PSOLibrary::PSOLibrary(UINT frameCount, UINT cbvRootSignatureIndex) :
 	m_cbvRootSignatureIndex(cbvRootSignatureIndex),
 	m_maxDrawsPerFrame(256),
 	m_dynamicCB(sizeof(UberShaderConstantBuffer), m_maxDrawsPerFrame, frameCount),
-	m_flagsMutex(),
+	m_pDevice(nullptr),
+	m_pRootSignature(nullptr),
+	m_compileThreads{},
+	m_compileThreadCount(0),
+	m_shutdown(false),
 	m_useUberShaders(true),
 	m_useDiskLibraries(true),
 	m_psoCachingMechanism(PSOCachingMechanism::PipelineLibraries),
 	m_drawIndex(0),
-	m_compiledPSOFlags{},
-	m_inflightPSOFlags{},
-	m_workerThreads{}
+	m_requestTicks{},
+	m_timeToPSOTotal(0.0),
+	m_timeToPSOCount(0),
+	m_frameCompiling(false),
+	m_lastFrameCompiling(false)
 {
 	WCHAR path[512];
 	GetAssetsPath(path, _countof(path));
 	m_cachePath = path;
 
-	m_flagsMutex = CreateMutex(nullptr, FALSE, nullptr);
+	LARGE_INTEGER frequency;
+	QueryPerformanceFrequency(&frequency);
+	m_ticksPerSecond = frequency.QuadPart;
+
+	for (UINT i = 0; i < EffectPipelineTypeCount; i++)
+	{
+		m_psoStates[i].store(PSOStateNotCompiled);
+		m_queuedPriorities[i] = CompilePriorityCount;
+	}
+
+	InitializeSRWLock(&m_queueLock);
+	InitializeConditionVariable(&m_compileRequested);
+	InitializeConditionVariable(&m_compileFinished);
+
+	// A fixed number of compile threads, leaving a core for the render thread, so a burst of
+	// new effects doesn't create a burst of threads competing with rendering.
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	m_compileThreadCount = systemInfo.dwNumberOfProcessors > 1 ? systemInfo.dwNumberOfProcessors - 1 : 1;
+	if (m_compileThreadCount > MaxCompileThreads)
+	{
+		m_compileThreadCount = MaxCompileThreads;
+	}
+
+	for (UINT i = 0; i < m_compileThreadCount; i++)
+	{
+		m_compileThreads[i] = CreateThread(
+			nullptr,
+			0,
+			CompileThreadProc,
+			reinterpret_cast<void*>(this),
+			0,
+			nullptr);
+
+		if (!m_compileThreads[i])
+		{
+			ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+		}
+	}
 }
 
 PSOLibrary::~PSOLibrary()
 {
-	WaitForThreads();
+	// The compile threads finish the PSO they're compiling, and drop the rest of the queue.
+	AcquireSRWLockExclusive(&m_queueLock);
+	m_shutdown = true;
+	ReleaseSRWLockExclusive(&m_queueLock);
+	WakeAllConditionVariable(&m_compileRequested);
+
+	for (UINT i = 0; i < m_compileThreadCount; i++)
+	{
+		WaitForSingleObject(m_compileThreads[i], INFINITE);
+		CloseHandle(m_compileThreads[i]);
+	}
 
 	for (UINT i = 0; i < EffectPipelineTypeCount; i++)
 	{
@@ -47,21 +106,95 @@ PSOLibrary::~PSOLibrary()
 	m_pipelineLibrary.Destroy(false);
 }
 
-void PSOLibrary::WaitForThreads()
+DWORD WINAPI PSOLibrary::CompileThreadProc(void* pContext)
+{
+	reinterpret_cast<PSOLibrary*>(pContext)->CompileThread();
+	return 0;
+}
+
+void PSOLibrary::CompileThread()
+{
+	for (;;)
+	{
+		EffectPipelineType type;
+		bool found = false;
+
+		AcquireSRWLockExclusive(&m_queueLock);
+		while (!found && !m_shutdown)
+		{
+			found = PopCompileRequest(&type);
+			if (!found && !m_shutdown)
+			{
+				SleepConditionVariableSRW(&m_compileRequested, &m_queueLock, INFINITE, 0);
+			}
+		}
+		ReleaseSRWLockExclusive(&m_queueLock);
+
+		if (!found)
+		{
+			return;
+		}
+
+		CompilePSO(type);
+	}
+}
+
+// Takes the most important queued effect off the queues. The queue lock must be held.
+bool PSOLibrary::PopCompileRequest(EffectPipelineType* pType)
 {
-	for (auto& thread : m_workerThreads)
+	for (UINT priority = 0; priority < CompilePriorityCount; priority++)
 	{
-		if (thread.threadHandle)
+		auto& queue = m_compileQueues[priority];
+		while (!queue.empty())
 		{
-			WaitForSingleObject(thread.threadHandle, INFINITE);
-			CloseHandle(thread.threadHandle);
+			EffectPipelineType type = queue.front();
+			queue.pop_front();
+
+			// Skip the entries left behind by promoted, cancelled, or already compiled requests.
+			UINT state = PSOStateQueued;
+			if (m_queuedPriorities[type] == priority &&
+				m_psoStates[type].compare_exchange_strong(state, PSOStateCompiling))
+			{
+				m_queuedPriorities[type] = CompilePriorityCount;
+				*pType = type;
+				return true;
+			}
 		}
-		thread.threadHandle = nullptr;
+	}
+
+	return false;
+}
+
+void PSOLibrary::RequestCompile(EffectPipelineType type, CompilePriority priority)
+{
+	bool queued = false;
+
+	AcquireSRWLockExclusive(&m_queueLock);
+
+	// Requests for an effect that is already queued at the same or a higher priority, or is
+	// already compiling, are coalesced. Otherwise the effect is queued, or promoted.
+	UINT state = PSOStateNotCompiled;
+	if (m_psoStates[type].compare_exchange_strong(state, PSOStateQueued) ||
+		(state == PSOStateQueued && priority < m_queuedPriorities[type]))
+	{
+		m_compileQueues[priority].push_back(type);
+		m_queuedPriorities[type] = priority;
+		queued = true;
+	}
+
+	ReleaseSRWLockExclusive(&m_queueLock);
+
+	if (queued)
+	{
+		WakeConditionVariable(&m_compileRequested);
 	}
 }
 
 void PSOLibrary::Build(ID3D12Device* pDevice, ID3D12RootSignature* pRootSignature)
 {
+	m_pDevice = pDevice;
+	m_pRootSignature = pRootSignature;
+
 	// Initialize all cache file mappings (file may be empty).
 	m_pipelineLibrariesSupported = m_pipelineLibrary.Init(pDevice, m_cachePath + g_cPipelineLibraryFileName);
 	for (UINT i = 0; i < EffectPipelineTypeCount; i++)
@@ -79,11 +212,8 @@ void PSOLibrary::Build(ID3D12Device* pDevice, ID3D12RootSignature* pRootSignatur
 	// Always compile the 3D shader and the Ubershader.
 	for (UINT i = 0; i < BaseEffectCount; i++)
 	{
-		m_workerThreads[i].pDevice = pDevice;
-		m_workerThreads[i].pRootSignature = pRootSignature;
-		m_workerThreads[i].type = EffectPipelineType(i);
-		m_workerThreads[i].pLibrary = this;
-		CompilePSO(&m_workerThreads[i]);
+		m_psoStates[i].store(PSOStateCompiling);
+		CompilePSO(EffectPipelineType(i));
 	}
 
 	m_dynamicCB.Init(pDevice);
@@ -91,24 +221,14 @@ void PSOLibrary::Build(ID3D12Device* pDevice, ID3D12RootSignature* pRootSignatur
 
 
 void PSOLibrary::SetPipelineState(
-	ID3D12Device* pDevice,
-	ID3D12RootSignature* pRootSignature,
 	ID3D12GraphicsCommandList* pCommandList,
 	_In_range_(0, EffectPipelineTypeCount-1) EffectPipelineType type,
 	UINT frameIndex)
 {
 	assert(m_drawIndex < m_maxDrawsPerFrame);
 
-	bool isBuilt = false;
-	bool isInFlight = false;
-
-	{
-		// Take the lock to figure out if we need to build this thing or use an Uber shader.
-		auto lock = Mutex::Lock(m_flagsMutex);
-
-		isBuilt = m_compiledPSOFlags[type];
-		isInFlight = m_inflightPSOFlags[type];
-	}
+	// Pairs with the release in CompilePSO(), so the PSO is visible once the effect reads as compiled.
+	bool isBuilt = (m_psoStates[type].load(std::memory_order_acquire) == PSOStateCompiled);
 
 	if (type > BaseUberShader)
 	{
@@ -120,35 +240,12 @@ void PSOLibrary::SetPipelineState(
 			constantData->effectIndex = type;
 			pCommandList->SetGraphicsRootConstantBufferView(m_cbvRootSignatureIndex, m_dynamicCB.GetGpuVirtualAddress(m_drawIndex, frameIndex));
 
-			// We don't want to double compile.
-			if (!isInFlight)
+			// Compile the PSO on the compile threads, ahead of any prewarming. This only needs
+			// to be requested the first time the effect is drawn.
+			if (m_requestTicks[type] == 0)
 			{
-				m_workerThreads[type].pDevice = pDevice;
-				m_workerThreads[type].pRootSignature = pRootSignature;
-				m_workerThreads[type].type = type;
-				m_workerThreads[type].pLibrary = this;
-
-				// Compile the PSO on a background thread.
-				m_workerThreads[type].threadHandle = CreateThread(
-					nullptr,
-					0,
-					reinterpret_cast<LPTHREAD_START_ROUTINE>(CompilePSO),
-					reinterpret_cast<void*>(&m_workerThreads[type]),
-					CREATE_SUSPENDED,
-					nullptr);
-
-				if (!m_workerThreads[type].threadHandle)
-				{
-					ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
-				}
-
-				ResumeThread(m_workerThreads[type].threadHandle);
-
-				{
-					auto lock = Mutex::Lock(m_flagsMutex);
-
-					m_inflightPSOFlags[type] = true;
-				}
+				m_requestTicks[type] = GetTicks();
+				RequestCompile(type, CompilePriorityOnScreen);
 			}
 
 			type = BaseUberShader;
@@ -157,13 +254,23 @@ void PSOLibrary::SetPipelineState(
 		{
 			// When not using ubershaders this will take a long time and cause a hitch as the 
 			// CPU is stalled!
-			m_workerThreads[type].pDevice = pDevice;
-			m_workerThreads[type].pRootSignature = pRootSignature;
-			m_workerThreads[type].type = type;
-			m_workerThreads[type].pLibrary = this;
+			if (m_requestTicks[type] == 0)
+			{
+				m_requestTicks[type] = GetTicks();
+			}
+
+			CompilePSOImmediately(type);
+		}
 
-			CompilePSO(&m_workerThreads[type]);
+		if (type != BaseUberShader && m_requestTicks[type] != 0)
+		{
+			// This is the first draw with the effect's own PSO.
+			m_timeToPSOTotal += static_cast<double>(GetTicks() - m_requestTicks[type]) / m_ticksPerSecond;
+			m_timeToPSOCount++;
+			m_requestTicks[type] = 0;
 		}
+
+		m_frameCompiling |= !isBuilt;
 	}
 	else
 	{
@@ -176,24 +283,43 @@ void PSOLibrary::SetPipelineState(
 	m_drawIndex++;
 }
 
-void PSOLibrary::CompilePSO(CompilePSOThreadData* pDataPackage)
+void PSOLibrary::CompilePSOImmediately(EffectPipelineType type)
 {
-	PSOLibrary* pLibrary = pDataPackage->pLibrary;
-	ID3D12Device* pDevice = pDataPackage->pDevice;
-	ID3D12RootSignature* pRootSignature = pDataPackage->pRootSignature;
-	EffectPipelineType type = pDataPackage->type;
-	bool useCache = false;
-	bool sleepToEmulateComplexCreatePSO = false;
-
+	UINT state = m_psoStates[type].load();
+	while (state == PSOStateNotCompiled || state == PSOStateQueued)
 	{
-		auto lock = Mutex::Lock(pLibrary->m_flagsMutex);
+		// If the effect is queued, its queue entry is skipped by the compile threads.
+		if (m_psoStates[type].compare_exchange_weak(state, PSOStateCompiling))
+		{
+			CompilePSO(type);
+			return;
+		}
+	}
 
-		// When using the disk cache compilation should be extremely quick so don't sleep.
-		useCache = pLibrary->m_useDiskLibraries;
+	// A compile thread is already compiling it.
+	WaitForPSO(type);
+}
+
+void PSOLibrary::WaitForPSO(EffectPipelineType type)
+{
+	AcquireSRWLockExclusive(&m_queueLock);
+	while (m_psoStates[type].load() == PSOStateCompiling)
+	{
+		SleepConditionVariableSRW(&m_compileFinished, &m_queueLock, INFINITE, 0);
 	}
+	ReleaseSRWLockExclusive(&m_queueLock);
+}
+
+void PSOLibrary::CompilePSO(EffectPipelineType type)
+{
+	ID3D12Device* pDevice = m_pDevice;
+	bool sleepToEmulateComplexCreatePSO = false;
+
+	// When using the disk cache compilation should be extremely quick so don't sleep.
+	bool useCache = m_useDiskLibraries;
 
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC baseDesc = {};
-	baseDesc.pRootSignature = pRootSignature;
+	baseDesc.pRootSignature = m_pRootSignature;
 	baseDesc.SampleMask = UINT_MAX;
 	baseDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
 	baseDesc.PrimitiveTopologyType = D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE;
@@ -212,21 +338,21 @@ void PSOLibrary::CompilePSO(CompilePSOThreadData* pDataPackage)
 	baseDesc.GS = g_cEffectShaderData[type].GS;
 
 	if (useCache && 
-		(pLibrary->m_psoCachingMechanism == PSOCachingMechanism::PipelineLibraries))
+		(m_psoCachingMechanism == PSOCachingMechanism::PipelineLibraries))
 	{
-		assert(pLibrary->m_pipelineLibrary.IsMapped());
-		ID3D12PipelineLibrary* pPipelineLibrary = pLibrary->m_pipelineLibrary.GetPipelineLibrary();
+		assert(m_pipelineLibrary.IsMapped());
+		ID3D12PipelineLibrary* pPipelineLibrary = m_pipelineLibrary.GetPipelineLibrary();
 
 		// Note: Load*Pipeline() will auto-name PSOs for you based on the provided name. However, this sample overrides those names.
-		HRESULT hr = pPipelineLibrary->LoadGraphicsPipeline(g_cEffectNames[type], &baseDesc, IID_PPV_ARGS(&pLibrary->m_pipelineStates[type]));
+		HRESULT hr = pPipelineLibrary->LoadGraphicsPipeline(g_cEffectNames[type], &baseDesc, IID_PPV_ARGS(&m_pipelineStates[type]));
 		if (E_INVALIDARG == hr)
 		{
 			// A PSO with the specified name doesnt exist, or the input desc doesnt match the data in the library.
 			// Create the PSO and then store it in the library for next time.
-			ThrowIfFailed(pDevice->CreateGraphicsPipelineState(&baseDesc, IID_PPV_ARGS(&pLibrary->m_pipelineStates[type])));
+			ThrowIfFailed(pDevice->CreateGraphicsPipelineState(&baseDesc, IID_PPV_ARGS(&m_pipelineStates[type])));
 
 			// Note: You don't need to pass StorePipeline() a name if the object is already named. If the name parameter is null, it will use the object's name.
-			hr = pPipelineLibrary->StorePipeline(g_cEffectNames[type], pLibrary->m_pipelineStates[type].Get());
+			hr = pPipelineLibrary->StorePipeline(g_cEffectNames[type], m_pipelineStates[type].Get());
 			if (E_INVALIDARG == hr)
 			{
 				// A PSO with the specified name already exists in the library.
@@ -245,40 +371,40 @@ void PSOLibrary::CompilePSO(CompilePSOThreadData* pDataPackage)
 		}
 	}
 	else if (useCache && 
-		(pLibrary->m_psoCachingMechanism == PSOCachingMechanism::CachedBlobs))
+		(m_psoCachingMechanism == PSOCachingMechanism::CachedBlobs))
 	{
 		// Read how long the cached shader blob is.
-		assert(pLibrary->m_diskCaches[type].IsMapped());
-		size_t size = pLibrary->m_diskCaches[type].GetCachedBlobSize();
+		assert(m_diskCaches[type].IsMapped());
+		size_t size = m_diskCaches[type].GetCachedBlobSize();
 
 		// If the size if 0 then this disk cache needs to be refreshed.
 		if (size == 0)
 		{
-			ThrowIfFailed(pDevice->CreateGraphicsPipelineState(&baseDesc, IID_PPV_ARGS(&pLibrary->m_pipelineStates[type])));
+			ThrowIfFailed(pDevice->CreateGraphicsPipelineState(&baseDesc, IID_PPV_ARGS(&m_pipelineStates[type])));
 
 			ComPtr<ID3DBlob> blob;
-			pLibrary->m_pipelineStates[type]->GetCachedBlob(&blob);
-			pLibrary->m_diskCaches[type].Update(blob.Get());
+			m_pipelineStates[type]->GetCachedBlob(&blob);
+			m_diskCaches[type].Update(blob.Get());
 
 			sleepToEmulateComplexCreatePSO = true;
 		}
 		else
 		{
 			// Read in the blob data from disk to avoid compiling it.
-			baseDesc.CachedPSO.pCachedBlob = pLibrary->m_diskCaches[type].GetCachedBlob();
-			baseDesc.CachedPSO.CachedBlobSizeInBytes = pLibrary->m_diskCaches[type].GetCachedBlobSize();
+			baseDesc.CachedPSO.pCachedBlob = m_diskCaches[type].GetCachedBlob();
+			baseDesc.CachedPSO.CachedBlobSizeInBytes = m_diskCaches[type].GetCachedBlobSize();
 
-			HRESULT hr = pDevice->CreateGraphicsPipelineState(&baseDesc, IID_PPV_ARGS(&pLibrary->m_pipelineStates[type]));
+			HRESULT hr = pDevice->CreateGraphicsPipelineState(&baseDesc, IID_PPV_ARGS(&m_pipelineStates[type]));
 
 			// If compilation fails the cache is probably stale. (old drivers etc.)
 			if (FAILED(hr))
 			{
 				baseDesc.CachedPSO = {};
-				ThrowIfFailed(pDevice->CreateGraphicsPipelineState(&baseDesc, IID_PPV_ARGS(&pLibrary->m_pipelineStates[type])));
+				ThrowIfFailed(pDevice->CreateGraphicsPipelineState(&baseDesc, IID_PPV_ARGS(&m_pipelineStates[type])));
 
 				ComPtr<ID3DBlob> blob;
-				pLibrary->m_pipelineStates[type]->GetCachedBlob(&blob);
-				pLibrary->m_diskCaches[type].Update(blob.Get());
+				m_pipelineStates[type]->GetCachedBlob(&blob);
+				m_diskCaches[type].Update(blob.Get());
 
 				sleepToEmulateComplexCreatePSO = true;
 			}
@@ -286,7 +412,7 @@ void PSOLibrary::CompilePSO(CompilePSOThreadData* pDataPackage)
 	}
 	else
 	{
-		ThrowIfFailed(pDevice->CreateGraphicsPipelineState(&baseDesc, IID_PPV_ARGS(&pLibrary->m_pipelineStates[type])));
+		ThrowIfFailed(pDevice->CreateGraphicsPipelineState(&baseDesc, IID_PPV_ARGS(&m_pipelineStates[type])));
 
 		sleepToEmulateComplexCreatePSO = true;
 	}
@@ -300,36 +426,81 @@ void PSOLibrary::CompilePSO(CompilePSOThreadData* pDataPackage)
 	WCHAR name[50];
 	if (swprintf_s(name, L"m_pipelineStates[%s]", g_cEffectNames[type]) > 0)
 	{
-		SetName(pLibrary->m_pipelineStates[type].Get(), name);
+		SetName(m_pipelineStates[type].Get(), name);
 	}
 
+	// Publish the PSO, then wake anything waiting on it. Taking the lock ensures a waiter
+	// either sees the new state or is already asleep.
+	m_psoStates[type].store(PSOStateCompiled, std::memory_order_release);
+
+	AcquireSRWLockExclusive(&m_queueLock);
+	ReleaseSRWLockExclusive(&m_queueLock);
+	WakeAllConditionVariable(&m_compileFinished);
+}
+
+// Drops the effect's request if it's still queued, otherwise waits for its compile to finish.
+void PSOLibrary::CancelCompile(EffectPipelineType type)
+{
+	AcquireSRWLockExclusive(&m_queueLock);
+	UINT state = PSOStateQueued;
+	bool cancelled = m_psoStates[type].compare_exchange_strong(state, PSOStateNotCompiled);
+	ReleaseSRWLockExclusive(&m_queueLock);
+
+	if (cancelled)
 	{
-		auto lock = Mutex::Lock(pLibrary->m_flagsMutex);
+		// It will be requested again the next time it's drawn.
+		m_requestTicks[type] = 0;
+	}
+	else
+	{
+		WaitForPSO(type);
+	}
+}
 
-		pLibrary->m_compiledPSOFlags[type] = true;
-		pLibrary->m_inflightPSOFlags[type] = false;
+// Drops all the queued compiles and waits for the running ones to finish.
+void PSOLibrary::FlushCompiles()
+{
+	for (UINT i = BaseEffectCount; i < EffectPipelineTypeCount; i++)
+	{
+		CancelCompile(EffectPipelineType(i));
+	}
+}
+
+bool PSOLibrary::IsCompiling()
+{
+	for (UINT i = BaseEffectCount; i < EffectPipelineTypeCount; i++)
+	{
+		UINT state = m_psoStates[i].load();
+		if (state == PSOStateQueued || state == PSOStateCompiling)
+		{
+			return true;
+		}
 	}
+
+	return false;
 }
 
 void PSOLibrary::EndFrame()
 {
+	m_lastFrameCompiling = m_frameCompiling || IsCompiling();
+	m_frameCompiling = false;
 	m_drawIndex = 0;
 }
 
 void PSOLibrary::ClearPSOCache()
 {
-	WaitForThreads();
+	FlushCompiles();
 
 	for (size_t i = PostBlit; i < EffectPipelineTypeCount; i++)
 	{
-		if (m_pipelineStates[i])
-		{
-			m_pipelineStates[i] = nullptr;
-			m_compiledPSOFlags[i] = false;
-			m_inflightPSOFlags[i] = false;
-		}
+		m_pipelineStates[i] = nullptr;
+		m_psoStates[i].store(PSOStateNotCompiled);
+		m_requestTicks[i] = 0;
 	}
 
+	m_timeToPSOTotal = 0.0;
+	m_timeToPSOCount = 0;
+
 	// Clear the disk caches.
 	for (size_t i = 0; i < EffectPipelineTypeCount; i++)
 	{
@@ -346,44 +517,43 @@ void PSOLibrary::ToggleUberShader()
 
 void PSOLibrary::ToggleDiskLibrary()
 {
-	{
-		auto lock = Mutex::Lock(m_flagsMutex);
-
-		m_useDiskLibraries = !m_useDiskLibraries;
-	}
+	FlushCompiles();
 
-	WaitForThreads();
+	m_useDiskLibraries = !m_useDiskLibraries;
 }
 
 void PSOLibrary::SwitchPSOCachingMechanism()
 {
-	{
-		auto lock = Mutex::Lock(m_flagsMutex);
+	FlushCompiles();
 
-		UINT newMechanism = static_cast<UINT>(m_psoCachingMechanism) + 1;
-		newMechanism = newMechanism % PSOCachingMechanism::PSOCachingMechanismCount;
+	UINT newMechanism = static_cast<UINT>(m_psoCachingMechanism) + 1;
+	newMechanism = newMechanism % PSOCachingMechanism::PSOCachingMechanismCount;
 
-		// Don't allow Pipeline Libraries if they're not available.
-		if (!m_pipelineLibrariesSupported && (newMechanism == PSOCachingMechanism::PipelineLibraries))
-		{
-			newMechanism++;
-			newMechanism = newMechanism % PSOCachingMechanism::PSOCachingMechanismCount;
-		}
-		
-		m_psoCachingMechanism = static_cast<PSOCachingMechanism>(newMechanism);
+	// Don't allow Pipeline Libraries if they're not available.
+	if (!m_pipelineLibrariesSupported && (newMechanism == PSOCachingMechanism::PipelineLibraries))
+	{
+		newMechanism++;
+		newMechanism = newMechanism % PSOCachingMechanism::PSOCachingMechanismCount;
 	}
-
-	WaitForThreads();
+	
+	m_psoCachingMechanism = static_cast<PSOCachingMechanism>(newMechanism);
 }
 
 void PSOLibrary::DestroyShader(EffectPipelineType type)
 {
-	WaitForThreads();
+	CancelCompile(type);
 
-	if (m_pipelineStates[type])
+	m_pipelineStates[type] = nullptr;
+	m_psoStates[type].store(PSOStateNotCompiled);
+	m_requestTicks[type] = 0;
+}
+
+// Queues every effect that hasn't been compiled yet behind the on-screen requests, so
+// effects that are turned on later can skip the uber shader.
+void PSOLibrary::PrewarmPipelineStates()
+{
+	for (UINT i = BaseEffectCount; i < EffectPipelineTypeCount; i++)
 	{
-		m_pipelineStates[type] = nullptr;
-		m_compiledPSOFlags[type] = false;
-		m_inflightPSOFlags[type] = false;
+		RequestCompile(EffectPipelineType(i), CompilePriorityPrewarm);
 	}
 }
@@ -210,6 +210,18 @@ static const LPWCH g_cEffectNames[EffectPipelineTypeCount] =
 	L"Wave",
 };
 
+// The order in which queued PSOs are compiled by the compile threads.
+enum CompilePriority : UINT
+{
+	// The effect is on screen and is being drawn with the uber shader until its PSO is ready.
+	CompilePriorityOnScreen,
+
+	// The effect isn't on screen yet, compile it when nothing on screen is waiting.
+	CompilePriorityPrewarm,
+
+	CompilePriorityCount
+};
+
 class PSOLibrary
 {
 public:
@@ -219,8 +231,6 @@ public:
 	void Build(ID3D12Device* pDevice, ID3D12RootSignature* pRootSignature);
 
 	void SetPipelineState(
-		ID3D12Device* pDevice,
-		ID3D12RootSignature* pRootSignature,
 		ID3D12GraphicsCommandList* pCommandList,
 		_In_range_(0, EffectPipelineTypeCount-1) EffectPipelineType type,
 		UINT frameIndex);
@@ -231,22 +241,32 @@ public:
 	void ToggleDiskLibrary();
 	void SwitchPSOCachingMechanism();
 	void DestroyShader(EffectPipelineType type);
+	void PrewarmPipelineStates();
 
 	bool UberShadersEnabled() { return m_useUberShaders; }
 	bool DiskCacheEnabled() { return m_useDiskLibraries; }
 	PSOCachingMechanism GetPSOCachingMechanism() { return m_psoCachingMechanism; }
+	UINT GetCompileThreadCount() { return m_compileThreadCount; }
+
+	// True if the last frame drew an effect without its PSO, or PSOs were compiling in the background.
+	bool LastFrameCompiling() { return m_lastFrameCompiling; }
+
+	// The average time from an effect being drawn to it being drawn with its own PSO.
+	double GetAverageTimeToPSO() { return m_timeToPSOCount ? 1000.0 * m_timeToPSOTotal / m_timeToPSOCount : 0.0; }
+	UINT GetTimeToPSOCount() { return m_timeToPSOCount; }
 
 private:
 	static const UINT BaseEffectCount = 2;
+	static const UINT MaxCompileThreads = 4;
 
-	struct CompilePSOThreadData
+	// Only the thread that moves an effect from PSOStateNotCompiled or PSOStateQueued to
+	// PSOStateCompiling compiles it, so an effect is never compiled twice.
+	enum PSOState : UINT
 	{
-		PSOLibrary* pLibrary;
-		ID3D12Device* pDevice;
-		ID3D12RootSignature* pRootSignature;
-		EffectPipelineType type;
-
-		HANDLE threadHandle;
+		PSOStateNotCompiled,
+		PSOStateQueued,
+		PSOStateCompiling,
+		PSOStateCompiled,
 	};
 
 	// This will be used to tell the uber shader which effect to use.
@@ -255,17 +275,36 @@ private:
 		UINT32 effectIndex;
 	};
 
-	static void CompilePSO(CompilePSOThreadData* pDataPackage);
-	void WaitForThreads();
+	static DWORD WINAPI CompileThreadProc(void* pContext);
+	void CompileThread();
+	bool PopCompileRequest(EffectPipelineType* pType);
+	void RequestCompile(EffectPipelineType type, CompilePriority priority);
+	void CompilePSOImmediately(EffectPipelineType type);
+	void CompilePSO(EffectPipelineType type);
+	void WaitForPSO(EffectPipelineType type);
+	void CancelCompile(EffectPipelineType type);
+	void FlushCompiles();
+	bool IsCompiling();
 
 	ComPtr<ID3D12PipelineState> m_pipelineStates[EffectPipelineTypeCount];
-	bool m_compiledPSOFlags[EffectPipelineTypeCount];
-	bool m_inflightPSOFlags[EffectPipelineTypeCount];
+	std::atomic<UINT> m_psoStates[EffectPipelineTypeCount];
 	MemoryMappedPSOCache m_diskCaches[EffectPipelineTypeCount];	// Cached blobs.
 	MemoryMappedPipelineLibrary m_pipelineLibrary; // Pipeline Library.
-	HANDLE m_flagsMutex;
-	CompilePSOThreadData m_workerThreads[EffectPipelineTypeCount];
 
+	// The compile thread pool. The queues are protected by m_queueLock, and a request that
+	// is promoted to a higher priority leaves a stale entry behind which is skipped.
+	ID3D12Device* m_pDevice;
+	ID3D12RootSignature* m_pRootSignature;
+	HANDLE m_compileThreads[MaxCompileThreads];
+	UINT m_compileThreadCount;
+	SRWLOCK m_queueLock;
+	CONDITION_VARIABLE m_compileRequested;
+	CONDITION_VARIABLE m_compileFinished;
+	std::deque<EffectPipelineType> m_compileQueues[CompilePriorityCount];
+	CompilePriority m_queuedPriorities[EffectPipelineTypeCount];
+	bool m_shutdown;
+
+	// The compile threads read the caching settings, so they're only changed after FlushCompiles().
 	bool m_useUberShaders;
 	bool m_useDiskLibraries;
 	bool m_pipelineLibrariesSupported;
@@ -276,5 +315,13 @@ private:
 	UINT m_maxDrawsPerFrame;
 	UINT m_drawIndex;
 
+	// Statistics, only accessed by the render thread.
+	UINT64 m_requestTicks[EffectPipelineTypeCount];
+	UINT64 m_ticksPerSecond;
+	double m_timeToPSOTotal;
+	UINT m_timeToPSOCount;
+	bool m_frameCompiling;
+	bool m_lastFrameCompiling;
+
 	DynamicConstantBuffer m_dynamicCB;
 };
@@ -29,6 +29,8 @@
 #include <pix3.h>
 
 #include <wrl.h>
+#include <atomic>
+#include <deque>
 #include <list>
 #include <stdio.h>
 #include <iostream>
@@ -26,7 +26,11 @@ D3D12PipelineStateCache::D3D12PipelineStateCache(UINT width, UINT height, std::w
 	m_scissorRect(0, 0, static_cast<LONG>(width), static_cast<LONG>(height)),
 	m_rtvDescriptorSize(0),
 	m_srvDescriptorSize(0),
-	m_fenceValues{}
+	m_fenceValues{},
+	m_frameTimeTotals{},
+	m_frameTimeCounts{},
+	m_frameTimeAverages{},
+	m_statsStartTime(0.0)
 {
 	memset(m_enabledEffects, true, sizeof(m_enabledEffects));
 }
@@ -382,6 +386,8 @@ void D3D12PipelineStateCache::OnUpdate()
 
 	m_timer.Tick(NULL);
 	m_camera.Update(static_cast<float>(m_timer.GetElapsedSeconds()));
+
+	UpdateFrameStats();
 }
 
 // Render the scene.
@@ -445,6 +451,10 @@ void D3D12PipelineStateCache::OnKeyUp(UINT8 key)
 		m_psoLibrary.SwitchPSOCachingMechanism();
 		break;
 
+	case 'P':
+		m_psoLibrary.PrewarmPipelineStates();
+		break;
+
 	case '1':
 		ToggleEffect(PostBlit);
 		break;
@@ -531,7 +541,7 @@ void D3D12PipelineStateCache::PopulateCommandList()
 
 		m_commandList->IASetVertexBuffers(0, 1, &m_cubeVbv);
 		m_commandList->IASetIndexBuffer(&m_cubeIbv);
-		m_psoLibrary.SetPipelineState(m_device.Get(), m_rootSignature.Get(), m_commandList.Get(), BaseNormal3DRender, m_frameIndex);
+		m_psoLibrary.SetPipelineState(m_commandList.Get(), BaseNormal3DRender, m_frameIndex);
 
 		m_commandList->SetGraphicsRootConstantBufferView(RootParameterCB, m_dynamicCB.GetGpuVirtualAddress(m_drawIndex, m_frameIndex));
 		m_commandList->DrawIndexedInstanced(36, 1, 0, 0, 0);
@@ -577,7 +587,7 @@ void D3D12PipelineStateCache::PopulateCommandList()
 
 				PIXBeginEvent(m_commandList.Get(), 0, g_cEffectNames[i]);
 				m_commandList->RSSetViewports(1, &viewport);
-				m_psoLibrary.SetPipelineState(m_device.Get(), m_rootSignature.Get(), m_commandList.Get(), static_cast<EffectPipelineType>(i), m_frameIndex);
+				m_psoLibrary.SetPipelineState(m_commandList.Get(), static_cast<EffectPipelineType>(i), m_frameIndex);
 				m_commandList->DrawInstanced(4, 1, 0, 0);
 				PIXEndEvent(m_commandList.Get());
 			}
@@ -637,9 +647,44 @@ void D3D12PipelineStateCache::UpdateWindowTextPso()
 		stringStream <<  L"false]";
 	}
 
+	stringStream.precision(1);
+	stringStream << std::fixed;
+	stringStream << L"   [Compile threads: " << m_psoLibrary.GetCompileThreadCount() << L"]";
+	stringStream << L"   [Frame time: " << m_frameTimeAverages[FrameTimeIdle] << L" ms idle, ";
+	stringStream << m_frameTimeAverages[FrameTimeCompiling] << L" ms compiling]";
+	stringStream << L"   [Time to PSO: " << m_psoLibrary.GetAverageTimeToPSO() << L" ms over ";
+	stringStream << m_psoLibrary.GetTimeToPSOCount() << L"]";
+
 	SetCustomWindowText(stringStream.str().c_str());
 }
 
+// Average the frame times over one second, split by whether PSOs were being compiled,
+// so the cost of compiling a burst of new effects is visible in the window title.
+void D3D12PipelineStateCache::UpdateFrameStats()
+{
+	const FrameTimeBucket bucket = m_psoLibrary.LastFrameCompiling() ? FrameTimeCompiling : FrameTimeIdle;
+	m_frameTimeTotals[bucket] += m_timer.GetElapsedSeconds();
+	m_frameTimeCounts[bucket]++;
+
+	const double totalSeconds = m_timer.GetTotalSeconds();
+	if (totalSeconds - m_statsStartTime >= 1.0)
+	{
+		for (UINT i = 0; i < FrameTimeBucketCount; i++)
+		{
+			if (m_frameTimeCounts[i] > 0)
+			{
+				m_frameTimeAverages[i] = 1000.0 * m_frameTimeTotals[i] / m_frameTimeCounts[i];
+			}
+
+			m_frameTimeTotals[i] = 0.0;
+			m_frameTimeCounts[i] = 0;
+		}
+
+		m_statsStartTime = totalSeconds;
+		UpdateWindowTextPso();
+	}
+}
+
 // Wait for pending GPU work to complete.
 void D3D12PipelineStateCache::WaitForGpu()
 {
@@ -12,10 +12,27 @@
 #include "stdafx.h"
 #include "Camera.h"
 
+//
+// The weight given to the latest frame when smoothing the camera velocity. Mouse input
+// arrives unevenly between frames, so a lower weight gives a steadier prediction at the
+// cost of reacting more slowly when the camera changes direction.
+//
+#define CAMERA_MOTION_SMOOTHING 0.25f
+
+//
+// The zoom limits of the camera.
+//
+#define CAMERA_MIN_ZOOM 0.1f
+#define CAMERA_MAX_ZOOM 100.0f
+
 Camera::Camera() :
 	m_position(),
 	m_zoom(),
-	m_projectionRect()
+	m_projectionRect(),
+	m_lastPosition(),
+	m_lastZoom(),
+	m_velocity(),
+	m_zoomVelocity()
 {
 }
 
@@ -28,6 +45,11 @@ void Camera::Initialize(PointF position, float zoom)
 
 	m_position = position;
 	m_zoom = zoom;
+
+	m_lastPosition = position;
+	m_lastZoom = zoom;
+	m_velocity = PointF{ 0.0f, 0.0f };
+	m_zoomVelocity = 0.0f;
 }
 
 XMMATRIX Camera::GetViewProjectionMatrix() const
@@ -60,6 +82,41 @@ RectF Camera::GenerateViewportBounds() const
 	return ViewportBounds;
 }
 
+void Camera::UpdateMotion()
+{
+	float DeltaX = m_position.X - m_lastPosition.X;
+	float DeltaY = m_position.Y - m_lastPosition.Y;
+	float DeltaZoom = log2f(m_zoom / m_lastZoom);
+
+	m_velocity.X += (DeltaX - m_velocity.X) * CAMERA_MOTION_SMOOTHING;
+	m_velocity.Y += (DeltaY - m_velocity.Y) * CAMERA_MOTION_SMOOTHING;
+	m_zoomVelocity += (DeltaZoom - m_zoomVelocity) * CAMERA_MOTION_SMOOTHING;
+
+	m_lastPosition = m_position;
+	m_lastZoom = m_zoom;
+}
+
+float Camera::PredictZoom(UINT Frames) const
+{
+	float Zoom = m_zoom * exp2f(m_zoomVelocity * Frames);
+	return min(max(Zoom, CAMERA_MIN_ZOOM), CAMERA_MAX_ZOOM);
+}
+
+RectF Camera::PredictViewportBounds(UINT Frames) const
+{
+	float Zoom = PredictZoom(Frames);
+	float X = m_position.X + m_velocity.X * Frames;
+	float Y = m_position.Y + m_velocity.Y * Frames;
+
+	RectF ViewportBounds = m_projectionRect;
+	ViewportBounds.Left = ViewportBounds.Left / Zoom + X;
+	ViewportBounds.Right = ViewportBounds.Right / Zoom + X;
+	ViewportBounds.Top = ViewportBounds.Top / Zoom + Y;
+	ViewportBounds.Bottom = ViewportBounds.Bottom / Zoom + Y;
+
+	return ViewportBounds;
+}
+
 void Camera::OnMouseMove(PointF delta)
 {
 	m_position.X -= delta.X / m_zoom;
@@ -82,13 +139,13 @@ void Camera::OnMouseWheel(short delta)
 			newZoom /= deltaZoom;
 		}
 
-		if (newZoom < 0.1f)
+		if (newZoom < CAMERA_MIN_ZOOM)
 		{
-			newZoom = 0.1f;
+			newZoom = CAMERA_MIN_ZOOM;
 		}
-		if (newZoom > 100.0f)
+		if (newZoom > CAMERA_MAX_ZOOM)
 		{
-			newZoom = 100.0f;
+			newZoom = CAMERA_MAX_ZOOM;
 		}
 
 		m_zoom = newZoom;
@@ -32,6 +32,15 @@ public:
 	XMMATRIX GetViewProjectionMatrix() const;
 	RectF GenerateViewportBounds() const;
 
+	//
+	// Motion prediction. UpdateMotion records how far the camera moved since the previous
+	// call, and should be called once per frame. The prediction assumes the camera keeps
+	// moving at its recent velocity for the given number of frames.
+	//
+	void UpdateMotion();
+	RectF PredictViewportBounds(UINT Frames) const;
+	float PredictZoom(UINT Frames) const;
+
 	void OnMouseMove(PointF delta);
 	void OnMouseWheel(short delta);
 
@@ -40,5 +49,12 @@ private:
 	float m_zoom;
 	RectF m_projectionRect;
 
+	// The camera state at the previous UpdateMotion, and the smoothed per-frame velocity
+	// of the position and of the zoom (in powers of two).
+	PointF m_lastPosition;
+	float m_lastZoom;
+	PointF m_velocity;
+	float m_zoomVelocity;
+
 	bool m_mouseDown;
 };
@@ -37,6 +37,16 @@
 //
 #define PREFETCH_DISTANCE 600.0f
 
+//
+// Predictive prefetching extrapolates the scene camera's motion over the next
+// PREFETCH_PREDICTION_FRAMES frames, sampled at PREFETCH_PREDICTION_STEPS points along the
+// way. The predicted mipmaps may add up to PREFETCH_PREDICTION_BUDGET bytes of data that is
+// not yet resident, which bounds how far ahead of the camera the paging thread is asked to load.
+//
+#define PREFETCH_PREDICTION_FRAMES 30
+#define PREFETCH_PREDICTION_STEPS 4
+#define PREFETCH_PREDICTION_BUDGET _128MB
+
 //
 // Helper function to calculate an average for a numbe rof statistic points.
 //
@@ -104,6 +114,7 @@ void InitializeImage(Image* pImage, Resource* pResource, UINT32 ImageIndex)
 
 	pImage->pResource = pResource;
 	pImage->Bounds = DestRect;
+	pImage->PredictedMip = UNDEFINED_MIPMAP_INDEX;
 }
 
 D3D12MemoryManagement::D3D12MemoryManagement()
@@ -115,6 +126,7 @@ D3D12MemoryManagement::D3D12MemoryManagement()
 	m_pCapturedCamera = &m_ViewportCamera;
 	m_pSceneCamera = &m_ViewportCamera;
 	ZeroMemory(m_GraphPoints, sizeof(m_GraphPoints));
+	ZeroMemory(m_StatMipMisses, sizeof(m_StatMipMisses));
 #if(_DEBUG)
 	m_bRenderStats = true;
 	m_bDrawMipColors = true;
@@ -359,6 +371,10 @@ bool D3D12MemoryManagement::HandleMessage(HWND hwnd, UINT Message, WPARAM wParam
 			{
 				m_bPresentOnVsync = !m_bPresentOnVsync;
 			}
+			else if (wParam == GetVirtualKeyFromCharacter('p')) // Toggle 'p'redictive prefetching.
+			{
+				m_bPredictivePrefetch = !m_bPredictivePrefetch;
+			}
 	#if(_DEBUG)
 			//
 			// In debug builds, allow simulated device removed errors for testing purposes.
@@ -485,7 +501,98 @@ bool D3D12MemoryManagement::HandleMessage(HWND hwnd, UINT Message, WPARAM wParam
 	return false;
 }
 
-void D3D12MemoryManagement::CalculateImagePagingData(const RectF* pViewportBounds, const Image* pImage, UINT8* pVisibleMip, UINT8* pPrefetchMip)
+void D3D12MemoryManagement::PredictPrefetchMips(const RectF& SceneBounds)
+{
+	m_PrefetchCandidates.clear();
+
+	for (auto& Img : m_Images)
+	{
+		Img.PredictedMip = UNDEFINED_MIPMAP_INDEX;
+	}
+
+	if (!m_bPredictivePrefetch)
+	{
+		return;
+	}
+
+	UINT PredictedFrames[PREFETCH_PREDICTION_STEPS];
+	RectF PredictedBounds[PREFETCH_PREDICTION_STEPS];
+	float PredictedZoom[PREFETCH_PREDICTION_STEPS];
+
+	for (UINT Step = 0; Step < PREFETCH_PREDICTION_STEPS; ++Step)
+	{
+		PredictedFrames[Step] = PREFETCH_PREDICTION_FRAMES * (Step + 1) / PREFETCH_PREDICTION_STEPS;
+		PredictedBounds[Step] = m_pSceneCamera->PredictViewportBounds(PredictedFrames[Step]);
+		PredictedZoom[Step] = m_pSceneCamera->PredictZoom(PredictedFrames[Step]);
+	}
+
+	//
+	// An image that the camera is predicted to see at any of the sampled points is a candidate
+	// for prefetching, at the most detailed mip it will need along the way. A stationary camera
+	// predicts only what is already visible.
+	//
+	for (auto& Img : m_Images)
+	{
+		PrefetchCandidate Candidate = { &Img, UINT_MAX, UNDEFINED_MIPMAP_INDEX };
+		float ImageWidth = Img.Bounds.Right - Img.Bounds.Left;
+
+		if (RectIntersects(SceneBounds, Img.Bounds))
+		{
+			Candidate.FramesUntilVisible = 0;
+		}
+
+		for (UINT Step = 0; Step < PREFETCH_PREDICTION_STEPS; ++Step)
+		{
+			if (RectIntersects(PredictedBounds[Step], Img.Bounds))
+			{
+				UINT8 Mip = (UINT8)CalculateRequiredMipLevel(Img.pResource, ImageWidth * PredictedZoom[Step]);
+
+				Candidate.FramesUntilVisible = min(Candidate.FramesUntilVisible, PredictedFrames[Step]);
+				Candidate.Mip = ChooseMoreDetailedMip(Candidate.Mip, Mip);
+			}
+		}
+
+		if (IsMoreDetailedMip(Img.pResource->MostDetailedMipResident, Candidate.Mip))
+		{
+			m_PrefetchCandidates.push_back(Candidate);
+		}
+	}
+
+	//
+	// Hand out predicted mips to the images the camera will reach first, until the data they
+	// are missing exceeds the budget. The paging thread can only load so much before the camera
+	// arrives, and asking for more would compete with the mipmaps needed sooner.
+	//
+	std::sort(
+		m_PrefetchCandidates.begin(),
+		m_PrefetchCandidates.end(),
+		[](const PrefetchCandidate& a, const PrefetchCandidate& b)
+		{
+			return a.FramesUntilVisible < b.FramesUntilVisible;
+		});
+
+	UINT64 RemainingBudget = PREFETCH_PREDICTION_BUDGET;
+	for (auto& Candidate : m_PrefetchCandidates)
+	{
+		Resource* pResource = Candidate.pImage->pResource;
+
+		UINT64 MissingBytes = 0;
+		for (UINT8 Mip = Candidate.Mip; Mip < pResource->MostDetailedMipResident && Mip < pResource->PackedMipHeapIndex; ++Mip)
+		{
+			MissingBytes += GetNonPackedMipSize(pResource, Mip);
+		}
+
+		if (MissingBytes > RemainingBudget)
+		{
+			continue;
+		}
+
+		RemainingBudget -= MissingBytes;
+		Candidate.pImage->PredictedMip = Candidate.Mip;
+	}
+}
+
+void D3D12MemoryManagement::CalculateImagePagingData(const RectF* pViewportBounds, const Image* pImage, UINT8* pVisibleMip, UINT8* pPrefetchMip, bool* pbPrefetchPredicted)
 {
 	float ImageScale = (pImage->Bounds.Right - pImage->Bounds.Left) * m_pSceneCamera->GetZoom();
 	UINT8 RequiredMip = (UINT8)CalculateRequiredMipLevel(pImage->pResource, ImageScale);
@@ -520,14 +627,35 @@ void D3D12MemoryManagement::CalculateImagePagingData(const RectF* pViewportBound
 		PrefetchMip = UNDEFINED_MIPMAP_INDEX;
 	}
 
+	//
+	// Raise the prefetch mip if the camera is predicted to need a more detailed one soon.
+	//
+	bool bPrefetchPredicted = IsMoreDetailedMip(PrefetchMip, pImage->PredictedMip);
+	if (bPrefetchPredicted)
+	{
+		PrefetchMip = pImage->PredictedMip;
+	}
+
 	*pVisibleMip = VisibleMip;
 	*pPrefetchMip = PrefetchMip;
+	*pbPrefetchPredicted = bPrefetchPredicted;
 }
 
 HRESULT D3D12MemoryManagement::RenderScene(const RectF& ViewportBounds)
 {
 	RectF SceneBounds = m_pSceneCamera->GenerateViewportBounds();
 
+	//
+	// Track the motion of both cameras, so that switching the scene camera does not look
+	// like a sudden jump.
+	//
+	m_ViewportCamera.UpdateMotion();
+	m_DebugCamera.UpdateMotion();
+
+	PredictPrefetchMips(SceneBounds);
+
+	UINT MipMisses = 0;
+
 	for (auto& Img : m_Images)
 	{
 		Resource* pResource = Img.pResource;
@@ -537,16 +665,20 @@ HRESULT D3D12MemoryManagement::RenderScene(const RectF& ViewportBounds)
 		//
 		UINT8 VisibleMip;
 		UINT8 PrefetchMip;
-		CalculateImagePagingData(&SceneBounds, &Img, &VisibleMip, &PrefetchMip);
+		bool bPrefetchPredicted;
+		CalculateImagePagingData(&SceneBounds, &Img, &VisibleMip, &PrefetchMip, &bPrefetchPredicted);
 
 		//
 		// If the visibility or prefetch values have changed, notify the paging thread
 		// so it can update this resource's priority.
 		//
-		if (pResource->VisibleMip != VisibleMip || pResource->PrefetchMip != PrefetchMip)
+		if (pResource->VisibleMip != VisibleMip ||
+			pResource->PrefetchMip != PrefetchMip ||
+			pResource->bPrefetchPredicted != bPrefetchPredicted)
 		{
 			pResource->VisibleMip = VisibleMip;
 			pResource->PrefetchMip = PrefetchMip;
+			pResource->bPrefetchPredicted = bPrefetchPredicted;
 			NotifyPagingWork(pResource);
 		}
 
@@ -563,6 +695,15 @@ HRESULT D3D12MemoryManagement::RenderScene(const RectF& ViewportBounds)
 
 			FillRectangle(&Img.Bounds, &DefaultColor, pResource);
 
+			//
+			// Count the images drawn with less detail than they need, which is what
+			// prefetching tries to prevent.
+			//
+			if (IsLessDetailedMip(pResource->VisibleMip, pResource->MostDetailedMipResident))
+			{
+				++MipMisses;
+			}
+
 			if (m_bDrawMipColors)
 			{
 				//
@@ -617,8 +758,21 @@ HRESULT D3D12MemoryManagement::RenderScene(const RectF& ViewportBounds)
 		pColor = &ViewportColor;
 
 		DrawRectangle(&SceneBounds, Thickness, pColor);
+
+		//
+		// Outline where the scene camera is predicted to be at the end of the prediction window.
+		//
+		if (m_bPredictivePrefetch)
+		{
+			ColorF PredictionColor = { 1.0f, 1.0f, 0.0f, 0.5f };
+			RectF PredictedBounds = m_pSceneCamera->PredictViewportBounds(PREFETCH_PREDICTION_FRAMES);
+
+			DrawRectangle(&PredictedBounds, 2 / m_ViewportCamera.GetZoom(), &PredictionColor);
+		}
 	}
 
+	m_StatMipMisses[m_StatIndex] = (float)MipMisses;
+
 	return S_OK;
 }
 
@@ -660,15 +814,17 @@ HRESULT D3D12MemoryManagement::RenderUI()
 			TextRect.left = 8;
 			TextRect.top = 8;
 			TextRect.right = 256;
-			TextRect.bottom = 256;
+			TextRect.bottom = 380;
 
 			float StatTimeBetweenFrames = AverageStatistics(m_StatTimeBetweenFrames, STATISTIC_COUNT);
 			float StatRenderScene = AverageStatistics(m_StatRenderScene, STATISTIC_COUNT);
 			float StatRenderUI = AverageStatistics(m_StatRenderUI, STATISTIC_COUNT);
+			float StatPagingSubmission = AverageStatistics(m_StatPagingSubmission, STATISTIC_COUNT);
+			float StatMipMisses = AverageStatistics(m_StatMipMisses, STATISTIC_COUNT);
 
 			m_pTextFormat->SetTextAlignment(DWRITE_TEXT_ALIGNMENT_LEADING);
 			m_pTextFormat->SetParagraphAlignment(DWRITE_PARAGRAPH_ALIGNMENT_NEAR);
-			wchar_t FPSString[128];
+			wchar_t FPSString[256];
 			swprintf_s(
 				FPSString,
 				_TRUNCATE,
@@ -676,12 +832,33 @@ HRESULT D3D12MemoryManagement::RenderUI()
 				L"Glitch Count: %d\n"
 				L"\n"
 				L"RenderScene: %.2f ms\n"
-				L"RenderUI: %.2f ms",
+				L"  Paging Submission: %.3f ms\n"
+				L"RenderUI: %.2f ms\n"
+				L"\n"
+				L"Mip Loads: %.1f/s (%d decode workers)\n"
+				L"  First Use Latency: %.1f ms\n"
+				L"Mip Misses: %.1f per frame (prediction %s)\n"
+				L"\n"
+				L"Heaps: %d (%d resident)\n"
+				L"  Created: %.1f/s, Destroyed: %.1f/s\n"
+				L"  Reused: %.1f/s, Compacted: %d",
 				(UINT)(1.0f / StatTimeBetweenFrames),
 				StatTimeBetweenFrames * 1000.0f,
 				GetGlitchCount(),
 				StatRenderScene * 1000.0f,
-				StatRenderUI * 1000.0f);
+				StatPagingSubmission * 1000.0f,
+				StatRenderUI * 1000.0f,
+				m_StatMipLoadRate,
+				GetDecodeWorkerCount(),
+				m_StatFirstUseLatency * 1000.0f,
+				StatMipMisses,
+				m_bPredictivePrefetch ? L"on" : L"off",
+				m_HeapPool.GetNumHeaps(),
+				m_HeapPool.GetNumResidentHeaps(),
+				m_StatHeapCreateRate,
+				m_StatHeapDestroyRate,
+				m_StatHeapReuseRate,
+				m_HeapPool.GetHeapsCompacted());
 
 			m_pD2DContext->DrawTextW(
 				FPSString,
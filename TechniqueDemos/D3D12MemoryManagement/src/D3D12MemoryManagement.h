@@ -34,12 +34,28 @@ struct Image
 {
 	RectF Bounds;
 	Resource* pResource;
+
+	// The most detailed mip the image is predicted to need over the next few frames, given
+	// the scene camera's motion, or UNDEFINED_MIPMAP_INDEX if no prefetch was predicted.
+	UINT8 PredictedMip;
+};
+
+//
+// An image the scene camera is predicted to reach, and how soon. Candidates are given
+// predicted prefetches in order of how soon they become visible.
+//
+struct PrefetchCandidate
+{
+	Image* pImage;
+	UINT FramesUntilVisible;
+	UINT8 Mip;
 };
 
 class D3D12MemoryManagement : public DX12Framework
 {
 private:
 	std::vector<Image> m_Images;
+	std::vector<PrefetchCandidate> m_PrefetchCandidates;
 
 	Camera m_ViewportCamera;
 	Camera m_DebugCamera;
@@ -56,10 +72,15 @@ private:
 	UINT64 m_GraphPoints[NUM_GRAPH_POINTS];
 
 	bool m_bDrawMipColors = false;
+	bool m_bPredictivePrefetch = true;
 	bool m_bSimulateDeviceRemoved = false;
 	bool m_bFullscreen = false;
 	RECT m_WindowRect;
 
+	// The number of visible images drawn with a less detailed mip than they requested,
+	// for each of the last STATISTIC_COUNT frames.
+	float m_StatMipMisses[STATISTIC_COUNT];
+
 	//
 	// D2D UI rendering
 	//
@@ -80,11 +101,14 @@ protected:
 	HRESULT GenerateMemoryGraphGeometry(const RectF& Bounds, UINT GraphSizeMB, ID2D1PathGeometry** ppPathGeometry);
 	void RenderMemoryGraph();
 
+	void PredictPrefetchMips(const RectF& SceneBounds);
+
 	void CalculateImagePagingData(
 		const RectF* pViewportBounds,
 		const Image* pImage,
 		UINT8* pVisibleMip,
-		UINT8* pPrefetchMip);
+		UINT8* pPrefetchMip,
+		bool* pbPrefetchPredicted);
 
 public:
 	D3D12MemoryManagement();
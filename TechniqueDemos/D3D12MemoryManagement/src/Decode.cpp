@@ -0,0 +1,195 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+
+//
+// DecodeWorkerPool
+//
+// The decode workers take mipmap load requests from the paging thread, read and decode the
+// pixel data through WIC into each request's upload buffer, and hand the request back to the
+// paging thread to copy into the resource. Only the decode runs on the workers. All paging
+// decisions, heap management and command queue work remain on the paging thread.
+//
+
+DecodeWorkerPool::DecodeWorkerPool(DX12Framework* pFramework) :
+	m_pFramework(pFramework),
+	m_NumWorkers(0),
+	m_hCompletionEvent(nullptr),
+	m_NumInFlight(0),
+	m_bShutdown(false)
+{
+	ZeroMemory(m_hThreads, sizeof(m_hThreads));
+
+	InitializeListHead(&m_PendingListHead);
+	InitializeListHead(&m_CompletedListHead);
+
+	InitializeCriticalSection(&m_Lock);
+	InitializeConditionVariable(&m_WorkAvailable);
+}
+
+DecodeWorkerPool::~DecodeWorkerPool()
+{
+	EnterCriticalSection(&m_Lock);
+	m_bShutdown = true;
+	LeaveCriticalSection(&m_Lock);
+
+	WakeAllConditionVariable(&m_WorkAvailable);
+
+	for (UINT i = 0; i < m_NumWorkers; ++i)
+	{
+		WaitForSingleObject(m_hThreads[i], INFINITE);
+		CloseHandle(m_hThreads[i]);
+	}
+
+	//
+	// Discard any requests the paging thread never finished. The tiles allocated for these
+	// mipmaps stay with the resource and are reused the next time the mip is loaded.
+	//
+	LIST_ENTRY* ListHeads[] = { &m_PendingListHead, &m_CompletedListHead };
+	for (LIST_ENTRY* pListHead : ListHeads)
+	{
+		while (!IsListEmpty(pListHead))
+		{
+			MipLoadRequest* pRequest = CONTAINING_RECORD(RemoveHeadList(pListHead), MipLoadRequest, ListEntry);
+			pRequest->pResource->bLoadPending = false;
+			delete pRequest;
+		}
+	}
+
+	DeleteCriticalSection(&m_Lock);
+}
+
+HRESULT DecodeWorkerPool::Init(UINT NumWorkers, HANDLE hCompletionEvent)
+{
+	m_hCompletionEvent = hCompletionEvent;
+
+	NumWorkers = min(NumWorkers, MAX_DECODE_WORKERS);
+	for (UINT i = 0; i < NumWorkers; ++i)
+	{
+		HANDLE hThread = CreateThread(nullptr, 0, DecodeWorkerPool::ThreadEntry, this, 0, nullptr);
+		if (hThread == nullptr)
+		{
+			LOG_ERROR("Failed to create decode worker thread, Error=0x%.8x", GetLastError());
+			return HRESULT_FROM_WIN32(GetLastError());
+		}
+
+		m_hThreads[m_NumWorkers++] = hThread;
+	}
+
+	return S_OK;
+}
+
+void DecodeWorkerPool::Submit(MipLoadRequest* pRequest)
+{
+	EnterCriticalSection(&m_Lock);
+
+	//
+	// Keep the pending list sorted by priority, so that the workers always take the most
+	// important request. The list is short (bounded by MAX_PENDING_MIP_LOADS), so a linear
+	// insertion is cheap.
+	//
+	LIST_ENTRY* pEntry = m_PendingListHead.Flink;
+	while (pEntry != &m_PendingListHead)
+	{
+		MipLoadRequest* pPending = CONTAINING_RECORD(pEntry, MipLoadRequest, ListEntry);
+		if (pRequest->Priority < pPending->Priority ||
+			(pRequest->Priority == pPending->Priority && pRequest->Sequence < pPending->Sequence))
+		{
+			break;
+		}
+		pEntry = pEntry->Flink;
+	}
+
+	//
+	// Insert before pEntry, which may be the list head (i.e. at the tail).
+	//
+	InsertTailList(pEntry, &pRequest->ListEntry);
+	++m_NumInFlight;
+
+	LeaveCriticalSection(&m_Lock);
+
+	WakeConditionVariable(&m_WorkAvailable);
+}
+
+MipLoadRequest* DecodeWorkerPool::PopCompleted()
+{
+	MipLoadRequest* pRequest = nullptr;
+
+	EnterCriticalSection(&m_Lock);
+	if (!IsListEmpty(&m_CompletedListHead))
+	{
+		pRequest = CONTAINING_RECORD(RemoveHeadList(&m_CompletedListHead), MipLoadRequest, ListEntry);
+		--m_NumInFlight;
+	}
+	LeaveCriticalSection(&m_Lock);
+
+	return pRequest;
+}
+
+DWORD CALLBACK DecodeWorkerPool::ThreadEntry(void* pArg)
+{
+	DecodeWorkerPool* pPool = (DecodeWorkerPool*)pArg;
+
+	//
+	// WIC objects are created and used on the decode workers, so each worker joins the
+	// multithreaded apartment.
+	//
+	HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+	if (FAILED(hr))
+	{
+		LOG_CRITICAL_ERROR("Failed to initialize COM on decode worker, hr=0x%.8x", hr);
+	}
+
+	DWORD Result = pPool->Run();
+
+	CoUninitialize();
+
+	return Result;
+}
+
+DWORD DecodeWorkerPool::Run()
+{
+	for (;;)
+	{
+		EnterCriticalSection(&m_Lock);
+		while (IsListEmpty(&m_PendingListHead) && !m_bShutdown)
+		{
+			SleepConditionVariableCS(&m_WorkAvailable, &m_Lock, INFINITE);
+		}
+
+		if (m_bShutdown)
+		{
+			LeaveCriticalSection(&m_Lock);
+			break;
+		}
+
+		MipLoadRequest* pRequest = CONTAINING_RECORD(RemoveHeadList(&m_PendingListHead), MipLoadRequest, ListEntry);
+		LeaveCriticalSection(&m_Lock);
+
+		LARGE_INTEGER Tick;
+		QueryPerformanceCounter(&Tick);
+		pRequest->DecodeStartTick = Tick.QuadPart;
+
+		pRequest->DecodeResult = m_pFramework->DecodeMip(pRequest);
+
+		QueryPerformanceCounter(&Tick);
+		pRequest->DecodeEndTick = Tick.QuadPart;
+
+		EnterCriticalSection(&m_Lock);
+		InsertTailList(&m_CompletedListHead, &pRequest->ListEntry);
+		LeaveCriticalSection(&m_Lock);
+
+		SetEvent(m_hCompletionEvent);
+	}
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+//
+// The maximum number of decode worker threads, and the maximum number of mipmaps which
+// may be loading at once. Each loading mipmap holds an upload buffer the size of the mip,
+// so the limit also bounds the amount of upload memory in use.
+//
+#define MAX_DECODE_WORKERS 8
+#define MAX_PENDING_MIP_LOADS (MAX_DECODE_WORKERS * 2)
+
+//
+// The pixel source for a mipmap, opened through WIC for images backed by a file.
+// Generated images have no source objects, and are drawn directly by GenerateMip.
+//
+struct MipSource
+{
+	BitmapFrameInfo FrameInfo;
+
+	ComPtr<IWICBitmapFrameDecode> pBitmapFrame;
+	ComPtr<IWICDdsFrameDecode> pDdsFrame;
+	ComPtr<IWICBitmapSource> pSourceBitmap;
+};
+
+//
+// Tracks a mipmap as it moves through the loading pipeline. The paging thread allocates and
+// maps the tiles and creates the upload buffer, a decode worker reads and decodes the
+// pixel data into the upload buffer, and the paging thread then copies the data into the
+// resource on the copy queue.
+//
+struct MipLoadRequest
+{
+	LIST_ENTRY ListEntry;
+
+	Resource* pResource;
+	UINT32 Mip;
+
+	// The priority of the paging operation that requested the mip. Decode workers always
+	// take the highest priority request first, and requests of the same priority in the
+	// order they were made.
+	ResourcePriority Priority;
+	UINT64 Sequence;
+
+	ComPtr<ID3D12Resource> pUploadBuffer;
+	void* pUploadData;
+	D3D12_PLACED_SUBRESOURCE_FOOTPRINT Layout;
+	UINT NumRows;
+
+	// Filled in by the decode worker.
+	BitmapFrameInfo FrameInfo;
+	HRESULT DecodeResult;
+
+	// QPC timestamps used for statistics.
+	LONGLONG RequestTick;
+	LONGLONG DecodeStartTick;
+	LONGLONG DecodeEndTick;
+};
+
+//
+// A fixed pool of threads which decode mipmaps for the paging thread, so that paging
+// throughput is not bound by the decode speed of a single core. While the workers decode
+// the next mipmaps, the paging thread uploads the previous ones on the copy queue.
+//
+class DecodeWorkerPool
+{
+public:
+	DecodeWorkerPool(DX12Framework* pFramework);
+	~DecodeWorkerPool();
+
+	HRESULT Init(UINT NumWorkers, HANDLE hCompletionEvent);
+
+	// Queues a request for decoding. Called from the paging thread.
+	void Submit(MipLoadRequest* pRequest);
+
+	// Returns the next decoded request, or null if none are ready. Called from the paging thread.
+	MipLoadRequest* PopCompleted();
+
+	// The number of requests which have been submitted, but not yet returned by PopCompleted.
+	inline UINT GetNumInFlight() const
+	{
+		return m_NumInFlight;
+	}
+
+	inline UINT GetNumWorkers() const
+	{
+		return m_NumWorkers;
+	}
+
+private:
+	DWORD Run();
+
+	static DWORD CALLBACK ThreadEntry(void* pArg);
+
+	DX12Framework* m_pFramework;
+
+	HANDLE m_hThreads[MAX_DECODE_WORKERS];
+	UINT m_NumWorkers;
+
+	// Signaled each time a request finishes decoding, to wake the paging thread.
+	HANDLE m_hCompletionEvent;
+
+	// Protects the request lists and the shutdown flag, which are shared by the paging
+	// thread and the decode workers.
+	CRITICAL_SECTION m_Lock;
+	CONDITION_VARIABLE m_WorkAvailable;
+
+	// Requests waiting for a decode worker, sorted by priority.
+	LIST_ENTRY m_PendingListHead;
+
+	// Requests which have been decoded, in the order they finished.
+	LIST_ENTRY m_CompletedListHead;
+
+	UINT m_NumInFlight;
+	bool m_bShutdown;
+};
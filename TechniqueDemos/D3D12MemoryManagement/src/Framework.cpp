@@ -56,7 +56,8 @@ LRESULT CALLBACK WndProcPreCreate(HWND hwnd, UINT Message, WPARAM wParam, LPARAM
 
 DX12Framework::DX12Framework() :
 	m_RenderContext(this),
-	m_PagingContext(this)
+	m_PagingContext(this),
+	m_HeapPool(this)
 {
 	InitializeListHead(&m_ResourceListHead);
 	InitializeListHead(&m_DynamicBufferListHead);
@@ -71,6 +72,7 @@ DX12Framework::DX12Framework() :
 	ZeroMemory(m_StatTimeBetweenFrames, sizeof(m_StatTimeBetweenFrames));
 	ZeroMemory(m_StatRenderScene, sizeof(m_StatRenderScene));
 	ZeroMemory(m_StatRenderUI, sizeof(m_StatRenderUI));
+	ZeroMemory(m_StatPagingSubmission, sizeof(m_StatPagingSubmission));
 	ZeroMemory(m_pRenderTargets, sizeof(m_pRenderTargets));
 	ZeroMemory(m_pWrappedBackBuffers, sizeof(m_pRenderTargets));
 	ZeroMemory(m_pD2DRenderTargets, sizeof(m_pRenderTargets));
@@ -286,21 +288,29 @@ void DX12Framework::DestroyResourceDeviceState(Resource* pResource)
 	{
 		SafeRelease(pDeviceState->pD3DResource);
 
-		for (UINT i = 0; i < pDeviceState->NumHeaps; ++i)
+		//
+		// Return the resource's tiles to the heap pool. There is no need to unmap them, since
+		// the reserved resource has been released.
+		//
+		for (UINT i = 0; i <= GetLeastDetailedMipHeapIndex(pResource); ++i)
 		{
-			SafeRelease(pDeviceState->Mips[0].ppHeaps[i]);
+			m_HeapPool.Free(&pDeviceState->Mips[i].RangeListHead);
 		}
-		delete[] pDeviceState->Mips[0].ppHeaps;
 		free(pDeviceState);
 		pResource->pDeviceState = nullptr;
 	}
 
 	RemoveResourceCommitment(pResource);
-	if (pResource->PrioritizationEntry.Flink != nullptr)
-	{
-		RemoveEntryList(&pResource->PrioritizationEntry);
-		pResource->PrioritizationEntry.Flink = nullptr;
-	}
+
+	//
+	// The paging worker thread is destroyed before the resource device state, along with its
+	// submission and paging queues, so simply forget any work that was queued for the resource.
+	//
+	pResource->pNextSubmission = nullptr;
+	pResource->SubmissionPending = 0;
+	pResource->PagingQueueIndex = INVALID_PAGING_QUEUE_INDEX;
+	pResource->bLoadPending = false;
+	pResource->FirstUseMip = UNDEFINED_MIPMAP_INDEX;
 }
 
 void DX12Framework::DestroyDeviceIndependentStateInternal()
@@ -713,6 +723,12 @@ void DX12Framework::DestroyDeviceDependentStateInternal()
 		}
 	}
 
+	//
+	// The resources have returned all of their tiles, so the pooled heaps can be released.
+	//
+	m_HeapPool.DestroyDeviceDependentState();
+	SafeRelease(m_pCompactionBuffer);
+
 	{
 		LIST_ENTRY* pVersionedBufferEntry = m_DynamicBufferListHead.Flink;
 		while (pVersionedBufferEntry != &m_DynamicBufferListHead)
@@ -1266,7 +1282,6 @@ HRESULT DX12Framework::CreateResourceDeviceState(Resource* pResource, UINT NumMi
 	HRESULT hr;
 
 	ID3D12Resource* pTiledResource = nullptr;
-	ID3D12Heap** ppHeaps = nullptr;
 	ResourceDeviceState* pDeviceState = nullptr;
 
 	//
@@ -1348,17 +1363,13 @@ HRESULT DX12Framework::CreateResourceDeviceState(Resource* pResource, UINT NumMi
 	ZeroMemory(pDeviceState, SizeOfResource + SizeOfResourceMipIndices);
 
 	//
-	// For each mip heap, calculate the number of D3D12 heaps that will back the resource,
-	// and allocate this data up front. Note that we are not creating the actual D3D12
-	// heap here (this is done lazily when we load the image data). We will also
-	// initialize mipmap specific tracking information.
+	// Initialize the mipmap specific tracking information. The tiles backing each mipmap
+	// are not allocated here (this is done lazily when we load the image data).
 	//
-	UINT CurrentHeapCount = 0;
 	for (size_t i = 0; i < NumberOfMipIndices; ++i)
 	{
 		MipDescription* pDesc = &pDeviceState->Mips[i].Desc;
 
-		NumTiles = PackedMipInfo.NumTilesForPackedMips;
 		if (SubresourceTiling[i].StartTileIndexInOverallResource == 0xFFFFFFFF)
 		{
 			pDesc->WidthInTiles = 0;
@@ -1366,54 +1377,15 @@ HRESULT DX12Framework::CreateResourceDeviceState(Resource* pResource, UINT NumMi
 		}
 		else
 		{
-			UINT WidthInTiles = SubresourceTiling[i].WidthInTiles;
-			UINT HeightInTiles = SubresourceTiling[i].HeightInTiles;
-
-			pDesc->WidthInTiles = WidthInTiles;
-			pDesc->HeightInTiles = HeightInTiles;
-
-			NumTiles = WidthInTiles * HeightInTiles;
+			pDesc->WidthInTiles = SubresourceTiling[i].WidthInTiles;
+			pDesc->HeightInTiles = SubresourceTiling[i].HeightInTiles;
 		}
-		pDesc->HeapStartIndex = CurrentHeapCount;
 
-		//
-		// Even if a resource does not fill in a full 16MB heap, it is OK, because
-		// we are counting the number of 16MB or less heaps in the resource. Thus
-		// even 64KB rounded up will be 1, which is the correct value.
-		//
-		UINT MipSize = NumTiles * TILE_SIZE;
-		UINT NumHeapsInMip = (MipSize + MAX_HEAP_SIZE - 1) / MAX_HEAP_SIZE;
-
-		CurrentHeapCount += NumHeapsInMip;
+		InitializeListHead(&pDeviceState->Mips[i].RangeListHead);
 		pDeviceState->Mips[i].ReferenceFence = 0;
 	}
 
-	//
-	// Allocate heap list for entire texture. Each mip is broken into chunks of
-	// at most MAX_HEAP_SIZE (Currently 16MB)
-	//
-	try
-	{
-		ppHeaps = new ID3D12Heap*[CurrentHeapCount];
-	}
-	catch (std::bad_alloc&)
-	{
-		LOG_ERROR("Out of memory allocating D3D12 heap array");
-		hr = E_OUTOFMEMORY;
-		goto cleanup;
-	}
-
-	//
-	// Initialize the rest of the resource to various default values.
-	//
-	ZeroMemory(ppHeaps, sizeof(*ppHeaps) * CurrentHeapCount);
-	for (size_t i = 0; i < NumberOfMipIndices; ++i)
-	{
-		pDeviceState->Mips[i].ppHeaps = ppHeaps + pDeviceState->Mips[i].Desc.HeapStartIndex;
-	}
-
 	pDeviceState->pD3DResource = pTiledResource;
-	pDeviceState->NumHeaps = CurrentHeapCount;
 
 	pResource->PackedMipTileCount = PackedMipInfo.NumTilesForPackedMips;
 	pResource->NumStandardMips = PackedMipInfo.NumStandardMips;
@@ -1436,8 +1408,13 @@ HRESULT DX12Framework::CreateResourceDeviceState(Resource* pResource, UINT NumMi
 
 	pResource->TrimLimit = ERTP_None;
 	pResource->bIgnoreBudget = false;
+	pResource->bPrefetchPredicted = false;
 
-	pResource->PagingEntry.Flink = nullptr;
+	pResource->pNextSubmission = nullptr;
+	pResource->SubmissionPending = 0;
+	pResource->PagingQueueIndex = INVALID_PAGING_QUEUE_INDEX;
+	pResource->bLoadPending = false;
+	pResource->FirstUseMip = UNDEFINED_MIPMAP_INDEX;
 
 	//
 	// Notify the paging thread of this resource so it can be prioritized. Although
@@ -1448,10 +1425,6 @@ HRESULT DX12Framework::CreateResourceDeviceState(Resource* pResource, UINT NumMi
 	return S_OK;
 
 cleanup:
-	if (ppHeaps)
-	{
-		delete[] ppHeaps;
-	}
 	SafeRelease(pTiledResource);
 
 	if (pDeviceState)
@@ -1554,31 +1527,16 @@ HRESULT DX12Framework::GetBitmapFrameInfo(IWICBitmapFrameDecode* pFrame, BitmapF
 }
 
 //
-// LoadMip is in charge of creating resource data. If necessary, LoadMip will create the
-// heaps (physical memory) for the mipmap, update the virtual address mappings, and copy
-// the pixel data from the WIC image source.
+// OpenMipSource opens the WIC objects which provide the pixel data for a mipmap, and fills
+// in the frame information used to copy it. Generated images do not have any source objects.
+// This is called from the decode workers, so it must not modify the resource.
 //
-HRESULT DX12Framework::LoadMip(Resource* pResource, UINT32 Mip)
+HRESULT DX12Framework::OpenMipSource(Resource* pResource, UINT32 Mip, MipSource* pSource)
 {
 	HRESULT hr;
 
-	LOG_MESSAGE("Loading mip %d", Mip);
-
-	UINT32 MipHeap = Mip;
-
-	UINT NumMips = GetResourceMipCount(pResource);
-	if (Mip >= NumMips)
-	{
-		LOG_WARNING("Trying to load mip %d for pResource 0x%p, but the image file only contains %d mip levels", Mip, pResource, NumMips);
-		return S_FALSE;
-	}
-
-	BitmapFrameInfo MipFrameInfo = {};
-
-	ComPtr<IWICDdsDecoder> pDdsDecoder;
-	ComPtr<IWICBitmapFrameDecode> pBitmapFrame;
-	ComPtr<IWICDdsFrameDecode> pDdsFrame;
-	ComPtr<IWICBitmapSource> pSourceBitmap;
+	BitmapFrameInfo* pFrameInfo = &pSource->FrameInfo;
+	ZeroMemory(pFrameInfo, sizeof(*pFrameInfo));
 
 	//
 	// Different behavior is performed depending on whether this is a generated image,
@@ -1586,24 +1544,25 @@ HRESULT DX12Framework::LoadMip(Resource* pResource, UINT32 Mip)
 	//
 	if (pResource->pDecoder)
 	{
+		ComPtr<IWICDdsDecoder> pDdsDecoder;
 		hr = pResource->pDecoder->QueryInterface(IID_PPV_ARGS(&pDdsDecoder));
 		if (SUCCEEDED(hr))
 		{
-			hr = pDdsDecoder->GetFrame(0, Mip, 0, &pBitmapFrame);
+			hr = pDdsDecoder->GetFrame(0, Mip, 0, &pSource->pBitmapFrame);
 			if (FAILED(hr))
 			{
 				LOG_ERROR("Failed to load decode frame for Resource 0x%p, mip %d, hr=0x%.8x", pResource, Mip, hr);
 				return hr;
 			}
 
-			hr = pBitmapFrame.As(&pDdsFrame);
+			hr = pSource->pBitmapFrame.As(&pSource->pDdsFrame);
 			if (FAILED(hr))
 			{
 				LOG_ERROR("Failed to query DDS frame for mip %d, hr=0x%.8x", Mip, hr);
 				return hr;
 			}
 
-			hr = GetDdsFrameInfo(pDdsFrame.Get(), &MipFrameInfo);
+			hr = GetDdsFrameInfo(pSource->pDdsFrame.Get(), pFrameInfo);
 			if (FAILED(hr))
 			{
 				LOG_ERROR("Failed to load frame information for mip %d, hr=0x%.8x", Mip, hr);
@@ -1612,14 +1571,14 @@ HRESULT DX12Framework::LoadMip(Resource* pResource, UINT32 Mip)
 		}
 		else
 		{
-			hr = pResource->pDecoder->GetFrame(0, &pBitmapFrame);
+			hr = pResource->pDecoder->GetFrame(0, &pSource->pBitmapFrame);
 			if (FAILED(hr))
 			{
 				LOG_ERROR("Failed to decode bitmap for Resource 0x%p, mip %d, hr=0x%.8x", pResource, Mip, hr);
 				return hr;
 			}
 
-			hr = GetBitmapFrameInfo(pBitmapFrame.Get(), &MipFrameInfo);
+			hr = GetBitmapFrameInfo(pSource->pBitmapFrame.Get(), pFrameInfo);
 			if (FAILED(hr))
 			{
 				LOG_ERROR("Failed to load bitmap information for mip %d, hr=0x%.8x", Mip, hr);
@@ -1639,8 +1598,8 @@ HRESULT DX12Framework::LoadMip(Resource* pResource, UINT32 Mip)
 			}
 
 			hr = pConverter->Initialize(
-				pBitmapFrame.Get(),
-				MipFrameInfo.TargetPixelFormat,
+				pSource->pBitmapFrame.Get(),
+				pFrameInfo->TargetPixelFormat,
 				WICBitmapDitherTypeNone,
 				nullptr,
 				0.0f,
@@ -1651,89 +1610,174 @@ HRESULT DX12Framework::LoadMip(Resource* pResource, UINT32 Mip)
 				return hr;
 			}
 
-			pSourceBitmap = pConverter;
+			pSource->pSourceBitmap = pConverter;
 		}
 	}
 	else
 	{
 		D3D12_RESOURCE_DESC resourceDesc = pResource->pDeviceState->pD3DResource->GetDesc();
-		MipFrameInfo.BlockWidth = 1;
-		MipFrameInfo.BlockHeight = 1;
-		MipFrameInfo.DxgiFormat = resourceDesc.Format;
+		pFrameInfo->BlockWidth = 1;
+		pFrameInfo->BlockHeight = 1;
+		pFrameInfo->DxgiFormat = resourceDesc.Format;
 
-		MipFrameInfo.WidthInBlocks = (UINT)(resourceDesc.Width) >> Mip;
-		MipFrameInfo.HeightInBlocks = resourceDesc.Height >> Mip;
+		pFrameInfo->WidthInBlocks = (UINT)(resourceDesc.Width) >> Mip;
+		pFrameInfo->HeightInBlocks = resourceDesc.Height >> Mip;
 	}
 
-	UINT NumTiles;
-	UINT WidthInTiles;
+	return S_OK;
+}
 
+//
+// Copies a rectangle of blocks from the mipmap source into a staging buffer.
+//
+_Use_decl_annotations_
+HRESULT DX12Framework::CopyMipSourceRows(Resource* pResource, const MipSource* pSource, WICRect* pRect, UINT RowPitch, UINT BufferSizeInBytes, void* pBuffer)
+{
 	//
-	// Mip maps beyond NumStandardMips are packed, and so the entire set of mipmaps
-	// under it is packed into a single heap.
+	// The copy differs slightly based on whether or not this is a DDS file with block compressed data.
 	//
-	if (MipHeap >= pResource->PackedMipHeapIndex)
+	if (pSource->pDdsFrame)
+	{
+		return pSource->pDdsFrame->CopyBlocks(pRect, RowPitch, BufferSizeInBytes, (BYTE*)pBuffer);
+	}
+	else if (pSource->pSourceBitmap)
 	{
-		MipHeap = pResource->PackedMipHeapIndex;
-		WidthInTiles = pResource->PackedMipTileCount;
-		NumTiles = pResource->PackedMipTileCount;
+		return pSource->pSourceBitmap->CopyPixels(pRect, RowPitch, BufferSizeInBytes, (BYTE*)pBuffer);
 	}
 	else
 	{
-		WidthInTiles = pResource->pDeviceState->Mips[MipHeap].Desc.WidthInTiles;
-		NumTiles = WidthInTiles * pResource->pDeviceState->Mips[MipHeap].Desc.HeightInTiles;
+		return GenerateMip(pResource->GeneratedImageIndex, pRect, RowPitch, BufferSizeInBytes, (UINT*)pBuffer);
 	}
+}
+
+//
+// Allocates tiles (physical memory) for the mipmap from the heap pool if it has none, and
+// maps the reserved resource to them on the paging queue.
+//
+HRESULT DX12Framework::PrepareMipHeaps(Resource* pResource, UINT32 Mip)
+{
+	HRESULT hr;
+
+	//
+	// Mip maps beyond NumStandardMips are packed, and so the entire set of mipmaps
+	// under it is packed into a single mip heap.
+	//
+	UINT8 MipHeap = GetMipHeapIndexForResource(pResource, static_cast<UINT8>(Mip));
+	ResourceMip* pResourceMip = &pResource->pDeviceState->Mips[MipHeap];
 
 	//
-	// Round up the number of heaps needed for this mip.
+	// The least detailed mip heap is never trimmed, so it is allocated from pinned heaps.
 	//
-	UINT NumHeapsInMip = ((NumTiles * TILE_SIZE) + MAX_HEAP_SIZE - 1) / MAX_HEAP_SIZE;
+	bool bPinned = MipHeap >= GetLeastDetailedMipHeapIndex(pResource);
 
 	//
-	// Although we have a fixed heap count that is already calculated, we still calculate
-	// the required size so we don't allocate more space than necessary. We do not want
-	// to create 16MB heaps for mipmaps that are much smaller, or mipmaps which only
-	// excced multiples of 16MB by a small amount (e.g. 33MB == 3 heaps == 16+16+1)
+	// Packed mipmaps keep their tiles when a more detailed mip is loaded, and a mipmap whose
+	// previous load failed still has its tiles, so those only need to be mapped again.
 	//
-	UINT64 RemainingSize = NumTiles * TILE_SIZE;
-	ID3D12Heap** ppHeaps = pResource->pDeviceState->Mips[MipHeap].ppHeaps;
-	for (UINT i = 0; i < NumHeapsInMip; ++i)
+	if (IsListEmpty(&pResourceMip->RangeListHead))
 	{
-		ID3D12Heap* pHeap = ppHeaps[i];
-		if (pHeap == nullptr)
+		UINT NumTiles = GetMipHeapTileCount(pResource, MipHeap);
+
+		hr = m_HeapPool.Allocate(pResource, MipHeap, 0, NumTiles, bPinned, nullptr, &pResourceMip->RangeListHead);
+		if (FAILED(hr))
 		{
-			D3D12_HEAP_DESC heapDesc = {};
+			LOG_ERROR("Failed to allocate %d tiles for resource 0x%p mip %d, hr=0x%.8x", NumTiles, pResource, Mip, hr);
+			m_HeapPool.Free(&pResourceMip->RangeListHead);
+			return hr;
+		}
+	}
 
-			heapDesc.SizeInBytes = min(RemainingSize, MAX_HEAP_SIZE);
-			heapDesc.Alignment = 0;
-			heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
-			heapDesc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-			heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+	//
+	// Map the reserved resource (e.g. the virtual address we created with the resource)
+	// to the tiles that back them. Page table updates for tiled resources can be costly,
+	// so we will split up the mapping into one tile range at a time, which is at most one
+	// heap (16MB of updates per call).
+	//
+	LIST_ENTRY* pListHead = &pResourceMip->RangeListHead;
+	for (LIST_ENTRY* pEntry = pListHead->Flink; pEntry != pListHead; pEntry = pEntry->Flink)
+	{
+		TileRange* pRange = CONTAINING_RECORD(pEntry, TileRange, MipListEntry);
 
-			//
-			// Tier 1 heaps have restrictions on the type of information that can be stored in
-			// a heap. To accommodate this, we will retsrict the content to only shader resources.
-			// The heap cannot store textures that are used as render targets, depth-stencil
-			// output, or buffers. But this is okay, since we do not use these heaps for those
-			// purposes.
-			//
-			heapDesc.Flags = D3D12_HEAP_FLAG_DENY_RT_DS_TEXTURES | D3D12_HEAP_FLAG_DENY_BUFFERS;
+		MapTileRange(pResource, Mip, pRange, D3D12_TILE_MAPPING_FLAG_NO_HAZARD);
+	}
 
-			hr = m_pDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&pHeap));
-			if (FAILED(hr))
-			{
-				LOG_ERROR("Failed to create D3D12 heap, hr=0x%.8x", hr);
-				return hr;
-			}
+	return S_OK;
+}
 
-			ppHeaps[i] = pHeap;
-			RemainingSize -= heapDesc.SizeInBytes;
-		}
+//
+// Maps a tile range of a resource mipmap to its tiles in the heap pool, on the paging queue.
+//
+void DX12Framework::MapTileRange(Resource* pResource, UINT32 Mip, const TileRange* pRange, D3D12_TILE_MAPPING_FLAGS Flags)
+{
+	D3D12_TILED_RESOURCE_COORDINATE Coordinates = GetMipTileCoordinate(pResource, Mip, pRange->MipTileOffset);
+
+	D3D12_TILE_REGION_SIZE RegionSize = {};
+	RegionSize.NumTiles = pRange->NumTiles;
+
+	D3D12_TILE_RANGE_FLAGS RangeFlags = D3D12_TILE_RANGE_FLAG_NONE;
+	UINT RangeOffset = pRange->HeapTileOffset;
+	UINT RangeCount = pRange->NumTiles;
+	m_PagingContext.GetCommandQueue()->UpdateTileMappings(
+		pResource->pDeviceState->pD3DResource,
+		1,
+		&Coordinates,
+		&RegionSize,
+		pRange->pHeap->pHeap,
+		1,
+		&RangeFlags,
+		&RangeOffset,
+		&RangeCount,
+		Flags);
+}
+
+//
+// LoadMip is in charge of creating resource data. If necessary, LoadMip will allocate the
+// tiles (physical memory) for the mipmap, update the virtual address mappings, and copy
+// the pixel data from the WIC image source.
+//
+// When the decode workers are available, LoadMip only starts the load, and the pixel data
+// is copied by FinishLoadMip once a worker has decoded it. Otherwise the mipmap is loaded
+// synchronously on the paging thread.
+//
+HRESULT DX12Framework::LoadMip(Resource* pResource, UINT32 Mip)
+{
+	HRESULT hr;
+
+	LOG_MESSAGE("Loading mip %d", Mip);
+
+	UINT NumMips = GetResourceMipCount(pResource);
+	if (Mip >= NumMips)
+	{
+		LOG_WARNING("Trying to load mip %d for pResource 0x%p, but the image file only contains %d mip levels", Mip, pResource, NumMips);
+		return S_FALSE;
+	}
+
+	if (m_pWorkerThread->m_pDecodePool != nullptr)
+	{
+		return BeginLoadMip(pResource, Mip);
+	}
+
+	LARGE_INTEGER RequestTick;
+	QueryPerformanceCounter(&RequestTick);
+
+	MipSource Source;
+	hr = OpenMipSource(pResource, Mip, &Source);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	const BitmapFrameInfo& MipFrameInfo = Source.FrameInfo;
+
+	hr = PrepareMipHeaps(pResource, Mip);
+	if (FAILED(hr))
+	{
+		return hr;
 	}
 
 	//
 	// Calculate the required size of the upload buffer for transferring the contents
-	// to the new heaps.
+	// to the new tiles.
 	//
 	UINT64 UploadBufferSize = GetRequiredIntermediateSize(pResource->pDeviceState->pD3DResource, Mip, 1);
 
@@ -1777,50 +1821,6 @@ HRESULT DX12Framework::LoadMip(Resource* pResource, UINT32 Mip)
 		pUploadSurface = pUploadBuffer.Get();
 	}
 
-	//
-	// Map the reserved resource (e.g. the virtual address we created with the resource)
-	// to the heaps that back them. Page table updates for tiled resources can be costly,
-	// so we will split up the mapping into one heap at a time (16MB of updates per call).
-	//
-	{
-		static const UINT MaxTilesPerUpdate = MAX_HEAP_SIZE / TILE_SIZE;
-
-		UINT32 NumTilesRemaining = NumTiles;
-
-		while (NumTilesRemaining)
-		{
-			UINT TilesInUpdate = min(MaxTilesPerUpdate, NumTilesRemaining);
-
-			UINT32 TileOffset = NumTiles - NumTilesRemaining;
-
-			D3D12_TILED_RESOURCE_COORDINATE Coordinates = {};
-			Coordinates.Subresource = Mip;
-			Coordinates.X = TileOffset % WidthInTiles;
-			Coordinates.Y = TileOffset / WidthInTiles;
-
-			D3D12_TILE_REGION_SIZE RegionSize = {};
-			RegionSize.NumTiles = TilesInUpdate;
-
-			D3D12_TILE_RANGE_FLAGS RangeFlags = D3D12_TILE_RANGE_FLAG_NONE;
-			UINT RangeOffset = 0;
-			UINT RangeCount = TilesInUpdate;
-			m_PagingContext.GetCommandQueue()->UpdateTileMappings(
-				pResource->pDeviceState->pD3DResource,
-				1,
-				&Coordinates,
-				&RegionSize,
-				*ppHeaps,
-				1,
-				&RangeFlags,
-				&RangeOffset,
-				&RangeCount,
-				D3D12_TILE_MAPPING_FLAG_NO_HAZARD);
-
-			NumTilesRemaining -= TilesInUpdate;
-			++ppHeaps;
-		}
-	}
-
 	//
 	// Copy the pixel data into the staging resource, and then transfer it to the
 	// reserved resource via CopyTextureRegion.
@@ -1869,21 +1869,7 @@ HRESULT DX12Framework::LoadMip(Resource* pResource, UINT32 Mip)
 		SourceRect.Width = MipFrameInfo.WidthInBlocks;
 		SourceRect.Height = TransferHeightInBlocks;
 
-		//
-		// The copy differs slightly based on whether or not this is a DDS file with block compressed data.
-		//
-		if (pDdsFrame)
-		{
-			hr = pDdsFrame->CopyBlocks(&SourceRect, Layout.Footprint.RowPitch, Layout.Footprint.RowPitch * TransferHeightInBlocks, ((BYTE*)pUploadData));
-		}
-		else if (pSourceBitmap.Get())
-		{
-			hr = pSourceBitmap->CopyPixels(&SourceRect, Layout.Footprint.RowPitch, Layout.Footprint.RowPitch * TransferHeightInBlocks, ((BYTE*)pUploadData));
-		}
-		else
-		{
-			hr = GenerateMip(pResource->GeneratedImageIndex, &SourceRect, Layout.Footprint.RowPitch, Layout.Footprint.RowPitch * TransferHeightInBlocks, (UINT*)pUploadData);
-		}
+		hr = CopyMipSourceRows(pResource, &Source, &SourceRect, Layout.Footprint.RowPitch, Layout.Footprint.RowPitch * TransferHeightInBlocks, pUploadData);
 		if (FAILED(hr))
 		{
 			LOG_ERROR("Failed to copy frame data to upload staging buffer, hr=0x%.8x", hr);
@@ -1932,11 +1918,196 @@ HRESULT DX12Framework::LoadMip(Resource* pResource, UINT32 Mip)
 		RemainingBytes -= BytesInTransfer;
 	}
 
+	CompleteLoadMip(pResource, Mip, pResource->PagingPriority, RequestTick.QuadPart);
+
+	return S_OK;
+}
+
+//
+// BeginLoadMip prepares the tiles and an upload buffer for the mipmap on the paging thread,
+// and hands the mipmap to the decode workers. The resource is not given any more paging work
+// until FinishLoadMip completes the load.
+//
+HRESULT DX12Framework::BeginLoadMip(Resource* pResource, UINT32 Mip)
+{
+	HRESULT hr;
+
+	MipLoadRequest* pRequest = nullptr;
+	try
+	{
+		pRequest = new MipLoadRequest();
+	}
+	catch (std::bad_alloc&)
+	{
+		LOG_ERROR("Failed to allocate mip load request");
+		return E_OUTOFMEMORY;
+	}
+
+	pRequest->pResource = pResource;
+	pRequest->Mip = Mip;
+	pRequest->Priority = pResource->PagingPriority;
+	pRequest->Sequence = m_NextMipLoadSequence++;
+
+	LARGE_INTEGER RequestTick;
+	QueryPerformanceCounter(&RequestTick);
+	pRequest->RequestTick = RequestTick.QuadPart;
+
+	hr = PrepareMipHeaps(pResource, Mip);
+	if (FAILED(hr))
+	{
+		delete pRequest;
+		return hr;
+	}
+
+	//
+	// The upload buffer holds the whole mipmap, so the worker can decode it in one pass and
+	// the paging thread can transfer it with a single copy.
+	//
+	UINT64 TotalBytes;
+	D3D12_RESOURCE_DESC Desc = pResource->pDeviceState->pD3DResource->GetDesc();
+	m_pDevice->GetCopyableFootprints(&Desc, Mip, 1, 0, &pRequest->Layout, &pRequest->NumRows, nullptr, &TotalBytes);
+
+	hr = m_pDevice->CreateCommittedResource(
+		&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+		D3D12_HEAP_FLAG_NONE,
+		&CD3DX12_RESOURCE_DESC::Buffer(TotalBytes),
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&pRequest->pUploadBuffer));
+	if (FAILED(hr))
+	{
+		LOG_ERROR("Failed to create upload buffer, hr=0x%.8x", hr);
+		delete pRequest;
+		return hr;
+	}
+
+	CD3DX12_RANGE readRange(0, 0);
+	hr = pRequest->pUploadBuffer->Map(0, &readRange, &pRequest->pUploadData);
+	if (FAILED(hr))
+	{
+		LOG_ERROR("Failed to map upload buffer, hr=0x%.8x", hr);
+		delete pRequest;
+		return hr;
+	}
+
+	pResource->bLoadPending = true;
+	m_pWorkerThread->m_pDecodePool->Submit(pRequest);
+
+	return S_OK;
+}
+
+//
+// DecodeMip runs on a decode worker, and reads and decodes the whole mipmap into the
+// request's upload buffer.
+//
+HRESULT DX12Framework::DecodeMip(MipLoadRequest* pRequest)
+{
+	HRESULT hr;
+
+	MipSource Source;
+	hr = OpenMipSource(pRequest->pResource, pRequest->Mip, &Source);
+	if (FAILED(hr))
+	{
+		return hr;
+	}
+
+	pRequest->FrameInfo = Source.FrameInfo;
+
+	UINT RowPitch = pRequest->Layout.Footprint.RowPitch;
+
+	WICRect SourceRect;
+	SourceRect.X = 0;
+	SourceRect.Y = 0;
+	SourceRect.Width = Source.FrameInfo.WidthInBlocks;
+	SourceRect.Height = pRequest->NumRows;
+
+	hr = CopyMipSourceRows(pRequest->pResource, &Source, &SourceRect, RowPitch, RowPitch * pRequest->NumRows, pRequest->pUploadData);
+	if (FAILED(hr))
+	{
+		LOG_ERROR("Failed to copy frame data to upload staging buffer, hr=0x%.8x", hr);
+		return hr;
+	}
+
+	return S_OK;
+}
+
+//
+// FinishLoadMip runs on the paging thread once a decode worker has finished with the request,
+// and transfers the decoded mipmap into the reserved resource.
+//
+HRESULT DX12Framework::FinishLoadMip(MipLoadRequest* pRequest)
+{
+	HRESULT hr;
+
+	Resource* pResource = pRequest->pResource;
+	UINT32 Mip = pRequest->Mip;
+	const BitmapFrameInfo& MipFrameInfo = pRequest->FrameInfo;
+
+	pResource->bLoadPending = false;
+
+	if (FAILED(pRequest->DecodeResult))
+	{
+		return pRequest->DecodeResult;
+	}
+
+	m_PagingContext.Begin();
+
+	Frame* pPagingFrame = m_PagingContext.GetCurrentFrame();
+
+	UINT32 HeightInRows = pRequest->NumRows * MipFrameInfo.BlockHeight;
+
+	D3D12_BOX SrcBox =
+	{
+		0,                      // UINT left;
+		0,                      // UINT top;
+		0,                      // UINT front;
+		MipFrameInfo.WidthInBlocks * MipFrameInfo.BlockWidth, // UINT right;
+		HeightInRows,           // UINT bottom;
+		1,                      // UINT back;
+	};
+
+	CD3DX12_TEXTURE_COPY_LOCATION Dst(pResource->pDeviceState->pD3DResource, Mip);
+	CD3DX12_TEXTURE_COPY_LOCATION Src(pRequest->pUploadBuffer.Get(), pRequest->Layout);
+	Src.PlacedFootprint.Footprint.Height = HeightInRows;
+	Src.PlacedFootprint.Offset = 0;
+	pPagingFrame->pCommandList->CopyTextureRegion(&Dst, 0, 0, 0, &Src, &SrcBox);
+
+	//
+	// The transfer is still synchronized, but the decode workers continue decoding the next
+	// mipmaps while the paging thread waits for it.
+	//
+	hr = m_PagingContext.Execute();
+	if (FAILED(hr))
+	{
+		LOG_WARNING("Failed to transfer content for resource 0x%p, mip %d. hr=0x%.8x", pResource, Mip, hr);
+		return hr;
+	}
+
+	m_PagingContext.End();
+	m_PagingContext.Flush();
+
+	CompleteLoadMip(pResource, Mip, pRequest->Priority, pRequest->RequestTick);
+
+	return S_OK;
+}
+
+void DX12Framework::CompleteLoadMip(Resource* pResource, UINT32 Mip, ResourcePriority Priority, LONGLONG RequestTick)
+{
 	pResource->MostDetailedMipResident = Mip;
 
 	AddResourceCommitment(pResource);
 
-	return S_OK;
+	InterlockedIncrement(&m_MipsLoaded);
+
+	//
+	// Only mipmaps loaded because they are visible are timed until their first use. Prefetched
+	// mipmaps may not be drawn for a long time, and would skew the latency.
+	//
+	if (Priority <= ERP_High)
+	{
+		pResource->FirstUseRequestTick = RequestTick;
+		InterlockedExchange(&pResource->FirstUseMip, Mip);
+	}
 }
 
 _Use_decl_annotations_
@@ -2091,6 +2262,22 @@ void DX12Framework::FillRectangle(const RectF* pDest, const ColorF* pColor, Reso
 	UINT Mip = ReferenceResource(pResource, pCurrentFrame, pResource->VisibleMip);
 	SetShader(pCurrentFrame, &m_TextureShader);
 
+	//
+	// The first time a newly loaded mipmap (or a more detailed one) is drawn, record how long
+	// it took from the load request to becoming visible.
+	//
+	LONG FirstUseMip = pResource->FirstUseMip;
+	if (FirstUseMip != UNDEFINED_MIPMAP_INDEX &&
+		Mip <= (UINT)FirstUseMip &&
+		InterlockedCompareExchange(&pResource->FirstUseMip, UNDEFINED_MIPMAP_INDEX, FirstUseMip) == FirstUseMip)
+	{
+		LARGE_INTEGER Tick;
+		QueryPerformanceCounter(&Tick);
+
+		m_FirstUseLatencyTicks += Tick.QuadPart - pResource->FirstUseRequestTick;
+		++m_FirstUseCount;
+	}
+
 	typedef TextureShader::VertexFormat VertexType;
 
 	VertexType Vertices[] =
@@ -2325,6 +2512,40 @@ HRESULT DX12Framework::RenderInternal()
 	m_StatTimeBetweenFrames[m_StatIndex] = CalculateDeltaTime(CurrentTick.QuadPart, PrevTick.QuadPart, m_PerformanceFrequency.QuadPart);
 	m_LastFrameCounter = CurrentTick;
 
+	//
+	// Mipmap load throughput and first use latency are sampled over one second windows.
+	//
+	if (m_MipLoadWindowStart == 0)
+	{
+		m_MipLoadWindowStart = CurrentTick.QuadPart;
+	}
+	else if (CurrentTick.QuadPart - m_MipLoadWindowStart >= m_PerformanceFrequency.QuadPart)
+	{
+		LONG MipsLoaded = InterlockedExchange(&m_MipsLoaded, 0);
+		m_StatMipLoadRate = MipsLoaded / CalculateDeltaTime(CurrentTick.QuadPart, m_MipLoadWindowStart, m_PerformanceFrequency.QuadPart);
+
+		if (m_FirstUseCount > 0)
+		{
+			m_StatFirstUseLatency = CalculateDeltaTime(m_FirstUseLatencyTicks, 0, m_PerformanceFrequency.QuadPart) / m_FirstUseCount;
+		}
+
+		m_FirstUseLatencyTicks = 0;
+		m_FirstUseCount = 0;
+
+		LONG HeapsCreated = m_HeapPool.GetHeapsCreated();
+		LONG HeapsDestroyed = m_HeapPool.GetHeapsDestroyed();
+		LONG HeapsReused = m_HeapPool.GetHeapsReused();
+		float WindowTime = CalculateDeltaTime(CurrentTick.QuadPart, m_MipLoadWindowStart, m_PerformanceFrequency.QuadPart);
+		m_StatHeapCreateRate = (HeapsCreated - m_WindowHeapsCreated) / WindowTime;
+		m_StatHeapDestroyRate = (HeapsDestroyed - m_WindowHeapsDestroyed) / WindowTime;
+		m_StatHeapReuseRate = (HeapsReused - m_WindowHeapsReused) / WindowTime;
+		m_WindowHeapsCreated = HeapsCreated;
+		m_WindowHeapsDestroyed = HeapsDestroyed;
+		m_WindowHeapsReused = HeapsReused;
+
+		m_MipLoadWindowStart = CurrentTick.QuadPart;
+	}
+
 	//
 	// Prepare for a new frame.
 	//
@@ -2347,6 +2568,13 @@ HRESULT DX12Framework::RenderInternal()
 		QueryPerformanceCounter(&CurrentTick);
 
 		m_StatRenderScene[m_StatIndex] = CalculateDeltaTime(CurrentTick.QuadPart, PrevTick.QuadPart, m_PerformanceFrequency.QuadPart);
+
+		//
+		// RenderScene notifies the paging thread of visibility changes. Record how much of
+		// the scene time was spent doing so.
+		//
+		m_StatPagingSubmission[m_StatIndex] = CalculateDeltaTime(m_PagingSubmissionTicks, 0, m_PerformanceFrequency.QuadPart);
+		m_PagingSubmissionTicks = 0;
 	}
 
 	//
@@ -2485,76 +2713,17 @@ HRESULT DX12Framework::PageInNextLevelOfDetail(Resource* pResource)
 
 	assert(IsMoreDetailedMip(ResidentMip, Mip));
 
-	UINT32 MipHeap = GetMipHeapIndexForResource(pResource, Mip);
-	ResourceMip* pResourceMip = &pResource->pDeviceState->Mips[MipHeap];
-
-	if (*pResourceMip->ppHeaps == nullptr || Mip >= pResource->PackedMipHeapIndex)
-	{
-		//
-		// We need to create the heap and page in the texture from disk, since this
-		// mipmap has not yet been created. There is an exception for packed mipmaps,
-		// where the heap has been created, but we still need to copy the pixel data
-		// and possibly update the virtual address.
-		//
-		hr = LoadMip(pResource, Mip);
-		if (FAILED(hr))
-		{
-			LOG_WARNING("Failed to load mip");
-			return hr;
-		}
-	}
-	else
+	//
+	// Trimmed mipmaps return their tiles to the heap pool, so every mipmap is paged in by
+	// allocating tiles from the pool, mapping them and copying the pixel data from disk.
+	// Packed mipmaps keep their tiles, but we still need to copy the pixel data and
+	// possibly update the virtual address.
+	//
+	hr = LoadMip(pResource, Mip);
+	if (FAILED(hr))
 	{
-		UINT i;
-
-		//
-		// The texture was already loaded, but we evicted it. Make it resident now.
-		//
-		UINT HeapCount = GetResourceMipHeapCount(*pResourceMip);
-		for (i = 0; i < HeapCount; ++i)
-		{
-			//
-			// The MakeResident API is synchronous, and the resource is considered to
-			// be fully resident and usable by the GPU by the time the call returns.
-			//
-			ID3D12Pageable* pPageable = pResourceMip->ppHeaps[i];
-			hr = m_pDevice->MakeResident(1, &pPageable);
-			if (FAILED(hr))
-			{
-				LOG_ERROR("Failed to make resource 0x%p mip %d resident, hr=0x%.8x", pResource, Mip, hr);
-				break;
-			}
-		}
-
-		if (FAILED(hr))
-		{
-			assert(i > 0);
-
-			//
-			// Undo the MakeResident calls above.
-			//
-			while (i > 0)
-			{
-				ID3D12Pageable* pPageable = pResourceMip->ppHeaps[i];
-				HRESULT hrTemp = m_pDevice->Evict(1, &pPageable);
-				if (FAILED(hrTemp))
-				{
-					LOG_WARNING("Failed to evict resource 0x%p mip %d, hr=0x%.8x", pResource, Mip, hrTemp);
-				}
-				--i;
-			}
-
-			return hr;
-		}
-
-		pResource->MostDetailedMipResident = Mip;
-		pResource->MipRestriction = 0;
-
-		//
-		// Add this mipmap to the commitment lists, which is used to efficiently
-		// trim more detailed mips first.
-		//
-		AddResourceCommitment(pResource);
+		LOG_WARNING("Failed to load mip");
+		return hr;
 	}
 
 	return S_OK;
@@ -2596,6 +2765,15 @@ bool DX12Framework::TrimToTarget(ResourceTrimPass MaxPass, UINT64 TargetUsage)
 					continue;
 				}
 
+				if (pResource->bLoadPending)
+				{
+					//
+					// Skip resources with a mipmap in the decode workers. The load will make
+					// the next mip level resident, so the current one must stay resident too.
+					//
+					continue;
+				}
+
 				ResourceMip* pResourceMip = &pResource->pDeviceState->Mips[Mip];
 
 				UINT64 WaitFence = 0;
@@ -2652,27 +2830,328 @@ bool DX12Framework::TrimToTarget(ResourceTrimPass MaxPass, UINT64 TargetUsage)
 		}
 	}
 
+	//
+	// Trimming returns tiles to the heap pool, but only the heaps left empty give memory back
+	// to the budget. Compacting sparse heaps into the others may still reach the target.
+	//
+	while (CompactHeapPool(MaxPass))
+	{
+		UpdateVideoMemoryInfo();
+		if (m_LocalVideoMemoryInfo.CurrentUsage < TargetUsage)
+		{
+			return true;
+		}
+	}
+
 	return false;
 }
 
-void DX12Framework::TrimMip(Resource* pResource, UINT8 Mip)
+//
+// Returns true if the mipmap may be restricted from rendering during the given trimming pass.
+//
+static bool CanRestrictMip(const Resource* pResource, UINT8 Mip, ResourceTrimPass MaxPass)
 {
-	ResourceMip* pResourceMip = &pResource->pDeviceState->Mips[Mip];
+	switch (MaxPass)
+	{
+	case ERTP_Visible:
+		return true;
+	case ERTP_NonVisible:
+		return IsLessDetailedMip(Mip, pResource->VisibleMip);
+	case ERTP_NonPrefetchable:
+		return IsLessDetailedMip(Mip, pResource->PrefetchMip);
+	default:
+		return false;
+	}
+}
+
+//
+// Moves the tiles of the sparsest heap in the heap pool into the other resident heaps, so
+// that the heap can be evicted. The mipmaps are copied through a staging buffer on the paging
+// queue, and are restricted from rendering while they move, just like mipmaps being trimmed.
+// Returns true if a heap was compacted.
+//
+bool DX12Framework::CompactHeapPool(ResourceTrimPass MaxPass)
+{
+	HRESULT hr;
+
+	PoolHeap* pHeap = m_HeapPool.SelectCompactionHeap();
+	if (pHeap == nullptr)
+	{
+		return false;
+	}
+
+	TileRange* pRanges[MAX_COMPACTION_TILES];
+	UINT NumRanges = 0;
+
+	LIST_ENTRY* pListHead = &pHeap->RangeListHead;
+	for (LIST_ENTRY* pEntry = pListHead->Flink; pEntry != pListHead; pEntry = pEntry->Flink)
+	{
+		TileRange* pRange = CONTAINING_RECORD(pEntry, TileRange, HeapListEntry);
+
+		if (pRange->pResource->bLoadPending || !CanRestrictMip(pRange->pResource, pRange->MipHeap, MaxPass))
+		{
+			return false;
+		}
+
+		assert(NumRanges < MAX_COMPACTION_TILES);
+		pRanges[NumRanges++] = pRange;
+	}
 
 	//
-	// Evict all the heaps for this mipmap.
+	// Allocate the new tiles before touching the mipmaps, so nothing needs to be undone if
+	// the other heaps cannot hold them.
 	//
-	UINT HeapCount = GetResourceMipHeapCount(*pResourceMip);
-	for (UINT i = 0; i < HeapCount; ++i)
+	LIST_ENTRY NewRangeListHeads[MAX_COMPACTION_TILES];
+	for (UINT i = 0; i < NumRanges; ++i)
 	{
-		ID3D12Pageable* pPageable = pResourceMip->ppHeaps[i];
-		HRESULT hr = m_pDevice->Evict(1, &pPageable);
+		InitializeListHead(&NewRangeListHeads[i]);
+	}
+
+	hr = S_OK;
+	for (UINT i = 0; i < NumRanges && SUCCEEDED(hr); ++i)
+	{
+		TileRange* pRange = pRanges[i];
+		hr = m_HeapPool.Allocate(pRange->pResource, pRange->MipHeap, pRange->MipTileOffset, pRange->NumTiles, false, pHeap, &NewRangeListHeads[i]);
+	}
+
+	if (SUCCEEDED(hr) && m_pCompactionBuffer == nullptr)
+	{
+		hr = m_pDevice->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(MAX_COMPACTION_TILES * TILE_SIZE),
+			D3D12_RESOURCE_STATE_COPY_DEST,
+			nullptr,
+			IID_PPV_ARGS(&m_pCompactionBuffer));
 		if (FAILED(hr))
 		{
-			LOG_WARNING("Failed to evict resource 0x%p mip %d, hr=0x%.8x", pResource, Mip, hr);
+			LOG_ERROR("Failed to create compaction buffer, hr=0x%.8x", hr);
 		}
 	}
 
+	if (FAILED(hr))
+	{
+		for (UINT i = 0; i < NumRanges; ++i)
+		{
+			m_HeapPool.Free(&NewRangeListHeads[i]);
+		}
+		return false;
+	}
+
+	//
+	// Restrict the mipmaps from rendering, and wait for the last frame which referenced them.
+	//
+	UINT64 WaitFence = 0;
+	for (UINT i = 0; i < NumRanges; ++i)
+	{
+		Resource* pResource = pRanges[i]->pResource;
+		ResourceMip* pResourceMip = &pResource->pDeviceState->Mips[pRanges[i]->MipHeap];
+
+		EnterCriticalSection(&pResource->ReferenceLock);
+
+		if (pResourceMip->ReferenceFence > m_RenderContext.GetLastCompletedFence())
+		{
+			WaitFence = max(WaitFence, pResourceMip->ReferenceFence);
+		}
+
+		UINT8 Restriction = DecreaseMipQuality(pRanges[i]->MipHeap, 1);
+		if (Restriction > pResource->MipRestriction)
+		{
+			pResource->MipRestriction = Restriction;
+		}
+
+		LeaveCriticalSection(&pResource->ReferenceLock);
+	}
+
+	if (WaitFence > 0)
+	{
+		m_RenderContext.WaitForFence(WaitFence);
+	}
+
+	//
+	// Each mipmap subresource is transitioned once, although it may have several ranges
+	// in the heap.
+	//
+	D3D12_RESOURCE_BARRIER Barriers[MAX_COMPACTION_TILES];
+	UINT NumBarriers = 0;
+	for (UINT i = 0; i < NumRanges; ++i)
+	{
+		ID3D12Resource* pD3DResource = pRanges[i]->pResource->pDeviceState->pD3DResource;
+		UINT Subresource = pRanges[i]->MipHeap;
+
+		UINT j = 0;
+		while (j < NumBarriers &&
+			(Barriers[j].Transition.pResource != pD3DResource || Barriers[j].Transition.Subresource != Subresource))
+		{
+			++j;
+		}
+
+		if (j == NumBarriers)
+		{
+			Barriers[NumBarriers++] = CD3DX12_RESOURCE_BARRIER::Transition(pD3DResource, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE, Subresource);
+		}
+	}
+
+	//
+	// Copy the tiles out of the heap into the staging buffer.
+	//
+	m_PagingContext.Begin();
+
+	ID3D12GraphicsCommandList* pCommandList = m_PagingContext.GetCurrentFrame()->pCommandList;
+
+	pCommandList->ResourceBarrier(NumBarriers, Barriers);
+
+	UINT BufferTileOffsets[MAX_COMPACTION_TILES];
+	UINT BufferTileOffset = 0;
+	for (UINT i = 0; i < NumRanges; ++i)
+	{
+		TileRange* pRange = pRanges[i];
+		D3D12_TILED_RESOURCE_COORDINATE Coordinates = GetMipTileCoordinate(pRange->pResource, pRange->MipHeap, pRange->MipTileOffset);
+
+		D3D12_TILE_REGION_SIZE RegionSize = {};
+		RegionSize.NumTiles = pRange->NumTiles;
+
+		pCommandList->CopyTiles(
+			pRange->pResource->pDeviceState->pD3DResource,
+			&Coordinates,
+			&RegionSize,
+			m_pCompactionBuffer,
+			(UINT64)BufferTileOffset * TILE_SIZE,
+			D3D12_TILE_COPY_FLAG_SWIZZLED_TILED_RESOURCE_TO_LINEAR_BUFFER);
+
+		BufferTileOffsets[i] = BufferTileOffset;
+		BufferTileOffset += pRange->NumTiles;
+	}
+
+	for (UINT i = 0; i < NumBarriers; ++i)
+	{
+		std::swap(Barriers[i].Transition.StateBefore, Barriers[i].Transition.StateAfter);
+	}
+	pCommandList->ResourceBarrier(NumBarriers, Barriers);
+	pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_pCompactionBuffer, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_COPY_SOURCE));
+
+	hr = m_PagingContext.Execute();
+	m_PagingContext.End();
+
+	if (FAILED(hr))
+	{
+		LOG_WARNING("Failed to copy tiles for compaction, hr=0x%.8x", hr);
+
+		m_PagingContext.Flush();
+		for (UINT i = 0; i < NumRanges; ++i)
+		{
+			pRanges[i]->pResource->MipRestriction = 0;
+			m_HeapPool.Free(&NewRangeListHeads[i]);
+		}
+		return false;
+	}
+
+	//
+	// Remap the mipmaps to their new tiles. The queue executes the remapping after the copy
+	// above, and before the copy below.
+	//
+	for (UINT i = 0; i < NumRanges; ++i)
+	{
+		LIST_ENTRY* pNewListHead = &NewRangeListHeads[i];
+		for (LIST_ENTRY* pEntry = pNewListHead->Flink; pEntry != pNewListHead; pEntry = pEntry->Flink)
+		{
+			TileRange* pNewRange = CONTAINING_RECORD(pEntry, TileRange, MipListEntry);
+			MapTileRange(pNewRange->pResource, pNewRange->MipHeap, pNewRange, D3D12_TILE_MAPPING_FLAG_NONE);
+		}
+	}
+
+	//
+	// Copy the tiles back from the staging buffer into their new location.
+	//
+	m_PagingContext.Begin();
+
+	pCommandList = m_PagingContext.GetCurrentFrame()->pCommandList;
+
+	for (UINT i = 0; i < NumRanges; ++i)
+	{
+		LIST_ENTRY* pNewListHead = &NewRangeListHeads[i];
+		for (LIST_ENTRY* pEntry = pNewListHead->Flink; pEntry != pNewListHead; pEntry = pEntry->Flink)
+		{
+			TileRange* pNewRange = CONTAINING_RECORD(pEntry, TileRange, MipListEntry);
+			D3D12_TILED_RESOURCE_COORDINATE Coordinates = GetMipTileCoordinate(pNewRange->pResource, pNewRange->MipHeap, pNewRange->MipTileOffset);
+
+			D3D12_TILE_REGION_SIZE RegionSize = {};
+			RegionSize.NumTiles = pNewRange->NumTiles;
+
+			UINT SourceTileOffset = BufferTileOffsets[i] + (pNewRange->MipTileOffset - pRanges[i]->MipTileOffset);
+
+			pCommandList->CopyTiles(
+				pNewRange->pResource->pDeviceState->pD3DResource,
+				&Coordinates,
+				&RegionSize,
+				m_pCompactionBuffer,
+				(UINT64)SourceTileOffset * TILE_SIZE,
+				D3D12_TILE_COPY_FLAG_LINEAR_BUFFER_TO_SWIZZLED_TILED_RESOURCE);
+		}
+	}
+
+	pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_pCompactionBuffer, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_COPY_DEST));
+
+	hr = m_PagingContext.Execute();
+	if (FAILED(hr))
+	{
+		LOG_WARNING("Failed to copy tiles for compaction, hr=0x%.8x", hr);
+	}
+
+	m_PagingContext.End();
+	m_PagingContext.Flush();
+
+	//
+	// The mipmaps are now backed by their new ranges, so return the old ones to the pool.
+	// This empties the heap, which evicts it.
+	//
+	for (UINT i = 0; i < NumRanges; ++i)
+	{
+		Resource* pResource = pRanges[i]->pResource;
+		ResourceMip* pResourceMip = &pResource->pDeviceState->Mips[pRanges[i]->MipHeap];
+
+		while (!IsListEmpty(&NewRangeListHeads[i]))
+		{
+			InsertTailList(&pResourceMip->RangeListHead, RemoveHeadList(&NewRangeListHeads[i]));
+		}
+
+		m_HeapPool.Free(pRanges[i]);
+		pResource->MipRestriction = 0;
+	}
+
+	m_HeapPool.OnHeapCompacted();
+
+	return true;
+}
+
+void DX12Framework::TrimMip(Resource* pResource, UINT8 Mip)
+{
+	ResourceMip* pResourceMip = &pResource->pDeviceState->Mips[Mip];
+
+	//
+	// Unmap the mipmap, and return its tiles to the heap pool, where they can back any other
+	// resource. Only heaps which are left without any allocated tiles are evicted.
+	//
+	D3D12_TILED_RESOURCE_COORDINATE Coordinates = GetMipTileCoordinate(pResource, Mip, 0);
+
+	D3D12_TILE_REGION_SIZE RegionSize = {};
+	RegionSize.NumTiles = GetMipHeapTileCount(pResource, Mip);
+
+	D3D12_TILE_RANGE_FLAGS RangeFlags = D3D12_TILE_RANGE_FLAG_NULL;
+	m_PagingContext.GetCommandQueue()->UpdateTileMappings(
+		pResource->pDeviceState->pD3DResource,
+		1,
+		&Coordinates,
+		&RegionSize,
+		nullptr,
+		1,
+		&RangeFlags,
+		nullptr,
+		nullptr,
+		D3D12_TILE_MAPPING_FLAG_NONE);
+
+	m_HeapPool.Free(&pResourceMip->RangeListHead);
+
 	pResource->MostDetailedMipResident = DecreaseMipQuality(Mip, 1);
 	pResource->MipRestriction = 0;
 
@@ -2715,6 +3194,16 @@ void DX12Framework::RemoveResourceCommitment(Resource* pResource)
 	InsertTailList(&m_UncommittedListHead, &pResource->CommittedListEntry);
 }
 
+UINT DX12Framework::GetDecodeWorkerCount() const
+{
+	if (m_pWorkerThread == nullptr || m_pWorkerThread->m_pDecodePool == nullptr)
+	{
+		return 0;
+	}
+
+	return m_pWorkerThread->m_pDecodePool->GetNumWorkers();
+}
+
 void DX12Framework::LoadConfig(int argc, LPCSTR argv[])
 {
 	//
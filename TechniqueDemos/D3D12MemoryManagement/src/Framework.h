@@ -53,6 +53,8 @@ class DX12Framework
 {
 	friend class RenderContext;
 	friend class PagingContext;
+	friend class DecodeWorkerPool;
+	friend class HeapPool;
 
 private:
 	//
@@ -83,6 +85,13 @@ private:
 	HRESULT GetDdsFrameInfo(IWICDdsFrameDecode* pFrame, BitmapFrameInfo* pFormatInfo);
 	HRESULT GetBitmapFrameInfo(IWICBitmapFrameDecode* pFrame, BitmapFrameInfo* pFormatInfo);
 	HRESULT LoadMip(Resource* pResource, UINT32 Mip);
+	HRESULT BeginLoadMip(Resource* pResource, UINT32 Mip);
+	HRESULT DecodeMip(MipLoadRequest* pRequest);
+	void CompleteLoadMip(Resource* pResource, UINT32 Mip, ResourcePriority Priority, LONGLONG RequestTick);
+	HRESULT OpenMipSource(Resource* pResource, UINT32 Mip, MipSource* pSource);
+	HRESULT CopyMipSourceRows(Resource* pResource, const MipSource* pSource, WICRect* pRect, UINT RowPitch, UINT BufferSizeInBytes, _Out_writes_bytes_(BufferSizeInBytes) void* pBuffer);
+	HRESULT PrepareMipHeaps(Resource* pResource, UINT32 Mip);
+	void MapTileRange(Resource* pResource, UINT32 Mip, const TileRange* pRange, D3D12_TILE_MAPPING_FLAGS Flags);
 	HRESULT GenerateMip(UINT ImageIndex, WICRect* pRect, UINT RowPitch, UINT BufferSizeInBytes, _In_reads_bytes_(BufferSizeInBytes) UINT* pBuffer);
 	void RemoveResourceCommitment(Resource* pResource);
 	void AddResourceCommitment(Resource* pResource);
@@ -161,6 +170,13 @@ protected:
 	RenderContext m_RenderContext;
 	PagingContext m_PagingContext;
 
+	// Backs the mipmaps of every resource with tiles from a shared set of heaps. Only the
+	// paging thread allocates from the pool.
+	HeapPool m_HeapPool;
+
+	// Holds the tiles of a heap while it is compacted. Created the first time a heap is compacted.
+	ID3D12Resource* m_pCompactionBuffer = nullptr;
+
 	PagingWorkerThread* m_pWorkerThread = nullptr;
 
 	DescriptorInfo m_DescriptorInfo;
@@ -185,6 +201,9 @@ protected:
 	DWORD m_ThreadContextWaitHandleIndex = 0;
 	UINT64 m_LocalBudgetOverride = 0;
 
+	// Orders mipmap loads of the same priority for the decode workers.
+	UINT64 m_NextMipLoadSequence = 0;
+
 	//
 	// Camera
 	//
@@ -199,6 +218,27 @@ protected:
 	float m_StatTimeBetweenFrames[STATISTIC_COUNT];
 	float m_StatRenderScene[STATISTIC_COUNT];
 	float m_StatRenderUI[STATISTIC_COUNT];
+	float m_StatPagingSubmission[STATISTIC_COUNT];
+	LONGLONG m_PagingSubmissionTicks = 0;
+
+	// Mipmap load throughput and latency, sampled over one second windows. The paging
+	// thread counts loaded mipmaps, and the rendering thread measures the latency from
+	// requesting a visible mipmap to the first frame that draws with it.
+	volatile LONG m_MipsLoaded = 0;
+	LONGLONG m_MipLoadWindowStart = 0;
+	LONGLONG m_FirstUseLatencyTicks = 0;
+	UINT m_FirstUseCount = 0;
+	float m_StatMipLoadRate = 0.0f;
+	float m_StatFirstUseLatency = 0.0f;
+
+	// Heap pool activity, sampled over the same windows. The pool keeps cumulative counts,
+	// and these hold the counts at the start of the current window.
+	LONG m_WindowHeapsCreated = 0;
+	LONG m_WindowHeapsDestroyed = 0;
+	LONG m_WindowHeapsReused = 0;
+	float m_StatHeapCreateRate = 0.0f;
+	float m_StatHeapDestroyRate = 0.0f;
+	float m_StatHeapReuseRate = 0.0f;
 	UINT m_PreviousPresentCount = 0;
 	UINT m_PreviousRefreshCount = 0;
 	UINT m_GlitchCount = 0;
@@ -246,15 +286,36 @@ public:
 	//
 	inline void NotifyPagingWork(Resource* pResource)
 	{
+		//
+		// Track how long the rendering thread spends handing work to the paging thread, since
+		// any time spent here (e.g. contending with the paging thread) stalls the frame.
+		//
+		LARGE_INTEGER Start, End;
+		QueryPerformanceCounter(&Start);
 		m_pWorkerThread->EnqueueResource(pResource);
+		QueryPerformanceCounter(&End);
+
+		m_PagingSubmissionTicks += End.QuadPart - Start.QuadPart;
 	}
 	HRESULT PageInNextLevelOfDetail(Resource* pResource);
+	HRESULT FinishLoadMip(MipLoadRequest* pRequest);
 	bool TrimToTarget(ResourceTrimPass TrimLimit, UINT64 TargetUsage);
+	bool CompactHeapPool(ResourceTrimPass MaxPass);
 	inline bool TrimToBudget(ResourceTrimPass TrimLimit)
 	{
 		return TrimToTarget(TrimLimit, m_LocalVideoMemoryInfo.Budget);
 	}
 
+	//
+	// Returns the size of the heaps which the heap pool must make resident to page in the
+	// mip heap. This is zero when the mipmap fits in tiles the pool already has resident.
+	//
+	inline UINT64 GetMipHeapPagingSize(const Resource* pResource, UINT MipHeapIndex) const
+	{
+		bool bPinned = MipHeapIndex >= GetLeastDetailedMipHeapIndex(pResource);
+		return m_HeapPool.GetAllocationGrowth(GetMipHeapTileCount(pResource, MipHeapIndex), bPinned);
+	}
+
 	//
 	// Camera
 	//
@@ -285,6 +346,8 @@ public:
 		return m_GlitchCount;
 	}
 
+	UINT GetDecodeWorkerCount() const;
+
 	//
 	// Data Access
 	//
@@ -318,6 +381,11 @@ public:
 		return m_ThreadContextWaitHandleIndex;
 	}
 
+	inline bool IsUsingSharedStagingSurface() const
+	{
+		return m_bUseSharedStagingSurface;
+	}
+
 	bool IsUnderBudget() const
 	{
 		return m_LocalVideoMemoryInfo.CurrentUsage <= m_LocalVideoMemoryInfo.Budget;
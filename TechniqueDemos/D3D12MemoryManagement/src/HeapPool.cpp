@@ -0,0 +1,461 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#include "stdafx.h"
+
+//
+// HeapPool
+//
+// Each pooled heap tracks its free tiles in a bitmap. Allocations are made of one or more
+// ranges of contiguous tiles, and the pool only creates a new heap when the resident heaps
+// cannot hold the allocation. Heaps which become empty are evicted and kept for reuse, which
+// is much cheaper than creating a new heap, since the video memory manager only has to page
+// the heap back in.
+//
+
+HeapPool::HeapPool(DX12Framework* pFramework) :
+	m_pFramework(pFramework),
+	m_NumEmptyHeaps(0),
+	m_NumHeaps(0),
+	m_NumResidentHeaps(0),
+	m_HeapsCreated(0),
+	m_HeapsDestroyed(0),
+	m_HeapsReused(0),
+	m_HeapsCompacted(0)
+{
+	InitializeListHead(&m_ResidentListHeads[0]);
+	InitializeListHead(&m_ResidentListHeads[1]);
+	InitializeListHead(&m_EmptyListHead);
+}
+
+HeapPool::~HeapPool()
+{
+	DestroyDeviceDependentState();
+}
+
+void HeapPool::DestroyDeviceDependentState()
+{
+	//
+	// Every resource device state is destroyed before the pool, which returns all of their
+	// tiles. Only the heaps themselves are left.
+	//
+	LIST_ENTRY* ListHeads[] = { &m_ResidentListHeads[0], &m_ResidentListHeads[1], &m_EmptyListHead };
+	for (LIST_ENTRY* pListHead : ListHeads)
+	{
+		while (!IsListEmpty(pListHead))
+		{
+			PoolHeap* pHeap = CONTAINING_RECORD(RemoveHeadList(pListHead), PoolHeap, ListEntry);
+			assert(IsListEmpty(&pHeap->RangeListHead));
+
+			SafeRelease(pHeap->pHeap);
+			delete pHeap;
+		}
+	}
+
+	m_NumEmptyHeaps = 0;
+	m_NumHeaps = 0;
+	m_NumResidentHeaps = 0;
+}
+
+HRESULT HeapPool::Allocate(
+	Resource* pResource,
+	UINT8 MipHeap,
+	UINT MipTileOffset,
+	UINT NumTiles,
+	bool bPinned,
+	const PoolHeap* pExcludeHeap,
+	LIST_ENTRY* pRangeListHead)
+{
+	HRESULT hr;
+
+	UINT Remaining = NumTiles;
+	UINT Offset = MipTileOffset;
+	UINT NumAllocated;
+
+	//
+	// Give large mipmaps whole heaps, so that trimming them empties the heaps again.
+	//
+	while (pExcludeHeap == nullptr && Remaining >= TILES_PER_POOL_HEAP)
+	{
+		PoolHeap* pHeap;
+		hr = AcquireHeap(bPinned, &pHeap);
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+
+		hr = AllocateFromHeap(pHeap, pResource, MipHeap, Offset, TILES_PER_POOL_HEAP, pRangeListHead, &NumAllocated);
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+
+		Remaining -= NumAllocated;
+		Offset += NumAllocated;
+	}
+
+	//
+	// Place the rest in the fullest resident heap that can hold it, or failing that, spread
+	// it over the resident heaps with the most free tiles. Preferring full heaps leaves the
+	// sparse ones to drain, so they can be evicted.
+	//
+	while (Remaining > 0)
+	{
+		PoolHeap* pBestFit = nullptr;
+		PoolHeap* pLargest = nullptr;
+
+		LIST_ENTRY* pListHead = &m_ResidentListHeads[bPinned ? 1 : 0];
+		for (LIST_ENTRY* pEntry = pListHead->Flink; pEntry != pListHead; pEntry = pEntry->Flink)
+		{
+			PoolHeap* pHeap = CONTAINING_RECORD(pEntry, PoolHeap, ListEntry);
+			if (pHeap == pExcludeHeap || pHeap->NumFreeTiles == 0)
+			{
+				continue;
+			}
+
+			if (pHeap->NumFreeTiles >= Remaining &&
+				(pBestFit == nullptr || pHeap->NumFreeTiles < pBestFit->NumFreeTiles))
+			{
+				pBestFit = pHeap;
+			}
+
+			if (pLargest == nullptr || pHeap->NumFreeTiles > pLargest->NumFreeTiles)
+			{
+				pLargest = pHeap;
+			}
+		}
+
+		PoolHeap* pHeap = pBestFit ? pBestFit : pLargest;
+		if (pHeap == nullptr)
+		{
+			if (pExcludeHeap != nullptr)
+			{
+				return E_OUTOFMEMORY;
+			}
+
+			hr = AcquireHeap(bPinned, &pHeap);
+			if (FAILED(hr))
+			{
+				return hr;
+			}
+		}
+
+		hr = AllocateFromHeap(pHeap, pResource, MipHeap, Offset, Remaining, pRangeListHead, &NumAllocated);
+		if (FAILED(hr))
+		{
+			return hr;
+		}
+
+		Remaining -= NumAllocated;
+		Offset += NumAllocated;
+	}
+
+	return S_OK;
+}
+
+void HeapPool::Free(TileRange* pRange)
+{
+	PoolHeap* pHeap = pRange->pHeap;
+
+	RemoveEntryList(&pRange->HeapListEntry);
+	RemoveEntryList(&pRange->MipListEntry);
+	SetTileRange(pHeap, pRange->HeapTileOffset, pRange->NumTiles, true);
+	delete pRange;
+
+	if (pHeap->NumFreeTiles == TILES_PER_POOL_HEAP)
+	{
+		ReleaseHeap(pHeap);
+	}
+}
+
+void HeapPool::Free(LIST_ENTRY* pRangeListHead)
+{
+	while (!IsListEmpty(pRangeListHead))
+	{
+		Free(CONTAINING_RECORD(pRangeListHead->Flink, TileRange, MipListEntry));
+	}
+}
+
+UINT64 HeapPool::GetAllocationGrowth(UINT NumTiles, bool bPinned) const
+{
+	UINT64 Growth = (UINT64)(NumTiles / TILES_PER_POOL_HEAP) * MAX_HEAP_SIZE;
+	UINT Remaining = NumTiles % TILES_PER_POOL_HEAP;
+
+	const LIST_ENTRY* pListHead = &m_ResidentListHeads[bPinned ? 1 : 0];
+	for (const LIST_ENTRY* pEntry = pListHead->Flink; pEntry != pListHead && Remaining > 0; pEntry = pEntry->Flink)
+	{
+		const PoolHeap* pHeap = CONTAINING_RECORD(pEntry, PoolHeap, ListEntry);
+		Remaining -= min(Remaining, pHeap->NumFreeTiles);
+	}
+
+	if (Remaining > 0)
+	{
+		Growth += MAX_HEAP_SIZE;
+	}
+
+	return Growth;
+}
+
+PoolHeap* HeapPool::SelectCompactionHeap() const
+{
+	const LIST_ENTRY* pListHead = &m_ResidentListHeads[0];
+
+	UINT TotalFreeTiles = 0;
+	for (const LIST_ENTRY* pEntry = pListHead->Flink; pEntry != pListHead; pEntry = pEntry->Flink)
+	{
+		TotalFreeTiles += CONTAINING_RECORD(pEntry, PoolHeap, ListEntry)->NumFreeTiles;
+	}
+
+	PoolHeap* pSparsest = nullptr;
+	for (const LIST_ENTRY* pEntry = pListHead->Flink; pEntry != pListHead; pEntry = pEntry->Flink)
+	{
+		PoolHeap* pHeap = CONTAINING_RECORD(pEntry, PoolHeap, ListEntry);
+		UINT UsedTiles = TILES_PER_POOL_HEAP - pHeap->NumFreeTiles;
+
+		if (UsedTiles > MAX_COMPACTION_TILES ||
+			UsedTiles > TotalFreeTiles - pHeap->NumFreeTiles)
+		{
+			continue;
+		}
+
+		if (pSparsest == nullptr || pHeap->NumFreeTiles > pSparsest->NumFreeTiles)
+		{
+			pSparsest = pHeap;
+		}
+	}
+
+	return pSparsest;
+}
+
+HRESULT HeapPool::AcquireHeap(bool bPinned, PoolHeap** ppHeap)
+{
+	HRESULT hr;
+
+	PoolHeap* pHeap = nullptr;
+
+	if (!IsListEmpty(&m_EmptyListHead))
+	{
+		pHeap = CONTAINING_RECORD(RemoveHeadList(&m_EmptyListHead), PoolHeap, ListEntry);
+		--m_NumEmptyHeaps;
+
+		ID3D12Pageable* pPageable = pHeap->pHeap;
+		hr = m_pFramework->GetDevice()->MakeResident(1, &pPageable);
+		if (FAILED(hr))
+		{
+			LOG_ERROR("Failed to make pooled heap resident, hr=0x%.8x", hr);
+			SafeRelease(pHeap->pHeap);
+			delete pHeap;
+			--m_NumHeaps;
+			InterlockedIncrement(&m_HeapsDestroyed);
+			return hr;
+		}
+
+		InterlockedIncrement(&m_HeapsReused);
+	}
+	else
+	{
+		try
+		{
+			pHeap = new PoolHeap();
+		}
+		catch (std::bad_alloc&)
+		{
+			LOG_ERROR("Failed to allocate pooled heap");
+			return E_OUTOFMEMORY;
+		}
+
+		D3D12_HEAP_DESC heapDesc = {};
+
+		heapDesc.SizeInBytes = MAX_HEAP_SIZE;
+		heapDesc.Alignment = 0;
+		heapDesc.Properties.Type = D3D12_HEAP_TYPE_DEFAULT;
+		heapDesc.Properties.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+		heapDesc.Properties.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+
+		//
+		// Tier 1 heaps have restrictions on the type of information that can be stored in
+		// a heap. To accommodate this, we will retsrict the content to only shader resources.
+		// The heap cannot store textures that are used as render targets, depth-stencil
+		// output, or buffers. But this is okay, since we do not use these heaps for those
+		// purposes.
+		//
+		heapDesc.Flags = D3D12_HEAP_FLAG_DENY_RT_DS_TEXTURES | D3D12_HEAP_FLAG_DENY_BUFFERS;
+
+		hr = m_pFramework->GetDevice()->CreateHeap(&heapDesc, IID_PPV_ARGS(&pHeap->pHeap));
+		if (FAILED(hr))
+		{
+			LOG_ERROR("Failed to create D3D12 heap, hr=0x%.8x", hr);
+			delete pHeap;
+			return hr;
+		}
+
+		++m_NumHeaps;
+		InterlockedIncrement(&m_HeapsCreated);
+	}
+
+	for (UINT i = 0; i < POOL_HEAP_BITMAP_WORDS; ++i)
+	{
+		pHeap->FreeTiles[i] = ~0ull;
+	}
+	pHeap->NumFreeTiles = TILES_PER_POOL_HEAP;
+	pHeap->bPinned = bPinned;
+	pHeap->bResident = true;
+	InitializeListHead(&pHeap->RangeListHead);
+
+	InsertTailList(&m_ResidentListHeads[bPinned ? 1 : 0], &pHeap->ListEntry);
+	++m_NumResidentHeaps;
+
+	*ppHeap = pHeap;
+
+	return S_OK;
+}
+
+void HeapPool::ReleaseHeap(PoolHeap* pHeap)
+{
+	assert(IsListEmpty(&pHeap->RangeListHead));
+
+	RemoveEntryList(&pHeap->ListEntry);
+	--m_NumResidentHeaps;
+
+	if (m_NumEmptyHeaps < MAX_EMPTY_POOL_HEAPS)
+	{
+		//
+		// Keep the heap for reuse. Evicting it releases its video memory back to the budget,
+		// but the heap does not have to be created again.
+		//
+		ID3D12Pageable* pPageable = pHeap->pHeap;
+		HRESULT hr = m_pFramework->GetDevice()->Evict(1, &pPageable);
+		if (FAILED(hr))
+		{
+			LOG_WARNING("Failed to evict pooled heap, hr=0x%.8x", hr);
+		}
+
+		pHeap->bResident = false;
+		InsertTailList(&m_EmptyListHead, &pHeap->ListEntry);
+		++m_NumEmptyHeaps;
+	}
+	else
+	{
+		SafeRelease(pHeap->pHeap);
+		delete pHeap;
+		--m_NumHeaps;
+		InterlockedIncrement(&m_HeapsDestroyed);
+	}
+}
+
+HRESULT HeapPool::AllocateFromHeap(PoolHeap* pHeap, Resource* pResource, UINT8 MipHeap, UINT MipTileOffset, UINT NumTiles, LIST_ENTRY* pRangeListHead, UINT* pNumAllocated)
+{
+	UINT NumAllocated = 0;
+
+	UINT Start;
+	UINT Length;
+	while (NumAllocated < NumTiles && FindFreeRun(pHeap, NumTiles - NumAllocated, &Start, &Length))
+	{
+		TileRange* pRange;
+		try
+		{
+			pRange = new TileRange();
+		}
+		catch (std::bad_alloc&)
+		{
+			LOG_ERROR("Failed to allocate tile range");
+			*pNumAllocated = NumAllocated;
+			return E_OUTOFMEMORY;
+		}
+
+		pRange->pHeap = pHeap;
+		pRange->HeapTileOffset = Start;
+		pRange->NumTiles = Length;
+		pRange->pResource = pResource;
+		pRange->MipHeap = MipHeap;
+		pRange->MipTileOffset = MipTileOffset + NumAllocated;
+
+		SetTileRange(pHeap, Start, Length, false);
+		InsertTailList(&pHeap->RangeListHead, &pRange->HeapListEntry);
+		InsertTailList(pRangeListHead, &pRange->MipListEntry);
+
+		NumAllocated += Length;
+	}
+
+	*pNumAllocated = NumAllocated;
+
+	return S_OK;
+}
+
+//
+// Finds the first run of free tiles that is at least MaxTiles long, or otherwise the longest
+// run. The returned length is limited to MaxTiles.
+//
+bool HeapPool::FindFreeRun(const PoolHeap* pHeap, UINT MaxTiles, UINT* pStart, UINT* pLength)
+{
+	UINT BestStart = 0;
+	UINT BestLength = 0;
+
+	UINT RunStart = 0;
+	UINT RunLength = 0;
+	for (UINT i = 0; i < TILES_PER_POOL_HEAP; ++i)
+	{
+		if (pHeap->FreeTiles[i / 64] & (1ull << (i % 64)))
+		{
+			if (RunLength == 0)
+			{
+				RunStart = i;
+			}
+
+			if (++RunLength > BestLength)
+			{
+				BestStart = RunStart;
+				BestLength = RunLength;
+
+				if (BestLength >= MaxTiles)
+				{
+					break;
+				}
+			}
+		}
+		else
+		{
+			RunLength = 0;
+		}
+	}
+
+	*pStart = BestStart;
+	*pLength = min(BestLength, MaxTiles);
+
+	return BestLength > 0;
+}
+
+void HeapPool::SetTileRange(PoolHeap* pHeap, UINT Start, UINT Length, bool bFree)
+{
+	for (UINT i = Start; i < Start + Length; ++i)
+	{
+		UINT64 Bit = 1ull << (i % 64);
+		assert(((pHeap->FreeTiles[i / 64] & Bit) != 0) != bFree);
+
+		if (bFree)
+		{
+			pHeap->FreeTiles[i / 64] |= Bit;
+		}
+		else
+		{
+			pHeap->FreeTiles[i / 64] &= ~Bit;
+		}
+	}
+
+	if (bFree)
+	{
+		pHeap->NumFreeTiles += Length;
+	}
+	else
+	{
+		pHeap->NumFreeTiles -= Length;
+	}
+}
@@ -0,0 +1,185 @@
+//*********************************************************
+//
+// Copyright (c) Microsoft. All rights reserved.
+// This code is licensed under the MIT License (MIT).
+// THIS CODE IS PROVIDED *AS IS* WITHOUT WARRANTY OF
+// ANY KIND, EITHER EXPRESS OR IMPLIED, INCLUDING ANY
+// IMPLIED WARRANTIES OF FITNESS FOR A PARTICULAR
+// PURPOSE, MERCHANTABILITY, OR NON-INFRINGEMENT.
+//
+//*********************************************************
+
+#pragma once
+
+//
+// Every pooled heap is MAX_HEAP_SIZE, and is sub-allocated in tiles.
+//
+#define TILES_PER_POOL_HEAP (MAX_HEAP_SIZE / TILE_SIZE)
+#define POOL_HEAP_BITMAP_WORDS (TILES_PER_POOL_HEAP / 64)
+
+//
+// The number of empty heaps which are kept (evicted) for reuse. Heaps which become empty
+// beyond this count are destroyed.
+//
+#define MAX_EMPTY_POOL_HEAPS 8
+
+//
+// A heap is a candidate for compaction when at most 1/POOL_COMPACTION_DENSITY of its tiles
+// are in use. This also bounds the size of the staging buffer used to move the tiles.
+//
+#define POOL_COMPACTION_DENSITY 4
+#define MAX_COMPACTION_TILES (TILES_PER_POOL_HEAP / POOL_COMPACTION_DENSITY)
+
+//
+// A D3D12 heap owned by the pool. The least detailed mip heap of each resource (usually
+// the packed mipmaps) is never trimmed, so these are placed in their own pinned heaps to
+// keep them from holding on to heaps which would otherwise become empty.
+//
+struct PoolHeap
+{
+	LIST_ENTRY ListEntry;
+
+	ID3D12Heap* pHeap;
+
+	// One bit per tile, set when the tile is free.
+	UINT64 FreeTiles[POOL_HEAP_BITMAP_WORDS];
+	UINT NumFreeTiles;
+
+	bool bPinned;
+	bool bResident;
+
+	// The tile ranges allocated from this heap.
+	LIST_ENTRY RangeListHead;
+};
+
+//
+// A contiguous run of tiles in a pooled heap, mapped to a contiguous run of tiles in a
+// resource mipmap. A mipmap is backed by one or more ranges.
+//
+struct TileRange
+{
+	LIST_ENTRY HeapListEntry;
+	LIST_ENTRY MipListEntry;
+
+	PoolHeap* pHeap;
+	UINT HeapTileOffset;
+	UINT NumTiles;
+
+	Resource* pResource;
+	UINT8 MipHeap;
+	UINT MipTileOffset;
+};
+
+//
+// The heap pool backs the reserved resources with a shared set of MAX_HEAP_SIZE heaps.
+// Trimming a mipmap returns its tiles to the pool, where they can be mapped to any other
+// resource, so most paging operations only need UpdateTileMappings instead of creating,
+// evicting or destroying heaps.
+//
+// Mipmaps of at least a full heap are given whole heaps, so trimming them frees whole
+// heaps. Smaller mipmaps are packed into the fullest heap with room, which keeps the
+// remaining heaps sparse so they drain, or can be compacted, and be evicted.
+//
+// The pool is only used by the paging thread.
+//
+class HeapPool
+{
+public:
+	HeapPool(DX12Framework* pFramework);
+	~HeapPool();
+
+	void DestroyDeviceDependentState();
+
+	//
+	// Allocates tiles for NumTiles tiles of a resource mipmap, starting at MipTileOffset, and
+	// appends the ranges to pRangeListHead. When pExcludeHeap is set, the tiles are only taken
+	// from the other resident heaps and the pool never grows. This is used for compaction.
+	//
+	HRESULT Allocate(
+		Resource* pResource,
+		UINT8 MipHeap,
+		UINT MipTileOffset,
+		UINT NumTiles,
+		bool bPinned,
+		const PoolHeap* pExcludeHeap,
+		LIST_ENTRY* pRangeListHead);
+
+	// Returns the tiles of a single range, or every range in a list, to the pool.
+	void Free(TileRange* pRange);
+	void Free(LIST_ENTRY* pRangeListHead);
+
+	//
+	// Returns the number of bytes the pool must make resident to allocate NumTiles tiles,
+	// which is zero if the tiles fit in the resident heaps.
+	//
+	UINT64 GetAllocationGrowth(UINT NumTiles, bool bPinned) const;
+
+	//
+	// Returns the sparsest resident standard heap whose tiles fit in the other resident
+	// heaps, or null if there is no heap worth compacting.
+	//
+	PoolHeap* SelectCompactionHeap() const;
+
+	inline UINT GetNumHeaps() const
+	{
+		return m_NumHeaps;
+	}
+
+	inline UINT GetNumResidentHeaps() const
+	{
+		return m_NumResidentHeaps;
+	}
+
+	//
+	// Cumulative counters, read by the rendering thread for statistics.
+	//
+	inline LONG GetHeapsCreated() const
+	{
+		return m_HeapsCreated;
+	}
+
+	inline LONG GetHeapsDestroyed() const
+	{
+		return m_HeapsDestroyed;
+	}
+
+	inline LONG GetHeapsReused() const
+	{
+		return m_HeapsReused;
+	}
+
+	inline void OnHeapCompacted()
+	{
+		InterlockedIncrement(&m_HeapsCompacted);
+	}
+
+	inline LONG GetHeapsCompacted() const
+	{
+		return m_HeapsCompacted;
+	}
+
+private:
+	HRESULT AcquireHeap(bool bPinned, PoolHeap** ppHeap);
+	void ReleaseHeap(PoolHeap* pHeap);
+	HRESULT AllocateFromHeap(PoolHeap* pHeap, Resource* pResource, UINT8 MipHeap, UINT MipTileOffset, UINT NumTiles, LIST_ENTRY* pRangeListHead, UINT* pNumAllocated);
+
+	static bool FindFreeRun(const PoolHeap* pHeap, UINT MaxTiles, UINT* pStart, UINT* pLength);
+	static void SetTileRange(PoolHeap* pHeap, UINT Start, UINT Length, bool bFree);
+
+	DX12Framework* m_pFramework;
+
+	// Resident heaps with at least one allocated tile, per heap class (standard, pinned).
+	LIST_ENTRY m_ResidentListHeads[2];
+
+	// Evicted heaps with no allocated tiles, kept for reuse.
+	LIST_ENTRY m_EmptyListHead;
+	UINT m_NumEmptyHeaps;
+
+	UINT m_NumHeaps;
+	UINT m_NumResidentHeaps;
+
+	volatile LONG m_HeapsCreated;
+	volatile LONG m_HeapsDestroyed;
+	volatile LONG m_HeapsReused;
+	volatile LONG m_HeapsCompacted;
+};
@@ -15,8 +15,8 @@
 // PagingWorkerThread
 //
 // The paging worker thread is the powerhouse of the sample. This is where all the streaming,
-// prefetching, trimming, etc occurs. The worker thread is responsible for creating and
-// mapping the heaps for the resource mipmaps as they are needed.
+// prefetching, trimming, etc occurs. The worker thread is responsible for allocating and
+// mapping the tiles for the resource mipmaps as they are needed.
 //
 
 PagingWorkerThread::PagingWorkerThread(DX12Framework* pFramework) :
@@ -24,16 +24,12 @@ PagingWorkerThread::PagingWorkerThread(DX12Framework* pFramework) :
 	m_hThread(nullptr),
 	m_CurrentStatus(EWTS_Suspended),
 	m_RequestedStatus(EWTS_Suspended),
-	m_BudgetNotificationCookie(0)
+	m_BudgetNotificationCookie(0),
+	m_pSubmissionHead(nullptr),
+	m_NextTailSequence(0),
+	m_NextHeadSequence(-1),
+	m_pDecodePool(nullptr)
 {
-	InitializeListHead(&m_PrioritizationListHead);
-	for (int i = 0; i < _ERP_COUNT; ++i)
-	{
-		InitializeListHead(&m_PriorityQueues[i]);
-	}
-
-	InitializeCriticalSection(&m_PrioritizationListLock);
-
 	ZeroMemory(m_hWakeEvents, sizeof(m_hWakeEvents));
 }
 
@@ -51,6 +47,12 @@ PagingWorkerThread::~PagingWorkerThread()
 		CloseHandle(m_hThread);
 	}
 
+	//
+	// The decode workers signal one of the wake events, so stop them before the events are
+	// closed. Any mipmaps still being decoded are discarded.
+	//
+	SafeDelete(m_pDecodePool);
+
 	for (UINT i = 0; i < _countof(m_hWakeEvents); ++i)
 	{
 		if (m_hWakeEvents[i] != INVALID_HANDLE_VALUE)
@@ -93,6 +95,38 @@ HRESULT PagingWorkerThread::Init()
 		return HRESULT_FROM_WIN32(GetLastError());
 	}
 
+	//
+	// Mipmaps are decoded on a pool of worker threads, which lets the paging thread upload one
+	// mipmap while the next ones are being read and decoded. The shared staging surface is
+	// a single buffer that can only hold one transfer at a time, so it is loaded synchronously.
+	//
+	if (!m_pFramework->IsUsingSharedStagingSurface())
+	{
+		try
+		{
+			m_pDecodePool = new DecodeWorkerPool(m_pFramework);
+		}
+		catch (std::bad_alloc&)
+		{
+			LOG_ERROR("Failed to allocate decode worker pool");
+			return E_OUTOFMEMORY;
+		}
+
+		//
+		// Leave a core each for the rendering and paging threads.
+		//
+		SYSTEM_INFO SystemInfo;
+		GetSystemInfo(&SystemInfo);
+		UINT NumWorkers = SystemInfo.dwNumberOfProcessors > 2 ? SystemInfo.dwNumberOfProcessors - 2 : 1;
+
+		hr = m_pDecodePool->Init(NumWorkers, m_hWakeEvents[EWR_DecodeCompletion]);
+		if (FAILED(hr))
+		{
+			LOG_WARNING("Failed to initialize decode worker pool");
+			return hr;
+		}
+	}
+
 	m_hThread = CreateThread(nullptr, 0, PagingWorkerThread::ThreadEntry, this, 0, nullptr);
 	if (m_hThread == nullptr)
 	{
@@ -125,6 +159,23 @@ void PagingWorkerThread::Flush()
 	while (bMoreWork)
 	{
 		ProcessSubmission(&bMoreWork);
+
+		if (m_pDecodePool != nullptr)
+		{
+			//
+			// Mipmaps which are still being decoded must be finished as well, and finishing
+			// them may queue more paging work for their resources.
+			//
+			if (ProcessCompletedLoads())
+			{
+				bMoreWork = true;
+			}
+			else if (!bMoreWork && m_pDecodePool->GetNumInFlight() > 0)
+			{
+				WaitForSingleObject(m_hWakeEvents[EWR_DecodeCompletion], INFINITE);
+				bMoreWork = true;
+			}
+		}
 	}
 }
 
@@ -206,6 +257,10 @@ DWORD PagingWorkerThread::Run()
 				ProcessBudgetChangeNotification();
 				bMoreWork = true;
 			}
+			else if (Reason == EWR_DecodeCompletion)
+			{
+				bMoreWork = true;
+			}
 			else
 			{
 				assert(false);
@@ -214,6 +269,12 @@ DWORD PagingWorkerThread::Run()
 
 		if (bMoreWork)
 		{
+			//
+			// Upload any mipmaps the decode workers have finished, so that the resources can
+			// be prioritized for their next paging operation.
+			//
+			ProcessCompletedLoads();
+
 			//
 			// Reprioritize any resources which may have visibility changes.
 			//
@@ -223,6 +284,15 @@ DWORD PagingWorkerThread::Run()
 			// Process the next highest priority paging operation.
 			//
 			ProcessSubmission(&bMoreWork);
+
+			//
+			// Once there is no more paging work, compact the heap pool one heap at a time, so
+			// that sparse heaps are evicted. Visible mipmaps are left alone while idle.
+			//
+			if (!bMoreWork)
+			{
+				bMoreWork = m_pFramework->CompactHeapPool(ERTP_NonVisible);
+			}
 		}
 	}
 
@@ -233,7 +303,7 @@ void PagingWorkerThread::DiscardPendingWork()
 {
 	for (int i = 0; i < _ERP_COUNT; ++i)
 	{
-		InitializeListHead(&m_PriorityQueues[i]);
+		m_PriorityQueues[i].Clear();
 	}
 }
 
@@ -259,6 +329,16 @@ void PagingWorkerThread::ProcessSubmission(bool* pMoreWork)
 {
 	*pMoreWork = true;
 
+	//
+	// Limit the number of mipmaps being decoded at once, since each holds an upload buffer.
+	// The paging thread is woken again when a decode worker finishes.
+	//
+	if (m_pDecodePool != nullptr && m_pDecodePool->GetNumInFlight() >= MAX_PENDING_MIP_LOADS)
+	{
+		*pMoreWork = false;
+		return;
+	}
+
 	//
 	// Select the highest priority paging operation from the priority queues. SelectResource
 	// may return null if there are no entries, or if none of the operations can be selected
@@ -282,6 +362,8 @@ void PagingWorkerThread::ProcessSubmission(bool* pMoreWork)
 
 	//
 	// After the paging operation completes, we need to reprioritize this specific resource.
+	// If the mipmap is still being decoded, the resource is reprioritized once the load
+	// finishes instead.
 	//
 	PrioritizeResource(pResource);
 
@@ -297,6 +379,38 @@ void PagingWorkerThread::ProcessSubmission(bool* pMoreWork)
 	}
 }
 
+bool PagingWorkerThread::ProcessCompletedLoads()
+{
+	bool bAnyCompleted = false;
+
+	if (m_pDecodePool == nullptr)
+	{
+		return false;
+	}
+
+	//
+	// Copy each decoded mipmap into its resource, in the order the decode workers finished them.
+	//
+	MipLoadRequest* pRequest;
+	while ((pRequest = m_pDecodePool->PopCompleted()) != nullptr)
+	{
+		Resource* pResource = pRequest->pResource;
+
+		HRESULT hr = m_pFramework->FinishLoadMip(pRequest);
+		if (FAILED(hr))
+		{
+			LOG_WARNING("Failed to finish loading mip %d for resource 0x%p, hr=0x%.8x", pRequest->Mip, pResource, hr);
+		}
+
+		SafeDelete(pRequest);
+
+		PrioritizeResource(pResource);
+		bAnyCompleted = true;
+	}
+
+	return bAnyCompleted;
+}
+
 void PagingWorkerThread::ProcessBudgetChangeNotification()
 {
 	HRESULT hr;
@@ -326,35 +440,81 @@ void PagingWorkerThread::SetStatus(WorkerThreadStatus Status)
 void PagingWorkerThread::EnqueueResource(Resource* pResource)
 {
 	//
-	// Take the prioritization lock as we insert resources into the prioritization list.
-	// This synchronizes the rendering thread queuing work items with the paging thread
-	// prioritizing it.
+	// The rendering thread must never block on the paging thread, so resources are pushed
+	// onto a lock-free stack rather than a locked list. A resource that is already waiting
+	// to be prioritized does not need to be queued again, since the paging thread reads the
+	// latest visibility information when it gets to it.
 	//
-	EnterCriticalSection(&m_PrioritizationListLock);
-
-	if (pResource->PrioritizationEntry.Flink != nullptr)
+	if (InterlockedExchange(&pResource->SubmissionPending, 1) != 0)
 	{
-		RemoveEntryList(&pResource->PrioritizationEntry);
+		return;
 	}
-	InsertTailList(&m_PrioritizationListHead, &pResource->PrioritizationEntry);
 
-	LeaveCriticalSection(&m_PrioritizationListLock);
+	Resource* pHead;
+	do
+	{
+		pHead = m_pSubmissionHead;
+		pResource->pNextSubmission = pHead;
+	} while (InterlockedCompareExchangePointer((void* volatile*)&m_pSubmissionHead, pResource, pHead) != pHead);
 
-	SetEvent(m_hWakeEvents[EWR_Submission]);
+	//
+	// Only the first submission since the paging thread last drained the stack needs to
+	// wake it. Later submissions will be picked up by the same drain.
+	//
+	if (pHead == nullptr)
+	{
+		SetEvent(m_hWakeEvents[EWR_Submission]);
+	}
 }
 
 void PagingWorkerThread::ReprioritizeResources()
 {
-	EnterCriticalSection(&m_PrioritizationListLock);
-	while (!IsListEmpty(&m_PrioritizationListHead))
+	//
+	// Take every submitted resource in one operation. The stack holds the most recent
+	// submission first, so reverse it to prioritize resources in the order they were submitted.
+	//
+	Resource* pSubmissions = (Resource*)InterlockedExchangePointer((void* volatile*)&m_pSubmissionHead, nullptr);
+
+	Resource* pOrdered = nullptr;
+	while (pSubmissions != nullptr)
+	{
+		Resource* pNext = pSubmissions->pNextSubmission;
+		pSubmissions->pNextSubmission = pOrdered;
+		pOrdered = pSubmissions;
+		pSubmissions = pNext;
+	}
+
+	while (pOrdered != nullptr)
 	{
-		LIST_ENTRY* pEntry = RemoveHeadList(&m_PrioritizationListHead);
-		Resource* pResource = CONTAINING_RECORD(pEntry, Resource, PrioritizationEntry);
-		pResource->PrioritizationEntry.Flink = nullptr;
+		Resource* pResource = pOrdered;
+		pOrdered = pResource->pNextSubmission;
+		pResource->pNextSubmission = nullptr;
+
+		//
+		// Clear the pending flag before reading the visibility information, so that a change
+		// made by the rendering thread after this point submits the resource again.
+		//
+		InterlockedExchange(&pResource->SubmissionPending, 0);
 
 		PrioritizeResource(pResource);
 	}
-	LeaveCriticalSection(&m_PrioritizationListLock);
+}
+
+void PagingWorkerThread::QueueResource(Resource* pResource, ResourcePriority Priority, UINT8 TargetMip, bool bFront)
+{
+	pResource->PagingPriority = Priority;
+	pResource->PagingMipDeficit = (UINT8)(pResource->MostDetailedMipResident - TargetMip);
+	pResource->PagingSequence = bFront ? m_NextHeadSequence-- : m_NextTailSequence++;
+
+	m_PriorityQueues[Priority].Push(pResource);
+}
+
+void PagingWorkerThread::DequeueResource(Resource* pResource)
+{
+	if (pResource->PagingQueueIndex != INVALID_PAGING_QUEUE_INDEX)
+	{
+		m_PriorityQueues[pResource->PagingPriority].Remove(pResource);
+	}
 }
 
 void PagingWorkerThread::PrioritizeResource(Resource* pResource)
@@ -363,10 +523,15 @@ void PagingWorkerThread::PrioritizeResource(Resource* pResource)
 	UINT8 VisibleMip = pResource->VisibleMip;
 	UINT8 PrefetchMip = pResource->PrefetchMip;
 
-	if (pResource->PagingEntry.Flink != nullptr)
+	DequeueResource(pResource);
+
+	//
+	// A resource with a mipmap in the decode workers is not given more paging work until the
+	// load finishes, at which point it is prioritized again with its latest visibility.
+	//
+	if (pResource->bLoadPending)
 	{
-		RemoveEntryList(&pResource->PagingEntry);
-		pResource->PagingEntry.Flink = nullptr;
+		return;
 	}
 
 	bool AnyPackedMipsMissing = MostDetailedMipResident > GetLeastDetailedMipHeapIndex(pResource);
@@ -381,7 +546,7 @@ void PagingWorkerThread::PrioritizeResource(Resource* pResource)
 		// else. We want to make sure the user has *something* to see, even if it's just
 		// the 1x1 mipmap of a rough color.
 		//
-		InsertTailList(&m_PriorityQueues[ERP_VeryHigh], &pResource->PagingEntry);
+		QueueResource(pResource, ERP_VeryHigh, GetLeastDetailedMipHeapIndex(pResource), false);
 		pResource->TrimLimit = ERTP_Visible;
 		pResource->bIgnoreBudget = true;
 	}
@@ -392,7 +557,7 @@ void PagingWorkerThread::PrioritizeResource(Resource* pResource)
 		// one currently resident. This is high priority, because we want what's on screen
 		// to be visually correct.
 		//
-		InsertTailList(&m_PriorityQueues[ERP_High], &pResource->PagingEntry);
+		QueueResource(pResource, ERP_High, VisibleMip, false);
 		pResource->TrimLimit = ERTP_NonVisible;
 	}
 	else if (AnyPackedMipsMissing)
@@ -402,7 +567,7 @@ void PagingWorkerThread::PrioritizeResource(Resource* pResource)
 		// camera to be considered a lower priority. We will make sure that the stuff the user
 		// sees on screen gets loaded before this.
 		//
-		InsertHeadList(&m_PriorityQueues[ERP_Medium], &pResource->PagingEntry);
+		QueueResource(pResource, ERP_Medium, GetLeastDetailedMipHeapIndex(pResource), true);
 		pResource->TrimLimit = ERTP_Visible;
 		pResource->bIgnoreBudget = true;
 	}
@@ -411,8 +576,9 @@ void PagingWorkerThread::PrioritizeResource(Resource* pResource)
 		//
 		// This is a proximity prefetched mipmap. The user cannot see this mipmap yet, but it
 		// is nearby. We want to reduce any texture popping that may occur as the user scrolls
+		// Mipmaps the camera is predicted to reach soon go ahead of the other nearby ones.
 		//
-		InsertTailList(&m_PriorityQueues[ERP_Medium], &pResource->PagingEntry);
+		QueueResource(pResource, ERP_Medium, PrefetchMip, pResource->bPrefetchPredicted);
 		pResource->TrimLimit = ERTP_NonPrefetchable;
 
 		assert(PrefetchMip != UNDEFINED_MIPMAP_INDEX);
@@ -425,7 +591,7 @@ void PagingWorkerThread::PrioritizeResource(Resource* pResource)
 		// occur after everything else, but will help guarantee that the user gets a smooth
 		// experience at all times by prefetching the texture data prior to being needed.
 		//
-		InsertTailList(&m_PriorityQueues[ERP_Low], &pResource->PagingEntry);
+		QueueResource(pResource, ERP_Low, 0, false);
 		pResource->TrimLimit = ERTP_None;
 	}
 }
@@ -450,10 +616,9 @@ Resource* PagingWorkerThread::SelectResource()
 		//
 		UINT64 BudgetBias = _1MB + _8MB * i;
 
-		if (!IsListEmpty(&m_PriorityQueues[i]))
+		if (!m_PriorityQueues[i].IsEmpty())
 		{
-			LIST_ENTRY* pEntry = m_PriorityQueues[i].Flink;
-			Resource* pResource = CONTAINING_RECORD(pEntry, Resource, PagingEntry);
+			Resource* pResource = m_PriorityQueues[i].Top();
 
 			//
 			// The paging thread will only page in one mipmap at a time to be fair to all
@@ -467,11 +632,14 @@ Resource* PagingWorkerThread::SelectResource()
 			// loading a large 8Kx8K mipmap far off screen could cause a significant enough delay
 			// to prevent a mipmap on screen from being loaded by the time it is actually visible.
 			//
+			// The mipmap only adds to the budget usage if the heap pool does not already have
+			// enough free tiles resident to hold it.
+			//
 			UINT NextMip = IncreaseMipQuality(pResource->MostDetailedMipResident, 1);
 			UINT64 MipSize = 0;
 			if (NextMip < pResource->PackedMipHeapIndex)
 			{
-				MipSize = GetNonPackedMipSize(pResource, NextMip);
+				MipSize = m_pFramework->GetMipHeapPagingSize(pResource, NextMip);
 			}
 
 			//
@@ -498,8 +666,11 @@ Resource* PagingWorkerThread::SelectResource()
 				}
 			}
 
-			RemoveEntryList(pEntry);
-			pEntry->Flink = nullptr;
+			//
+			// Trimming may have reprioritized the resource, so remove it from whichever queue
+			// it is now in.
+			//
+			DequeueResource(pResource);
 			pResource->bIgnoreBudget = false;
 
 			return pResource;
@@ -509,6 +680,126 @@ Resource* PagingWorkerThread::SelectResource()
 	return nullptr;
 }
 
+//
+// PagingQueue
+//
+// Resources are kept in a binary heap ordered by IsMoreImportant. Each resource stores its
+// index in the heap so that it can be removed in O(log n) when it is reprioritized.
+//
+
+bool PagingQueue::IsMoreImportant(const Resource* pA, const Resource* pB)
+{
+	bool AQueuedAtFront = pA->PagingSequence < 0;
+	bool BQueuedAtFront = pB->PagingSequence < 0;
+	if (AQueuedAtFront != BQueuedAtFront)
+	{
+		return AQueuedAtFront;
+	}
+
+	if (pA->PagingMipDeficit != pB->PagingMipDeficit)
+	{
+		return pA->PagingMipDeficit > pB->PagingMipDeficit;
+	}
+
+	return pA->PagingSequence < pB->PagingSequence;
+}
+
+void PagingQueue::Place(Resource* pResource, UINT Index)
+{
+	m_Heap[Index] = pResource;
+	pResource->PagingQueueIndex = Index;
+}
+
+void PagingQueue::SiftUp(UINT Index)
+{
+	Resource* pResource = m_Heap[Index];
+	while (Index > 0)
+	{
+		UINT Parent = (Index - 1) / 2;
+		if (!IsMoreImportant(pResource, m_Heap[Parent]))
+		{
+			break;
+		}
+
+		Place(m_Heap[Parent], Index);
+		Index = Parent;
+	}
+	Place(pResource, Index);
+}
+
+void PagingQueue::SiftDown(UINT Index)
+{
+	UINT Count = (UINT)m_Heap.size();
+	Resource* pResource = m_Heap[Index];
+	for (;;)
+	{
+		UINT Child = Index * 2 + 1;
+		if (Child >= Count)
+		{
+			break;
+		}
+
+		if (Child + 1 < Count && IsMoreImportant(m_Heap[Child + 1], m_Heap[Child]))
+		{
+			++Child;
+		}
+
+		if (!IsMoreImportant(m_Heap[Child], pResource))
+		{
+			break;
+		}
+
+		Place(m_Heap[Child], Index);
+		Index = Child;
+	}
+	Place(pResource, Index);
+}
+
+void PagingQueue::Push(Resource* pResource)
+{
+	assert(pResource->PagingQueueIndex == INVALID_PAGING_QUEUE_INDEX);
+
+	m_Heap.push_back(pResource);
+	SiftUp((UINT)m_Heap.size() - 1);
+}
+
+void PagingQueue::Remove(Resource* pResource)
+{
+	UINT Index = pResource->PagingQueueIndex;
+	assert(Index < m_Heap.size() && m_Heap[Index] == pResource);
+
+	pResource->PagingQueueIndex = INVALID_PAGING_QUEUE_INDEX;
+
+	//
+	// Move the last resource into the hole, then restore the heap order in whichever
+	// direction it is out of place.
+	//
+	Resource* pLast = m_Heap.back();
+	m_Heap.pop_back();
+
+	if (pLast != pResource)
+	{
+		Place(pLast, Index);
+		if (Index > 0 && IsMoreImportant(pLast, m_Heap[(Index - 1) / 2]))
+		{
+			SiftUp(Index);
+		}
+		else
+		{
+			SiftDown(Index);
+		}
+	}
+}
+
+void PagingQueue::Clear()
+{
+	for (Resource* pResource : m_Heap)
+	{
+		pResource->PagingQueueIndex = INVALID_PAGING_QUEUE_INDEX;
+	}
+	m_Heap.clear();
+}
+
 //
 // PagingContext
 //
@@ -32,6 +32,10 @@ enum WakeReason
 	// resources to remain under the budget.
 	EWR_BudgetNotification,
 
+	// Indicates that a decode worker has finished decoding a mipmap, and the paging
+	// thread can copy it into the resource.
+	EWR_DecodeCompletion,
+
 	_EWR_COUNT
 };
 
@@ -47,6 +51,40 @@ enum WorkerThreadStatus
 	_EWTS_COUNT
 };
 
+#define INVALID_PAGING_QUEUE_INDEX UINT_MAX
+
+//
+// A binary heap of resources waiting for paging work at one priority. The resource that
+// should be paged in next is always at the top, and resources can be removed from any
+// position when they are reprioritized, since each resource tracks its own position.
+//
+class PagingQueue
+{
+public:
+	inline bool IsEmpty() const
+	{
+		return m_Heap.empty();
+	}
+
+	inline Resource* Top() const
+	{
+		return m_Heap.front();
+	}
+
+	void Push(Resource* pResource);
+	void Remove(Resource* pResource);
+	void Clear();
+
+private:
+	static bool IsMoreImportant(const Resource* pA, const Resource* pB);
+
+	void Place(Resource* pResource, UINT Index);
+	void SiftUp(UINT Index);
+	void SiftDown(UINT Index);
+
+	std::vector<Resource*> m_Heap;
+};
+
 //
 // The paging worker thread is the powerhouse behind all paging and texture streaming
 // for the sample.
@@ -73,18 +111,24 @@ private:
 	HANDLE m_hStatusChangeEvent;
 	DWORD m_BudgetNotificationCookie;
 
-	// Lock for accessing the prioritization list head, which is accessed by both
-	// the rendering and paging threads.
-	CRITICAL_SECTION m_PrioritizationListLock;
-
-	// A list of unprioritized resources. A resource must be prioritized before
+	// A lock-free stack of unprioritized resources, pushed by the rendering thread and
+	// drained all at once by the paging thread. A resource must be prioritized before
 	// any paging operations can occur, so that the paging thread knows how to process
 	// the resource.
-	LIST_ENTRY m_PrioritizationListHead;
+	Resource* volatile m_pSubmissionHead;
+
+	// An array of priority queues. The worker thread will process resources in these
+	// queues in strict order. Only the paging thread accesses them.
+	PagingQueue m_PriorityQueues[_ERP_COUNT];
+
+	// Counters used to order resources within a priority queue. Resources queued at the
+	// back take increasing values, and resources queued at the front decreasing ones.
+	INT64 m_NextTailSequence;
+	INT64 m_NextHeadSequence;
 
-	// An array of priority-ordered linked list heads. The worker thread will process
-	// resources in these arrays in strict order.
-	LIST_ENTRY m_PriorityQueues[_ERP_COUNT];
+	// Decodes mipmaps in parallel with the paging thread. This is null when mipmaps are
+	// loaded synchronously on the paging thread (e.g. when using the shared staging surface).
+	DecodeWorkerPool* m_pDecodePool;
 
 private:
 	PagingWorkerThread(DX12Framework* pFramework);
@@ -99,10 +143,13 @@ private:
 	void EnqueueResource(Resource* pResource);
 	void ReprioritizeResources();
 	void PrioritizeResource(Resource* pResource);
+	void QueueResource(Resource* pResource, ResourcePriority Priority, UINT8 TargetMip, bool bFront);
+	void DequeueResource(Resource* pResource);
 	Resource* SelectResource();
 
 	void ProcessStatusChangeRequest();
 	void ProcessSubmission(bool* pMoreWork);
+	bool ProcessCompletedLoads();
 	void ProcessBudgetChangeNotification();
 
 	void SetStatus(WorkerThreadStatus Status);
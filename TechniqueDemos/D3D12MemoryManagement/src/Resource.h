@@ -20,22 +20,25 @@ struct MipDescription
 {
 	UINT WidthInTiles;
 	UINT HeightInTiles;
-	UINT HeapStartIndex;
 };
 
 //
 // Stores information about each mipmap in a resource. This includes tile information,
-// an array of heaps backing the resource, and the last rendering fence which
+// the tile ranges backing the resource, and the last rendering fence which
 // referenced this specific mipmap.
-// Each mipmap may be backed by multiple heaps, currently defined in 16MB chunks.
-// Breaking large allocations into smaller chunks helps reduce pressure in the kernel's
-// memory manager when finding space to place the resource in VRAM, and reduces overall
-// memory fragmentation.
+// Each mipmap may be backed by tiles from multiple heaps in the heap pool, which are
+// currently 16MB each. Breaking large allocations into smaller chunks helps reduce
+// pressure in the kernel's memory manager when finding space to place the resource
+// in VRAM, and reduces overall memory fragmentation.
 //
 struct ResourceMip
 {
 	MipDescription Desc;
-	ID3D12Heap** ppHeaps;
+
+	// The TileRange objects backing the mipmap, linked by their MipListEntry. The list is
+	// empty while the mipmap is not resident.
+	LIST_ENTRY RangeListHead;
+
 	UINT64 ReferenceFence;
 };
 
@@ -78,7 +81,6 @@ enum ResourceTrimPass
 struct ResourceDeviceState
 {
 	ID3D12Resource* pD3DResource;
-	UINT32 NumHeaps;
 
 	//
 	// Mips must always be the last element, since it is actually a dynamic array.
@@ -102,11 +104,23 @@ struct Resource
 	// List entry for tracking the commitment of mipmaps for this resource.
 	LIST_ENTRY CommittedListEntry;
 
-	// List entry used by the worker thread to prioritize paging operations.
-	LIST_ENTRY PrioritizationEntry;
+	// Link used by the rendering thread to submit the resource to the worker thread
+	// for prioritization. See PagingWorkerThread::EnqueueResource.
+	Resource* pNextSubmission;
+
+	// Nonzero while the resource is waiting in the submission queue. A resource whose
+	// visibility changes several times before the worker thread runs is only queued once.
+	volatile LONG SubmissionPending;
+
+	// Position of the resource in the paging queue for PagingPriority, or
+	// INVALID_PAGING_QUEUE_INDEX if there is no paging work for it.
+	UINT PagingQueueIndex;
+	ResourcePriority PagingPriority;
 
-	// List entry used to track paging requests.
-	LIST_ENTRY PagingEntry;
+	// Orders resources within a paging queue. Resources queued at the front go first, then
+	// resources missing more mip levels, and otherwise resources go in the order they were queued.
+	UINT8 PagingMipDeficit;
+	INT64 PagingSequence;
 
 	CRITICAL_SECTION ReferenceLock;
 
@@ -163,6 +177,21 @@ struct Resource
 	// priority resources from trimming higher priority ones.
 	ResourceTrimPass TrimLimit;
 
+	// Set by the rendering thread when PrefetchMip was raised because the camera is moving
+	// toward the resource. Such prefetches are queued ahead of those for resources which
+	// are merely nearby.
+	bool bPrefetchPredicted;
+
+	// True while a mipmap for this resource is being decoded by the decode workers. The
+	// paging thread does not prioritize or trim the resource until it finishes the load.
+	bool bLoadPending;
+
+	// The most recently loaded mipmap that has not been rendered yet, or UNDEFINED_MIPMAP_INDEX,
+	// along with the time the load was requested. The rendering thread uses these to measure
+	// the latency from requesting a mipmap to its first visible use.
+	volatile LONG FirstUseMip;
+	LONGLONG FirstUseRequestTick;
+
 	//
 	// Device dependent state information.
 	//
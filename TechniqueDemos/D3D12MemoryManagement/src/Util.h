@@ -173,12 +173,27 @@ inline UINT GetVirtualKeyFromCharacter(char c)
 }
 
 //
-// Calculates the number of heaps required to page in the provided resource mipmap, based
-// on the maximimum heap size.
+// Calculates the tiled resource coordinate of a tile in a resource mipmap, given the tile's
+// offset from the start of the mipmap. Packed mipmaps are addressed as a single row of tiles.
 //
-inline UINT GetResourceMipHeapCount(const ResourceMip& rMip)
+inline D3D12_TILED_RESOURCE_COORDINATE GetMipTileCoordinate(_In_ const Resource* pResource, UINT32 Mip, UINT TileOffset)
 {
-	return ((rMip.Desc.WidthInTiles * rMip.Desc.HeightInTiles * TILE_SIZE) + MAX_HEAP_SIZE - 1) / MAX_HEAP_SIZE;
+	UINT WidthInTiles;
+	if (Mip >= pResource->PackedMipHeapIndex)
+	{
+		WidthInTiles = pResource->PackedMipTileCount;
+	}
+	else
+	{
+		WidthInTiles = pResource->pDeviceState->Mips[Mip].Desc.WidthInTiles;
+	}
+
+	D3D12_TILED_RESOURCE_COORDINATE Coordinates = {};
+	Coordinates.Subresource = Mip;
+	Coordinates.X = TileOffset % WidthInTiles;
+	Coordinates.Y = TileOffset / WidthInTiles;
+
+	return Coordinates;
 }
 
 //
@@ -205,6 +220,21 @@ inline UINT64 GetNonPackedMipSize(_In_ const Resource* pResource, UINT MipHeapIn
 	return (UINT64)pMip->Desc.WidthInTiles * (UINT64)pMip->Desc.HeightInTiles * TILE_SIZE;
 }
 
+//
+// Calculates the number of tiles backing a mip heap index. All packed mipmaps share the
+// tiles of a single mip heap index.
+//
+inline UINT GetMipHeapTileCount(_In_ const Resource* pResource, UINT MipHeapIndex)
+{
+	if (MipHeapIndex >= pResource->PackedMipHeapIndex)
+	{
+		return pResource->PackedMipTileCount;
+	}
+
+	ResourceMip* pMip = &pResource->pDeviceState->Mips[MipHeapIndex];
+	return pMip->Desc.WidthInTiles * pMip->Desc.HeightInTiles;
+}
+
 //
 // Gets a friendly string for the provided D3D feature level.
 //
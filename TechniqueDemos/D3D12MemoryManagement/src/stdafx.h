@@ -66,6 +66,7 @@
 #include <stdio.h>
 #include <new>
 #include <vector>
+#include <algorithm>
 #include <wrl.h>
 
 using Microsoft::WRL::ComPtr;
@@ -78,11 +79,17 @@ struct ResourceDeviceState;
 struct Resource;
 struct Buffer;
 struct DescriptorHeap;
+struct MipSource;
+struct MipLoadRequest;
+struct PoolHeap;
+struct TileRange;
 
 class DX12Framework;
 class Camera;
 class Context;
 class PagingWorkerThread;
+class DecodeWorkerPool;
+class HeapPool;
 class PagingContext;
 class RenderContext;
 class Shader;
@@ -124,7 +131,9 @@ struct ColorF
 #include "Context.h"
 #include "Render.h"
 #include "Paging.h"
+#include "HeapPool.h"
 #include "Framework.h"
+#include "Decode.h"
 
 template<typename T>
 inline void SafeRelease(T *&rpInterface)